@@ -2,15 +2,22 @@
 #define KA_SHA1_HPP
 #pragma once
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
-#include <openssl/sha.h>
-#include "scoped.hpp"
+#include <utility>
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
 #include "typetraits.hpp"
 
 /// @file Contains sha1 digest functions.
 ///
-/// The implementation relies on openssl.
+/// The implementation relies on openssl, which selects at runtime the fastest
+/// compression function supported by the CPU (SHA extensions, AVX2, SSSE3...)
+/// and falls back to a portable one otherwise.
 ///
 /// An alternative is `boost::uuids::detail::sha1` but:
 /// 1) it is in a `detail` namespace, so not officially supported
@@ -23,6 +30,47 @@ namespace ka {
   using sha1_digest_t = std::array<uint8_t, 20>;
 
   namespace detail {
+    struct evp_md_ctx_deleter_t {
+      void operator()(EVP_MD_CTX* ctx) const {
+        EVP_MD_CTX_free(ctx);
+      }
+    };
+
+    using evp_md_ctx_ptr_t = std::unique_ptr<EVP_MD_CTX, evp_md_ctx_deleter_t>;
+
+    // The sha1 digest method. OpenSSL 3 looks `EVP_sha1()` up in its
+    // providers at each initialization, so it is fetched once instead.
+    inline EVP_MD const* sha1_md() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+      static EVP_MD const* const md = EVP_MD_fetch(nullptr, "SHA1", nullptr);
+      return md;
+#else
+      return EVP_sha1();
+#endif
+    }
+
+    // Returns a digest context initialized for sha1, or null if it could not
+    // be created.
+    inline evp_md_ctx_ptr_t sha1_context() {
+      evp_md_ctx_ptr_t s{EVP_MD_CTX_new()};
+      if (!s || !EVP_DigestInit_ex(s.get(), sha1_md(), nullptr)) {
+        return {};
+      }
+      return s;
+    }
+
+    // Returns the context of the calling thread, reinitialized for sha1, or
+    // null if it could not be. Reusing it spares one-shot digests an
+    // allocation and the setup of the digest method each.
+    inline EVP_MD_CTX* sha1_thread_context() {
+      static thread_local evp_md_ctx_ptr_t const s = sha1_context();
+      // A null digest method restarts the one already set.
+      if (!s || !EVP_DigestInit_ex(s.get(), nullptr, nullptr)) {
+        return nullptr;
+      }
+      return s.get();
+    }
+
     // With pointers, we use the single-call update.
     //
     // Precondition: boundedRange(b, e) && s has been initialized
@@ -30,8 +78,8 @@ namespace ka {
     // I == T*, with T having the size of one byte (e.g. int8_t, uint8_t,
     // unsigned char on some platforms, etc.)
     template<typename I>
-    int sha1_update(SHA_CTX& s, I b, I e, std::true_type /* is_pointer */) {
-      return SHA1_Update(&s, b, e - b);
+    int sha1_update(EVP_MD_CTX& s, I b, I e, std::true_type /* is_pointer */) {
+      return EVP_DigestUpdate(&s, b, static_cast<std::size_t>(e - b));
     }
 
     // With non-pointer iterators, we update byte by byte.
@@ -40,11 +88,11 @@ namespace ka {
     //
     // InputIterator<T> I, with T having the size of one byte
     template<typename I>
-    int sha1_update(SHA_CTX& s, I b, I e, std::false_type /* is_pointer */) {
+    int sha1_update(EVP_MD_CTX& s, I b, I e, std::false_type /* is_pointer */) {
       int res = 1;
       while (b != e) {
         auto const c = *b;
-        res = SHA1_Update(&s, &c, 1u);
+        res = EVP_DigestUpdate(&s, &c, 1u);
         if (res == 0) {
           return res;
         }
@@ -52,6 +100,12 @@ namespace ka {
       }
       return res;
     }
+
+    // Precondition: s has been initialized
+    inline bool sha1_final(EVP_MD_CTX& s, sha1_digest_t& d) {
+      unsigned int size = 0;
+      return EVP_DigestFinal_ex(&s, d.data(), &size) && size == d.size();
+    }
   } // namespace detail
 
   /// Computes the sha1 digest of the given bytes.
@@ -66,25 +120,16 @@ namespace ka {
   sha1_digest_t sha1(I b, I e) {
     static_assert(sizeof(Decay<decltype(*b)>) == 1,
       "sha1: element size is different than 1.");
-    SHA_CTX x;
-    if (!SHA1_Init(&x)) {
+    auto const x = detail::sha1_thread_context();
+    if (!x) {
       throw std::runtime_error("Can't initialize the sha1 context. "
                                "data=\"" + std::string(b, e) + "\"");
     }
-    bool release = false;
-    auto _ = scoped([&]() {
-      if (!release) {
-        // `SHA1_Final` both computes and frees the context.
-        // Here we just want to free, but there's no other way...
-        SHA1_Final(sha1_digest_t{{0}}.data(), &x);
-      }
-    });
-    if (!detail::sha1_update(x, b, e, std::is_pointer<I>{})) {
+    if (!detail::sha1_update(*x, b, e, std::is_pointer<I>{})) {
       throw std::runtime_error("Can't update sha1 on \"" + std::string(b, e) + "\"");
     }
     sha1_digest_t d;
-    release = true;
-    if (!SHA1_Final(d.data(), &x)) {
+    if (!detail::sha1_final(*x, d)) {
       throw std::runtime_error("Can't compute sha1 on \"" + std::string(b, e) + "\"");
     }
     return d;
@@ -108,6 +153,111 @@ namespace ka {
     using std::end;
     return sha1(begin(l), end(l));
   }
+
+  /// Incremental sha1 computation.
+  ///
+  /// Useful when the data to hash is not available as a single range, for
+  /// example when it is made of the fields of an object: they can be hashed one
+  /// after the other, without first copying them into a temporary buffer.
+  ///
+  /// Example: hashing two strings
+  /// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  /// sha1_hasher_t h;
+  /// h.update(std::string{"youpi"});
+  /// h.update(std::string{"youp"});
+  /// assert(h.digest() == sha1(std::string{"youpiyoup"}));
+  /// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  ///
+  /// A copy of a hasher continues independently from the state of the original
+  /// one. This allows to compute the digest of several data sharing a prefix.
+  class sha1_hasher_t {
+    detail::evp_md_ctx_ptr_t _ctx;
+    bool _finalized = false;
+
+  public:
+    sha1_hasher_t() : _ctx(detail::sha1_context()) {
+      if (!_ctx) {
+        throw std::runtime_error("Can't initialize the sha1 context.");
+      }
+    }
+
+    sha1_hasher_t(sha1_hasher_t const& o)
+      : _ctx(EVP_MD_CTX_new())
+      , _finalized(o._finalized) {
+      if (!_ctx || !EVP_MD_CTX_copy_ex(_ctx.get(), o._ctx.get())) {
+        throw std::runtime_error("Can't copy the sha1 context.");
+      }
+    }
+
+    // There are no move operations: a moved-from hasher would have no
+    // context. Rvalues are copied.
+    sha1_hasher_t& operator=(sha1_hasher_t const& o) {
+      sha1_hasher_t copy{o};
+      std::swap(_ctx, copy._ctx);
+      _finalized = copy._finalized;
+      return *this;
+    }
+
+    /// Adds the given bytes to the data being hashed.
+    ///
+    /// Precondition: boundedRange(b, e) && !finalized()
+    ///
+    /// InputIterator<T> I, with T having the size of one byte
+    template<typename I>
+    sha1_hasher_t& update(I b, I e) {
+      static_assert(sizeof(Decay<decltype(*b)>) == 1,
+        "sha1_hasher_t: element size is different than 1.");
+      if (!detail::sha1_update(*_ctx, b, e, std::is_pointer<I>{})) {
+        throw std::runtime_error("Can't update sha1 on \"" + std::string(b, e) + "\"");
+      }
+      return *this;
+    }
+
+    /// Adds the given bytes to the data being hashed.
+    ///
+    /// The same warning as for `sha1(L const&)` applies to string literals.
+    ///
+    /// Precondition: !finalized()
+    ///
+    /// Linearizable<T> L, with T having the size of one byte
+    template<typename L>
+    sha1_hasher_t& update(L const& l) {
+      using std::begin;
+      using std::end;
+      return update(begin(l), end(l));
+    }
+
+    /// Adds the object representation of the given value to the data being
+    /// hashed.
+    ///
+    /// Precondition: !finalized()
+    ///
+    /// Arithmetic T
+    template<typename T>
+    sha1_hasher_t& update_value(T const& t) {
+      static_assert(std::is_arithmetic<T>::value,
+        "sha1_hasher_t: only the bytes of arithmetic values can be hashed.");
+      auto const p = reinterpret_cast<unsigned char const*>(&t);
+      return update(p, p + sizeof(T));
+    }
+
+    /// Computes the digest of all the bytes passed so far.
+    ///
+    /// Precondition: !finalized()
+    /// Postcondition: finalized()
+    sha1_digest_t digest() {
+      sha1_digest_t d;
+      _finalized = true;
+      if (!detail::sha1_final(*_ctx, d)) {
+        throw std::runtime_error("Can't compute sha1.");
+      }
+      return d;
+    }
+
+    bool finalized() const {
+      return _finalized;
+    }
+  };
 } // namespace ka
 
 #endif // KA_SHA1_HPP
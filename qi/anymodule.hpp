@@ -13,6 +13,8 @@
 #include <qi/log.hpp>
 #include <qi/anyobject.hpp>
 #include <qi/anyvalue.hpp>
+#include <qi/clock.hpp>
+#include <qi/future.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/shared_ptr.hpp>
 #include <qi/type/objecttypebuilder.hpp>
@@ -113,6 +115,38 @@ namespace qi
   QI_API AnyModule import(const std::string& name);
   QI_API AnyModule import(const ModuleInfo& name);
 
+  /** import a module on the event loop
+   *
+   *  Imports of the same module, asynchronous or not, share a single loading.
+   *  The task never blocks the event loop waiting for a loading in progress
+   *  in another thread: the returned future is set when that loading is done.
+   */
+  QI_API Future<AnyModule> importAsync(const std::string& name);
+
+  /// Outcome of the import of a module by preloadModules().
+  struct ModuleImportReport {
+    std::string name;
+    /// The imported module, invalid if the import failed.
+    AnyModule module;
+    /// Why the import failed, empty if it succeeded.
+    std::string error;
+    /// Time taken by the import, including waiting for an import of the same
+    /// module already in progress.
+    qi::Duration duration;
+  };
+
+  /** import modules concurrently on the event loop
+   *
+   *  The library lookups and the initializations of the modules run in
+   *  parallel. A module importing another one during its initialization
+   *  waits for it if it is being imported by another task, unless that task
+   *  waits for the module being initialized: such circular imports fail
+   *  instead of deadlocking. The future is set
+   *  when all the imports are done, failed imports are reported in their
+   *  entry rather than failing the future.
+   */
+  QI_API Future<std::vector<ModuleImportReport>> preloadModules(const std::vector<std::string>& names);
+
 }
 
 QI_TYPE_STRUCT(qi::ModuleInfo, name, type, path);
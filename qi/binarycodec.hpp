@@ -69,6 +69,24 @@ namespace qi {
    */
   QI_API AnyReference decodeBinary(qi::BufferReader *buf, AnyReference gvp, DeserializeObjectCallback onObject=DeserializeObjectCallback(), MessageSocketPtr socket = 0);
 
+  /** Decode content of \p buf, encoded with \p signature, into \p gvp.
+   *
+   * Unlike the overload without signature, the type of \p gvp does not need
+   * to have the signature of the data: it is decoded directly in the target,
+   * with no intermediate value. Numbers are widened or narrowed with range
+   * checks, containers are filled element by element and dynamic values
+   * receive the type of the signature.
+   * @param buf buffer with serialized data
+   * @param gvp initialized AnyReference of the target type. Will be filled in.
+   * @param signature signature the data was encoded with
+   * @param onObject callback invoked each time an object is encountered.
+   * @param socket connection context
+   * @return the filled reference
+   *
+   * @throw std::runtime_error when the decoding fail or the data does not fit the target type
+   */
+  QI_API AnyReference decodeBinary(qi::BufferReader *buf, AnyReference gvp, const Signature& signature, DeserializeObjectCallback onObject=DeserializeObjectCallback(), MessageSocketPtr socket = 0);
+
   template <typename T>
   AnyReference decodeBinary(qi::BufferReader *buf, T* value, DeserializeObjectCallback onObject, MessageSocketPtr socket) {
     return decodeBinary(buf, AnyReference::fromPtr(value), onObject, socket);
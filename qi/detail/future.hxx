@@ -218,6 +218,7 @@ namespace detail {
     template <typename T>
     void FutureBaseTyped<T>::executeCallbacks(bool defaultAsync, const Callbacks& callbacks, qi::Future<T>& future)
     {
+      std::size_t asyncCount = 0;
       for (const auto& callback : callbacks)
       {
         const bool async = [&]{
@@ -228,7 +229,10 @@ namespace detail {
         }();
 
         if (async)
+        {
+          ++asyncCount;
           getEventLoop()->post(boost::bind(callback.callback, future));
+        }
         else
           try
           {
@@ -246,6 +250,8 @@ namespace detail {
             qiLogError("qi.future") << "Unknown exception caught in future callback";
           }
       }
+      if (!callbacks.empty())
+        countCallbacks(callbacks.size() - asyncCount, asyncCount);
     }
 
     template <typename T>
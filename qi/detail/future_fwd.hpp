@@ -973,6 +973,8 @@ namespace qi {
       void reportCanceled();
       boost::recursive_mutex& mutex();
       void notifyFinish();
+      /// Count the callbacks run, for the metrics.
+      static void countCallbacks(std::size_t synchronous, std::size_t asynchronous);
 
     public:
       FutureBasePrivate *_p;
@@ -13,10 +13,13 @@ KA_WARNING_DISABLE(4503, ) // decorated name length
 
 # include <boost/thread/synchronized_value.hpp>
 # include <boost/function.hpp>
+# include <string>
+# include <vector>
 
 # include <qi/types.hpp>
 # include <qi/api.hpp>
 # include <qi/clock.hpp>
+# include <qi/stats.hpp>
 # include <qi/detail/executioncontext.hpp>
 
 KA_WARNING_PUSH()
@@ -28,6 +31,32 @@ namespace qi
   template<typename T> class Future;
 
   class EventLoopPrivate;
+
+  /**
+   * \brief Measurements of the tasks of an event loop.
+   * \includename{qi/eventloop.hpp}
+   *
+   * Every task is timestamped when it is posted, or when it is due for
+   * delayed tasks. Its queue delay is the time from that date until a worker
+   * starts running it.
+   */
+  struct EventLoopStatistics
+  {
+    /// Tasks waiting to run, including the delayed ones that are not due yet.
+    int64_t queuedTasks = 0;
+    /// Tasks running.
+    int64_t activeTasks = 0;
+    /// Worker threads.
+    int workers = 0;
+    /// Queue delays of the tasks run since the event loop was created.
+    LatencyHistogram queueDelay;
+    /// Run times of the tasks run since the event loop was created.
+    LatencyHistogram runTime;
+    /// Queue delay measured during the last monitoring period. The number of
+    /// threads grows when it exceeds `QI_EVENTLOOP_MAX_QUEUE_DELAY`.
+    Duration recentQueueDelay = Duration(0);
+  };
+
   /**
    * \brief Class to handle eventloop.
    * \includename{qi/eventloop.hpp}
@@ -57,6 +86,16 @@ namespace qi
     EventLoop(std::string name, int nthreads, int minThreads, int maxThreads,
               bool spawnOnOverload);
 
+    /**
+     * \see EventLoop(std::string, int, int, int, bool)
+     * \param cpus CPUs the threads of the event loop run on. If empty, they
+     *   may run on any CPU. When the CPUs belong to several NUMA nodes, each
+     *   worker thread runs on the CPUs of a single node, and the workers are
+     *   spread over the nodes in turn.
+     */
+    EventLoop(std::string name, int nthreads, int minThreads, int maxThreads,
+              bool spawnOnOverload, std::vector<int> cpus);
+
     /// \brief Default destructor.
     ~EventLoop() override;
 
@@ -98,7 +137,7 @@ namespace qi
      * \brief Sets the minimum number of threads in the pool.
      * \note It is safe to call this method concurrently.
      * \note It will be effectively taken into account the next time the
-     *       "ping task" is run (see environment variable `QI_EVENTLOOP_PING_TIMEOUT`).
+     *       monitoring task is run (see environment variable `QI_EVENTLOOP_PING_TIMEOUT`).
      */
     void setMinThreads(unsigned int min);
 
@@ -109,6 +148,12 @@ namespace qi
      */
     void setMaxThreads(unsigned int max);
 
+    /**
+     * \brief Gets the measurements of the tasks of the event loop.
+     * \note It is safe to call this method concurrently.
+     */
+    EventLoopStatistics statistics() const;
+
     /// \brief Internal function.
     void *nativeHandle();
 
@@ -198,12 +243,36 @@ namespace qi
     ) override;
   };
 
-  /// \brief Returns the global eventloop, created on demand on first call.
+  /**
+   * \brief Returns the global eventloop, created on demand on first call.
+   *
+   * Its threads run on the CPUs given by the `--qi-eventloop-cpus` command
+   * line option or the QI_EVENTLOOP_CPUS environment variable, if set.
+   */
   QI_API EventLoop* getEventLoop();
 
-  /// \brief Returns the global network eventloop, created on demand on first call.
+  /**
+   * \brief Returns the global network eventloop, created on demand on first call.
+   *
+   * Its threads run on the CPUs given by the `--qi-network-eventloop-cpus`
+   * command line option or the QI_NETWORK_EVENTLOOP_CPUS environment
+   * variable, if set. Keeping them away from the CPUs of the global eventloop
+   * or of real-time threads avoids sharing their caches.
+   */
   QI_API EventLoop* getNetworkEventLoop();
 
+  /**
+   * \brief Returns one of the network eventloops, in turn, to spread sockets
+   *   over them. They are created on demand on first call.
+   *
+   * There are as many network eventloops as given by the
+   * `--qi-network-eventloop-count` command line option or the
+   * QI_NETWORK_EVENTLOOP_COUNT environment variable, 1 by default. Each one
+   * has a single thread. The first one is the one returned by
+   * getNetworkEventLoop().
+   */
+  QI_API EventLoop* nextNetworkEventLoop();
+
   /**
    * \brief Starts the eventloop with nthread threads. Does nothing if already started.
    * \param nthread Set the minimum number of worker threads in the pool.
@@ -225,6 +294,16 @@ namespace qi
       }
     };
 
+    /**
+     * Parse a list of CPUs such as "0-3,6", as used by cpusets.
+     * \throw std::runtime_error if the list is invalid.
+     */
+    QI_API std::vector<int> parseCPUList(const std::string& list);
+
+    /// Split `cpus` by NUMA node, in the order of the nodes. CPUs of an
+    /// unknown node are grouped together.
+    QI_API std::vector<std::vector<int>> cpuSetsByNumaNode(const std::vector<int>& cpus);
+
     using IntPercent = int;
 
     // Percent of `n` in `[a, b]` (i.e. `a` and `b` included).
@@ -7,6 +7,8 @@
 #ifndef _QI_TYPE_JSONCODEC_HPP_
 #define _QI_TYPE_JSONCODEC_HPP_
 
+#include <cstddef>
+#include <string>
 #include <qi/api.hpp>
 #include <qi/anyvalue.hpp>
 
@@ -19,11 +21,44 @@ namespace qi {
   const JsonOption JsonOption_Expand = 2;
 
   /** @return the value encoded in JSON.
+   * Raw buffers (qi::Buffer) are encoded as base64 strings.
    * @param val Value to encode
    * @param jsonPrintOption Option to change JSON output
    */
   QI_API std::string encodeJSON(const qi::AutoAnyReference &val, JsonOption jsonPrintOption = JsonOption_None);
 
+  /** Append the value encoded in JSON to a string.
+   * Reusing the same output string between calls spares its reallocations.
+   * @param val Value to encode
+   * @param out String the encoded value is appended to
+   * @param jsonPrintOption Option to change JSON output
+   */
+  QI_API void encodeJSON(const qi::AutoAnyReference &val, std::string &out, JsonOption jsonPrintOption = JsonOption_None);
+
+  /**
+   * Receives the elements of a JSON document, in order, as they are decoded.
+   *
+   * The strings given to onString() and onKey() are UTF-8 encoded, unescaped,
+   * and only valid during the call. Throwing from a callback aborts the
+   * decoding and the exception is propagated to the caller of decodeJSON().
+   */
+  class QI_API JsonHandler
+  {
+  public:
+    virtual ~JsonHandler();
+    virtual void onNull() = 0;
+    virtual void onBool(bool value) = 0;
+    virtual void onInt(int64_t value) = 0;
+    virtual void onDouble(double value) = 0;
+    virtual void onString(const char* data, std::size_t size) = 0;
+    virtual void onBeginArray() = 0;
+    virtual void onEndArray() = 0;
+    virtual void onBeginObject() = 0;
+    /// Called with the key of each member of an object, before its value.
+    virtual void onKey(const char* data, std::size_t size) = 0;
+    virtual void onEndObject() = 0;
+  };
+
   /**
     * creates a GV representing a JSON string or throw on parse error.
     * @param in JSON string to decode.
@@ -42,6 +77,35 @@ namespace qi {
                                          const std::string::const_iterator &end,
                                          AnyValue &target);
 
+  /**
+    * decode the JSON sequence between two string iterators, forwarding its elements to a handler,
+    * or throw on parse error.
+    * No value is built: it is up to the handler to keep what it needs.
+    * @param begin iterator to the beginning of the sequence to decode.
+    * @param end iterator to the end of the sequence to decode.
+    * @param handler receives the elements of the sequence.
+    * @return an iterator to the last read char + 1
+    */
+  QI_API std::string::const_iterator decodeJSON(const std::string::const_iterator &begin,
+                                         const std::string::const_iterator &end,
+                                         JsonHandler &handler);
+
+  /**
+    * decode a JSON string directly into a value of the type of the target, without building
+    * an intermediate GV, or throw on parse error or if the JSON does not match the type.
+    * As with decodeBinary(), the target is modified in place: it should be default constructed.
+    * Objects decode into maps or into structs with named fields, arrays into lists or tuples,
+    * base64 strings into raw buffers.
+    * @param in JSON string to decode.
+    * @param target reference to the value to fill.
+    */
+  QI_API void decodeJSON(const std::string &in, AnyReference target);
+
+  template <typename T>
+  void decodeJSON(const std::string &in, T* target)
+  {
+    decodeJSON(in, AnyReference::fromPtr(target));
+  }
 
 
 }
@@ -0,0 +1,41 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_METRICSSERVICE_HPP_
+#define _QIMESSAGING_METRICSSERVICE_HPP_
+
+#include <qi/anyobject.hpp>
+#include <qi/api.hpp>
+#include <qi/metrics.hpp>
+
+namespace qi
+{
+  namespace metrics
+  {
+    /// Name under which ApplicationSession registers the service when the
+    /// metrics are enabled.
+    static const char* const serviceName = "qi.Metrics";
+
+    /**
+     * @return An object publishing the metrics of the process, with the
+     * methods:
+     * - `std::vector<MetricSample> collect()`,
+     * - `std::string prometheusText()`,
+     * - `bool isEnabled()` and `void setEnabled(bool)`.
+     */
+    QI_API qi::AnyObject makeService();
+  }
+}
+
+QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::metrics::MetricSample,
+  ("name",      name),
+  ("help",      help),
+  ("type",      type),
+  ("labels",    labels),
+  ("value",     value),
+  ("histogram", histogram));
+
+#endif  // _QIMESSAGING_METRICSSERVICE_HPP_
@@ -0,0 +1,109 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_METHODHANDLE_HPP_
+#define _QI_METHODHANDLE_HPP_
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <qi/anyobject.hpp>
+
+namespace qi
+{
+
+namespace detail
+{
+  /**
+   * Find the method of `object` called with parameters of the given
+   * signature, and check that its result can be converted to the return
+   * signature. Throw if no method, or more than one, matches.
+   */
+  QI_API unsigned int bindMethod(const AnyObject& object,
+                                 const std::string& nameWithOptionalSignature,
+                                 const Signature& parametersSignature,
+                                 const Signature& returnSignature);
+}
+
+/**
+ * A method of an object, resolved once to be called many times.
+ *
+ * Binding the handle finds the method and its overload from the parameter
+ * types, and checks the return type, once. Calls through the handle then go
+ * straight to the method, for local and remote objects alike, while
+ * AnyObject::call repeats this work at each call.
+ *
+ * The handle keeps the object alive.
+ *
+ * \code
+ *   qi::MethodHandle<int(int, int)> add(obj, "add");
+ *   int three = add(1, 2);
+ * \endcode
+ *
+ * \includename{qi/methodhandle.hpp}
+ */
+template <typename F>
+class MethodHandle;
+
+template <typename R, typename... Args>
+class MethodHandle<R(Args...)>
+{
+public:
+  MethodHandle() = default;
+
+  /// Bind the method of the given name, or signature 'name::(args)', of object.
+  /// @throw std::runtime_error if no method matches.
+  MethodHandle(const AnyObject& object, const std::string& nameWithOptionalSignature)
+    : _object(object)
+    , _methodId(detail::bindMethod(
+          object, nameWithOptionalSignature,
+          makeTupleSignature(std::vector<TypeInterface*>{ typeOf<typename std::decay<Args>::type>()... }),
+          typeOf<R>()->signature()))
+  {
+  }
+
+  bool isValid() const { return _object.isValid(); }
+  explicit operator bool() const { return isValid(); }
+
+  const AnyObject& object() const { return _object; }
+  unsigned int methodId() const { return _methodId; }
+
+  /// Call the method and wait for its result.
+  R operator()(Args... args) const
+  {
+    static_assert(!detail::isFuture<R>::value, "return type of a method handle must not be a Future");
+    if (!isValid())
+      throw std::runtime_error("Invalid MethodHandle");
+    GenericFunctionParameters params;
+    params.assign({ AnyReference::from(args)... });
+    return detail::extractFuture<R>(_object.asGenericObject()->metaCallNoUnwrap(
+        _methodId, params, MetaCallType_Direct, Signature()));
+  }
+
+  /// Call the method asynchronously.
+  /// If the method returned a future, the future is unwrapped.
+  Future<R> async(Args... args) const
+  {
+    if (!isValid())
+      return makeFutureError<R>("Invalid MethodHandle");
+    GenericFunctionParameters params;
+    params.assign({ AnyReference::from(args)... });
+    auto futureMeta = _object.asGenericObject()->metaCallNoUnwrap(
+        _methodId, params, MetaCallType_Queued, Signature());
+    Promise<R> result;
+    adaptFutureUnwrap(futureMeta, result);
+    return result.future();
+  }
+
+private:
+  AnyObject _object;
+  unsigned int _methodId = 0;
+};
+
+}
+
+#endif  // _QI_METHODHANDLE_HPP_
@@ -0,0 +1,221 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_METRICS_HPP_
+# define _QI_METRICS_HPP_
+
+# include <atomic>
+# include <cstdint>
+# include <iosfwd>
+# include <map>
+# include <string>
+# include <vector>
+# include <boost/function.hpp>
+# include <boost/noncopyable.hpp>
+# include <qi/api.hpp>
+# include <qi/clock.hpp>
+# include <qi/stats.hpp>
+
+namespace qi
+{
+  /**
+   * Process wide registry of counters, gauges and histograms.
+   *
+   * Metrics are identified by a name and labels, as in Prometheus. Getting a
+   * metric that does not exist creates it, and metrics are never destroyed:
+   * instrumented code keeps a reference to the ones it updates.
+   *
+   * Counters and histograms only record while the metrics are enabled, which
+   * they are not by default. Set the QI_METRICS environment variable to 1 or
+   * call setEnabled() to enable them. Gauges track levels and are therefore
+   * always up to date, except the strand and send queue gauges, which every
+   * strand and socket would otherwise update on each task and message: a
+   * queue is accounted in them while the metrics are enabled, from its next
+   * change on.
+   *
+   * libqi publishes:
+   * - qi_eventloop_queued_tasks, qi_eventloop_active_tasks and
+   *   qi_eventloop_workers, gauges labelled by event loop,
+   * - qi_eventloop_recent_queue_delay_seconds, the queue delay the size of
+   *   each event loop is based on,
+   * - qi_eventloop_task_delay_seconds and qi_eventloop_task_duration_seconds,
+   *   histograms of the time tasks wait before running, and of their run time,
+   * - qi_strand_queued_tasks, tasks waiting in all strands,
+   * - qi_socket_send_queue_bytes, bytes waiting in the send queues of all
+   *   sockets,
+   * - qi_messages_sent_total, qi_messages_received_total and the matching
+   *   _bytes_total counters, labelled by message type,
+   * - qi_message_encode_duration_seconds and
+   *   qi_message_decode_duration_seconds, histograms of the serialization of
+   *   message payloads,
+   * - qi_future_continuations_total, callbacks of futures run, labelled by
+   *   whether they were posted to the event loop.
+   */
+  namespace metrics
+  {
+    enum MetricType
+    {
+      MetricType_Counter   = 0,
+      MetricType_Gauge     = 1,
+      MetricType_Histogram = 2,
+    };
+
+    using Labels = std::map<std::string, std::string>;
+
+    namespace detail
+    {
+      QI_API std::atomic<bool>& enabledFlag();
+    }
+
+    /// @return Whether counters and histograms record.
+    inline bool isEnabled()
+    {
+      return detail::enabledFlag().load(std::memory_order_relaxed);
+    }
+
+    QI_API void setEnabled(bool enabled);
+
+    /// Monotonic count of events.
+    class QI_API Counter : private boost::noncopyable
+    {
+    public:
+      Counter() : _value(0) {}
+
+      /// Count \p n events, if the metrics are enabled.
+      void add(std::uint64_t n = 1)
+      {
+        if (isEnabled())
+          _value.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      std::uint64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+      std::atomic<std::uint64_t> _value;
+    };
+
+    /// Level that goes up and down, such as a queue depth.
+    class QI_API Gauge : private boost::noncopyable
+    {
+    public:
+      Gauge() : _value(0) {}
+
+      void add(std::int64_t n) { _value.fetch_add(n, std::memory_order_relaxed); }
+      void sub(std::int64_t n) { _value.fetch_sub(n, std::memory_order_relaxed); }
+      void set(std::int64_t value) { _value.store(value, std::memory_order_relaxed); }
+
+      std::int64_t value() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+      std::atomic<std::int64_t> _value;
+    };
+
+    /// Distribution of durations, in the buckets of LatencyHistogram.
+    class QI_API Histogram : private boost::noncopyable
+    {
+    public:
+      Histogram();
+
+      /// Count \p duration, if the metrics are enabled.
+      void push(Duration duration)
+      {
+        if (isEnabled())
+          record(duration);
+      }
+
+      /// Count \p duration, whether the metrics are enabled or not.
+      void record(Duration duration)
+      {
+        const auto ns = (std::max)(duration.count(), Duration::rep(0));
+        _buckets[LatencyHistogram::bucketIndex(static_cast<std::uint64_t>(ns))]
+            .fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(ns, std::memory_order_relaxed);
+      }
+
+      /// @return The durations counted so far. Concurrent pushes may be missed.
+      LatencyHistogram snapshot() const;
+
+      /// @return The sum of the durations counted.
+      Duration sum() const { return Duration(_sum.load(std::memory_order_relaxed)); }
+
+    private:
+      std::atomic<std::uint64_t> _buckets[LatencyHistogram::BucketCount];
+      std::atomic<Duration::rep> _sum;
+    };
+
+    /// @return The counter with this name and labels, created if needed.
+    /// @throw std::runtime_error if the name is used by a metric of another type.
+    QI_API Counter& counter(const std::string& name, const std::string& help,
+                            const Labels& labels = Labels());
+
+    /// @return The gauge with this name and labels, created if needed.
+    /// @throw std::runtime_error if the name is used by a metric of another type.
+    QI_API Gauge& gauge(const std::string& name, const std::string& help,
+                        const Labels& labels = Labels());
+
+    /// @return The histogram with this name and labels, created if needed.
+    /// @throw std::runtime_error if the name is used by a metric of another type.
+    QI_API Histogram& histogram(const std::string& name, const std::string& help,
+                                const Labels& labels = Labels());
+
+    /**
+     * Gauge whose value is read from a function when the metrics are
+     * collected, for levels that are already tracked elsewhere. The gauge
+     * exists as long as this object. The function is called with the
+     * registry locked: it must not get nor create metrics.
+     */
+    class QI_API GaugeFunction : private boost::noncopyable
+    {
+    public:
+      /// Functions registered with the same name and labels are summed.
+      /// @throw std::runtime_error if the name is used by a metric of another
+      /// type, or by a Gauge with the same labels.
+      GaugeFunction(const std::string& name, const std::string& help,
+                    const Labels& labels, boost::function<double()> read);
+      ~GaugeFunction();
+
+    private:
+      std::uint64_t _id;
+    };
+
+    /// Value of a metric when it was collected.
+    struct MetricSample
+    {
+      std::string name;
+      std::string help;
+      int type = MetricType_Counter;
+      Labels labels;
+      /// The count or level, or for histograms the sum of the durations, in
+      /// seconds.
+      double value = 0;
+      /// Only for histograms.
+      LatencyHistogram histogram;
+
+      MetricSample() = default;
+      MetricSample(std::string name, std::string help, int type, Labels labels,
+                   double value, LatencyHistogram histogram)
+        : name(std::move(name)), help(std::move(help)), type(type), labels(std::move(labels))
+        , value(value), histogram(std::move(histogram))
+      {}
+    };
+
+    /// @return The current value of every metric, sorted by name then labels.
+    QI_API std::vector<MetricSample> collect();
+
+    /**
+     * Write the current value of every metric in the Prometheus text format.
+     *
+     * Histograms are written with cumulative buckets of fixed decimal bounds,
+     * from 1us to 10s. A LatencyHistogram bucket is counted under the first
+     * bound above all its durations, which may put durations close to a bound
+     * under the next one.
+     */
+    QI_API void writePrometheusText(std::ostream& out);
+    QI_API std::string prometheusText();
+  }
+}
+
+#endif  // _QI_METRICS_HPP_
@@ -624,6 +624,12 @@ namespace qi {
      *  \return Number of CPUs
      */
     QI_API long numberOfCPUs();
+    /**
+     *  \brief Get the NUMA node of a CPU.
+     *  \param cpu Id of the CPU.
+     *  \return The id of the NUMA node of the CPU, or -1 if it is unknown.
+     */
+    QI_API int numaNodeOfCPU(int cpu);
     /**
      * \brief Returns an unique uuid for the machine.
      * \return The uuid of the machine.
@@ -0,0 +1,63 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#pragma once
+#ifndef _QI_PERF_ALLOCATIONCOUNTER_HPP_
+#define _QI_PERF_ALLOCATIONCOUNTER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include <qi/api.hpp>
+
+namespace qi
+{
+  namespace perf
+  {
+    /// Allocations made through operator new by all the threads of the program.
+    struct AllocationCount
+    {
+      std::uint64_t count;
+      std::uint64_t bytes;
+    };
+
+    /// @return The allocations counted so far, always 0 if the program does
+    /// not use QI_PERF_COUNT_ALLOCATIONS.
+    QI_API AllocationCount allocationCount();
+
+    /// @return If the program counts its allocations.
+    QI_API bool isAllocationCountingEnabled();
+
+    namespace detail
+    {
+      QI_API void enableAllocationCounting() noexcept;
+      QI_API void countAllocation(std::size_t size) noexcept;
+    }
+  }
+}
+
+/**
+ * Replace the global operator new and delete of the program by ones that
+ * count the allocations, for qi::perf::allocationCount(). Use it once, at
+ * global scope, in a source file of a benchmark program: never in a library,
+ * as it changes the allocator of the whole process.
+ */
+#define QI_PERF_COUNT_ALLOCATIONS()                                                   \
+  static const bool _qi_perf_allocationCounting =                                     \
+      (::qi::perf::detail::enableAllocationCounting(), true);                         \
+  void* operator new(std::size_t size)                                                \
+  {                                                                                   \
+    ::qi::perf::detail::countAllocation(size);                                        \
+    if (void* p = std::malloc(size ? size : 1))                                       \
+      return p;                                                                       \
+    throw std::bad_alloc();                                                           \
+  }                                                                                   \
+  void* operator new[](std::size_t size) { return ::operator new(size); }             \
+  void operator delete(void* p) noexcept { std::free(p); }                            \
+  void operator delete[](void* p) noexcept { std::free(p); }
+
+#endif  // _QI_PERF_ALLOCATIONCOUNTER_HPP_
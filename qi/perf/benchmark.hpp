@@ -0,0 +1,164 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#pragma once
+#ifndef _QI_PERF_BENCHMARK_HPP_
+#define _QI_PERF_BENCHMARK_HPP_
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include <qi/api.hpp>
+#include <qi/clock.hpp>
+
+namespace qi
+{
+  namespace perf
+  {
+    /// How the benchmarks of a Benchmark are run.
+    struct BenchmarkOptions
+    {
+      /// Trials run before the measured ones, to warm caches, pools and
+      /// lazily initialized state up.
+      unsigned int warmupTrials = 1;
+      /// Measured trials.
+      unsigned int trials = 10;
+      /// Iterations per trial. If 0, they are calibrated so that a trial
+      /// lasts at least minTrialDuration.
+      unsigned long iterations = 0;
+      qi::Duration minTrialDuration = qi::MilliSeconds{ 100 };
+      /// Only the benchmarks whose name contains this string are run.
+      std::string filter;
+    };
+
+    /// Statistics of the trials of a benchmark. Times are in nanoseconds per
+    /// iteration.
+    struct QI_API BenchmarkResult
+    {
+      std::string name;
+      std::string variable;
+      /// Iterations per trial.
+      unsigned long iterations = 0;
+      unsigned long bytesPerIteration = 0;
+      /// Threads running the iterations at the same time.
+      unsigned int concurrency = 1;
+      /// One sample per trial, or one per iteration for latency benchmarks.
+      /// Latency benchmarks of more than about 4 million iterations only time
+      /// one iteration out of a few.
+      std::vector<double> samples;
+      double mean = 0;
+      double stddev = 0;
+      double min = 0;
+      double median = 0;
+      /// Percentiles of single iterations: -1 for benchmarks timing whole
+      /// trials, whose few per-trial means do not have meaningful ones.
+      double p90 = -1;
+      double p99 = -1;
+      double max = 0;
+      /// CPU time of the process over the wall clock time.
+      double cpuRatio = 0;
+      /// -1 if the program does not count allocations, see
+      /// QI_PERF_COUNT_ALLOCATIONS.
+      double allocationsPerIteration = -1;
+      double allocatedBytesPerIteration = -1;
+
+      /// Iterations of all the threads, each one waiting for its iteration
+      /// to finish before starting the next.
+      double iterationsPerSecond() const;
+      /// -1 if the benchmark does not transfer data.
+      double megaBytesPerSecond() const;
+    };
+
+    /// A benchmark whose median time got slower than its baseline beyond
+    /// the threshold, or that allocates more.
+    struct Regression
+    {
+      std::string name;
+      std::string variable;
+      double baselineMedian;
+      double median;
+      double baselineAllocations;
+      double allocations;
+    };
+
+    class BenchmarkPrivate;
+
+    /**
+     * Runs benchmarks in repeated trials, and reports statistics over them.
+     *
+     * \verbatim
+     * qi::perf::Benchmark bench("qi", options);
+     * bench.run("FutureSetValue", [](unsigned long n) {
+     *   for (unsigned long i = 0; i < n; ++i)
+     *     qi::Promise<int>().setValue(i);
+     * });
+     * bench.writeJson(file);
+     * \endverbatim
+     */
+    class QI_API Benchmark
+    {
+    public:
+      explicit Benchmark(const std::string& suiteName,
+                         const BenchmarkOptions& options = BenchmarkOptions());
+      ~Benchmark();
+
+      Benchmark(const Benchmark&) = delete;
+      Benchmark& operator=(const Benchmark&) = delete;
+
+      /// Run a benchmark whose body runs the measured code the given number
+      /// of times. Each trial is timed as a whole, so the result has no
+      /// percentiles.
+      /// @return false if the benchmark was filtered out.
+      bool run(const std::string& name,
+               const boost::function<void(unsigned long)>& body,
+               unsigned long bytesPerIteration = 0,
+               const std::string& variable = std::string());
+
+      /// Run a benchmark timing each call of `once` on its own, so that the
+      /// percentiles are those of single operations. The timing overhead
+      /// makes it only suitable for operations of a microsecond or more.
+      /// @return false if the benchmark was filtered out.
+      bool runLatency(const std::string& name,
+                      const boost::function<void()>& once,
+                      unsigned long bytesPerIteration = 0,
+                      const std::string& variable = std::string());
+
+      /// Like runLatency(), with `concurrency` threads calling `once` (with
+      /// their index) at the same time. The percentiles are those of the
+      /// operations of all the threads.
+      /// @return false if the benchmark was filtered out.
+      bool runConcurrentLatency(const std::string& name,
+                                unsigned int concurrency,
+                                const boost::function<void(unsigned int)>& once,
+                                unsigned long bytesPerIteration = 0,
+                                const std::string& variable = std::string());
+
+      const std::vector<BenchmarkResult>& results() const;
+
+      /// Write the results as JSON, the format readBaseline() expects.
+      void writeJson(std::ostream& out) const;
+
+      /// @return The results of a previous run, written by writeJson().
+      /// @throw std::runtime_error if the input is not such results.
+      static std::vector<BenchmarkResult> readBaseline(std::istream& in);
+
+      /// @return The benchmarks whose median time exceeds the one of the same
+      /// benchmark in the baseline by more than `threshold` (0.1 for 10%), or
+      /// that allocate more per iteration.
+      std::vector<Regression> compare(const std::vector<BenchmarkResult>& baseline,
+                                      double threshold) const;
+
+    private:
+      BenchmarkPrivate* _p;
+    };
+  }
+}
+
+#include <qi/perf/detail/benchmark.hxx>
+
+#endif  // _QI_PERF_BENCHMARK_HPP_
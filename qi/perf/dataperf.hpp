@@ -17,7 +17,9 @@ namespace qi
 {
   class DataPerfPrivate;
 
-  /// Class to compute and store a benchmark time.
+  /// Class to compute and store a benchmark time, measured once.
+  /// qi::perf::Benchmark (qi/perf/benchmark.hpp) runs warmup and repeated
+  /// trials, and reports their statistics.
   class QI_API DataPerf
   {
   public:
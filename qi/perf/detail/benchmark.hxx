@@ -0,0 +1,97 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_PERF_DETAIL_BENCHMARK_HXX_
+#define _QI_PERF_DETAIL_BENCHMARK_HXX_
+
+#include <fstream>
+#include <iostream>
+#include <boost/program_options.hpp>
+
+namespace qi {
+
+  namespace perf {
+
+    inline boost::program_options::options_description getBenchmarkOptions()
+    {
+      namespace po = boost::program_options;
+      po::options_description desc(std::string("Options for benchmarks"));
+
+      desc.add_options()
+        ("warmup", po::value<unsigned int>()->default_value(1), "Trials run before the measured ones.")
+        ("trials", po::value<unsigned int>()->default_value(10), "Measured trials.")
+        ("iterations", po::value<unsigned long>()->default_value(0),
+         "Iterations per trial (calibrated if 0).")
+        ("min-time", po::value<unsigned int>()->default_value(100),
+         "Minimum duration of a calibrated trial, in milliseconds.")
+        ("filter", po::value<std::string>()->default_value(""),
+         "Only run the benchmarks whose name contains this string.")
+        ("json", po::value<std::string>()->default_value(""), "Write the results as JSON to this file.")
+        ("baseline", po::value<std::string>()->default_value(""),
+         "Compare the results to the ones of this JSON file, and fail on regressions.")
+        ("threshold", po::value<double>()->default_value(10),
+         "Tolerated slowdown against the baseline, in percent.");
+
+      return desc;
+    }
+
+    inline BenchmarkOptions benchmarkOptions(const boost::program_options::variables_map& vm)
+    {
+      BenchmarkOptions options;
+      options.warmupTrials = vm["warmup"].as<unsigned int>();
+      options.trials = vm["trials"].as<unsigned int>();
+      options.iterations = vm["iterations"].as<unsigned long>();
+      options.minTrialDuration = qi::MilliSeconds{ vm["min-time"].as<unsigned int>() };
+      options.filter = vm["filter"].as<std::string>();
+      return options;
+    }
+
+    /// Write and compare the results as asked by the options of
+    /// getBenchmarkOptions().
+    /// @return The exit code of the benchmark program: EXIT_FAILURE if a
+    /// file cannot be used, or if a benchmark regressed.
+    inline int finishBenchmark(const Benchmark& bench, const boost::program_options::variables_map& vm)
+    {
+      const auto& jsonPath = vm["json"].as<std::string>();
+      if (!jsonPath.empty())
+      {
+        std::ofstream out(jsonPath.c_str());
+        bench.writeJson(out);
+        if (!out)
+        {
+          std::cerr << "Cannot write results to " << jsonPath << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      const auto& baselinePath = vm["baseline"].as<std::string>();
+      if (baselinePath.empty())
+        return EXIT_SUCCESS;
+      std::ifstream in(baselinePath.c_str());
+      if (!in)
+      {
+        std::cerr << "Cannot read baseline " << baselinePath << std::endl;
+        return EXIT_FAILURE;
+      }
+      const auto regressions = bench.compare(Benchmark::readBaseline(in),
+                                             vm["threshold"].as<double>() / 100.0);
+      for (const auto& regression : regressions)
+      {
+        std::cerr << "Regression: " << regression.name;
+        if (!regression.variable.empty())
+          std::cerr << "-" << regression.variable;
+        std::cerr << ": " << regression.median << " ns (baseline " << regression.baselineMedian
+                  << " ns), " << regression.allocations << " allocations (baseline "
+                  << regression.baselineAllocations << ")" << std::endl;
+      }
+      return regressions.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+  }
+
+}
+
+#endif /* _QI_PERF_DETAIL_BENCHMARK_HXX_ */
@@ -10,6 +10,9 @@
 
 # include <sstream>
 # include <algorithm>
+# include <cstdint>
+# include <vector>
+# include <qi/clock.hpp>
 
 namespace qi
 {
@@ -145,6 +148,161 @@ namespace qi
     MinMaxSum _user;
     MinMaxSum _system;
   };
+
+  /**
+   * Distribution of durations in logarithmic buckets, as in HDR histograms.
+   *
+   * Durations below 8ns have their own bucket. Then each range [2^n, 2^(n+1))
+   * of nanoseconds is split into 8 buckets of the same width, so that a bucket
+   * is at most 12.5% wide relatively to the durations it counts. Durations
+   * above 2^36ns (about 68s) are counted in the last bucket.
+   */
+  class LatencyHistogram
+  {
+  public:
+    static const unsigned int SubBucketBits = 3;
+    static const unsigned int SubBucketCount = 1u << SubBucketBits;
+    static const unsigned int MaxBits = 36;
+    static const unsigned int BucketCount = (MaxBits - SubBucketBits + 1) * SubBucketCount;
+
+    /// Default constructor, with no duration counted.
+    LatencyHistogram() {}
+    /**
+     * \brief Constructor
+     * \param buckets Count of durations of each bucket, from the lowest one.
+     *        Missing trailing buckets are empty.
+     */
+    explicit LatencyHistogram(std::vector<uint64_t> buckets)
+      : _buckets(std::move(buckets))
+    {
+      if (_buckets.size() > BucketCount)
+        _buckets.resize(BucketCount);
+    }
+
+    /// Get the index of the bucket counting the duration of \p nanoseconds.
+    static unsigned int bucketIndex(uint64_t nanoseconds)
+    {
+      if (nanoseconds < SubBucketCount)
+        return static_cast<unsigned int>(nanoseconds);
+#ifdef __GNUC__
+      const unsigned int log2 = 63u - static_cast<unsigned int>(__builtin_clzll(nanoseconds));
+#else
+      unsigned int log2 = 0;
+      for (uint64_t v = nanoseconds >> 1; v != 0; v >>= 1)
+        ++log2;
+#endif
+      if (log2 >= MaxBits)
+        return BucketCount - 1;
+      const auto subBucket = (nanoseconds >> (log2 - SubBucketBits)) & (SubBucketCount - 1);
+      return (log2 - SubBucketBits + 1) * SubBucketCount + static_cast<unsigned int>(subBucket);
+    }
+
+    /// Get the smallest duration counted by the bucket \p index.
+    static Duration bucketLowerBound(unsigned int index)
+    {
+      if (index < SubBucketCount)
+        return Duration(index);
+      const auto log2 = index / SubBucketCount + SubBucketBits - 1;
+      const auto subBucket = index % SubBucketCount;
+      return Duration(static_cast<int64_t>(SubBucketCount + subBucket) << (log2 - SubBucketBits));
+    }
+
+    /// Get the duration right above the ones counted by the bucket \p index.
+    static Duration bucketUpperBound(unsigned int index)
+    {
+      if (index < SubBucketCount)
+        return Duration(index + 1);
+      const auto log2 = index / SubBucketCount + SubBucketBits - 1;
+      return bucketLowerBound(index) + Duration(int64_t(1) << (log2 - SubBucketBits));
+    }
+
+    /// Count a new duration.
+    void push(Duration duration)
+    {
+      const auto index = bucketIndex(static_cast<uint64_t>((std::max)(duration.count(), int64_t(0))));
+      if (_buckets.size() <= index)
+        _buckets.resize(index + 1);
+      ++_buckets[index];
+    }
+
+    /// Add the durations counted by \p other.
+    void merge(const LatencyHistogram& other)
+    {
+      if (_buckets.size() < other._buckets.size())
+        _buckets.resize(other._buckets.size());
+      for (std::size_t i = 0; i < other._buckets.size(); ++i)
+        _buckets[i] += other._buckets[i];
+    }
+
+    /// Get the count of durations of each bucket. Trailing empty buckets may be omitted.
+    const std::vector<uint64_t>& buckets() const { return _buckets; }
+
+    /// Get the number of durations counted.
+    uint64_t count() const
+    {
+      uint64_t total = 0;
+      for (const auto c : _buckets)
+        total += c;
+      return total;
+    }
+
+    /**
+     * \brief Get an upper bound of the duration below which the fraction \p q
+     *        of the durations fall, e.g. 0.99 for the 99th percentile.
+     * \return The upper bound of the bucket of that duration, or 0 if no
+     *         duration was counted.
+     */
+    Duration quantile(double q) const
+    {
+      const auto total = count();
+      if (total == 0)
+        return Duration(0);
+      const auto clamped = (std::min)((std::max)(q, 0.), 1.);
+      const auto rank = (std::max)(uint64_t(1), static_cast<uint64_t>(clamped * static_cast<double>(total) + 0.5));
+      uint64_t seen = 0;
+      for (std::size_t i = 0; i < _buckets.size(); ++i)
+      {
+        seen += _buckets[i];
+        if (seen >= rank)
+          return bucketUpperBound(static_cast<unsigned int>(i));
+      }
+      return bucketUpperBound(static_cast<unsigned int>(_buckets.size() - 1));
+    }
+
+    /// Forget all the durations counted.
+    void reset()
+    {
+      _buckets.clear();
+    }
+
+  private:
+    std::vector<uint64_t> _buckets;
+  };
+
+  /// Store the distributions of the durations of method calls.
+  class MethodHistograms
+  {
+  public:
+    /// Default constructor
+    MethodHistograms() {}
+    /**
+     * \brief Constructor
+     * \param wall Distribution of the wall time of the calls.
+     * \param cpu Distribution of the CPU time (user and system) of the calls.
+     */
+    MethodHistograms(LatencyHistogram wall, LatencyHistogram cpu)
+      : _wall(std::move(wall)), _cpu(std::move(cpu))
+    {}
+
+    /// Get the distribution of the wall time of the calls.
+    const LatencyHistogram& wall() const { return _wall; }
+    /// Get the distribution of the CPU time of the calls.
+    const LatencyHistogram& cpu() const  { return _cpu; }
+
+  private:
+    LatencyHistogram _wall;
+    LatencyHistogram _cpu;
+  };
 }
 
 #endif // !_QI_STATS_HPP_
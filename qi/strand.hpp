@@ -9,6 +9,7 @@
 
 #include <deque>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <ka/macro.hpp>
 #include <ka/functional.hpp>
@@ -98,7 +99,12 @@ private:
   void stopProcess(boost::recursive_mutex::scoped_lock& lock,
                    bool finished);
 
+  // Must be called with the mutex locked, each time the queue changes.
+  void reportQueuedTasks();
+
   bool joined = false;
+  // Part of the process wide strand queue gauge accounted to this strand.
+  std::int64_t _reportedQueuedTasks = 0;
 
   template<class Task>
   auto track(Task&& task)
@@ -0,0 +1,80 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_TRACECONTEXT_HPP_
+# define _QI_TRACECONTEXT_HPP_
+
+# include <boost/function.hpp>
+# include <qi/api.hpp>
+# include <qi/types.hpp>
+
+namespace qi
+{
+  /**
+   * Position of a call in a tree of calls that can span several processes.
+   *
+   * All the calls of a tree share the trace id. Each traced call gets its own
+   * span id, and records the span id of the call it was made from. Remote
+   * calls, posts and events carry the context of the sender, and tasks posted
+   * to an EventLoop or a Strand run with the context of the code that posted
+   * them.
+   */
+  struct TraceContext
+  {
+    /// Identifies the tree of calls. 0 if there is no context.
+    qi::uint64_t traceId = 0;
+    /// Identifies the call in the tree.
+    qi::uint64_t spanId = 0;
+    /// Span of the call this one was made from, 0 for the root.
+    qi::uint64_t parentSpanId = 0;
+
+    bool isValid() const
+    {
+      return traceId != 0;
+    }
+
+    /// @return A new span of the same trace, child of this one, or the root
+    /// span of a new trace if this context is not valid.
+    QI_API TraceContext child() const;
+  };
+
+  inline bool operator==(const TraceContext& a, const TraceContext& b)
+  {
+    return a.traceId == b.traceId && a.spanId == b.spanId && a.parentSpanId == b.parentSpanId;
+  }
+
+  inline bool operator!=(const TraceContext& a, const TraceContext& b)
+  {
+    return !(a == b);
+  }
+
+  /// @return The context of the code running in the calling thread.
+  QI_API TraceContext currentTraceContext();
+
+  /// Sets the context of the calling thread for its lifetime, then restores
+  /// the previous one.
+  class QI_API TraceContextScope
+  {
+  public:
+    explicit TraceContextScope(const TraceContext& context);
+    ~TraceContextScope();
+
+    TraceContextScope(const TraceContextScope&) = delete;
+    TraceContextScope& operator=(const TraceContextScope&) = delete;
+
+  private:
+    TraceContext _previous;
+  };
+
+  namespace detail
+  {
+    /// @return A function that calls `f` with the current context of the
+    /// calling thread, or `f` itself if there is none.
+    QI_API boost::function<void()> bindTraceContext(boost::function<void()> f);
+  }
+}
+
+#endif  // _QI_TRACECONTEXT_HPP_
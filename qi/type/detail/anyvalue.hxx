@@ -34,6 +34,12 @@ public:
     val->reset(src, true, true);
   }
 
+  void setOwned(void** storage, AnyReference src) override
+  {
+    AnyValue* val = (AnyValue*)ptrFromStorage(storage);
+    val->reset(src, false, true);
+  }
+
   // Default cloner will do just right since AnyValue is by-value.
   using Methods = DefaultTypeImplMethods<AnyValue, TypeByPointerPOD<AnyValue>>;
   _QI_BOUNCE_TYPE_METHODS(Methods);
@@ -28,6 +28,9 @@ KA_WARNING_DISABLE(4251, )
 namespace qi
 {
 
+template <typename F>
+class MethodHandle;
+
 /* ObjectValue
  *  static version wrapping class C: Type<C>
  *  dynamic version: Type<DynamicObject>
@@ -140,6 +143,9 @@ public:
   ObjectUid uid; ///< Uid of "value".
 
 private:
+  template <typename F>
+  friend class MethodHandle;
+
   /// Common meta call algorithm, without unwrapping the returned future.
   Future<AnyReference> metaCallNoUnwrap(
       unsigned int method,
@@ -27,6 +27,7 @@ public:
   AnyIterator begin(void* storage) override;
   AnyIterator end(void* storage) override;
   void pushBack(void** storage, void* valueStorage) override;
+  void pushBackOwned(void** storage, void* valueStorage) override;
   _QI_BOUNCE_TYPE_METHODS(MethodsImpl);
   TypeInterface* _elementType;
 };
@@ -101,6 +102,16 @@ namespace detail
   {
     container.insert(*element);
   }
+  template<typename T, typename E>
+  void pushBackMove(T& container, E* element)
+  {
+    container.push_back(std::move(*element));
+  }
+  template<typename CE, typename E>
+  void pushBackMove(std::set<CE>& container, E* element)
+  {
+    container.insert(std::move(*element));
+  }
 }
 template<typename T, typename H>
 void ListTypeInterfaceImpl<T, H>::pushBack(void **storage, void* valueStorage)
@@ -109,6 +120,15 @@ void ListTypeInterfaceImpl<T, H>::pushBack(void **storage, void* valueStorage)
   detail::pushBack(*ptr, (typename T::value_type*)_elementType->ptrFromStorage(&valueStorage));
 }
 
+template<typename T, typename H>
+void ListTypeInterfaceImpl<T, H>::pushBackOwned(void **storage, void* valueStorage)
+{
+  T* ptr = (T*) ptrFromStorage(storage);
+  detail::pushBackMove(*ptr, (typename T::value_type*)_elementType->ptrFromStorage(&valueStorage));
+  // only the moved-from element is left
+  _elementType->destroy(valueStorage);
+}
+
 template<typename T, typename H>
 size_t ListTypeInterfaceImpl<T, H>::size(void* storage)
 {
@@ -157,6 +177,10 @@ public:
     void* vstor = adaptStorage(storage);
     BaseClass::pushBack(&vstor, valueStorage);
   }
+  void pushBackOwned(void** storage, void* valueStorage) override {
+    void* vstor = adaptStorage(storage);
+    BaseClass::pushBackOwned(&vstor, valueStorage);
+  }
 
   //ListTypeInterface* _list;
 };
@@ -18,6 +18,8 @@
 #include <qi/anyfunction.hpp>
 #include <qi/type/typeobject.hpp>
 #include <qi/signal.hpp>
+#include <qi/buffer.hpp>
+#include <qi/tracecontext.hpp>
 #include <ka/macro.hpp>
 
 KA_WARNING_PUSH()
@@ -58,7 +60,19 @@ namespace qi {
       qi::os::timeval postTimestamp = qi::os::timeval())
     : _id(id), _kind(kind), _slotId(slotId), _arguments(arguments),
       _timestamp(timestamp), _postTimestamp(postTimestamp), _userUsTime(userUsTime), _systemUsTime(systemUsTime),
-      _callerContext(callerContext), _calleeContext(calleeContext)
+      _callerContext(callerContext), _calleeContext(calleeContext),
+      _traceId(0), _spanId(0), _parentSpanId(0)
+    {}
+    EventTrace(unsigned int id, EventKind  kind, unsigned int slotId,
+      const AnyValue& arguments, const qi::os::timeval timestamp,
+      qi::int64_t userUsTime, qi::int64_t systemUsTime,
+      unsigned int callerContext, unsigned int calleeContext,
+      qi::uint64_t traceId, qi::uint64_t spanId, qi::uint64_t parentSpanId,
+      qi::os::timeval postTimestamp = qi::os::timeval())
+    : _id(id), _kind(kind), _slotId(slotId), _arguments(arguments),
+      _timestamp(timestamp), _postTimestamp(postTimestamp), _userUsTime(userUsTime), _systemUsTime(systemUsTime),
+      _callerContext(callerContext), _calleeContext(calleeContext),
+      _traceId(traceId), _spanId(spanId), _parentSpanId(parentSpanId)
     {}
 
     // trace id, used to match call and call result
@@ -74,6 +88,10 @@ namespace qi {
     const qi::int64_t&      systemUsTime()    const { return _systemUsTime;}
     const unsigned int&     callerContext()   const { return _callerContext;}
     const unsigned int&     calleeContext()   const { return _calleeContext;}
+    // distributed trace of the call, see TraceContext
+    const qi::uint64_t&     traceId()         const { return _traceId;}
+    const qi::uint64_t&     spanId()          const { return _spanId;}
+    const qi::uint64_t&     parentSpanId()    const { return _parentSpanId;}
 
   private:
     unsigned int     _id; // trace id, used to match call and call result
@@ -86,8 +104,82 @@ namespace qi {
     qi::int64_t      _systemUsTime;
     unsigned int     _callerContext; // context of caller function
     unsigned int     _calleeContext; // context where method runs
+    qi::uint64_t     _traceId;
+    qi::uint64_t     _spanId;
+    qi::uint64_t     _parentSpanId; // span of the (possibly remote) caller
   };
 
+  /// Capture of the arguments and results of the traced calls. Raw arguments
+  /// and results are only recorded as their size.
+  enum TraceArguments
+  {
+    /// Not captured.
+    TraceArguments_None = 0,
+    /// Strings and containers bigger than the maximum argument size are cut
+    /// or replaced by their size, and raw buffers by their size, also in the
+    /// members of tuples and structures.
+    TraceArguments_Truncated = 1,
+    /// Captured whole.
+    TraceArguments_Full = 2
+  };
+
+  /// Settings of the tracing of an object.
+  class TraceOptions
+  {
+  public:
+    /**
+     * \param samplingPeriod One call out of samplingPeriod is traced.
+     * \param arguments Capture of the arguments and results.
+     * \param maxArgumentSize Maximum size of the truncated arguments, in
+     *        bytes for strings and in elements for containers.
+     */
+    TraceOptions(unsigned int samplingPeriod = 1,
+                 TraceArguments arguments = TraceArguments_Full,
+                 unsigned int maxArgumentSize = 64)
+      : _samplingPeriod(samplingPeriod), _arguments(arguments), _maxArgumentSize(maxArgumentSize)
+    {}
+
+    const unsigned int&   samplingPeriod()  const { return _samplingPeriod;}
+    const TraceArguments& arguments()       const { return _arguments;}
+    const unsigned int&   maxArgumentSize() const { return _maxArgumentSize;}
+
+  private:
+    unsigned int   _samplingPeriod;
+    TraceArguments _arguments;
+    unsigned int   _maxArgumentSize;
+  };
+
+  /**
+   * Fixed-size binary record of an EventTrace, without its arguments.
+   *
+   * The traceRecords signal delivers them in chunks: buffers of consecutive
+   * records in the byte order of the emitting host. Use decodeTraceRecords()
+   * to read them back.
+   */
+  struct TraceRecord
+  {
+    uint32_t id;
+    uint32_t kind;
+    uint32_t slotId;
+    uint32_t callerContext;
+    uint32_t calleeContext;
+    uint32_t reserved;
+    int64_t  timestamp;     // microseconds since the epoch
+    int64_t  postTimestamp; // microseconds since the epoch
+    int64_t  userUsTime;
+    int64_t  systemUsTime;
+    uint64_t traceId;
+    uint64_t spanId;
+    uint64_t parentSpanId;
+  };
+  static_assert(sizeof(TraceRecord) == 80, "TraceRecord must have no padding");
+
+  /// Number of records of a full chunk of the traceRecords signal.
+  const unsigned int TraceRecordsPerChunk = 256;
+
+  /// Get the events of a chunk of records emitted by the traceRecords signal.
+  /// @throw std::runtime_error if the chunk is not made of whole records.
+  QI_API std::vector<EventTrace> decodeTraceRecords(const Buffer& chunk);
 }
 
 QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::MinMaxSum,
@@ -101,6 +193,19 @@ QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::MethodStatistics,
   ("user",   user),
   ("system", system));
 
+QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::LatencyHistogram,
+  ("buckets", buckets));
+
+QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::MethodHistograms,
+  ("wall", wall),
+  ("cpu",  cpu));
+
+QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::TraceOptions,
+  ("samplingPeriod",  samplingPeriod),
+  ("arguments",       arguments),
+  ("maxArgumentSize", maxArgumentSize));
+
+QI_TYPE_STRUCT_EXTENSION_ADDED_FIELDS(qi::EventTrace, "traceId", "spanId", "parentSpanId");
 QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::EventTrace,
   ("id",            id),
   ("kind",          kind),
@@ -110,13 +215,17 @@ QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR(qi::EventTrace,
   ("userUsTime",    userUsTime),
   ("systemUsTime",  systemUsTime),
   ("callerContext", callerContext),
-  ("calleeContext", calleeContext));
+  ("calleeContext", calleeContext),
+  ("traceId",       traceId),
+  ("spanId",        spanId),
+  ("parentSpanId",  parentSpanId));
 
 QI_TYPE_STRUCT(qi::os::timeval, tv_sec, tv_usec);
 
 namespace qi {
 
   using ObjectStatistics = std::map<unsigned int, MethodStatistics>;
+  using ObjectHistograms = std::map<unsigned int, MethodHistograms>;
 /** Per-instance context.
   */
   class QI_API Manageable
@@ -146,7 +255,15 @@ namespace qi {
     void enableStats(bool enable);
     /// Push statistics information about \p slotId.
     void pushStats(int slotId, float wallTime, float userTime, float systemTime);
+    /** Push statistics information about \p slotId.
+     *
+     * Does not lock: calls from several threads record into distinct stripes,
+     * merged by stats() and statsHistogram().
+     */
+    void pushStats(int slotId, Duration wallTime, Duration userTime, Duration systemTime);
     ObjectStatistics stats() const;
+    /// Get the distributions of the wall and CPU times of the calls of each method.
+    ObjectHistograms statsHistogram() const;
     /// Reset all statistical data
     void clearStats();
 
@@ -166,6 +283,23 @@ namespace qi {
     *
     */
     void enableTrace(bool enable);
+
+    /** Emitted with chunks of TraceRecord of the traced calls, without their
+     * arguments. Records are delivered once a chunk is full, or by
+     * flushTrace(). Connecting to this signal enables the recording.
+     */
+    Signal<Buffer> traceRecords;
+
+    ///@return if the calls are recorded for traceRecords
+    bool isTraceRecordingEnabled() const;
+    /// Set recording state. Usually not called directly, see enableTrace().
+    void enableTraceRecording(bool enable);
+    /// Emit the records not yet delivered by traceRecords.
+    void flushTrace();
+
+    TraceOptions traceOptions() const;
+    /// Set the sampling and argument capture of both traceObject and traceRecords.
+    void setTraceOptions(const TraceOptions& options);
     /// @}
 
     /// Starting id of features handled by Manageable
@@ -184,6 +318,9 @@ namespace qi {
     static MetaObject&      manageableMetaObject();
     static void             _build();
     int                     _nextTraceId();
+    /// @return if the next call must be traced, according to the sampling period.
+    bool                    _sampleTrace();
+    void                    _recordTrace(const EventTrace& event);
 
   private:
     std::unique_ptr<ManageablePrivate> _p;
@@ -194,4 +331,5 @@ namespace qi {
 KA_WARNING_POP()
 
 QI_TYPE_ENUM(qi::EventTrace::EventKind);
+QI_TYPE_ENUM(qi::TraceArguments);
 #endif  // _QITYPE_MANAGEABLE_HPP_
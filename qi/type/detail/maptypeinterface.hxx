@@ -22,6 +22,7 @@ public:
   AnyIterator begin(void* storage) override;
   AnyIterator end(void* storage) override;
   void insert(void** storage, void* keyStorage, void* valueStorage) override;
+  void insertOwned(void** storage, void* keyStorage, void* valueStorage) override;
   AnyReference element(void** storage, void* keyStorage, bool autoInsert) override;
   _QI_BOUNCE_TYPE_METHODS(MethodsImpl);
   TypeInterface* _keyType;
@@ -86,6 +87,22 @@ MapTypeInterfaceImpl<M>::insert(void** storage, void* keyStorage, void* valueSto
     it->second = val;
 }
 
+template<typename M> void
+MapTypeInterfaceImpl<M>::insertOwned(void** storage, void* keyStorage, void* valueStorage)
+{
+  M* ptr = (M*) ptrFromStorage(storage);
+  typename M::key_type& key = *(typename M::key_type*)_keyType->ptrFromStorage(&keyStorage);
+  typename M::mapped_type& val = *(typename M::mapped_type*)_elementType->ptrFromStorage(&valueStorage);
+  typename M::iterator it = ptr->find(key);
+  if (it == ptr->end())
+    ptr->insert(std::make_pair(std::move(key), std::move(val)));
+  else
+    it->second = std::move(val);
+  // only the moved-from key and value are left
+  _keyType->destroy(keyStorage);
+  _elementType->destroy(valueStorage);
+}
+
 template<typename M> AnyReference
 MapTypeInterfaceImpl<M>::element(void** storage, void* keyStorage, bool autoInsert)
 {
@@ -141,6 +141,10 @@ namespace detail {
     {
       return go()->stats();
     }
+    inline ObjectHistograms statsHistogram() const
+    {
+      return go()->statsHistogram();
+    }
     inline void clearStats() const
     {
       return go()->clearStats();
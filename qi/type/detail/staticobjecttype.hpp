@@ -72,6 +72,7 @@ public:
   qi::Future<void> disconnect(void* instance, AnyObject context, SignalLink linkId) override;
   qi::Future<AnyValue> property(void* instance, AnyObject context, unsigned int id) override;
   qi::Future<void> setProperty(void* instance, AnyObject context, unsigned int id, AnyValue value) override;
+  TypeInterface* parametersType(void* instance, unsigned int method) override;
 
   const std::vector<std::pair<TypeInterface*, std::ptrdiff_t> >& parentTypes() override;
   void* initializeStorage(void*) override;
@@ -82,6 +83,8 @@ public:
 private:
   MetaObject     _metaObject;
   ObjectTypeData _data;
+  // Tuple of the parameter types of each method, if they match its signature.
+  std::map<unsigned int, TypeInterface*> _parametersTypes;
 
   ExecutionContext* getExecutionContext(void* instance, qi::AnyObject context, MetaCallType methodThreadingModel = MetaCallType_Auto);
 };
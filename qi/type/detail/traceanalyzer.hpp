@@ -27,6 +27,8 @@ namespace qi
     void clear(const qi::os::timeval& limit);
     /// Add a new trace to the system. There is no order requirement between traces.
     void addTrace(const qi::EventTrace& e, unsigned int objectId);
+    /// Add the traces of a chunk emitted by the traceRecords signal of an object.
+    void addTraceRecords(const Buffer& chunk, unsigned int objectId);
     struct FlowLink
     {
       FlowLink(unsigned int srcObj, unsigned int srcFun, unsigned int dstObj, unsigned int dstFun, bool sync)
@@ -34,11 +36,23 @@ namespace qi
       unsigned int srcObj, srcFun, dstObj, dstFun;
       bool sync;
     };
-    /// Append the set of discovered links between traces to \p links
+    /** Append the set of discovered links between traces to \p links.
+     * Besides the links deduced from the timeline of each context, calls of
+     * a same distributed trace (see TraceContext) are linked to the call
+     * they were made from, even if it ran in another process.
+     */
     void analyze(std::set<FlowLink>& links);
     /// Debug-dump the internal structures to given ostream
     void dumpTraces(std::ostream& o);
     std::string dumpTraces();
+    /** Write the calls in the JSON trace event format of Chrome, which
+     * chrome://tracing and Perfetto load. Each object is a process, each
+     * context a thread of it, and asynchronous and remote calls are linked
+     * to the call they come from by flow events. Call analyze() first to
+     * get the remote links.
+     */
+    void dumpChromeTrace(std::ostream& o);
+    std::string dumpChromeTrace();
   protected:
     std::unique_ptr<TraceAnalyzerImpl> _p;
   };
@@ -9,6 +9,34 @@
 
 namespace qi {
 
+  inline StructMembers::StructMembers(StructTypeInterface* type, void* storage)
+    : _type(type)
+    , _storage(storage)
+    , _types(&type->cachedMemberTypes())
+  {
+  }
+
+  inline std::size_t StructMembers::size() const
+  {
+    return _types->size();
+  }
+
+  inline AnyReference StructMembers::operator[](std::size_t index) const
+  {
+    const auto i = static_cast<unsigned int>(index);
+    return AnyReference((*_types)[i], _type->get(_storage, i));
+  }
+
+  inline const std::vector<TypeInterface*>& StructMembers::types() const
+  {
+    return *_types;
+  }
+
+  inline StructMembers::operator AnyReferenceVector() const
+  {
+    return _type->values(_storage);
+  }
+
   template<typename TypeDispatcher>
   TypeDispatcher& typeDispatch(TypeDispatcher &v, AnyReference value)
   {
@@ -85,8 +113,8 @@ namespace qi {
       case TypeKind_Tuple:
       {
         StructTypeInterface* ttuple = static_cast<StructTypeInterface*>(value.type());
-        AnyReferenceVector tuple = ttuple->values(value.rawValue());
-        v.visitTuple(ttuple->className(), tuple, ttuple->elementsName());
+        v.visitTuple(ttuple->className(), StructMembers(ttuple, value.rawValue()),
+                     ttuple->cachedElementsName());
         break;
       }
       case TypeKind_Dynamic:
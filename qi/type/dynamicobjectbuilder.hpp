@@ -90,6 +90,8 @@ namespace qi {
     unsigned int xAdvertiseSignal(const std::string &name, const Signature &signature, bool isSignalProperty = false);
     unsigned int xAdvertiseProperty(const std::string& name, const Signature& sig, int id=-1);
     void setDescription(const std::string& desc);
+    /// @see MemberPriority
+    void setMemberPriority(unsigned int id, MemberPriority priority);
     qi::AnyObject object(boost::function<void (GenericObject*)> onDelete = boost::function<void (GenericObject*)>());
     /// Return an AnyObject that shares life type with \p other.
     template<typename T> qi::AnyObject object(boost::shared_ptr<T> other);
@@ -20,6 +20,20 @@ namespace qi {
   class MetaObjectPrivate;
   class GenericFunctionParameters;
 
+  /// Priority of the messages sent for a member (the events of a signal, the results of a
+  /// method) by the process exposing the object. Control messages are sent before bulk ones when
+  /// both are waiting in a socket.
+  ///
+  /// The priority is local to the process exposing the object: it is not transmitted with the
+  /// meta object.
+  enum class MemberPriority
+  {
+    /// Deduced from the message: events are bulk, other messages are control.
+    Default,
+    Control,
+    Bulk,
+  };
+
   /// Description of the signals and methods accessible on an ObjectTypeInterface
   class QI_API MetaObject  {
   public:
@@ -137,6 +151,12 @@ namespace qi {
     */
     std::string description() const;
 
+    /**
+    *   @param id The member's id.
+    *   @return The priority of the messages of the member.
+    */
+    MemberPriority memberPriority(unsigned int id) const;
+
     MetaObjectPrivate   *_p;
     MetaObject(const MethodMap& methodMap, const SignalMap& signalMap,
       const PropertyMap& propertyMap, const std::string& description);
@@ -176,6 +196,9 @@ namespace qi {
 
     /// @see MetaObjectPrivate::addProperty()
     MemberAddInfo addProperty(const std::string& name, const qi::Signature& sig, int id = -1);
+
+    /// @see MemberPriority
+    void setMemberPriority(unsigned int id, MemberPriority priority);
     qi::MetaObject metaObject();
 
   private:
@@ -44,6 +44,8 @@ namespace detail {
 
     /// Sets a description for the type to build.
     void setDescription(const std::string& description);
+    /// @see MemberPriority
+    void setMemberPriority(unsigned int id, MemberPriority priority);
 
     // input: template-based
 
@@ -17,6 +17,34 @@ namespace qi {
   template<typename Dispatcher>
   Dispatcher& typeDispatch(Dispatcher& dispatcher, AnyReference value);
 
+  /** The fields of a struct value, given to TypeDispatcher::visitTuple.
+   * It refers to the value: fields are neither copied nor gathered in a
+   * vector.
+   *
+   * It converts to the vector of fields that visitTuple used to take, so that
+   * dispatchers taking a `const AnyReferenceVector&` still work, at the cost
+   * of that vector.
+   */
+  class StructMembers
+  {
+  public:
+    StructMembers(StructTypeInterface* type, void* storage);
+
+    /// Get the number of fields.
+    std::size_t size() const;
+    /// Get the field at index (not a copy).
+    AnyReference operator[](std::size_t index) const;
+    /// Get the types of the fields.
+    const std::vector<TypeInterface*>& types() const;
+
+    operator AnyReferenceVector() const;
+
+  private:
+    StructTypeInterface* _type;
+    void* _storage;
+    const std::vector<TypeInterface*>* _types;
+  };
+
 
   // class QI_API TypeDispatcher
   // {
@@ -30,7 +58,9 @@ namespace qi {
   //   void visitMap(qi::AnyIterator begin, qi::AnyIterator end);
   //   void visitObject(qi::GenericObject value);
   //   void visitPointer(qi::AnyReference pointee);
-  //   void visitTuple(const std::string &className, const std::vector<qi::AnyReference>& tuple, const std::vector<std::string>& elementNames);
+  //   void visitTuple(const std::string &className, const qi::StructMembers& tuple, const std::vector<std::string>& elementNames);
+  //   (or, allocating a vector of the fields,
+  //   void visitTuple(const std::string &className, const std::vector<qi::AnyReference>& tuple, const std::vector<std::string>& elementNames);)
   //   void visitDynamic(qi::AnyReference pointee);
   //   void visitRaw(qi::AnyReference value);
   //   void visitIterator(qi::AnyReference value);
@@ -200,6 +200,14 @@ namespace qi{
     virtual AnyIterator end(void* storage) = 0;
     /// Append an element to the end of the list
     virtual void pushBack(void** storage, void* valueStorage) = 0;
+    /**
+     * Append an element to the end of the list, taking ownership of
+     * valueStorage, which must have been created by elementType().
+     *
+     * The default implementation copies the element and destroys
+     * valueStorage, implementations may reuse or move from it instead.
+     */
+    virtual void pushBackOwned(void** storage, void* valueStorage);
     /// Get the element at index
     virtual void* element(void* storage, int index);
     TypeKind kind() override { return TypeKind_List;}
@@ -227,6 +235,13 @@ namespace qi{
     virtual AnyIterator end(void* storage) = 0;
     /// Set a key to a value and creates it if it does not exist
     virtual void insert(void** storage, void* keyStorage, void* valueStorage) = 0;
+    /**
+     * Set a key to a value, taking ownership of keyStorage and valueStorage,
+     * which must have been created by keyType() and elementType().
+     *
+     * The default implementation copies both and destroys them.
+     */
+    virtual void insertOwned(void** storage, void* keyStorage, void* valueStorage);
     /**
      * Get the value corresponding to the requested key
      *
@@ -244,6 +259,18 @@ namespace qi{
   public:
     /// Get all the fields of the structure
     AnyReferenceVector values(void* storage);
+    /// Get the field at index (not a copy). Does not allocate.
+    AnyReference member(void* storage, unsigned int index);
+    /**
+     * Get the member types, computed once by memberTypes() and kept for the
+     * lifetime of the type. Does not allocate, except on the first call.
+     */
+    const std::vector<TypeInterface*>& cachedMemberTypes();
+    /// Get the names of the fields, computed once by elementsName(). Does not
+    /// allocate, except on the first call.
+    const std::vector<std::string>& cachedElementsName();
+    /// Get the number of fields. Does not allocate, except on the first call.
+    std::size_t memberCount() { return cachedMemberTypes().size(); }
     /**
      * Get all the member types
      *
@@ -260,6 +287,14 @@ namespace qi{
     virtual void set(void** storage, const std::vector<void*>&);
     /// Set the fields of the struct at index (copies the value given)
     virtual void set(void** storage, unsigned int index, void* valStorage) = 0;
+    /**
+     * Set all the fields of the struct, taking ownership of the storages given
+     * in the vector, which must have been created by the member types. They
+     * are owned by the struct or destroyed even if an exception is thrown.
+     *
+     * The default implementation copies the values and destroys the storages.
+     */
+    virtual void setOwned(void** storage, const std::vector<void*>& valStorages);
     TypeKind kind() override { return TypeKind_Tuple; }
     /// Get the names of the fields of the struct
     virtual std::vector<std::string> elementsName() { return std::vector<std::string>();}
@@ -315,6 +350,12 @@ namespace qi{
     virtual AnyReference get(void* storage) = 0;
     /// Set the underlying element
     virtual void set(void** storage, AnyReference source) = 0;
+    /**
+     * Set the underlying element, taking ownership of source.
+     *
+     * The default implementation copies source and destroys it.
+     */
+    virtual void setOwned(void** storage, AnyReference source);
     TypeKind kind() override { return TypeKind_Dynamic; }
   };
 
@@ -59,6 +59,9 @@ namespace qi {
     virtual const std::vector<std::pair<TypeInterface*, std::ptrdiff_t> >& parentTypes() = 0;
     virtual qi::Future<AnyValue> property(void* instance, AnyObject context, unsigned int id) = 0;
     virtual qi::Future<void> setProperty(void* instance, AnyObject context, unsigned int id, AnyValue value) = 0;
+    /// @return the tuple of the types the method takes, into which calls can be
+    /// decoded directly, or null if unknown.
+    virtual TypeInterface* parametersType(void* /*instance*/, unsigned int /*method*/) { return nullptr; }
     virtual TypeKind kind() { return TypeKind_Object;}
     static const auto INHERITS_FAILED = PTRDIFF_MAX;
 
@@ -258,6 +258,11 @@ namespace qi {
 
   void* Application::loadModule(const std::string& moduleName, int flags)
   {
+    // Modules may be loaded from several threads: run the atEnter handlers
+    // they register one load at a time.
+    static boost::recursive_mutex* loadMutex = nullptr;
+    QI_THREADSAFE_NEW(loadMutex);
+    boost::recursive_mutex::scoped_lock lock(*loadMutex);
     void* handle = os::dlopen(moduleName.c_str(), flags);
     if (!handle)
     {
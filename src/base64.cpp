@@ -0,0 +1,411 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ka/base64.hpp>
+#include "base64.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+# define QI_BASE64_X86 1
+# define QI_BASE64_TARGET(isa) __attribute__((target(isa)))
+# include <immintrin.h>
+#endif
+
+namespace qi
+{
+namespace detail
+{
+namespace
+{
+  const char base64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  // Values of the characters of the alphabet, 0x80 for the other characters.
+  struct DecodeTable
+  {
+    unsigned char values[256];
+
+    DecodeTable()
+    {
+      std::fill(std::begin(values), std::end(values), 0x80);
+      for (unsigned char i = 0; i < 64; ++i)
+        values[static_cast<unsigned char>(base64Alphabet[i])] = i;
+    }
+
+    unsigned char operator()(char c) const
+    {
+      return values[static_cast<unsigned char>(c)];
+    }
+  };
+
+  const DecodeTable& decodeTable()
+  {
+    static const DecodeTable table;
+    return table;
+  }
+
+  // The encoding and decoding functions below process as much of [in, end) as
+  // they can by blocks, and advance `in` and `out` past what they processed.
+  using EncodeBlocks = void (*)(const unsigned char*& in, const unsigned char* end, char*& out);
+  // The decoding functions stop at the first block containing a character out
+  // of the alphabet (including padding). They may write up to 4 bytes past the
+  // decoded data.
+  using DecodeBlocks = void (*)(const char*& in, const char* end, unsigned char*& out);
+
+  void encodeBlocksScalar(const unsigned char*& in, const unsigned char* end, char*& out)
+  {
+    for (; end - in >= 3; in += 3, out += 4)
+    {
+      const std::uint32_t v = (in[0] << 16) | (in[1] << 8) | in[2];
+      out[0] = base64Alphabet[v >> 18];
+      out[1] = base64Alphabet[(v >> 12) & 0x3F];
+      out[2] = base64Alphabet[(v >> 6) & 0x3F];
+      out[3] = base64Alphabet[v & 0x3F];
+    }
+  }
+
+  void decodeBlocksScalar(const char*& in, const char* end, unsigned char*& out)
+  {
+    const DecodeTable& table = decodeTable();
+    for (; end - in >= 4; in += 4, out += 3)
+    {
+      const std::uint32_t a = table(in[0]), b = table(in[1]), c = table(in[2]), d = table(in[3]);
+      if ((a | b | c | d) & 0x80)
+        return;
+      const std::uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+      out[0] = static_cast<unsigned char>(v >> 16);
+      out[1] = static_cast<unsigned char>(v >> 8);
+      out[2] = static_cast<unsigned char>(v);
+    }
+  }
+
+#ifdef QI_BASE64_X86
+  // Vectorized codec from W. Mula and D. Lemire, "Faster Base64 Encoding and
+  // Decoding Using AVX2 Instructions".
+
+  // Spreads each group of 3 bytes of the 12 first bytes of `in` into four
+  // sextets, each one in its own byte, and translates them into characters.
+  QI_BASE64_TARGET("ssse3")
+  inline __m128i encodeSsse3(__m128i in)
+  {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // Offsets to add to the sextets to get their characters, selected by range
+    // of sextets.
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i lessThan26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(lessThan26, _mm_set1_epi8(13)));
+    const __m128i offsets = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+  }
+
+  QI_BASE64_TARGET("ssse3")
+  void encodeBlocksSsse3(const unsigned char*& in, const unsigned char* end, char*& out)
+  {
+    for (; end - in >= 16; in += 12, out += 16)
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), encodeSsse3(v));
+    }
+  }
+
+  // Translates the 16 characters of `in` into sextets and packs them into the
+  // 12 first bytes of the result.
+  // Returns false if a character is out of the alphabet.
+  QI_BASE64_TARGET("ssse3")
+  inline bool decodeSsse3(__m128i in, __m128i& result)
+  {
+    const __m128i lutLo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask2F = _mm_set1_epi8(0x2F);
+
+    const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+    const __m128i loNibbles = _mm_and_si128(in, mask2F);
+    const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+    const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF)
+      return false;
+
+    const __m128i eq2F = _mm_cmpeq_epi8(in, mask2F);
+    const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+    const __m128i sextets = _mm_add_epi8(in, roll);
+
+    const __m128i pairs = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+    const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    result = _mm_shuffle_epi8(groups, _mm_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    return true;
+  }
+
+  QI_BASE64_TARGET("ssse3")
+  void decodeBlocksSsse3(const char*& in, const char* end, unsigned char*& out)
+  {
+    __m128i decoded;
+    for (; end - in >= 16; in += 16, out += 12)
+    {
+      if (!decodeSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), decoded))
+        return;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), decoded);
+    }
+  }
+
+  // Same as encodeSsse3 on both lanes.
+  QI_BASE64_TARGET("avx2")
+  inline __m256i encodeAvx2(__m256i in)
+  {
+    in = _mm256_shuffle_epi8(in, _mm256_broadcastsi128_si256(
+        _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1)));
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i lessThan26 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range = _mm256_or_si256(range, _mm256_and_si256(lessThan26, _mm256_set1_epi8(13)));
+    const __m256i offsets = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+    return _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+  }
+
+  QI_BASE64_TARGET("avx2")
+  void encodeBlocksAvx2(const unsigned char*& in, const unsigned char* end, char*& out)
+  {
+    // Shuffles do not cross lanes: each lane is loaded with 12 bytes to encode.
+    for (; end - in >= 28; in += 24, out += 32)
+    {
+      const __m256i v = _mm256_inserti128_si256(
+          _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 12)), 1);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), encodeAvx2(v));
+    }
+  }
+
+  // Same as decodeSsse3 on both lanes.
+  QI_BASE64_TARGET("avx2")
+  inline bool decodeAvx2(__m256i in, __m256i& result)
+  {
+    const __m256i lutLo = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A));
+    const __m256i lutHi = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10));
+    const __m256i lutRoll = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0));
+    const __m256i mask2F = _mm256_set1_epi8(0x2F);
+
+    const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+    const __m256i loNibbles = _mm256_and_si256(in, mask2F);
+    const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+    const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256())) != -1)
+      return false;
+
+    const __m256i eq2F = _mm256_cmpeq_epi8(in, mask2F);
+    const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+    const __m256i sextets = _mm256_add_epi8(in, roll);
+
+    const __m256i pairs = _mm256_maddubs_epi16(sextets, _mm256_set1_epi32(0x01400140));
+    const __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    result = _mm256_shuffle_epi8(groups, _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+    return true;
+  }
+
+  QI_BASE64_TARGET("avx2")
+  void decodeBlocksAvx2(const char*& in, const char* end, unsigned char*& out)
+  {
+    __m256i decoded;
+    for (; end - in >= 32; in += 32, out += 24)
+    {
+      if (!decodeAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), decoded))
+        return;
+      // Each lane holds 12 decoded bytes.
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(decoded));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm256_extracti128_si256(decoded, 1));
+    }
+  }
+#endif
+
+  struct Kernels
+  {
+    EncodeBlocks encode;
+    DecodeBlocks decode;
+  };
+
+  Kernels selectKernels()
+  {
+#ifdef QI_BASE64_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return Kernels{ &encodeBlocksAvx2, &decodeBlocksAvx2 };
+    if (__builtin_cpu_supports("ssse3"))
+      return Kernels{ &encodeBlocksSsse3, &decodeBlocksSsse3 };
+#endif
+    return Kernels{ &encodeBlocksScalar, &decodeBlocksScalar };
+  }
+
+  const Kernels& kernels()
+  {
+    static const Kernels k = selectKernels();
+    return k;
+  }
+} // anonymous
+
+  void Base64Encoder::update(const void* data, std::size_t size, std::string& out)
+  {
+    auto in = static_cast<const unsigned char*>(data);
+    const auto end = in + size;
+
+    // Complete the group started by the previous chunk.
+    if (_pendingSize > 0)
+    {
+      unsigned char group[3];
+      std::memcpy(group, _pending, _pendingSize);
+      const auto missing = std::min<std::size_t>(3 - _pendingSize, size);
+      std::memcpy(group + _pendingSize, in, missing);
+      in += missing;
+      if (_pendingSize + missing < 3)
+      {
+        std::memcpy(_pending, group, _pendingSize + missing);
+        _pendingSize += missing;
+        return;
+      }
+      const unsigned char* groupIn = group;
+      const auto oldSize = out.size();
+      out.resize(oldSize + 4);
+      char* o = &out[oldSize];
+      encodeBlocksScalar(groupIn, group + 3, o);
+      _pendingSize = 0;
+    }
+
+    const auto groupsEnd = in + (end - in) / 3 * 3;
+    const auto oldSize = out.size();
+    out.resize(oldSize + (groupsEnd - in) / 3 * 4);
+    char* o = &out[oldSize];
+    kernels().encode(in, groupsEnd, o);
+    encodeBlocksScalar(in, groupsEnd, o);
+
+    _pendingSize = end - in;
+    std::memcpy(_pending, in, _pendingSize);
+  }
+
+  void Base64Encoder::finish(std::string& out)
+  {
+    out += ka::base64_encode_with_padding(_pending, _pending + _pendingSize);
+    _pendingSize = 0;
+  }
+
+  bool Base64Decoder::update(const char* data, std::size_t size, std::string& out)
+  {
+    const char* in = data;
+    const char* const end = data + size;
+    const DecodeTable& table = decodeTable();
+
+    // Decodes one group of four characters, possibly padded.
+    const auto decodeQuad = [&](const char* q) {
+      if (_padded)
+        return false;
+      const unsigned a = table(q[0]), b = table(q[1]);
+      const unsigned c = q[2] == '=' ? 0 : table(q[2]);
+      const unsigned d = q[3] == '=' ? 0 : table(q[3]);
+      if ((a | b | c | d) & 0x80 || (q[2] == '=' && q[3] != '='))
+        return false;
+      const std::uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+      out += static_cast<char>(v >> 16);
+      if (q[2] != '=')
+        out += static_cast<char>(v >> 8);
+      if (q[3] != '=')
+        out += static_cast<char>(v);
+      _padded = q[3] == '=';
+      return true;
+    };
+
+    // Complete the group started by the previous chunk.
+    if (_pendingSize > 0)
+    {
+      while (_pendingSize < 4 && in != end)
+        _pending[_pendingSize++] = *in++;
+      if (_pendingSize < 4)
+        return true;
+      _pendingSize = 0;
+      if (!decodeQuad(_pending))
+        return false;
+    }
+
+    const char* const quadsEnd = in + (end - in) / 4 * 4;
+    if (in != quadsEnd)
+    {
+      if (_padded)
+        return false;
+      const auto oldSize = out.size();
+      // Room for the bytes written past the decoded data by the kernels.
+      out.resize(oldSize + (quadsEnd - in) / 4 * 3 + 4);
+      const auto begin = reinterpret_cast<unsigned char*>(&out[oldSize]);
+      unsigned char* o = begin;
+      kernels().decode(in, quadsEnd, o);
+      decodeBlocksScalar(in, quadsEnd, o);
+      out.resize(oldSize + (o - begin));
+
+      // The remaining groups contain padding or invalid characters.
+      for (; in != quadsEnd; in += 4)
+      {
+        if (!decodeQuad(in))
+          return false;
+      }
+    }
+
+    _pendingSize = end - in;
+    std::memcpy(_pending, in, _pendingSize);
+    return _pendingSize == 0 || !_padded;
+  }
+
+  bool Base64Decoder::finish(std::string& out)
+  {
+    const auto pendingSize = _pendingSize;
+    _pendingSize = 0;
+    _padded = false;
+    if (pendingSize == 0)
+      return true;
+    if (pendingSize == 1)
+      return false;
+    // Unpadded data.
+    char quad[4] = { _pending[0], _pending[1], pendingSize == 3 ? _pending[2] : '=', '=' };
+    return update(quad, sizeof(quad), out) && finish(out);
+  }
+
+  void encodeBase64(const void* data, std::size_t size, std::string& out)
+  {
+    out.reserve(out.size() + ka::base64_encoded_with_padding_byte_count(size));
+    Base64Encoder encoder;
+    encoder.update(data, size, out);
+    encoder.finish(out);
+  }
+
+  bool decodeBase64(const char* data, std::size_t size, std::string& out)
+  {
+    Base64Decoder decoder;
+    return decoder.update(data, size, out) && decoder.finish(out);
+  }
+} // namespace detail
+} // namespace qi
@@ -0,0 +1,73 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_BASE64_HPP_
+#define _SRC_BASE64_HPP_
+
+# include <cstddef>
+# include <string>
+# include <qi/api.hpp>
+
+namespace qi
+{
+namespace detail
+{
+  /// Base64 encoder (RFC 4648 alphabet, with padding) of data given chunk by
+  /// chunk.
+  ///
+  /// Bytes that do not fill a group of three are kept until the next call to
+  /// `update` or `finish`, so that the output is the same than if all the data
+  /// had been given at once.
+  ///
+  /// Large chunks are encoded with SSSE3 or AVX2 instructions when the CPU
+  /// supports them.
+  class QI_API_TESTONLY Base64Encoder
+  {
+  public:
+    /// Appends the encoding of the given bytes to `out`.
+    void update(const void* data, std::size_t size, std::string& out);
+
+    /// Appends the encoding of the remaining bytes and the padding to `out`.
+    /// The encoder can then be reused for new data.
+    void finish(std::string& out);
+
+  private:
+    unsigned char _pending[2];
+    std::size_t _pendingSize = 0;
+  };
+
+  /// Base64 decoder of data given chunk by chunk.
+  ///
+  /// The padding is optional. Characters out of the base64 alphabet, including
+  /// white spaces, are errors.
+  class QI_API_TESTONLY Base64Decoder
+  {
+  public:
+    /// Appends the decoding of the given characters to `out`.
+    /// @return false if the characters are not valid base64.
+    bool update(const char* data, std::size_t size, std::string& out);
+
+    /// Appends the decoding of the remaining characters to `out`.
+    /// The decoder can then be reused for new data.
+    /// @return false if the data is truncated.
+    bool finish(std::string& out);
+
+  private:
+    char _pending[4];
+    std::size_t _pendingSize = 0;
+    bool _padded = false;
+  };
+
+  /// Appends the base64 encoding, with padding, of the given bytes to `out`.
+  QI_API_TESTONLY void encodeBase64(const void* data, std::size_t size, std::string& out);
+
+  /// Appends the decoding of the given base64 characters to `out`.
+  /// @return false if the characters are not valid base64.
+  QI_API_TESTONLY bool decodeBase64(const char* data, std::size_t size, std::string& out);
+} // namespace detail
+} // namespace qi
+
+#endif  // _SRC_BASE64_HPP_
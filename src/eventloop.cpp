@@ -2,6 +2,9 @@
 **  Copyright (C) 2012, 2013 Aldebaran Robotics
 **  See COPYING for the license
 */
+#include <cmath>
+#include <map>
+#include <sstream>
 #include <thread>
 #include <system_error>
 #include <memory>
@@ -26,6 +29,8 @@
 #include <qi/future.hpp>
 
 #include <qi/getenv.hpp>
+#include <qi/metrics.hpp>
+#include <qi/tracecontext.hpp>
 
 #include "eventloop_p.hpp"
 #ifdef WITH_PROBES
@@ -270,13 +275,18 @@ namespace qi {
   static const auto gMinThreadsEnvVar = "QI_EVENTLOOP_MIN_THREADS";
   static const auto gMaxThreadsEnvVar = "QI_EVENTLOOP_MAX_THREADS";
   static const auto gPingTimeoutEnvVar = "QI_EVENTLOOP_PING_TIMEOUT";
+  static const auto gMaxQueueDelayEnvVar = "QI_EVENTLOOP_MAX_QUEUE_DELAY";
   static const auto gGracePeriodEnvVar = "QI_EVENTLOOP_GRACE_PERIOD";
   static const auto gMaxTimeoutsEnvVar = "QI_EVENTLOOP_MAX_TIMEOUTS";
+  static const auto gCPUsEnvVar = "QI_EVENTLOOP_CPUS";
+  static const auto gNetworkCPUsEnvVar = "QI_NETWORK_EVENTLOOP_CPUS";
+  static const auto gNetworkCountEnvVar = "QI_NETWORK_EVENTLOOP_COUNT";
   static const auto gThreadMaxIdleDurationMsEnvVar = "QI_EVENTLOOP_THREAD_MAX_IDLE_DURATION";
   const char* const EventLoopAsio::defaultName = "MainEventLoop";
 
   EventLoopAsio::EventLoopAsio(int threadCount, int minThreadCount, int maxThreadCount,
-                               std::string name, bool spawnOnOverload)
+                               std::string name, bool spawnOnOverload,
+                               std::vector<int> cpus)
     : EventLoopPrivate(std::move(name))
     , _io(threadCount)
     , _work(nullptr)
@@ -284,7 +294,24 @@ namespace qi {
     , _maxThreads(maxThreadCount)
     , _workerThreads(new WorkerThreadPool())
     , _spawnOnOverload(spawnOnOverload)
+    , _cpus(std::move(cpus))
+    , _cpuSets(detail::cpuSetsByNumaNode(_cpus))
+    , _taskDelayMetric(metrics::histogram("qi_eventloop_task_delay_seconds",
+        "Time tasks waited to run after they were due.", { { "loop", _name } }))
+    , _taskDurationMetric(metrics::histogram("qi_eventloop_task_duration_seconds",
+        "Run time of the tasks.", { { "loop", _name } }))
   {
+    const metrics::Labels labels{ { "loop", _name } };
+    _gauges.emplace_back(new metrics::GaugeFunction("qi_eventloop_queued_tasks",
+        "Tasks waiting to run, including the delayed ones.", labels,
+        [this] { return static_cast<double>(_totalTask.load() - _activeTask.load()); }));
+    _gauges.emplace_back(new metrics::GaugeFunction("qi_eventloop_active_tasks",
+        "Tasks running.", labels, [this] { return static_cast<double>(_activeTask.load()); }));
+    _gauges.emplace_back(new metrics::GaugeFunction("qi_eventloop_workers",
+        "Worker threads.", labels, [this] { return static_cast<double>(workerCount()); }));
+    _gauges.emplace_back(new metrics::GaugeFunction("qi_eventloop_recent_queue_delay_seconds",
+        "Queue delay measured during the last monitoring period.", labels,
+        [this] { return static_cast<double>(_recentQueueDelay.load()) / 1e9; }));
     start(threadCount);
   }
 
@@ -369,7 +396,7 @@ namespace qi {
     _workerThreads->launchN(threadCount, &EventLoopAsio::runWorkerLoop, this);
     if (_spawnOnOverload)
     {
-      _pingThread = std::thread(&EventLoopAsio::runPingLoop, this);
+      _monitorThread = std::thread(&EventLoopAsio::runMonitorLoop, this);
     }
   }
 
@@ -414,154 +441,215 @@ namespace qi {
   //
   // # Thread creation
   //
-  // The detection of contention is done by launching a task and looking if it
-  // has been run before a given duration. If the duration has been exceeded, a
-  // new thread is spawned (a questionable legacy behavior...) under a maximum
-  // limit. If this maximum limit is reached too many times, an
-  // "emergency callback" is called.
+  // Every task is timestamped when it is posted (or when it is due), so that
+  // its queue delay is known when it starts. Each monitoring period, the queue
+  // delay is the greater of:
+  // - the mean queue delay of the tasks started during the period,
+  // - how long the monitoring task has been waiting, if it has not started
+  //   yet, which accounts for tasks stuck in the queue.
+  // When it exceeds the maximum queue delay, threads are spawned in proportion
+  // to the excess, under a maximum limit. If this maximum limit is reached too
+  // many times, an "emergency callback" is called.
   //
   // # Thread destruction
   //
-  // Each thread is associated to the last date it has run a task. A task is
-  // periodically launched by the "ping loop" to test the contention. This task
-  // also checks how long the thread has been idle (the running of this
-  // monitoring task does not count as real work). If the maximum idle duration
-  // has been exceeded, a specific exception is thrown causing the worker to
-  // stop.
+  // Each thread is associated to the last date it has run a task. The
+  // monitoring task also checks how long the thread running it has been idle
+  // (the running of this monitoring task does not count as real work). If the
+  // maximum idle duration has been exceeded, a specific exception is thrown
+  // causing the worker to stop.
   //
   // Note: On a lower-level side, it is the worker thread pool
   // (`WorkerThreadPool`) that is responsible for the management of the
   // container of threads.
-  void EventLoopAsio::runPingLoop()
+  void EventLoopAsio::runMonitorLoop()
   {
     qi::os::setCurrentThreadName("EvLoop.mon");
-    const auto timeoutDuration = MilliSeconds{ qi::os::getEnvDefault(gPingTimeoutEnvVar, 500u) };
+    pinCurrentThread(_cpus);
+    const auto period = MilliSeconds{ qi::os::getEnvDefault(gPingTimeoutEnvVar, 500u) };
+    const auto maxQueueDelay = MilliSeconds{
+      qi::os::getEnvDefault(gMaxQueueDelayEnvVar, static_cast<unsigned int>(period.count())) };
     const auto graceDuration = MilliSeconds{ qi::os::getEnvDefault(gGracePeriodEnvVar, 0u) };
     const auto maxTimeouts = qi::os::getEnvDefault(gMaxTimeoutsEnvVar, 20u);
     const auto maxIdle = maxIdleDuration();
     const auto prefix = "Threadpool " + _name + ": ";
 
+    Future<void> monitoring;
+    SteadyClockTimePoint monitoringDate;
     unsigned int nbTimeout = 0;
     while (_work.load())
     {
-      qiLogDebug() << "Ping";
-      auto calling = asyncCallInternal(Seconds{0},
-        [this, maxIdle]() {
-          // TODO: check that the eventloop cannot be dead by this point.
-          if (_workerThreads->mustTerminate(
-                std::this_thread::get_id(), maxIdle, _minThreads.load()))
-          {
-            throw detail::TerminateThread{};
-          }
-        },
-        defaultExecutionOptions(),
-        UpdateLastWorkDate{false} // the "ping task" doesn't count as real work.
-      );
-      auto callState = calling.waitFor(timeoutDuration);
-      QI_ASSERT(callState != FutureState_None);
-      if (callState == FutureState_Running)
+      // A monitoring task still waiting is kept: the time it waits is what
+      // reveals the tasks stuck in the queue.
+      if (!monitoring.isValid() || monitoring.isFinished())
       {
-        const auto workerCount = static_cast<int>(_workerThreads->activeWorkerCount());
-        const auto maxThreads = _maxThreads.load();
-        if (maxThreads && workerCount >= maxThreads) // we count in nThreads
-        {
-          ++nbTimeout;
-          qiLogInfo() << prefix << "Size limit reached ("
-                      << nbTimeout << " timeouts / " << maxTimeouts << " max"
-                      << ", number of tasks: " << _totalTask.load()
-                      << ", number of active tasks: " << _activeTask.load()
-                      << ", number of threads: " << workerCount
-                      << ", maximum number of threads: " << maxThreads << ")";
-
-          if (nbTimeout >= maxTimeouts)
-          {
-            qiLogError() << prefix <<
-              "System seems to be deadlocked, sending emergency signal";
+        qiLogDebug() << "Ping";
+        monitoringDate = SteadyClock::now();
+        monitoring = asyncCallInternal(Seconds{0},
+          [this, maxIdle]() {
+            // TODO: check that the eventloop cannot be dead by this point.
+            if (_workerThreads->mustTerminate(
+                  std::this_thread::get_id(), maxIdle, _minThreads.load()))
             {
-              auto syncedEmergencyCallback = _emergencyCallback.synchronize();
-              if (*syncedEmergencyCallback)
-              {
-                try {
-                  (*syncedEmergencyCallback)();
-                } catch (const std::exception& ex) {
-                  qiLogWarning() << prefix << "Emergency callback failed: " << ex.what();
-                } catch (...) {
-                  qiLogWarning() << prefix << "Emergency callback failed: unknown exception";
-                }
-              }
+              throw detail::TerminateThread{};
             }
-          }
-        }
-        else
-        {
-          const auto nextWorkerCount = workerCount + 1;
-          const auto minThreads = _minThreads.load();
-          std::ostringstream details;
-          details << "min: " << minThreads << ", max: ";
-          if (maxThreads) details << maxThreads;
-          else            details << "no limit";
-          if (minThreads != 0)
-          {
-            const auto sizeRatioMin = 100*nextWorkerCount/minThreads;
-            details << ", size/min: " << sizeRatioMin << "%";
-          }
-          if (maxThreads != 0)
-          {
-            const auto sizeRatioMax = detail::posInBetween(0, nextWorkerCount, maxThreads);
-            details << ", size/max: " << sizeRatioMax << "%";
-            const auto growingCapacity = maxThreads - minThreads; // [min,max]
-            const auto growth = nextWorkerCount - minThreads;
-            const auto growingRate = detail::posInBetween(minThreads, nextWorkerCount, maxThreads);
-            details << ", growth ratio: " << growingRate << "%"
-                    << " (" << growth << "/" << growingCapacity << ")";
-          }
-          qiLogInfo() << prefix << "Spawning 1 more thread. New size: " << nextWorkerCount << " (" << details.str() << ")";
-
-          try
-          {
-            _workerThreads->launch(&EventLoopAsio::runWorkerLoop, this);
-          }
-          catch (const std::system_error& ex)
-          {
-            // TODO: report some system info about memory usage etc. in this case.
-            // One of the possible reason to fail here is that there is no memory available.
-            qiLogWarning() << prefix << "Spawning thread " << nextWorkerCount
-              << " failed with system error "<< ex.code() << " : " << ex.what();
-          }
-          catch (const std::exception& ex)
-          {
-            qiLogWarning() << prefix << "Spawning thread " << nextWorkerCount
-              << " failed with error: " << ex.what();
-          }
-          catch (...)
-          {
-            qiLogWarning() << prefix << "Spawning thread " << nextWorkerCount
-              << " failed with unknown error.";
-          }
+          },
+          defaultExecutionOptions(),
+          UpdateLastWorkDate{false} // the monitoring task doesn't count as real work.
+        );
+      }
+      const auto callState = monitoring.waitFor(period);
+      QI_ASSERT(callState != FutureState_None);
 
-        }
-        boost::this_thread::sleep_for(graceDuration);
+      // If the event loop has been stopped and work has been destroyed at this point then
+      // maybe the future has been set in error, so just ignore the result and leave.
+      if (!_work.load())
+      {
+        qiLogDebug() << prefix << "Ignoring monitoring result, the event loop is being stopped";
+        break;
       }
+
+      auto queueDelay = takeWindowQueueDelay();
+      if (callState == FutureState_Running)
+        queueDelay = std::max(queueDelay, Duration(SteadyClock::now() - monitoringDate));
       else
       {
-        // If the event loop has been stopped and work has been destroyed at this point then
-        // maybe the future has been set in error, so just ignore the result and leave.
-        if (!_work.load())
-        {
-          qiLogDebug() << prefix << "Ignoring ping result, the event loop is being stopped";
-          break;
-        }
-
         const bool idleThreadHasTerminated =
              callState == FutureState_FinishedWithError
-          && calling.error() == detail::TerminateThread::message();
+          && monitoring.error() == detail::TerminateThread::message();
 
         QI_IGNORE_UNUSED(idleThreadHasTerminated);
         QI_ASSERT(callState == FutureState_FinishedWithValue || idleThreadHasTerminated);
+      }
+      _recentQueueDelay.store(queueDelay.count());
+
+      if (queueDelay <= maxQueueDelay)
+      {
         nbTimeout = 0;
         qiLogDebug() << prefix << "Ping ok";
-        boost::this_thread::sleep_for(timeoutDuration);
+        boost::this_thread::sleep_for(period);
+        continue;
       }
+
+      const auto workerCount = static_cast<int>(_workerThreads->activeWorkerCount());
+      const auto maxThreads = _maxThreads.load();
+      if (maxThreads && workerCount >= maxThreads) // we count in nThreads
+      {
+        ++nbTimeout;
+        qiLogInfo() << prefix << "Size limit reached ("
+                    << nbTimeout << " timeouts / " << maxTimeouts << " max"
+                    << ", queue delay: " << boost::chrono::duration_cast<MilliSeconds>(queueDelay).count() << " ms"
+                    << ", number of tasks: " << _totalTask.load()
+                    << ", number of active tasks: " << _activeTask.load()
+                    << ", number of threads: " << workerCount
+                    << ", maximum number of threads: " << maxThreads << ")";
+
+        if (nbTimeout >= maxTimeouts)
+        {
+          qiLogError() << prefix <<
+            "System seems to be deadlocked, sending emergency signal";
+          {
+            auto syncedEmergencyCallback = _emergencyCallback.synchronize();
+            if (*syncedEmergencyCallback)
+            {
+              try {
+                (*syncedEmergencyCallback)();
+              } catch (const std::exception& ex) {
+                qiLogWarning() << prefix << "Emergency callback failed: " << ex.what();
+              } catch (...) {
+                qiLogWarning() << prefix << "Emergency callback failed: unknown exception";
+              }
+            }
+          }
+        }
+      }
+      else
+      {
+        growOnQueueDelay(queueDelay, maxQueueDelay);
+      }
+      boost::this_thread::sleep_for(graceDuration);
+    }
+  }
+
+  EventLoopAsio::TaskStatsStripe& EventLoopAsio::currentTaskStats()
+  {
+    static std::atomic<unsigned int> nextThreadIndex{ 0 };
+    static thread_local const unsigned int stripe = nextThreadIndex++ % taskStatsStripeCount;
+    return _taskStats[stripe];
+  }
+
+  Duration EventLoopAsio::takeWindowQueueDelay()
+  {
+    uint64_t count = 0;
+    Duration::rep sum = 0;
+    for (auto& stripe : _taskStats)
+    {
+      count += stripe.windowTaskCount.exchange(0);
+      sum += stripe.windowDelaySum.exchange(0);
+    }
+    if (count == 0)
+      return Duration(0);
+    return Duration(sum / static_cast<Duration::rep>(count));
+  }
+
+  void EventLoopAsio::growOnQueueDelay(Duration delay, Duration maxDelay)
+  {
+    const auto prefix = "Threadpool " + _name + ": ";
+    const auto workerCount = static_cast<int>(_workerThreads->activeWorkerCount());
+    const auto maxThreads = _maxThreads.load();
+    const auto minThreads = _minThreads.load();
+
+    // A delay twice the maximum adds as many threads as there are, so the
+    // number of threads at most doubles each period.
+    const auto excess = static_cast<double>(delay.count()) / static_cast<double>(maxDelay.count()) - 1.;
+    auto spawnCount = std::max(1, static_cast<int>(std::ceil(std::min(excess, 1.) * workerCount)));
+    if (maxThreads)
+      spawnCount = std::min(spawnCount, maxThreads - workerCount);
+    const auto nextWorkerCount = workerCount + spawnCount;
+
+    std::ostringstream details;
+    details << "queue delay: " << boost::chrono::duration_cast<MilliSeconds>(delay).count()
+            << " ms, min: " << minThreads << ", max: ";
+    if (maxThreads) details << maxThreads;
+    else            details << "no limit";
+    if (minThreads != 0)
+    {
+      const auto sizeRatioMin = 100*nextWorkerCount/minThreads;
+      details << ", size/min: " << sizeRatioMin << "%";
+    }
+    if (maxThreads != 0 && minThreads <= nextWorkerCount)
+    {
+      const auto sizeRatioMax = detail::posInBetween(0, nextWorkerCount, maxThreads);
+      details << ", size/max: " << sizeRatioMax << "%";
+      const auto growingCapacity = maxThreads - minThreads; // [min,max]
+      const auto growth = nextWorkerCount - minThreads;
+      const auto growingRate = detail::posInBetween(minThreads, nextWorkerCount, maxThreads);
+      details << ", growth ratio: " << growingRate << "%"
+              << " (" << growth << "/" << growingCapacity << ")";
+    }
+    qiLogInfo() << prefix << "Spawning " << spawnCount << " more thread(s). New size: "
+                << nextWorkerCount << " (" << details.str() << ")";
+
+    try
+    {
+      _workerThreads->launchN(spawnCount, &EventLoopAsio::runWorkerLoop, this);
+    }
+    catch (const std::system_error& ex)
+    {
+      // TODO: report some system info about memory usage etc. in this case.
+      // One of the possible reason to fail here is that there is no memory available.
+      qiLogWarning() << prefix << "Spawning threads up to " << nextWorkerCount
+        << " failed with system error "<< ex.code() << " : " << ex.what();
+    }
+    catch (const std::exception& ex)
+    {
+      qiLogWarning() << prefix << "Spawning threads up to " << nextWorkerCount
+        << " failed with error: " << ex.what();
+    }
+    catch (...)
+    {
+      qiLogWarning() << prefix << "Spawning threads up to " << nextWorkerCount
+        << " failed with unknown error.";
     }
   }
 
@@ -570,6 +658,8 @@ namespace qi {
     qiLogDebug() << this << ": run starting from pool "
       "(workerCount = " << _workerThreads->activeWorkerCount() << ")";
     qi::os::setCurrentThreadName(_name);
+    if (!_cpuSets.empty())
+      pinCurrentThread(_cpuSets[_nextCPUSet++ % _cpuSets.size()]);
 
     while (true) {
       try
@@ -590,6 +680,19 @@ namespace qi {
     }
   }
 
+  void EventLoopAsio::pinCurrentThread(const std::vector<int>& cpus) const
+  {
+    if (cpus.empty())
+      return;
+    if (!qi::os::setCurrentThreadCPUAffinity(cpus))
+    {
+      std::ostringstream list;
+      for (const auto cpu : cpus)
+        list << (list.tellp() > 0 ? "," : "") << cpu;
+      qiLogWarning() << _name << ": Cannot restrict a thread to the CPUs " << list.str();
+    }
+  }
+
   bool EventLoopAsio::isInThisContext() const
   {
     return _workerThreads->isWorker(std::this_thread::get_id());
@@ -597,11 +700,11 @@ namespace qi {
 
   void EventLoopAsio::join()
   {
-    if (_pingThread.joinable())
+    if (_monitorThread.joinable())
     {
-      qiLogVerbose() << "Waiting for the ping thread ...";
-      _pingThread.join();
-      qiLogDebug()  << "Waiting for the ping thread - DONE";
+      qiLogVerbose() << "Waiting for the monitoring thread ...";
+      _monitorThread.join();
+      qiLogDebug()  << "Waiting for the monitoring thread - DONE";
     }
 
     qiLogVerbose()
@@ -614,13 +717,21 @@ namespace qi {
   /// Destructible D
   template <typename D>
   void EventLoopAsio::invoke_maybe(boost::function<void()> f, qi::uint64_t id, qi::Promise<void> p,
-                                   const boost::system::error_code& erc, D countTask, UpdateLastWorkDate update)
+                                   const boost::system::error_code& erc, D countTask, UpdateLastWorkDate update,
+                                   SteadyClockTimePoint dueDate)
   {
     boost::ignore_unused(id, countTask);
     if (!erc)
     {
       auto _ = ka::scoped_incr_and_decr(_activeTask);
       tracepoint(qi_qi, eventloop_task_start, id);
+      const auto start = SteadyClock::now();
+      const auto delay = Duration(start - dueDate);
+      auto& stats = currentTaskStats();
+      stats.delay.record(delay);
+      _taskDelayMetric.push(delay);
+      stats.windowDelaySum.fetch_add(delay.count(), std::memory_order_relaxed);
+      stats.windowTaskCount.fetch_add(1, std::memory_order_relaxed);
 
       try
       {
@@ -643,6 +754,9 @@ namespace qi {
         tracepoint(qi_qi, eventloop_task_error, id);
         p.setError("unknown error");
       }
+      const auto duration = Duration(SteadyClock::now() - start);
+      stats.duration.record(duration);
+      _taskDurationMetric.push(duration);
     }
     else
     {
@@ -674,8 +788,16 @@ namespace qi {
       tracepoint(qi_qi, eventloop_post, id, cb.target_type().name());
 
       auto countTotalTask = ka::shared_ptr(ka::scoped_incr_and_decr(_totalTask));
-      _io.post([=] { invoke_maybe(cb, id, Promise<void>{}, erc, countTotalTask,
-                                  UpdateLastWorkDate{true}); });
+      const auto dueDate = SteadyClock::now();
+      const auto postTask = [&](const boost::function<void()>& task) {
+        _io.post([=] { invoke_maybe(task, id, Promise<void>{}, erc, countTotalTask,
+                                    UpdateLastWorkDate{true}, dueDate); });
+      };
+      // Only bind a context there is, so that untraced tasks are not copied.
+      if (currentTraceContext().isValid())
+        postTask(detail::bindTraceContext(cb));
+      else
+        postTask(cb);
     }
     else
     {
@@ -716,23 +838,25 @@ namespace qi {
     if (!_work.load())
       return qi::makeFutureError<void>("Schedule attempt on destroyed thread pool");
 
+    cb = detail::bindTraceContext(std::move(cb));
     const auto id = ++gTaskId;
 
     auto countTotalTask = ka::shared_ptr(ka::scoped_incr_and_decr(_totalTask));
 
     tracepoint(qi_qi, eventloop_delay, id, cb.target_type().name(), boost::chrono::duration_cast<qi::MicroSeconds>(delay).count());
+    const auto dueDate = SteadyClock::now() + delay;
     if (delay > Duration::zero())
     {
       boost::shared_ptr<boost::asio::steady_timer> timer = boost::make_shared<boost::asio::steady_timer>(_io);
       timer->expires_from_now(boost::chrono::duration_cast<boost::asio::steady_timer::duration>(delay));
       auto prom = detail::makeCancelingPromise(options, boost::bind(&boost::asio::steady_timer::cancel, timer));
       timer->async_wait([=](const boost::system::error_code& erc) {
-        invoke_maybe(cb, id, prom, erc, countTotalTask, update);
+        invoke_maybe(cb, id, prom, erc, countTotalTask, update, dueDate);
       });
       return prom.future();
     }
     Promise<void> prom;
-    _io.post([=] { invoke_maybe(cb, id, prom, erc, countTotalTask, update); });
+    _io.post([=] { invoke_maybe(cb, id, prom, erc, countTotalTask, update, dueDate); });
     return prom.future();
   }
 
@@ -761,6 +885,7 @@ namespace qi {
     if (!_work.load())
       return qi::makeFutureError<void>("Schedule attempt on destroyed thread pool");
 
+    cb = detail::bindTraceContext(std::move(cb));
     const auto id = ++gTaskId;
 
     auto countTotalTask = ka::shared_ptr(ka::scoped_incr_and_decr(_totalTask));
@@ -770,7 +895,7 @@ namespace qi {
     timer->expires_at(timepoint);
     auto prom = detail::makeCancelingPromise(options, boost::bind(&SteadyTimer::cancel, timer));
     timer->async_wait([=](const boost::system::error_code& erc) {
-      invoke_maybe(cb, id, prom, erc, countTotalTask, update);
+      invoke_maybe(cb, id, prom, erc, countTotalTask, update, timepoint);
     });
     return prom.future();
   }
@@ -795,6 +920,21 @@ namespace qi {
     return _workerThreads->activeWorkerCount();
   }
 
+  EventLoopStatistics EventLoopAsio::statistics() const
+  {
+    EventLoopStatistics statistics;
+    statistics.activeTasks = _activeTask.load();
+    statistics.queuedTasks = _totalTask.load() - statistics.activeTasks;
+    statistics.workers = workerCount();
+    for (const auto& stripe : _taskStats)
+    {
+      statistics.queueDelay.merge(stripe.delay.snapshot());
+      statistics.runTime.merge(stripe.duration.snapshot());
+    }
+    statistics.recentQueueDelay = Duration(_recentQueueDelay.load());
+    return statistics;
+  }
+
   EventLoop::EventLoop(std::string name, int nthreads, bool spawnOnOverload)
     : _p(std::make_shared<EventLoopAsio>(nthreads, name, spawnOnOverload))
     , _name(name)
@@ -808,6 +948,14 @@ namespace qi {
   {
   }
 
+  EventLoop::EventLoop(std::string name, int nthreads, int minThreads, int maxThreads,
+    bool spawnOnOverload, std::vector<int> cpus)
+    : _p(std::make_shared<EventLoopAsio>(nthreads, minThreads, maxThreads, name, spawnOnOverload,
+                                         std::move(cpus)))
+    , _name(name)
+  {
+  }
+
   EventLoop::~EventLoop()
   {
     // TODO after compiler upgrades: auto p = std::atomic_exchange(&_p, {});
@@ -942,6 +1090,14 @@ namespace qi {
     });
   }
 
+  EventLoopStatistics EventLoop::statistics() const
+  {
+    return safeCall(_p, [](const ImplPtr& impl){
+      return impl->statistics();
+    }
+    , []{ return EventLoopStatistics{}; });
+  }
+
   struct MonitorContext
   {
     EventLoop* target;
@@ -1022,6 +1178,51 @@ namespace qi {
     return ctx->promise.future();
   }
 
+  namespace detail
+  {
+    std::vector<int> parseCPUList(const std::string& list)
+    {
+      std::vector<int> cpus;
+      std::istringstream in(list);
+      std::string item;
+      while (std::getline(in, item, ','))
+      {
+        const auto dash = item.find('-');
+        std::size_t firstEnd = 0, lastEnd = 0;
+        int first = 0, last = 0;
+        try
+        {
+          first = std::stoi(item.substr(0, dash), &firstEnd);
+          last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1), &lastEnd);
+        }
+        catch (const std::exception&)
+        {
+          throw std::runtime_error("Invalid CPU list \"" + list + "\"");
+        }
+        if (firstEnd != (dash == std::string::npos ? item.size() : dash)
+            || (dash != std::string::npos && lastEnd != item.size() - dash - 1)
+            || first < 0 || last < first)
+          throw std::runtime_error("Invalid CPU list \"" + list + "\"");
+        for (int cpu = first; cpu <= last; ++cpu)
+          cpus.push_back(cpu);
+      }
+      std::sort(cpus.begin(), cpus.end());
+      cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+      return cpus;
+    }
+
+    std::vector<std::vector<int>> cpuSetsByNumaNode(const std::vector<int>& cpus)
+    {
+      std::map<int, std::vector<int>> byNode;
+      for (const auto cpu : cpus)
+        byNode[os::numaNodeOfCPU(cpu)].push_back(cpu);
+      std::vector<std::vector<int>> sets;
+      for (auto& node : byNode)
+        sets.push_back(std::move(node.second));
+      return sets;
+    }
+  }
+
   static void eventloop_stop(EventLoop* &ctx)
   {
     delete ctx;
@@ -1029,7 +1230,78 @@ namespace qi {
   }
 
   static EventLoop* _poolEventLoop = nullptr;
-  static EventLoop* _networkEventLoop = nullptr;
+  // The network event loops, created all at once. The first one is the one
+  // returned by getNetworkEventLoop().
+  static std::vector<EventLoop*>& _networkEventLoops()
+  {
+    // Never destroyed: the event loops are deleted at exit, and their slots
+    // reset, by the handlers of Application::atExit.
+    static auto* const loops = new std::vector<EventLoop*>();
+    return *loops;
+  }
+
+  namespace
+  {
+    // CPU lists given on the command line, which take precedence over the
+    // environment variables.
+    boost::synchronized_value<std::string> _eventLoopCPUs;
+    boost::synchronized_value<std::string> _networkEventLoopCPUs;
+    std::atomic<int> _networkEventLoopCount{0};
+
+    void _setEventLoopCPUs(const std::string& list)
+    {
+      if (_poolEventLoop)
+        qiLogWarning() << "The global event loop is already running, ignoring its CPUs";
+      _eventLoopCPUs = list;
+    }
+
+    void _setNetworkEventLoopCPUs(const std::string& list)
+    {
+      if (!_networkEventLoops().empty())
+        qiLogWarning() << "The global network event loop is already running, ignoring its CPUs";
+      _networkEventLoopCPUs = list;
+    }
+
+    void _setNetworkEventLoopCount(int count)
+    {
+      if (!_networkEventLoops().empty())
+        qiLogWarning() << "The network event loops are already running, ignoring their count";
+      _networkEventLoopCount = count;
+    }
+
+    std::vector<int> _configuredCPUs(const boost::synchronized_value<std::string>& option,
+                                     const char* envVar)
+    {
+      auto list = option.get();
+      if (list.empty())
+        list = os::getenv(envVar);
+      if (list.empty())
+        return {};
+      try
+      {
+        return detail::parseCPUList(list);
+      }
+      catch (const std::exception& ex)
+      {
+        qiLogWarning() << "Running the event loop on any CPU: " << ex.what();
+        return {};
+      }
+    }
+  }
+
+  _QI_COMMAND_LINE_OPTIONS(
+    "Event loop options",
+    ("qi-eventloop-cpus", value<std::string>()->notifier(&_setEventLoopCPUs),
+     "CPUs the threads of the global event loop run on, such as 0-3,6.\n"
+     "Can be set with env var QI_EVENTLOOP_CPUS")
+    ("qi-network-eventloop-cpus", value<std::string>()->notifier(&_setNetworkEventLoopCPUs),
+     "CPUs the threads of the network event loop run on, such as 0-3,6.\n"
+     "Can be set with env var QI_NETWORK_EVENTLOOP_CPUS")
+    ("qi-network-eventloop-count", value<int>()->notifier(&_setNetworkEventLoopCount),
+     "Number of network event loops, each with a single thread, sockets being spread over them "
+     "(default: 1).\n"
+     "Can be set with env var QI_NETWORK_EVENTLOOP_COUNT")
+  )
 
   namespace
   {
@@ -1037,7 +1309,8 @@ namespace qi {
     // We then use an atomic to prevent having a mutex on a fastpath.
     EventLoop* _getInternal(EventLoop* &ctx, int nthreads,
       const std::string& name, bool spawnOnOverload, boost::mutex& mutex,
-      std::atomic<int>& init, int minThreads, int maxThreads)
+      std::atomic<int>& init, int minThreads, int maxThreads,
+      const boost::synchronized_value<std::string>& cpusOption, const char* cpusEnvVar)
     {
       if (init.load())
         return ctx;
@@ -1051,7 +1324,8 @@ namespace qi {
             qiLogVerbose() << "Creating event loop while no qi::Application() is running";
           }
           // TODO: use make_unique once we can use C++14
-          ctx = new EventLoop(name, nthreads, minThreads, maxThreads, spawnOnOverload);
+          ctx = new EventLoop(name, nthreads, minThreads, maxThreads, spawnOnOverload,
+                              _configuredCPUs(cpusOption, cpusEnvVar));
           Application::atExit(boost::bind(&eventloop_stop, boost::ref(ctx)));
         }
       }
@@ -1066,15 +1340,50 @@ namespace qi {
     static std::atomic<int> init(0);
     // We do not decide here the min thread count, nor the max thread count.
     // Let the defaults be used (hence, min = -1, max = 0)
-    return _getInternal(ctx, nthreads, EventLoopAsio::defaultName, true, mutex, init, -1, 0);
+    return _getInternal(ctx, nthreads, EventLoopAsio::defaultName, true, mutex, init, -1, 0,
+                        _eventLoopCPUs, gCPUsEnvVar);
   }
 
-  static EventLoop* _getNetwork(EventLoop* &ctx)
+  static const std::vector<EventLoop*>& _getNetwork()
   {
     static boost::mutex mutex;
     static std::atomic<int> init(0);
-    // This eventloop has only one thread (hence, min thread count = max thread count = 1).
-    return _getInternal(ctx, 1, "EventLoopNetwork", false, mutex, init, 1, 1);
+    auto& loops = _networkEventLoops();
+    if (init.load())
+      return loops;
+
+    {
+      boost::mutex::scoped_lock _sl(mutex);
+      if (loops.empty())
+      {
+        if (!qi::Application::initialized())
+        {
+          qiLogVerbose() << "Creating event loop while no qi::Application() is running";
+        }
+        auto count = _networkEventLoopCount.load();
+        if (count <= 0)
+          count = qi::os::getEnvDefault(gNetworkCountEnvVar, 1);
+        count = std::max(count, 1);
+        const auto cpus = _configuredCPUs(_networkEventLoopCPUs, gNetworkCPUsEnvVar);
+        const auto cpuSets = detail::cpuSetsByNumaNode(cpus);
+
+        // The slots are bound by reference by the exit handlers: the vector
+        // must not grow once they are registered.
+        loops.resize(static_cast<std::size_t>(count));
+        for (int i = 0; i < count; ++i)
+        {
+          const std::string name = i == 0 ? "EventLoopNetwork" : "EventLoopNetwork" + std::to_string(i);
+          // Each event loop has only one thread (hence, min thread count = max
+          // thread count = 1), so they are spread over the NUMA nodes here.
+          const auto loopCPUs = count == 1 || cpuSets.empty() ? cpus : cpuSets[i % cpuSets.size()];
+          // TODO: use make_unique once we can use C++14
+          loops[i] = new EventLoop(name, 1, 1, 1, false, loopCPUs);
+          Application::atExit(boost::bind(&eventloop_stop, boost::ref(loops[i])));
+        }
+      }
+    }
+    ++init;
+    return loops;
   }
 
   void startEventLoop(int nthread)
@@ -1089,7 +1398,16 @@ namespace qi {
 
   EventLoop* getNetworkEventLoop()
   {
-    return _getNetwork(_networkEventLoop);
+    return _getNetwork().front();
+  }
+
+  EventLoop* nextNetworkEventLoop()
+  {
+    static std::atomic<unsigned int> next{0};
+    const auto& loops = _getNetwork();
+    if (loops.size() == 1)
+      return loops.front();
+    return loops[next++ % loops.size()];
   }
 
 }
@@ -7,6 +7,7 @@
 #ifndef _SRC_EVENTLOOP_P_HPP_
 #define _SRC_EVENTLOOP_P_HPP_
 
+#include <array>
 #include <atomic>
 #include <thread>
 #include <boost/asio.hpp>
@@ -14,6 +15,7 @@
 #include <ka/ark/mutable.hpp>
 #include <ka/macroregular.hpp>
 #include <qi/eventloop.hpp>
+#include <qi/metrics.hpp>
 #include <boost/thread/synchronized_value.hpp>
 
 namespace qi {
@@ -55,6 +57,7 @@ namespace qi {
     virtual void* nativeHandle()=0;
     virtual void setMinThreads(unsigned int min)=0;
     virtual void setMaxThreads(unsigned int max)=0;
+    virtual EventLoopStatistics statistics() const=0;
     boost::synchronized_value<boost::function<void()>> _emergencyCallback;
     const std::string _name;
   };
@@ -67,8 +70,10 @@ namespace qi {
     explicit EventLoopAsio(int threadCount = 0, std::string name = defaultName,
       bool spawnOnOverload = true);
 
+    /// \see EventLoop(std::string, int, int, int, bool, std::vector<int>)
     EventLoopAsio(int threadCount, int minThreadCount, int maxThreadCount,
-                  std::string name, bool spawnOnOverload);
+                  std::string name, bool spawnOnOverload,
+                  std::vector<int> cpus = std::vector<int>());
 
     ~EventLoopAsio() override;
 
@@ -87,6 +92,7 @@ namespace qi {
     void* nativeHandle() override;
     void setMinThreads(unsigned int min) override;
     void setMaxThreads(unsigned int max) override;
+    EventLoopStatistics statistics() const override;
     int workerCount() const;
     MilliSeconds maxIdleDuration() const;
   private:
@@ -94,11 +100,19 @@ namespace qi {
     using UpdateLastWorkDate = ka::ark_mutable_t<bool>;
 
     /// Destructible D
+    /// The queue delay of the task is measured from `dueDate`.
     template<typename D>
     void invoke_maybe(boost::function<void()> f, qi::uint64_t id, qi::Promise<void> p,
-        const boost::system::error_code& erc, D countTask, UpdateLastWorkDate);
+        const boost::system::error_code& erc, D countTask, UpdateLastWorkDate,
+        SteadyClockTimePoint dueDate);
     void runWorkerLoop();
-    void runPingLoop();
+    void runMonitorLoop();
+    /// Restrict the current thread to `cpus`, if not empty.
+    void pinCurrentThread(const std::vector<int>& cpus) const;
+    /// Mean queue delay of the tasks started since the last call.
+    Duration takeWindowQueueDelay();
+    /// Launch workers in proportion to how much `delay` exceeds `maxDelay`.
+    void growOnQueueDelay(Duration delay, Duration maxDelay);
 
     qi::Future<void> asyncCallInternal(
       qi::Duration delay, boost::function<void ()> callback,
@@ -115,11 +129,37 @@ namespace qi {
 
     class WorkerThreadPool;
     std::unique_ptr<WorkerThreadPool> _workerThreads;
-    std::thread _pingThread;
+    std::thread _monitorThread;
 
     std::atomic<int64_t> _totalTask {0};
     std::atomic<int64_t> _activeTask {0};
     const bool _spawnOnOverload;
+
+    const std::vector<int> _cpus;
+    // The CPUs of each NUMA node, a worker running on those of a single node.
+    const std::vector<std::vector<int>> _cpuSets;
+    std::atomic<unsigned int> _nextCPUSet {0};
+
+    // Statistics of the tasks, always recorded. They are recorded into
+    // stripes, each thread using the stripe selected by its index, so that
+    // concurrent tasks rarely write to the same counters. The stripes are
+    // merged when read.
+    struct TaskStatsStripe
+    {
+      metrics::Histogram delay;
+      metrics::Histogram duration;
+      std::atomic<Duration::rep> windowDelaySum {0};
+      std::atomic<uint64_t> windowTaskCount {0};
+    };
+    static const unsigned int taskStatsStripeCount = 4;
+    std::array<TaskStatsStripe, taskStatsStripeCount> _taskStats;
+    TaskStatsStripe& currentTaskStats();
+    std::atomic<Duration::rep> _recentQueueDelay {0};
+
+    metrics::Histogram& _taskDelayMetric;
+    metrics::Histogram& _taskDurationMetric;
+    // Last, so that they are unregistered before what they read is destroyed.
+    std::vector<std::unique_ptr<metrics::GaugeFunction>> _gauges;
   };
 }
 
@@ -4,6 +4,7 @@
 */
 #include <qi/future.hpp>
 #include <qi/log.hpp>
+#include <qi/metrics.hpp>
 #include <qi/os.hpp>
 
 #include <boost/thread.hpp>
@@ -49,6 +50,18 @@ namespace qi {
       delete _p;
     };
 
+    void FutureBase::countCallbacks(std::size_t synchronous, std::size_t asynchronous)
+    {
+      if (!metrics::isEnabled())
+        return;
+      static auto& synchronousCount = metrics::counter("qi_future_continuations_total",
+          "Callbacks of futures run.", { { "mode", "sync" } });
+      static auto& asynchronousCount = metrics::counter("qi_future_continuations_total",
+          "Callbacks of futures run.", { { "mode", "async" } });
+      synchronousCount.add(synchronous);
+      asynchronousCount.add(asynchronous);
+    }
+
     FutureState FutureBase::state() const
     {
       return FutureState(_p->_state.load());
@@ -11,6 +11,7 @@
 #include <qi/applicationsession.hpp>
 #include <qi/anyvalue.hpp>
 #include <qi/log.hpp>
+#include <qi/messaging/metricsservice.hpp>
 #include "applicationsession_internal.hpp"
 
 qiLogCategory("qi.applicationsession");
@@ -84,14 +85,28 @@ public:
     if (_config.standalone())
     {
       _session->listenStandalone();
-      return;
+    }
+    else
+    {
+      _session->connect();
+
+      // Only listen if there were listen URLs specified on the command line.
+      if (defaultProgramOptions().hasCliListenUrl)
+        _session->listen();
     }
 
-    _session->connect();
+    if (metrics::isEnabled())
+      registerMetricsService();
+  }
 
-    // Only listen if there were listen URLs specified on the command line.
-    if (defaultProgramOptions().hasCliListenUrl)
-      _session->listen();
+  void registerMetricsService()
+  {
+    // Another process may already publish its metrics under this name.
+    const auto registering =
+      _session->registerService(metrics::serviceName, metrics::makeService()).async();
+    if (registering.hasError())
+      qiLogWarning() << "Cannot register the " << metrics::serviceName
+                     << " service: " << registering.error();
   }
 
 public:
@@ -28,10 +28,12 @@ namespace qi
                                    unsigned int event, Signature sig,
                                    MessageSocketPtr client,
                                    boost::weak_ptr<ObjectHost> context,
-                                   const std::string& signature)
+                                   const std::string& signature,
+                                   MemberPriority priority)
   {
     qiLogDebug() << "forwardEvent";
     qi::Message msg;
+    msg.setCurrentTraceContext(client);
     // FIXME: would like to factor with serveresult.hpp convertAndSetValue()
     // but we have a setValue/setValues issue
     bool processed = false;
@@ -84,6 +86,7 @@ namespace qi
     msg.setFunction(event);
     msg.setType(Message::Type_Event);
     msg.setObject(object);
+    msg.setPriority(priority);
     client->send(std::move(msg));
     return AnyReference();
   }
@@ -158,7 +161,8 @@ namespace qi
     if (!ms)
       throw std::runtime_error("No such signal");
     QI_ASSERT(_currentSocket);
-    AnyFunction mc = AnyFunction::fromDynamicFunction(boost::bind(&forwardEvent, _1, _serviceId, _objectId, eventId, ms->parametersSignature(), _currentSocket, asHostWeakPtr(), ""));
+    AnyFunction mc = AnyFunction::fromDynamicFunction(boost::bind(&forwardEvent, _1, _serviceId, _objectId, eventId, ms->parametersSignature(), _currentSocket, asHostWeakPtr(), "",
+                                                                  _object.metaObject().memberPriority(eventId)));
     qi::Future<SignalLink> linking = _object.connect(eventId, mc);
     auto& linkEntry = _links[_currentSocket][remoteSignalLinkId];
     linkEntry = RemoteSignalLink(linking, eventId);
@@ -175,7 +179,8 @@ namespace qi
     if (!ms)
       throw std::runtime_error("No such signal");
     QI_ASSERT(_currentSocket);
-    AnyFunction mc = AnyFunction::fromDynamicFunction(boost::bind(&forwardEvent, _1, _serviceId, _objectId, eventId, ms->parametersSignature(), _currentSocket, asHostWeakPtr(), signature));
+    AnyFunction mc = AnyFunction::fromDynamicFunction(boost::bind(&forwardEvent, _1, _serviceId, _objectId, eventId, ms->parametersSignature(), _currentSocket, asHostWeakPtr(), signature,
+                                                                  _object.metaObject().memberPriority(eventId)));
     qi::Future<SignalLink> linking = _object.connect(eventId, mc);
     auto& linkEntry = _links[_currentSocket][remoteSignalLinkId];
     linkEntry = RemoteSignalLink(linking, eventId);
@@ -260,6 +265,8 @@ namespace qi
                                  << ", size=" << msg.buffer().size();
 
       QI_ASSERT_TRUE(msg.object() == _objectId);
+      // The call runs, even if queued, with the context of the caller.
+      TraceContextScope traceScope(msg.traceContext());
       qi::AnyObject    obj;
       unsigned int     funcId;
       //choose between special function (on BoundObject) or normal calls
@@ -329,8 +336,19 @@ namespace qi
       // with its own sub-parts), it is simpler here to directly manipulate an
       // AnyReference and achieve exception-safety through a scoped, than using
       // an AnyValue.
+      // Decode the arguments straight into the types the method takes when
+      // they are known, so that calling it does not convert them again.
+      TypeInterface* parametersType = nullptr;
+      if (!(msg.flags() & Message::TypeFlag_DynamicPayload))
+      {
+        GenericObject* go = obj.asGenericObject();
+        parametersType = go->type->parametersType(go->value, funcId);
+        if (parametersType && hasReturnType)
+          parametersType = makeTupleType({ parametersType, typeOf<std::string>() });
+      }
       bool mustDestroyRef = true;
-      ref = msg.value(sigparam, socket).release();
+      ref = (parametersType ? msg.value(parametersType, sigparam, socket)
+                            : msg.value(sigparam, socket)).release();
       auto guard = ka::scoped([&]() {
         if (mustDestroyRef)
         {
@@ -401,7 +419,8 @@ namespace qi
 
         fut.connect(boost::bind<void>
                     (&BoundObject::serverResultAdapter, _1, retSig, _gethost(), socket, msg.address(), sig,
-                     CancelableKitWeak(_cancelables), cancelRequested));
+                     CancelableKitWeak(_cancelables), cancelRequested,
+                     obj.metaObject().memberPriority(funcId)));
       }
         break;
       case Message::Type_Post: {
@@ -670,7 +689,8 @@ namespace qi
                                             MessageSocketPtr socket,
                                             const qi::MessageAddress& replyaddr,
                                             const Signature& forcedReturnSignature,
-                                            CancelableKitWeak kit)
+                                            CancelableKitWeak kit,
+                                            MemberPriority priority)
   {
     QI_ASSERT_TRUE(val.isValid());
     _removeCachedFuture(kit, socket, replyaddr.messageId);
@@ -720,6 +740,7 @@ namespace qi
       ret.setType(qi::Message::Type_Error);
       ret.setError("Unknown error caught while forwarding the answer");
     }
+    ret.setPriority(priority);
     if (!socket->send(std::move(ret)))
     {
       // TODO: if `convertAndSetValue` transfers ownership of `val` in the object host,
@@ -737,7 +758,8 @@ namespace qi
                                         const qi::MessageAddress& replyaddr,
                                         const Signature& forcedReturnSignature,
                                         CancelableKitWeak kit,
-                                        AtomicIntPtr cancelRequested)
+                                        AtomicIntPtr cancelRequested,
+                                        MemberPriority priority)
   {
     if(!socket->isConnected())
     {
@@ -760,7 +782,8 @@ namespace qi
         if (ao)
         {
           boost::function<void()> cb = boost::bind(&BoundObject::serverResultAdapterNext, val, targetSignature,
-                                                   host, socket, replyaddr, forcedReturnSignature, kit);
+                                                   host, socket, replyaddr, forcedReturnSignature, kit,
+                                                   priority);
           if (ao->call<bool>("isValid"))
           {
             ao->call<void>("_connect", cb);
@@ -809,6 +832,7 @@ namespace qi
       }
     }
     _removeCachedFuture(kit, socket, replyaddr.messageId);
+    ret.setPriority(priority);
     if (!socket->send(std::move(ret)))
     {
       // TODO: Check if `val` must be destroyed here. Take into account the potential
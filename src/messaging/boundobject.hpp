@@ -196,12 +196,14 @@ namespace qi
     static void serverResultAdapterNext(AnyReference val, Signature targetSignature,
                                         boost::weak_ptr<ObjectHost> host,
                                  MessageSocketPtr sock, const MessageAddress& replyAddr,
-                                 const Signature& forcedReturnSignature, CancelableKitWeak kit);
+                                 const Signature& forcedReturnSignature, CancelableKitWeak kit,
+                                 MemberPriority priority = MemberPriority::Default);
     static void serverResultAdapter(Future<AnyReference> future, const Signature& targetSignature,
                                     boost::weak_ptr<ObjectHost> host,
                                     MessageSocketPtr sock, const MessageAddress& replyAddr,
                                     const Signature& forcedReturnSignature, CancelableKitWeak kit,
-                                    AtomicIntPtr cancelRequested = AtomicIntPtr());
+                                    AtomicIntPtr cancelRequested = AtomicIntPtr(),
+                                    MemberPriority priority = MemberPriority::Default);
 
     // @returns The number of removed connections.
     std::size_t removeConnections(const MessageSocketPtr& socket) noexcept;
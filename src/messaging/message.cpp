@@ -17,14 +17,54 @@
 #include <qi/types.hpp>
 #include <qi/buffer.hpp>
 #include <qi/binarycodec.hpp>
+#include <qi/metrics.hpp>
 
 #include "boundobject.hpp"
+#include "messagesocket.hpp"
 #include "remoteobject_p.hpp"
 
 qiLogCategory("qimessaging.message");
 
 namespace qi
 {
+  namespace
+  {
+    metrics::Histogram& encodeDurationMetric()
+    {
+      static auto& histogram = metrics::histogram("qi_message_encode_duration_seconds",
+                                                  "Time spent serializing message payloads.");
+      return histogram;
+    }
+
+    metrics::Histogram& decodeDurationMetric()
+    {
+      static auto& histogram = metrics::histogram("qi_message_decode_duration_seconds",
+                                                  "Time spent deserializing message payloads.");
+      return histogram;
+    }
+
+    // Counts the time elapsed until its destruction in a histogram, if the
+    // metrics are enabled.
+    class MeasureDuration
+    {
+    public:
+      explicit MeasureDuration(metrics::Histogram& (*histogram)())
+        : _histogram(metrics::isEnabled() ? &histogram() : nullptr)
+        , _start(_histogram ? SteadyClock::now() : SteadyClockTimePoint{})
+      {}
+
+      ~MeasureDuration()
+      {
+        if (_histogram)
+          _histogram->push(SteadyClock::now() - _start);
+      }
+
+    private:
+      metrics::Histogram* _histogram;
+      SteadyClockTimePoint _start;
+    };
+  }
+
   const qi::uint32_t Message::Header::magicCookie = 0x42adde42;
 
   qi::uint32_t Message::Header::newMessageId()
@@ -281,6 +321,45 @@ namespace qi
     }
   }
 
+  void Message::setTraceContext(const TraceContext& context)
+  {
+    QI_ASSERT(_buffer.size() == 0 && "the trace context must be set before the values");
+    const qi::uint64_t ids[] = { context.traceId, context.spanId };
+    _buffer.write(ids, sizeof(ids));
+    _header.size = static_cast<qi::uint32_t>(_buffer.totalSize());
+    addFlags(TypeFlag_TraceContext);
+  }
+
+  void Message::setCurrentTraceContext(const MessageSocketPtr& socket)
+  {
+    if (!socket || !socket->sharedCapability<bool>(capabilityname::traceContext, false))
+      return;
+    // Calls out of any trace stay untraced: a traced object starts the trace
+    // of its calls itself.
+    const auto context = currentTraceContext();
+    if (context.isValid())
+      setTraceContext(context);
+  }
+
+  TraceContext Message::traceContext() const
+  {
+    TraceContext context;
+    if (!(flags() & TypeFlag_TraceContext) || _buffer.size() < traceContextSize)
+      return context;
+    qi::uint64_t ids[2];
+    std::memcpy(ids, _buffer.data(), sizeof(ids));
+    context.traceId = ids[0];
+    context.spanId = ids[1];
+    return context;
+  }
+
+  // The payload values follow the eventual trace context.
+  static void skipTraceContext(qi::BufferReader& br, const Message& msg)
+  {
+    if ((msg.flags() & Message::TypeFlag_TraceContext) && !br.seek(Message::traceContextSize))
+      throw std::runtime_error("Message payload is too short for its trace context");
+  }
+
   AnyValue Message::value(const qi::Signature& signature,
                               const qi::MessageSocketPtr& socket) const
   {
@@ -289,7 +368,9 @@ namespace qi
       qiLogError() <<"fromBuffer: unknown type " << signature.toString();
       throw std::runtime_error("Could not construct type for " + signature.toString());
     }
+    MeasureDuration measure(&decodeDurationMetric);
     qi::BufferReader br(_buffer);
+    skipTraceContext(br, *this);
     AnyReference res(type);
     return AnyValue(
       decodeBinary(&br, res, boost::bind(deserializeObject, _1, socket), socket),
@@ -298,6 +379,28 @@ namespace qi
     );
   }
 
+  AnyValue Message::value(TypeInterface* type,
+                          const qi::Signature& signature,
+                          const qi::MessageSocketPtr& socket) const
+  {
+    MeasureDuration measure(&decodeDurationMetric);
+    qi::BufferReader br(_buffer);
+    skipTraceContext(br, *this);
+    AnyValue res(AnyReference(type), false, true);
+    decodeBinary(&br, res.asReference(), signature, boost::bind(deserializeObject, _1, socket), socket);
+    return res;
+  }
+
+  void Message::encodeBinary(const qi::AutoAnyReference& ref,
+                             SerializeObjectCallback onObject,
+                             MessageSocketPtr socket)
+  {
+    MeasureDuration measure(&encodeDurationMetric);
+    auto updateHeaderSize =
+        ka::scoped([&] { _header.size = static_cast<qi::uint32_t>(_buffer.totalSize()); });
+    qi::encodeBinary(&_buffer, ref, onObject, socket);
+  }
+
   void Message::setValue(const AutoAnyReference& value,
                          const Signature& sig,
                          boost::weak_ptr<ObjectHost> context,
@@ -11,10 +11,12 @@
 #include <qi/api.hpp>
 #include <qi/anyvalue.hpp>
 #include <qi/anyobject.hpp>
+#include <qi/type/metaobject.hpp>
 #include <qi/buffer.hpp>
 #include <qi/binarycodec.hpp>
 #include <qi/anyfunction.hpp>
 #include <qi/types.hpp>
+#include <qi/tracecontext.hpp>
 #include <ka/macroregular.hpp>
 #include <qi/assert.hpp>
 #include <qi/messaging/messagesocket_fwd.hpp>
@@ -129,6 +131,12 @@ namespace qi {
      * NOT IMPLEMENTED
      */
     static const unsigned int TypeFlag_ReturnType = 2;
+    /* If flag is set, the payload starts with the TraceContext the message
+     * was sent from: its trace id and span id, as two uint64.
+     * Only set if the remote end has the TraceContext capability.
+     */
+    static const unsigned int TypeFlag_TraceContext = 4;
+    static const std::size_t traceContextSize = 2 * sizeof(qi::uint64_t);
 
     struct Header
     {
@@ -302,9 +310,25 @@ namespace qi {
       setValue(AnyReference::from(v), "m");
     }
 
+    /// Write the trace context prefix of the payload.
+    /// Must be called before any value is set.
+    QI_API void setTraceContext(const TraceContext& context);
+
+    /// Write the trace context of the calling thread, if it has one and the
+    /// remote end supports it.
+    QI_API void setCurrentTraceContext(const MessageSocketPtr& socket);
+
+    /// @return The context the message was sent from, or an invalid one if
+    /// it carries none. Its parent span id is not transmitted.
+    QI_API TraceContext traceContext() const;
+
     ///@return signature, set by setParameters() or setSignature()
     QI_API AnyValue value(const Signature &signature, const qi::MessageSocketPtr &socket) const;
 
+    /// Decode the payload, encoded with the signature, directly into a value
+    /// of the given type, without an intermediate value to convert.
+    QI_API AnyValue value(TypeInterface* type, const Signature &signature, const qi::MessageSocketPtr &socket) const;
+
     QI_API void setValue(const AutoAnyReference& value,
                   const Signature& signature,
                   boost::weak_ptr<ObjectHost> context = {},
@@ -329,6 +353,17 @@ namespace qi {
 
     const Header& header() const {return _header;}
 
+    /// The priority is local to the sending process: it is not part of the header.
+    void setPriority(MemberPriority priority)
+    {
+      _priority = priority;
+    }
+
+    MemberPriority priority() const
+    {
+      return _priority;
+    }
+
     friend KA_GENERATE_REGULAR_OP_EQUAL_3(Message, _header, signature, _buffer)
     friend KA_GENERATE_REGULAR_OP_DIFFERENT(Message)
 
@@ -336,15 +371,11 @@ namespace qi {
     Buffer _buffer;
     std::string signature;
     Header _header;
+    MemberPriority _priority = MemberPriority::Default;
 
     void encodeBinary(const qi::AutoAnyReference& ref,
                       SerializeObjectCallback onObject,
-                      MessageSocketPtr socket)
-    {
-      auto updateHeaderSize =
-          ka::scoped([&] { _header.size = static_cast<qi::uint32_t>(_buffer.totalSize()); });
-      qi::encodeBinary(&_buffer, ref, onObject, socket);
-    }
+                      MessageSocketPtr socket);
   };
 
   inline std::ostream& operator<<(std::ostream& os, const qi::MessageAddress &address)
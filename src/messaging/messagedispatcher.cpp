@@ -2,6 +2,7 @@
 **  Copyright (C) 2012 Aldebaran Robotics
 **  See COPYING for the license
 */
+#include <algorithm>
 #include "messagedispatcher.hpp"
 #include <ka/errorhandling.hpp>
 
@@ -39,30 +40,93 @@ MessageDispatcher::MessageDispatcher(ExecutionContext& execContext)
 Future<bool> MessageDispatcher::dispatch(Message msg)
 {
   QI_LOG_DEBUG_MSGDISPATCHER() << "Posting a message " << msg.address() << " for dispatch.";
-  // Avoid copying the message in the asynchronous callback by using a shared
-  // reference.
-  const auto sharedMsg = std::make_shared<Message>(std::move(msg));
-  return _execContext.async([=] {
-    const auto& msg = *sharedMsg;
-    const auto handlers = find(_state->recipients, RecipientId{ msg.service(), msg.object() })
-                            .value_or(MessageHandlerList{});
-    QI_LOG_DEBUG_MSGDISPATCHER() << "Dispatching a message " << msg.address() << " to "
-                                 << handlers.size() << " handlers.";
-    return tryDispatch(handlers, msg);
-  });
+  Promise<bool> promise;
+  bool mustPost = false;
+  {
+    auto pending = _pending.synchronize();
+    pending->messages.push_back(PendingMessage{ std::move(msg), promise });
+    mustPost = !pending->posted;
+    pending->posted = true;
+  }
+  if (mustPost)
+    _execContext.post([=] { dispatchPending(); });
+  return promise.future();
+}
+
+void MessageDispatcher::dispatchPending()
+{
+  std::vector<PendingMessage> batch;
+  {
+    auto pending = _pending.synchronize();
+    std::swap(batch, pending->messages);
+    pending->posted = false;
+  }
+  QI_LOG_DEBUG_MSGDISPATCHER() << "Dispatching a batch of " << batch.size() << " messages.";
+
+  static const MessageHandlerList noHandlers;
+  auto version = _recipientsVersion.load();
+  auto recipients = _state->recipients;
+  // The handlers of the recipient of the previous message, if it has not
+  // changed since.
+  const MessageHandlerList* handlers = nullptr;
+  RecipientId recipient{ 0, 0 };
+  for (auto& pendingMessage : batch)
+  {
+    const auto& msg = pendingMessage.message;
+    try
+    {
+      // A handler may have connected or disconnected handlers while
+      // dispatching the previous message.
+      const auto currentVersion = _recipientsVersion.load();
+      if (currentVersion != version)
+      {
+        version = currentVersion;
+        recipients = _state->recipients;
+        handlers = nullptr;
+      }
+      const RecipientId msgRecipient{ msg.service(), msg.object() };
+      if (!handlers || msgRecipient != recipient)
+      {
+        recipient = msgRecipient;
+        const auto it = recipients->find(recipient);
+        handlers = it == recipients->end() ? &noHandlers : it->second.get();
+      }
+      QI_LOG_DEBUG_MSGDISPATCHER() << "Dispatching a message " << msg.address() << " to "
+                                   << handlers->size() << " handlers.";
+      pendingMessage.promise.setValue(tryDispatch(*handlers, msg));
+    }
+    catch (const std::exception& ex)
+    {
+      pendingMessage.promise.setError(ex.what());
+    }
+    catch (...)
+    {
+      pendingMessage.promise.setError("Unknown error while dispatching a message");
+    }
+  }
 }
 
 SignalLink MessageDispatcher::messagePendingConnect(unsigned int serviceId,
                                                     unsigned int objectId,
-                                                    MessageHandler fun) noexcept
+                                                    MessageHandler fun,
+                                                    UsageProbe isInUse) noexcept
 {
   auto state = _state.synchronize();
-  auto& handlers = state->recipients[RecipientId{ serviceId, objectId }];
+  auto recipients = std::make_shared<RecipientMessageHandlerMap>(*state->recipients);
+  auto& handlersPtr = (*recipients)[RecipientId{ serviceId, objectId }];
+  auto handlers = handlersPtr ? std::make_shared<MessageHandlerList>(*handlersPtr)
+                              : std::make_shared<MessageHandlerList>();
   const auto newSignalLinkId = state->nextSignalLink++;
   QI_LOG_DEBUG_MSGDISPATCHER() << "Connecting a handler (linkId=" << newSignalLinkId
                                << ") for message dispatch for service=" << serviceId
                                << ", object=" << objectId;
-  handlers.emplace(newSignalLinkId, std::move(fun));
+  handlers->emplace(newSignalLinkId, std::move(fun));
+  handlersPtr = std::move(handlers);
+  state->recipients = std::move(recipients);
+  ++state->handlerCount;
+  if (isInUse)
+    state->usageProbes.emplace(newSignalLinkId, std::move(isInUse));
+  ++_recipientsVersion;
   return newSignalLinkId;
 }
 
@@ -76,18 +140,44 @@ bool MessageDispatcher::messagePendingDisconnect(unsigned int serviceId,
     return true;
 
   auto state = _state.synchronize();
-  const auto it = state->recipients.find(RecipientId{ serviceId, objectId });
-  if (it == state->recipients.end())
+  const RecipientId recipient{ serviceId, objectId };
+  const auto it = state->recipients->find(recipient);
+  if (it == state->recipients->end() || it->second->count(linkId) == 0)
     return false;
 
   QI_LOG_DEBUG_MSGDISPATCHER()
     << "Disconnecting a handler (linkId=" << linkId
     << ") for message dispatch for service=" << serviceId << ", object=" << objectId;
-  auto& handlers = it->second;
-  const auto disconnectedCount = handlers.erase(linkId);
-  if (handlers.empty())
-    state->recipients.erase(it);
-  return disconnectedCount == 1;
+  auto recipients = std::make_shared<RecipientMessageHandlerMap>(*state->recipients);
+  if (it->second->size() == 1)
+    recipients->erase(recipient);
+  else
+  {
+    auto handlers = std::make_shared<MessageHandlerList>(*it->second);
+    handlers->erase(linkId);
+    (*recipients)[recipient] = std::move(handlers);
+  }
+  state->recipients = std::move(recipients);
+  --state->handlerCount;
+  state->usageProbes.erase(linkId);
+  ++_recipientsVersion;
+  return true;
+}
+
+bool MessageDispatcher::isInUse() const
+{
+  std::vector<UsageProbe> probes;
+  {
+    auto state = _state.synchronize();
+    if (state->handlerCount > state->usageProbes.size())
+      return true;
+    probes.reserve(state->usageProbes.size());
+    for (const auto& linkProbe : state->usageProbes)
+      probes.push_back(linkProbe.second);
+  }
+  return std::any_of(probes.begin(), probes.end(), [](const UsageProbe& probe) {
+    return probe();
+  });
 }
 
 bool MessageDispatcher::tryDispatch(const MessageHandlerList& handlers, const Message& msg)
@@ -7,6 +7,10 @@
 #ifndef _SRC_MESSAGEDISPATCHER_HPP_
 #define _SRC_MESSAGEDISPATCHER_HPP_
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <qi/anyobject.hpp>
 
 #include <boost/thread/synchronized_value.hpp>
@@ -26,20 +30,32 @@ namespace qi {
    * This class generate an error message for all pending message that have timed out.
    * at the moment it only generate message if the socket have been disconnected.
    *
+   * Messages are handed over to the execution context in batches: a message
+   * dispatched while others wait to be dispatched joins them, instead of
+   * being posted on its own. A batch is dispatched with a snapshot of the
+   * handlers, which is looked up once for consecutive messages to the same
+   * recipient.
+   *
    * TODO: handle timeout on request taking too long to complete
    */
-  class MessageDispatcher
+  class QI_API_TESTONLY MessageDispatcher
   {
   public:
     using MessageHandler = std::function<DispatchStatus (const Message&)>;
+    /// Tells whether the owner of a handler currently needs the socket, for
+    /// instance because it waits for replies or signals through it.
+    using UsageProbe = std::function<bool ()>;
 
     MessageDispatcher(ExecutionContext& execContext);
 
     Future<bool> dispatch(Message msg);
 
+    /// A handler connected without a usage probe is considered in use for as
+    /// long as it is connected.
     qi::SignalLink messagePendingConnect(unsigned int serviceId,
                                          unsigned int objectId,
-                                         MessageHandler fun) noexcept;
+                                         MessageHandler fun,
+                                         UsageProbe isInUse = {}) noexcept;
 
     /// @invariant
     ///   `d.messagePendingDisconnect(sid, oid, d.messagePendingConnect(sid, oid, _)) == true`
@@ -47,6 +63,10 @@ namespace qi {
                                   unsigned int objectId,
                                   qi::SignalLink linkId) noexcept;
 
+    /// Whether some connected handler is in use, according to its usage probe.
+    /// The probes are called without holding any lock of the dispatcher.
+    bool isInUse() const;
+
   public:
     struct RecipientId
     {
@@ -58,18 +78,46 @@ namespace qi {
     ExecutionContext& _execContext;
 
     using MessageHandlerList = boost::container::flat_map<SignalLink, MessageHandler>;
-    using RecipientMessageHandlerMap = boost::container::flat_map<RecipientId, MessageHandlerList>;
-
-    // Mutable state of the object.
+    using MessageHandlerListPtr = std::shared_ptr<const MessageHandlerList>;
+    using RecipientMessageHandlerMap = boost::container::flat_map<RecipientId, MessageHandlerListPtr>;
+    using RecipientMessageHandlerMapPtr = std::shared_ptr<const RecipientMessageHandlerMap>;
+
+    // Mutable state of the object. The handlers are never modified in place,
+    // but replaced by a modified copy, so that snapshots of them can be read
+    // without locking. Only the handlers of the modified recipient are copied,
+    // those of the others being shared by the copies of the map.
     struct State
     {
-      RecipientMessageHandlerMap recipients;
+      RecipientMessageHandlerMapPtr recipients = std::make_shared<const RecipientMessageHandlerMap>();
       SignalLink nextSignalLink = 0;
+      // Number of connected handlers, and the usage probes of those that have one.
+      std::size_t handlerCount = 0;
+      boost::container::flat_map<SignalLink, UsageProbe> usageProbes;
     };
     using SyncState =  boost::synchronized_value<State>;
     SyncState _state;
+    // Incremented each time the handlers are replaced, for the snapshots to
+    // be refreshed.
+    std::atomic<unsigned int> _recipientsVersion{0};
 
   private:
+    struct PendingMessage
+    {
+      Message message;
+      Promise<bool> promise;
+    };
+
+    // Messages waiting to be dispatched, and whether a task dispatching them
+    // is posted.
+    struct Pending
+    {
+      std::vector<PendingMessage> messages;
+      bool posted = false;
+    };
+    boost::synchronized_value<Pending> _pending;
+
+    void dispatchPending();
+
     static bool tryDispatch(const MessageHandlerList& handlers, const Message& msg);
   };
 }
@@ -1,4 +1,5 @@
 #include <qi/log.hpp>
+#include <qi/metrics.hpp>
 #include <src/messaging/sock/option.hpp>
 #include "messagesocket.hpp"
 #include "tcpmessagesocket.hpp"
@@ -23,6 +24,78 @@ namespace qi
     return status() == qi::MessageSocket::Status::Connected;
   }
 
+  namespace
+  {
+    std::uint64_t messageSize(const Message::Header& header)
+    {
+      return sizeof(Message::Header) + header.size;
+    }
+
+    // Counters labelled by message type, with one label for all the unknown types.
+    class TypeCounters
+    {
+    public:
+      TypeCounters(const std::string& name, const std::string& help)
+      {
+        for (unsigned int type = 0; type < typeCount; ++type)
+          _counters[type] = &metrics::counter(name, help,
+              { { "type", Message::typeToString(static_cast<Message::Type>(type)) } });
+      }
+
+      metrics::Counter& operator[](Message::Type type)
+      {
+        const auto index = static_cast<unsigned int>(type);
+        return *_counters[index < typeCount ? index : typeCount - 1];
+      }
+
+    private:
+      // The last one is for the unknown types.
+      static const unsigned int typeCount = Message::Type_Canceled + 2;
+      metrics::Counter* _counters[typeCount];
+    };
+
+    void countMessage(bool sent, const Message::Header& header)
+    {
+      static TypeCounters messagesSent("qi_messages_sent_total", "Messages sent.");
+      static TypeCounters messagesReceived("qi_messages_received_total", "Messages received.");
+      static TypeCounters bytesSent("qi_messages_sent_bytes_total", "Bytes of the messages sent.");
+      static TypeCounters bytesReceived("qi_messages_received_bytes_total",
+                                        "Bytes of the messages received.");
+      const auto type = header.messageType();
+      (sent ? messagesSent : messagesReceived)[type].add();
+      (sent ? bytesSent : bytesReceived)[type].add(messageSize(header));
+    }
+  }
+
+  MessageSocket::Statistics MessageSocket::statistics() const
+  {
+    Statistics stats;
+    stats.lastActivity = SteadyClock::time_point(SteadyClock::duration(_lastActivity.load()));
+    stats.messagesSent = _messagesSent.load();
+    stats.messagesReceived = _messagesReceived.load();
+    stats.bytesSent = _bytesSent.load();
+    stats.bytesReceived = _bytesReceived.load();
+    return stats;
+  }
+
+  void MessageSocket::recordSent(const Message::Header& header)
+  {
+    _lastActivity.store(SteadyClock::now().time_since_epoch().count());
+    ++_messagesSent;
+    _bytesSent += messageSize(header);
+    if (metrics::isEnabled())
+      countMessage(true, header);
+  }
+
+  void MessageSocket::recordReceived(const Message::Header& header)
+  {
+    _lastActivity.store(SteadyClock::now().time_since_epoch().count());
+    ++_messagesReceived;
+    _bytesReceived += messageSize(header);
+    if (metrics::isEnabled())
+      countMessage(false, header);
+  }
+
   MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop)
   {
     return makeTcpMessageSocket(protocol, eventLoop);
@@ -13,9 +13,14 @@
 # include <qi/signal.hpp>
 # include <qi/binarycodec.hpp>
 # include <qi/messaging/messagesocket_fwd.hpp>
+# include <qi/clock.hpp>
+# include <atomic>
+# include <cstdint>
 # include <string>
 # include "messagedispatcher.hpp"
 # include "streamcontext.hpp"
+# include "sock/sendqueue.hpp"
+# include "sock/option.hpp"
 
 namespace qi {
   namespace detail {
@@ -54,9 +59,20 @@ namespace qi
       Event_Message = 1,
     };
 
+    /// Traffic counters of a socket, as sent and received by the socket implementation.
+    struct Statistics
+    {
+      SteadyClock::time_point lastActivity;
+      std::uint64_t messagesSent = 0u;
+      std::uint64_t messagesReceived = 0u;
+      std::uint64_t bytesSent = 0u;
+      std::uint64_t bytesReceived = 0u;
+    };
+
     explicit MessageSocket(qi::EventLoop* eventLoop = qi::getNetworkEventLoop())
       : _eventLoop(eventLoop)
       , _dispatcher{ _signalsStrand }
+      , _lastActivity(SteadyClock::now().time_since_epoch().count())
       // connected is the only signal to be synchronous, because it will always be the first signal
       // emitted (so no other asynchronous signal emission will overlap with it) and it's not
       // emitted from the network event loop worker
@@ -73,8 +89,27 @@ namespace qi
     virtual qi::FutureSync<void> connect(const qi::Url &url) = 0;
     virtual qi::FutureSync<void> disconnect()                = 0;
 
+    /// Returns false if the message could not be enqueued for sending, either because the
+    /// socket is not connected or because of the send queue limits.
     virtual bool send(qi::Message msg) = 0;
 
+    using SendQueueLimits = sock::SendQueueLimits;
+    using SendQueueStatistics = sock::SendQueueStatistics;
+
+    /// Limits of the queue of messages waiting to be sent. They apply to the current connection
+    /// and to the following ones.
+    virtual void setSendQueueLimits(const SendQueueLimits& limits) = 0;
+    virtual SendQueueLimits sendQueueLimits() const = 0;
+
+    /// Depth of the send queue of the current connection. Empty if the socket is not connected.
+    virtual SendQueueStatistics sendQueueStatistics() const = 0;
+
+    using SocketBufferSizes = sock::SocketBufferSizes;
+
+    /// Sizes of the kernel buffers of the current connection. Zero if the socket is not
+    /// connected, or if the implementation has no such buffers.
+    virtual SocketBufferSizes socketBufferSizes() const { return {}; }
+
     /// Start reading if is not already reading.
     /// Must be called once if the socket is obtained through TransportServer::newConnection()
     virtual bool  ensureReading() = 0;
@@ -86,11 +121,17 @@ namespace qi
 
     bool isConnected() const;
 
+    /// Snapshot of the traffic counters. The values are read independently from each other and
+    /// might therefore be slightly out of sync under concurrent traffic.
+    Statistics statistics() const;
+
     qi::SignalLink messagePendingConnect(unsigned int serviceId,
                                          unsigned int objectId,
-                                         MessageDispatcher::MessageHandler fun) noexcept
+                                         MessageDispatcher::MessageHandler fun,
+                                         MessageDispatcher::UsageProbe isInUse = {}) noexcept
     {
-      return _dispatcher.messagePendingConnect(serviceId, objectId, std::move(fun));
+      return _dispatcher.messagePendingConnect(serviceId, objectId, std::move(fun),
+                                               std::move(isInUse));
     }
 
     void messagePendingDisconnect(unsigned int serviceId,
@@ -100,11 +141,30 @@ namespace qi
       _dispatcher.messagePendingDisconnect(serviceId, objectId, linkId);
     }
 
+    /// Whether some object bound to the socket, or some remote object waiting for replies or
+    /// signals through it, still needs it.
+    bool isInUse() const
+    {
+      return _dispatcher.isInUse();
+    }
+
   protected:
+    /// Must be called by implementations each time a message is successfully enqueued for sending
+    /// or received.
+    void recordSent(const Message::Header& header);
+    void recordReceived(const Message::Header& header);
+
     qi::EventLoop* _eventLoop;
     Strand _signalsStrand; // Must be declared before the MessageDispatcher and the signals.
     qi::MessageDispatcher _dispatcher;
 
+  private:
+    std::atomic<SteadyClock::rep> _lastActivity;
+    std::atomic<std::uint64_t> _messagesSent{0u};
+    std::atomic<std::uint64_t> _messagesReceived{0u};
+    std::atomic<std::uint64_t> _bytesSent{0u};
+    std::atomic<std::uint64_t> _bytesReceived{0u};
+
   public:
     // C4251
     qi::Signal<>                   connected;
@@ -118,7 +178,7 @@ namespace qi
   };
 
   using MessageSocketWeakPtr = boost::weak_ptr<MessageSocket>;
-  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop = getNetworkEventLoop());
+  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop = nextNetworkEventLoop());
 
   /// A connection to the message dispatch of a socket that acts as a RAII helper to connect and
   /// disconnect the object as a message handler. Instances do not own their underlying socket.
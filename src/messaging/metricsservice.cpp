@@ -0,0 +1,64 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <boost/make_shared.hpp>
+
+#include <qi/messaging/metricsservice.hpp>
+#include <qi/type/objecttypebuilder.hpp>
+
+namespace qi
+{
+  namespace metrics
+  {
+    namespace
+    {
+      class MetricsService
+      {
+      public:
+        std::vector<MetricSample> collect()
+        {
+          return metrics::collect();
+        }
+
+        std::string prometheusText()
+        {
+          return metrics::prometheusText();
+        }
+
+        bool isEnabled()
+        {
+          return metrics::isEnabled();
+        }
+
+        void setEnabled(bool enabled)
+        {
+          metrics::setEnabled(enabled);
+        }
+      };
+
+      // Not registered at static initialization: the types of the methods,
+      // such as bool, may not be registered yet.
+      void registerMetricsService()
+      {
+        static const bool registered QI_ATTR_UNUSED = [] {
+          qi::ObjectTypeBuilder<MetricsService> builder;
+          builder.setThreadingModel(qi::ObjectThreadingModel_MultiThread);
+          builder.advertise("collect", &MetricsService::collect);
+          builder.advertise("prometheusText", &MetricsService::prometheusText);
+          builder.advertise("isEnabled", &MetricsService::isEnabled);
+          builder.advertise("setEnabled", &MetricsService::setEnabled);
+          builder.registerType();
+          return true;
+        }();
+      }
+    }
+
+    qi::AnyObject makeService()
+    {
+      registerMetricsService();
+      return qi::AnyObject(boost::make_shared<MetricsService>());
+    }
+  }
+}
@@ -3,6 +3,8 @@
 **  See COPYING for the license
 */
 
+#include <algorithm>
+
 // Disable "'this': used in base member initializer list"
 #include <ka/macro.hpp>
 KA_WARNING_PUSH()
@@ -94,6 +96,10 @@ namespace qi {
           qiLogVerbose() << "Could not handle message " << msg.address()
                          << " because the remote object has already been destroyed.";
           return DispatchStatus::MessageHandlingFailure;
+        },
+        [=] {
+          auto self = weakPtr.lock();
+          return self && self->isInUse();
         });
       _linkDisconnected = socket->disconnected.connect(
         track([=](const std::string& reason) { onSocketDisconnected(reason); },
@@ -101,6 +107,23 @@ namespace qi {
     }
   }
 
+  bool RemoteObject::isInUse()
+  {
+    if (!_promises->empty())
+      return true;
+    boost::recursive_mutex::scoped_lock lock(_localToRemoteSignalLinkMutex);
+    return std::any_of(_localToRemoteSignalLink.begin(), _localToRemoteSignalLink.end(),
+                       [](const LocalToRemoteSignalLinkMap::value_type& eventLinks) {
+                         return !eventLinks.second.localSignalLink.empty();
+                       });
+  }
+
+  bool RemoteObject::isConnected() const
+  {
+    MessageSocketPtr sock = *_socket;
+    return sock && sock->isConnected();
+  }
+
   //should be done in the object thread
   void RemoteObject::onSocketDisconnected(std::string error)
   {
@@ -144,6 +167,8 @@ namespace qi {
     QI_ASSERT_TRUE(msg.object() == _object);
 
     if (msg.type() == qi::Message::Type_Event) {
+      // Subscribers run with the context of the emitter.
+      TraceContextScope traceScope(msg.traceContext());
       SignalBase* sb = signal(msg.event());
       if (sb)
       {
@@ -316,6 +341,7 @@ namespace qi {
       (*syncPromises)[msg.id()] = out;
     }
     qi::Signature funcSig = mm->parametersSignature();
+    msg.setCurrentTraceContext(sock);
     try {
       msg.setValues(in, funcSig, weak_from_this(), sock);
     }
@@ -411,6 +437,7 @@ namespace qi {
       funcSig = ms->parametersSignature();
     }
     MessageSocketPtr sock = *_socket;
+    msg.setCurrentTraceContext(sock);
     try {
       msg.setValues(in, funcSig, weak_from_this(), sock);
     }
@@ -73,6 +73,10 @@ namespace qi {
     void close(const std::string& reason, bool fromSignal = false);
     unsigned int service() const { return _service; }
     unsigned int object() const { return _object; }
+    /// True if the object has a socket and it is connected.
+    bool isConnected() const;
+    /// True if the object waits for replies to its calls or for signals it is connected to.
+    bool isInUse();
 
     void metaPost(AnyObject context,
                   unsigned int event,
@@ -102,6 +102,7 @@ namespace qi {
       boost::mutex::scoped_lock lock(_mutex);
       stateData = std::move(_stateData);
     }
+    clearServiceInfoCache();
 
     Future<void> fut = futurize(); // if there was nothing asynchronous to do, return a future with
                                    // a value already set
@@ -340,6 +341,7 @@ namespace qi {
       qiLogVerbose() << s;
       return qi::makeFutureError<void>(s);
     }
+    clearServiceInfoCache();
     qi::Promise<void> promise;
     qi::Future<void> connecting;
     {
@@ -377,6 +379,7 @@ namespace qi {
 
   void ServiceDirectoryClient::setServiceDirectory(AnyObject serviceDirectoryService)
   {
+    clearServiceInfoCache();
     _object = serviceDirectoryService;
     _stateData.localSd = true;
 
@@ -423,11 +426,13 @@ namespace qi {
 
   void ServiceDirectoryClient::onServiceRemoved(unsigned int idx, const std::string &name) {
     qiLogVerbose() << "ServiceDirectoryClient: Service Removed #" << idx << ": " << name;
+    invalidateServiceInfo(name);
     serviceRemoved(idx, name);
   }
 
   void ServiceDirectoryClient::onServiceAdded(unsigned int idx, const std::string &name) {
     qiLogVerbose() << "ServiceDirectoryClient: Service Added #" << idx << ": " << name;
+    invalidateServiceInfo(name);
     serviceAdded(idx, name);
   }
 
@@ -455,12 +460,78 @@ namespace qi {
     return _stateData.localSd;
   }
 
+  void ServiceDirectoryClient::invalidateServiceInfo(const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+    ++_serviceInfoCacheGeneration;
+    _serviceInfoCache.erase(name);
+    _pendingServiceInfos.erase(name);
+  }
+
+  void ServiceDirectoryClient::clearServiceInfoCache()
+  {
+    boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+    ++_serviceInfoCacheGeneration;
+    _serviceInfoCache.clear();
+    _pendingServiceInfos.clear();
+  }
+
+  void ServiceDirectoryClient::onServiceInfoReceived(const std::string& name,
+                                                     unsigned int requestId,
+                                                     qi::Future<ServiceInfo> future)
+  {
+    boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+    auto it = _pendingServiceInfos.find(name);
+    // The entry was invalidated while the request was in progress, the answer
+    // might already be outdated.
+    if (it == _pendingServiceInfos.end() || it->second.requestId != requestId)
+      return;
+    _pendingServiceInfos.erase(it);
+    if (future.hasValue())
+      _serviceInfoCache[name] = future.value();
+  }
+
   qi::Future< std::vector<ServiceInfo> > ServiceDirectoryClient::services() {
-    return _object.async< std::vector<ServiceInfo> >("services");
+    unsigned int generation = 0;
+    {
+      boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+      generation = _serviceInfoCacheGeneration;
+    }
+    auto fut = _object.async< std::vector<ServiceInfo> >("services");
+    // The whole table is known at once: fill the cache with it, unless an
+    // event invalidated some entries in the meantime.
+    fut.connect(track([=](qi::Future< std::vector<ServiceInfo> > f) {
+      if (!f.hasValue())
+        return;
+      boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+      if (generation != _serviceInfoCacheGeneration)
+        return;
+      for (const auto& info : f.value())
+        _serviceInfoCache[info.name()] = info;
+    }, this));
+    return fut;
   }
 
   qi::Future<ServiceInfo>              ServiceDirectoryClient::service(const std::string &name) {
-    return _object.async< ServiceInfo >("service", name);
+    unsigned int requestId = 0;
+    qi::Future<ServiceInfo> fut;
+    {
+      boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+      auto cached = _serviceInfoCache.find(name);
+      if (cached != _serviceInfoCache.end())
+        return qi::Future<ServiceInfo>(cached->second);
+
+      auto pending = _pendingServiceInfos.find(name);
+      if (pending != _pendingServiceInfos.end())
+        return pending->second.future;
+
+      requestId = ++_serviceInfoRequestId;
+      fut = _object.async< ServiceInfo >("service", name);
+      _pendingServiceInfos[name] = PendingServiceInfo{ requestId, fut };
+    }
+    fut.connect(track(boost::bind(&ServiceDirectoryClient::onServiceInfoReceived,
+                                  this, name, requestId, _1), this));
+    return fut;
   }
 
   qi::Future<unsigned int>             ServiceDirectoryClient::registerService(const ServiceInfo &svcinfo) {
@@ -468,6 +539,18 @@ namespace qi {
   }
 
   qi::Future<void>                     ServiceDirectoryClient::unregisterService(const unsigned int &idx) {
+    {
+      // Do not wait for the serviceRemoved event to forget about our own service.
+      boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+      ++_serviceInfoCacheGeneration;
+      for (auto it = _serviceInfoCache.begin(); it != _serviceInfoCache.end();)
+      {
+        if (it->second.serviceId() == idx)
+          it = _serviceInfoCache.erase(it);
+        else
+          ++it;
+      }
+    }
     return _object.async<void>("unregisterService", idx);
   }
 
@@ -476,6 +559,20 @@ namespace qi {
   }
 
   qi::Future<void>                     ServiceDirectoryClient::updateServiceInfo(const ServiceInfo &svcinfo) {
+    {
+      // The service directory does not emit any event when endpoints change. It
+      // updates the endpoints of all the services of the same session.
+      boost::mutex::scoped_lock lock(_serviceInfoCacheMutex);
+      ++_serviceInfoCacheGeneration;
+      _pendingServiceInfos.erase(svcinfo.name());
+      for (auto it = _serviceInfoCache.begin(); it != _serviceInfoCache.end();)
+      {
+        if (it->first == svcinfo.name() || it->second.sessionId() == svcinfo.sessionId())
+          it = _serviceInfoCache.erase(it);
+        else
+          ++it;
+      }
+    }
     return _object.async<void>("updateServiceInfo", svcinfo);
   }
 
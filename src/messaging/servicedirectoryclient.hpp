@@ -7,6 +7,7 @@
 #ifndef _SRC_SERVICEDIRECTORYCLIENT_HPP_
 #define _SRC_SERVICEDIRECTORYCLIENT_HPP_
 
+#include <map>
 #include <vector>
 #include <string>
 #include <qi/signal.hpp>
@@ -48,6 +49,10 @@ namespace qi {
     /// if isLocal() only, return socket holding given service id
     qi::Future<qi::MessageSocketPtr>     _socketOfService(unsigned int serviceId);
 
+    /// Forget the cached information of a service, if any. The next call to
+    /// `service` for this name asks the service directory again.
+    void invalidateServiceInfo(const std::string& name);
+
     qi::Signal<>                                  connected;
     qi::Signal<std::string>                       disconnected;
     qi::Signal<unsigned int, std::string>         serviceAdded;
@@ -88,6 +93,11 @@ namespace qi {
 
     Future<void> closeImpl(const std::string& reason, bool sendSignalDisconnected);
 
+    void onServiceInfoReceived(const std::string& name,
+                               unsigned int requestId,
+                               qi::Future<ServiceInfo> future);
+    void clearServiceInfoCache();
+
   private:
     struct StateData
     {
@@ -110,6 +120,24 @@ namespace qi {
     ClientAuthenticatorFactoryPtr _authFactory;
     bool _enforceAuth;
     mutable boost::mutex _mutex;
+
+    // Local copy of the service directory table. Entries are added when a lookup
+    // succeeds and are dropped when the service directory notifies us that the
+    // service was added or removed, so that lookups of known services do not
+    // need any round trip to the service directory.
+    struct PendingServiceInfo
+    {
+      unsigned int requestId;
+      qi::Future<ServiceInfo> future;
+    };
+    std::map<std::string, ServiceInfo> _serviceInfoCache; // protected by _serviceInfoCacheMutex
+    // Lookups in progress, shared by concurrent callers asking for the same name.
+    std::map<std::string, PendingServiceInfo> _pendingServiceInfos; // protected by _serviceInfoCacheMutex
+    // Incremented each time the cache is invalidated, so that answers to requests
+    // sent before the invalidation are not cached.
+    unsigned int _serviceInfoCacheGeneration = 0; // protected by _serviceInfoCacheMutex
+    unsigned int _serviceInfoRequestId = 0; // protected by _serviceInfoCacheMutex
+    mutable boost::mutex _serviceInfoCacheMutex;
   };
 }
 
@@ -297,6 +297,8 @@ namespace qi {
 
       if (value.hasError())
       {
+        // The endpoints we got may be outdated, ask the service directory next time.
+        _sdClient->invalidateServiceInfo(sr->serviceInfo.name());
         setErrorAndRemoveRequest(sr->promise, value.error(), requestId);
         return;
       }
@@ -436,15 +438,27 @@ namespace qi {
     }
 
     //look for already registered remote objects
+    qi::AnyObject disconnectedObject;
     {
       boost::recursive_mutex::scoped_lock sl(_remoteObjectsMutex);
       RemoteObjectMap::iterator it = _remoteObjects.find(service);
       if (it != _remoteObjects.end())
       {
-        qiLogVerbose() << "Found service '" << service << "' in the registered remote objects.";
-        return qi::Future<qi::AnyObject>(it->second);
+        auto remoteObject = static_cast<RemoteObject*>(it->second.asGenericObject()->value);
+        if (remoteObject->isConnected())
+        {
+          qiLogVerbose() << "Found service '" << service << "' in the registered remote objects.";
+          return qi::Future<qi::AnyObject>(it->second);
+        }
+        // Its socket might have been closed by the sockets cache, reconnect to the service.
+        qiLogVerbose() << "Dropping disconnected remote object of service '" << service << "'.";
+        disconnectedObject = std::move(it->second);
+        _remoteObjects.erase(it);
       }
     }
+    // Closing the object notifies its pending calls and signals, do it without holding the lock.
+    if (disconnectedObject)
+      static_cast<RemoteObject*>(disconnectedObject.asGenericObject()->value)->close("Socket disconnected");
 
     qi::Future<qi::ServiceInfo> fut;
     ServiceRequest* rq = nullptr;
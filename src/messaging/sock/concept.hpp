@@ -119,6 +119,14 @@ namespace qi { namespace sock {
 ///     O option{b};
 /// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 ///
+/// ## NetSizeOption
+/// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+/// concept NetSizeOption(O) =
+///   With O option, the following is valid:
+///     int i = option.value();
+/// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+/// Socket option holding a size, such as the size of a kernel buffer.
+///
 /// ## NetLowestSocket
 /// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 /// concept NetLowestSocket(S, E, O) =
@@ -129,11 +137,13 @@ namespace qi { namespace sock {
 ///   && With S socket,
 ///           const S const_socket,
 ///           O noDelay,
+///           NetSizeOption sizeOptionLValue,
 ///           Endpoint<S> endpoint,
 ///           NetHandler handler,
 ///           ShutdownMode<S> shutdownMode,
 ///           E errorCodeLValue, the following writings are valid:
 ///        socket.set_option(noDelay)
+///     && const_socket.get_option(sizeOptionLValue)
 ///     && socket.async_connect(endpoint, handler)
 ///     && socket.shutdown(shutdownMode, errorCodeLValue)
 ///     && socket.cancel()
@@ -279,6 +289,8 @@ namespace qi { namespace sock {
 ///   && SslContext<N>: NetSslContext
 ///   && SslSocket<N>: NetSslSocket
 ///   && SocketOptionNoDelay<N>: NetOption
+///   && SocketOptionReceiveBufferSize<N>: NetSizeOption
+///   && SocketOptionSendBufferSize<N>: NetSizeOption
 ///   && AcceptOptionReuseAddress<N>: NetOption
 ///   && ErrorCode<N>: NetErrorCode
 ///   && IoService<N>: NetIoService
@@ -11,6 +11,7 @@
 #include <qi/url.hpp>
 #include "src/messaging/message.hpp"
 #include "common.hpp"
+#include "option.hpp"
 #include "receive.hpp"
 #include "send.hpp"
 #include "traits.hpp"
@@ -152,12 +153,13 @@ namespace qi
         void start(SslEnabled, size_t maxPayload, Proc onReceive, qi::int64_t messageHandlingTimeoutInMus);
 
         template<typename Msg, typename Proc>
-        void send(Msg msg, SslEnabled, Proc onSent);
+        bool send(Msg msg, SslEnabled, Proc onSent);
 
         void stop(Promise<void> disconnectedPromise)
         {
           if (tryRaiseAtomicFlag(_stopRequested))
           {
+            _sendMsg.close();
             (*_result)->disconnectedPromise = disconnectedPromise;
 
             // The shutdown will cause any pending operation on the socket to fail.
@@ -213,12 +215,26 @@ namespace qi
       /// If `onSent` returns false, the processing of enqueued messages stops.
       /// By default, we continue sending messages even if an error occurred.
       ///
+      /// Returns false if the message was rejected because of the send queue limits.
+      ///
       /// Procedure<bool (ErrorCode<N>, std::list<Message>::const_iterator)>
       template<typename Msg, typename Proc = ka::constant_function_t<bool>>
-      void send(Msg&& msg, SslEnabled ssl, const Proc& onSent = {true})
+      bool send(Msg&& msg, SslEnabled ssl, const Proc& onSent = {true})
       {
         return _impl->send(std::forward<Msg>(msg), ssl, onSent);
       }
+      void setSendQueueLimits(const SendQueueLimits& limits)
+      {
+        _impl->_sendMsg.setLimits(limits);
+      }
+      SendQueueStatistics sendQueueStatistics() const
+      {
+        return _impl->_sendMsg.statistics();
+      }
+      SocketBufferSizes socketBufferSizes() const
+      {
+        return sock::socketBufferSizes<N>(_impl->socket());
+      }
       Future<SyncConnectedResultPtr<N, S>> complete() const
       {
         return _impl->_completePromise->future();
@@ -263,6 +279,8 @@ namespace qi
       auto prom = _completePromise.synchronize();
       if (!prom->future().isRunning()) // promise already set
         return;
+      // The queue will not be processed anymore.
+      _sendMsg.close();
       const bool stopAsked = _stopRequested.load() && _shuttingdown.load();
       if (!stopAsked && error)
       {
@@ -320,44 +338,41 @@ namespace qi
 
     template<typename N, typename S>
     template<typename Msg, typename Proc>
-    void Connected<N, S>::Impl::send(Msg msg, SslEnabled ssl, Proc onSent)
+    bool Connected<N, S>::Impl::send(Msg msg, SslEnabled ssl, Proc onSent)
     {
       using SendMessage = decltype(_sendMsg);
       using ReadableMessage = typename SendMessage::ReadableMessage;
       auto self = shared_from_this();
-      auto life = lifetimeTransfo();
-      auto sync = syncTransfo();
-
-      // We preventively strand the first call.
-      sync(life(std::bind([=](Msg& msg) mutable {
-        _sendMsg(std::move(msg), ssl,
-
-          // This callback will be called when a message has been sent, or
-          // when an error occurred.
-          //
-          // Warning: `ptrMsg` can be dereferenced to read the sent message.
-          // This operation is only defined if no error occurred and only until
-          // this callback ends. After that, the underlying memory is typically
-          // freed, so the upper layer must not store the message pointer (it
-          // can copy the message though).
 
-          [=](const ErrorCode<N>& e, const ReadableMessage& ptrMsg) mutable {
-
-            // If we're not shutting down, we inform the upper layer that we
-            // sent a message. Then, the upper layer decides whether we should
-            // continue sending messages or not by returning a boolean.
-            const bool mustContinue = !_shuttingdown.load() && onSent(e, ptrMsg);
-            if (!mustContinue)
-            {
-              self->setPromise(e);
-              return false; // We must not continue to send messages.
-            }
-            return true; // Otherwise, we continue to send messages.
-          },
-          life,
-          sync
-        );
-      }, std::move(msg))))();
+      // The message is enqueued synchronously so that the caller knows if it was
+      // accepted. The send loop itself is started in the sync context.
+      return _sendMsg(std::move(msg), ssl,
+
+        // This callback will be called when a message has been sent, or
+        // when an error occurred.
+        //
+        // Warning: `ptrMsg` can be dereferenced to read the sent message.
+        // This operation is only defined if no error occurred and only until
+        // this callback ends. After that, the underlying memory is typically
+        // freed, so the upper layer must not store the message pointer (it
+        // can copy the message though).
+
+        [=](const ErrorCode<N>& e, const ReadableMessage& ptrMsg) mutable {
+
+          // If we're not shutting down, we inform the upper layer that we
+          // sent a message. Then, the upper layer decides whether we should
+          // continue sending messages or not by returning a boolean.
+          const bool mustContinue = !_shuttingdown.load() && onSent(e, ptrMsg);
+          if (!mustContinue)
+          {
+            self->setPromise(e);
+            return false; // We must not continue to send messages.
+          }
+          return true; // Otherwise, we continue to send messages.
+        },
+        lifetimeTransfo(),
+        syncTransfo()
+      );
     }
 }} // namespace qi::sock
 
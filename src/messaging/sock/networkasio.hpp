@@ -23,6 +23,8 @@ namespace qi { namespace sock {
     using ssl_context_type = boost::asio::ssl::context;
     using ssl_socket_type = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
     using socket_option_no_delay_type = boost::asio::ip::tcp::no_delay;
+    using socket_option_receive_buffer_size_type = boost::asio::socket_base::receive_buffer_size;
+    using socket_option_send_buffer_size_type = boost::asio::socket_base::send_buffer_size;
     using accept_option_reuse_address_type = boost::asio::ip::tcp::acceptor::reuse_address;
     using error_code_type = boost::system::error_code;
     using io_service_type = boost::asio::io_service;
@@ -1,6 +1,8 @@
 #pragma once
 #ifndef _QI_SOCK_OPTION_HPP
 #define _QI_SOCK_OPTION_HPP
+#include <algorithm>
+#include <cstddef>
 #include <limits>
 #include <boost/optional.hpp>
 #include <ka/typetraits.hpp>
@@ -66,6 +68,43 @@ namespace qi { namespace sock {
     }
   };
 
+  /// Sizes of the kernel buffers of a socket, in bytes. Zero if unknown.
+  struct SocketBufferSizes
+  {
+    std::size_t receive = 0u;
+    std::size_t send = 0u;
+
+  // Regular:
+    KA_GENERATE_FRIEND_REGULAR_OPS_2(SocketBufferSizes, receive, send)
+  };
+
+  /// Get the sizes of the kernel buffers of a socket.
+  ///
+  /// Network N,
+  /// With NetSslSocket S:
+  ///   S is compatible with N,
+  ///   Mutable<S> S
+  template<typename N, typename S>
+  SocketBufferSizes socketBufferSizes(S socket)
+  {
+    SocketBufferSizes sizes;
+    try
+    {
+      const auto& lowest = (*socket).lowest_layer();
+      SocketOptionReceiveBufferSize<N> receive;
+      lowest.get_option(receive);
+      SocketOptionSendBufferSize<N> send;
+      lowest.get_option(send);
+      sizes.receive = static_cast<std::size_t>(std::max(receive.value(), 0));
+      sizes.send = static_cast<std::size_t>(std::max(send.value(), 0));
+    }
+    catch (const std::exception& e)
+    {
+      qiLogVerbose(logCategory()) << "Can't get the buffer sizes of a socket: " << e.what();
+    }
+    return sizes;
+  }
+
   /// Set default options on a socket, including the timeout.
   ///
   /// Network N,
@@ -1,7 +1,10 @@
 #pragma once
 #ifndef _QI_SOCK_SEND_HPP
 #define _QI_SOCK_SEND_HPP
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 #include <list>
 #include <stdexcept>
@@ -13,12 +16,14 @@
 #include <qi/trackable.hpp>
 #include <qi/future.hpp>
 #include <qi/atomic.hpp>
+#include <qi/metrics.hpp>
 #include "src/messaging/message.hpp"
 #include "concept.hpp"
 #include "traits.hpp"
 #include "option.hpp"
 #include "error.hpp"
 #include "common.hpp"
+#include "sendqueue.hpp"
 
 
 /// @file
@@ -70,6 +75,14 @@
 /// case, `SendMessageEnqueue` effectively constitutes the upper layer of
 /// `sendMessage`.
 ///
+/// The queue is made of two lanes: a control lane (calls, replies, errors...)
+/// and a bulk lane (events), so that a reply is not stuck behind a burst of
+/// events. The control lane is served first, but after a few consecutive control
+/// messages, a bulk message is sent if any is waiting, so that the bulk lane is
+/// never starved. The lane of a message is given by its priority, which
+/// defaults to its type (see `MemberPriority`). The order of the messages is
+/// preserved inside a lane.
+///
 /// `SendMessageEnqueue` has itself an upper layer: it passes it the
 /// sent message though a callback. This callback returns a boolean to
 /// signal if message sending must continue.
@@ -81,7 +94,7 @@
 ///  SendMessageEnqueue start
 ///             |
 ///             v
-///   sendMessage(_msgQueue.begin()) <--
+///   sendMessage(nextLane().begin()) <-
 ///             | message sent          |
 ///             v                       |
 /// pass msg/error to upper layer*      |
@@ -113,6 +126,14 @@
 
 namespace qi { namespace sock {
 
+  /// Bytes waiting in the send queues of all the sockets.
+  inline metrics::Gauge& sendQueueBytesMetric()
+  {
+    static auto& gauge = metrics::gauge("qi_socket_send_queue_bytes",
+                                        "Bytes waiting in the send queues of the sockets.");
+    return gauge;
+  }
+
   /// Make network buffers for the given message.
   ///
   /// One buffer is for the header and the other one is for data.
@@ -235,13 +256,18 @@ namespace qi { namespace sock {
   /// the queue is not cleared. Next time you send a message, it will
   /// be enqueued and the queue processing will continue from where it had stopped.
   ///
+  /// The queue can be bounded (see `setLimits`). In this case, a message that
+  /// would exceed the limits is handled according to the overflow policy, and
+  /// the call operator returns false if the message was not enqueued.
+  ///
   /// Warning: The instance must remain alive until messages are sent.
   /// You can provide a procedure transformation (`lifetimeTransfo`) that will
   /// wrap any internal callback and handle the expired instance case.
   /// `SendMessageEnqueueTrack` does this for you by relying on `Trackable`.
   ///
   /// A sync procedure transformation can also be provided to wrap any
-  /// callback passed to the network. A typical use is to strand the callback.
+  /// callback passed to the network, including the start of the send loop.
+  /// A typical use is to strand the callback.
   ///
   /// Network N, Mutable<NetSslSocket> S
   template<typename N, typename S>
@@ -257,7 +283,14 @@ namespace qi { namespace sock {
       , _sending{false}
     {
     }
+    ~SendMessageEnqueue()
+    {
+      if (_reportedBytes != 0)
+        sendQueueBytesMetric().sub(_reportedBytes);
+    }
   // Procedure:
+    /// Returns false if the message was rejected because of the queue limits.
+    ///
     /// Message Msg,
     /// Procedure<bool (ErrorCode<N>, Readable<Message>)> Proc,
     /// Transformation<Procedure> F0,
@@ -265,43 +298,284 @@ namespace qi { namespace sock {
     template<typename Msg,
              typename Proc = ka::constant_function_t<bool>,
              typename F0 = ka::id_transfo_t, typename F1 = ka::id_transfo_t>
-    void operator()(Msg&&, SslEnabled, Proc onSent = Proc{true},
+    bool operator()(Msg&&, SslEnabled, Proc onSent = Proc{true},
       const F0& lifetimeTransfo = F0{}, const F1& syncTransfo = F1{});
+
+    /// The limits apply to the next enqueued messages.
+    void setLimits(const SendQueueLimits& limits)
+    {
+      std::lock_guard<std::mutex> lock{_sendMutex};
+      _limits = limits;
+      _queueNotFull.notify_all();
+    }
+
+    SendQueueStatistics statistics() const
+    {
+      std::lock_guard<std::mutex> lock{_sendMutex};
+      auto stats = _statistics;
+      stats.messages = queueSize();
+      return stats;
+    }
+
+    /// Rejects the messages of the senders blocked by the `Block` overflow
+    /// policy, and of the ones to come. To be called when the queue will not be
+    /// processed anymore.
+    void close()
+    {
+      std::lock_guard<std::mutex> lock{_sendMutex};
+      _closed = true;
+      _queueNotFull.notify_all();
+    }
   private:
+    enum class Admission
+    {
+      Enqueue,
+      Replaced,
+      Reject,
+    };
+
+    enum Lane : std::size_t
+    {
+      Lane_Control,
+      Lane_Bulk,
+      Lane_Count,
+    };
+
+    /// Number of consecutive control messages after which a waiting bulk
+    /// message is sent.
+    static constexpr unsigned int controlLaneWeight = 4u;
+
+    static std::size_t messageSize(const Message& msg)
+    {
+      return sizeof(Message::Header) + msg.header().size;
+    }
+
+    static Lane laneOf(const Message& msg)
+    {
+      switch (msg.priority())
+      {
+        case MemberPriority::Control: return Lane_Control;
+        case MemberPriority::Bulk: return Lane_Bulk;
+        case MemberPriority::Default: break;
+      }
+      return msg.type() == Message::Type_Event ? Lane_Bulk : Lane_Control;
+    }
+
+    // All the following functions must be called with `_sendMutex` locked.
+    std::size_t queueSize() const;
+    bool fits(std::size_t size) const;
+    Admission admit(Message& msg, std::unique_lock<std::mutex>& lock);
+    std::list<Message>::iterator firstDroppable(Lane lane);
+    bool dropOldestEvents(Lane lane, std::size_t size);
+    Lane nextLane();
+    void updatePeaks();
+    void reportBytes();
+
     S _socket;
-    /// A list is used because we need the iterators not to be invalidated by
+    /// Lists are used because we need the iterators not to be invalidated by
     /// insertions at begin or end, which is not the case with deque.
     /// See [23.3.3.4 deque modifiers].
-    std::list<Message> _sendQueue;
+    std::array<std::list<Message>, Lane_Count> _lanes;
+    /// Lane of the message being sent, if any.
+    Lane _sendingLane = Lane_Control;
+    unsigned int _consecutiveControlMessages = 0u;
     bool _sending;
-    std::mutex _sendMutex;
+    bool _closed = false;
+    SendQueueLimits _limits;
+    SendQueueStatistics _statistics;
+    /// Part of the process wide send queue gauge accounted to this queue.
+    std::int64_t _reportedBytes = 0;
+    mutable std::mutex _sendMutex;
+    std::condition_variable _queueNotFull;
   };
 
+  template<typename N, typename S>
+  constexpr unsigned int SendMessageEnqueue<N, S>::controlLaneWeight;
+
+  template<typename N, typename S>
+  std::size_t SendMessageEnqueue<N, S>::queueSize() const
+  {
+    return _lanes[Lane_Control].size() + _lanes[Lane_Bulk].size();
+  }
+
+  template<typename N, typename S>
+  bool SendMessageEnqueue<N, S>::fits(std::size_t size) const
+  {
+    // A message always fits in an empty queue, otherwise a message bigger than
+    // the byte limit could never be sent.
+    const auto messages = queueSize();
+    return messages == 0u
+      || ((_limits.maxMessages == 0u || messages < _limits.maxMessages)
+          && (_limits.maxBytes == 0u || _statistics.bytes + size <= _limits.maxBytes));
+  }
+
+  // The message being sent, if any, is at the front of its lane and must not
+  // be touched.
+  template<typename N, typename S>
+  std::list<Message>::iterator SendMessageEnqueue<N, S>::firstDroppable(Lane lane)
+  {
+    auto& queue = _lanes[lane];
+    auto it = queue.begin();
+    if (_sending && lane == _sendingLane && it != queue.end())
+      ++it;
+    return it;
+  }
+
+  // Returns true if the message of the given size now fits.
+  template<typename N, typename S>
+  bool SendMessageEnqueue<N, S>::dropOldestEvents(Lane lane, std::size_t size)
+  {
+    auto& queue = _lanes[lane];
+    for (auto it = firstDroppable(lane); it != queue.end() && !fits(size);)
+    {
+      if (it->type() == Message::Type_Event)
+      {
+        _statistics.bytes -= messageSize(*it);
+        reportBytes();
+        it = queue.erase(it);
+        ++_statistics.droppedMessages;
+      }
+      else
+        ++it;
+    }
+    return fits(size);
+  }
+
+  // Precondition: The queue is not empty.
+  template<typename N, typename S>
+  typename SendMessageEnqueue<N, S>::Lane SendMessageEnqueue<N, S>::nextLane()
+  {
+    const bool bulkWaiting = !_lanes[Lane_Bulk].empty();
+    if (!_lanes[Lane_Control].empty()
+        && (!bulkWaiting || _consecutiveControlMessages < controlLaneWeight))
+    {
+      ++_consecutiveControlMessages;
+      return Lane_Control;
+    }
+    _consecutiveControlMessages = 0u;
+    return Lane_Bulk;
+  }
+
+  // The process wide gauge is only updated while the metrics are enabled, so
+  // that the sockets do not contend on it otherwise. Disabling the metrics
+  // withdraws the bytes of the queue at its next change.
+  template<typename N, typename S>
+  void SendMessageEnqueue<N, S>::reportBytes()
+  {
+    const auto bytes = metrics::isEnabled() ? static_cast<std::int64_t>(_statistics.bytes) : 0;
+    if (bytes == _reportedBytes)
+      return;
+    sendQueueBytesMetric().add(bytes - _reportedBytes);
+    _reportedBytes = bytes;
+  }
+
+  template<typename N, typename S>
+  void SendMessageEnqueue<N, S>::updatePeaks()
+  {
+    _statistics.peakMessages = std::max(_statistics.peakMessages, queueSize());
+    _statistics.peakBytes = std::max(_statistics.peakBytes, _statistics.bytes);
+  }
+
+  template<typename N, typename S>
+  typename SendMessageEnqueue<N, S>::Admission
+    SendMessageEnqueue<N, S>::admit(Message& msg, std::unique_lock<std::mutex>& lock)
+  {
+    const auto type = msg.type();
+    const bool limited =
+      type == Message::Type_Call || type == Message::Type_Post || type == Message::Type_Event;
+    const auto size = messageSize(msg);
+    if (!limited || fits(size))
+      return Admission::Enqueue;
+
+    switch (_limits.policy)
+    {
+      case SendQueueOverflowPolicy::Block:
+        // If the send loop is stopped, the queue will not be processed until
+        // a message is enqueued, so there is no point in waiting.
+        _queueNotFull.wait(lock, [&] { return _closed || !_sending || fits(size); });
+        return _closed ? Admission::Reject : Admission::Enqueue;
+      case SendQueueOverflowPolicy::Fail:
+        return Admission::Reject;
+      case SendQueueOverflowPolicy::KeepLatest:
+        if (type == Message::Type_Event)
+        {
+          // All the events of a signal have the same priority, hence go in the
+          // same lane.
+          const auto lane = laneOf(msg);
+          const auto begin = firstDroppable(lane);
+          for (auto it = _lanes[lane].end(); it != begin;)
+          {
+            --it;
+            if (it->type() == Message::Type_Event && it->service() == msg.service()
+                && it->object() == msg.object() && it->event() == msg.event())
+            {
+              _statistics.bytes = _statistics.bytes - messageSize(*it) + size;
+              reportBytes();
+              *it = std::move(msg);
+              ++_statistics.droppedMessages;
+              updatePeaks();
+              return Admission::Replaced;
+            }
+          }
+        }
+        // No event of the same signal is enqueued: make room as `DropOldest` does.
+        // FALLTHROUGH
+      case SendQueueOverflowPolicy::DropOldest:
+      {
+        // Bulk events are dropped first.
+        const bool fit = dropOldestEvents(Lane_Bulk, size) || dropOldestEvents(Lane_Control, size);
+        // Only events are allowed to be lost.
+        return fit || type != Message::Type_Event ? Admission::Enqueue : Admission::Reject;
+      }
+    }
+    return Admission::Enqueue;
+  }
+
   // Lemma SendMessageEnqueue.0:
   //  If a message is already being sent, the message is queued without
   //  invalidating the one being sent.
   // Proof:
-  //  All messages are put in the send queue, including the one being sent.
-  //  The send queue is a list so adding an element doesn't invalidate the other ones.
+  //  All messages are put in a lane of the send queue, including the one being sent.
+  //  Lanes are lists so adding an element doesn't invalidate the other ones.
+  //  The admission never erases nor replaces the first element of the lane
+  //  being sent while a message is being sent.
   template<typename N, typename S>
   template<typename Msg, typename Proc, typename F0, typename F1>
-  void SendMessageEnqueue<N, S>::operator()(Msg&& msg, SslEnabled ssl, Proc onSent,
+  bool SendMessageEnqueue<N, S>::operator()(Msg&& m, SslEnabled ssl, Proc onSent,
       const F0& lifetimeTransfo, const F1& syncTransfo)
   {
+    Message msg{std::forward<Msg>(m)};
     qiLogDebug(logCategory()) << _socket.get() << " SendMessageEnqueue()(" << msg.type() << ": " << msg.address() << ", ssl=" << *ssl << ")";
-    using I = decltype(_sendQueue.begin());
+    using I = std::list<Message>::iterator;
     I itMsg;
     bool mustStartSendLoop = false;
     {
-      std::lock_guard<std::mutex> lock{_sendMutex};
-      _sendQueue.emplace_back(std::forward<Msg>(msg));
-      itMsg = _sendQueue.begin();
+      std::unique_lock<std::mutex> lock{_sendMutex};
+      switch (admit(msg, lock))
+      {
+        case Admission::Reject:
+          ++_statistics.rejectedMessages;
+          qiLogDebug(logCategory()) << _socket.get() << " SendMessageEnqueue: send queue is full, "
+                                    << "message rejected (" << msg.address() << ").";
+          return false;
+        case Admission::Replaced:
+          return true;
+        case Admission::Enqueue:
+          break;
+      }
+      _statistics.bytes += messageSize(msg);
+      reportBytes();
+      const auto lane = laneOf(msg);
+      _lanes[lane].emplace_back(std::move(msg));
+      updatePeaks();
       // We've just added a message to the queue, so if we are not currently sending,
       // we must (re)start the send loop.
       if (!_sending)
       {
         _sending = true;
         mustStartSendLoop = true;
+        _sendingLane = nextLane();
+        itMsg = _lanes[_sendingLane].begin();
       }
     }
     if (mustStartSendLoop)
@@ -313,12 +587,15 @@ namespace qi { namespace sock {
       //  doesn't invalidate the iterator.
       //  Each thread adds a message to the send queue. But only one at a time
       //  can enter this branch (by tryRaiseAtomicFlag.0).
+      //  The iterator is taken on the lane selected while the queue is locked,
+      //  which is not empty since it is selected by nextLane.
       //  Also, the sending flag is only modified while the queue is locked, so
       //  the scenario where a thread B adds a message to the queue, is suspended
       //  just before evaluating the condition of this branch, then the send loop
       //  thread A clears the queue, and then the thread B resumes, is correctly handled.
       //  Moreover, this branch results in exactly one message being removed from
-      //  the send queue (by SendMessageEnqueue.2).
+      //  the send queue (by SendMessageEnqueue.2), and the admission of the
+      //  other messages does not remove it (by SendMessageEnqueue.0).
       //  Therefore, at this point the number of messages in the send queue is
       //  always at least 1.
 
@@ -340,8 +617,11 @@ namespace qi { namespace sock {
             // A scoped is used to cope with potential exception thrown by onSent.
             auto scopedErase = ka::scoped([&] {
               std::lock_guard<std::mutex> lock{_sendMutex};
-              _sendQueue.erase(itSent);
-              if (!mustContinue || _sendQueue.empty())
+              _statistics.bytes -= messageSize(*itSent);
+              reportBytes();
+              _lanes[_sendingLane].erase(itSent);
+              _queueNotFull.notify_all();
+              if (!mustContinue || queueSize() == 0u)
               {
                 QI_ASSERT(_sending);
                 if (!_sending)
@@ -349,7 +629,8 @@ namespace qi { namespace sock {
                 _sending = false;
                 return;
               }
-              itNext = _sendQueue.begin();
+              _sendingLane = nextLane();
+              itNext = _lanes[_sendingLane].begin();
             });
             mustContinue = onSent(erc, itSent);
           }
@@ -361,9 +642,15 @@ namespace qi { namespace sock {
           return itNext;
         };
 
-      sendMessage<N>(_socket, itMsg, std::move(eraseAndReturnNextMessage), ssl,
-        lifetimeTransfo, syncTransfo);
+      // The send loop is started in the sync context, so that the caller does
+      // not have to.
+      auto life = lifetimeTransfo;
+      auto sync = syncTransfo;
+      sync(life([=]() mutable {
+        sendMessage<N>(_socket, itMsg, std::move(eraseAndReturnNextMessage), ssl, life, sync);
+      }))();
     }
+    return true;
   }
 
   /// Functor that sends messages and tracks the object's lifetime.
@@ -391,14 +678,14 @@ namespace qi { namespace sock {
   // Procedure:
     /// Message Msg, Procedure<void (ErrorCode<N>, Readable<Message>)> Proc, Transformation<Procedure<void (Args...)>> F
     template<typename Msg, typename Proc = ka::constant_function_t<void>, typename F = ka::id_transfo_t>
-    void operator()(Msg&& m, SslEnabled ssl, Proc onSent = Proc{}, F syncTransfo = F{})
+    bool operator()(Msg&& m, SslEnabled ssl, Proc onSent = Proc{}, F syncTransfo = F{})
     {
       auto lifetimeTransfo = trackWithFallbackTransfo([=]() mutable {
           onSent(operationAborted<ErrorCode<N>>(), {});
         },
         this
       );
-      _sendMsg(std::forward<Msg>(m), ssl, onSent, lifetimeTransfo, syncTransfo);
+      return _sendMsg(std::forward<Msg>(m), ssl, onSent, lifetimeTransfo, syncTransfo);
     }
   private:
     SendMessageEnqueue<N, S> _sendMsg;
@@ -0,0 +1,66 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_SOCK_SENDQUEUE_HPP
+#define _QI_SOCK_SENDQUEUE_HPP
+#include <cstddef>
+#include <cstdint>
+#include <ka/macroregular.hpp>
+
+/// @file
+/// Contains the types configuring and describing the send queue of a socket.
+
+namespace qi { namespace sock {
+
+  /// What to do with a message that would make the send queue exceed its limits.
+  ///
+  /// The limits only apply to the messages that initiate an exchange (calls,
+  /// posts and events). Replies, errors, cancellations and capabilities are
+  /// always enqueued, so that the protocol keeps working.
+  enum class SendQueueOverflowPolicy
+  {
+    /// The sender waits until the queue has room for the message.
+    /// Warning: It must not be used if messages are sent from the network
+    /// event loop, because the queue could then never be processed.
+    Block,
+    /// The message is rejected and the send operation fails.
+    Fail,
+    /// The oldest enqueued events are dropped to make room for the message.
+    /// Events are rejected if enough room cannot be made.
+    DropOldest,
+    /// An enqueued event of the same signal (same service, object and event)
+    /// is replaced by the new one. Otherwise, behaves as `DropOldest`.
+    KeepLatest,
+  };
+
+  /// Limits of the send queue of a socket. A limit of zero means unlimited.
+  struct SendQueueLimits
+  {
+    std::size_t maxMessages = 0u;
+    std::size_t maxBytes = 0u;
+    SendQueueOverflowPolicy policy = SendQueueOverflowPolicy::Fail;
+
+  // Regular:
+    KA_GENERATE_FRIEND_REGULAR_OPS_3(SendQueueLimits, maxMessages, maxBytes, policy)
+  };
+
+  /// Depth of the send queue of a socket, including the message being sent.
+  struct SendQueueStatistics
+  {
+    std::size_t messages = 0u;
+    std::size_t bytes = 0u;
+    /// Highest depth reached since the connection.
+    std::size_t peakMessages = 0u;
+    std::size_t peakBytes = 0u;
+    /// Events dropped or replaced by newer ones.
+    std::uint64_t droppedMessages = 0u;
+    /// Messages that could not be enqueued.
+    std::uint64_t rejectedMessages = 0u;
+  };
+
+}} // namespace qi::sock
+
+#endif // _QI_SOCK_SENDQUEUE_HPP
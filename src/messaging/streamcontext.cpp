@@ -17,6 +17,7 @@ namespace qi
     char const * const remoteCancelableCalls = "RemoteCancelableCalls";
     char const * const objectPtrUid          = "ObjectPtrUID";
     char const * const relativeEndpointUri   = "RelativeEndpointURI";
+    char const * const traceContext          = "TraceContext";
   }
 
 
@@ -116,6 +117,7 @@ static void initCapabilities()
   , { capabilityname::remoteCancelableCalls, AnyValue::from(true)  }
   , { capabilityname::objectPtrUid         , AnyValue::from(true)  }
   , { capabilityname::relativeEndpointUri  , AnyValue::from(true)  }
+  , { capabilityname::traceContext         , AnyValue::from(true)  }
   };
 
   _defaultCapabilities = new CapabilityMap(defaultCaps);
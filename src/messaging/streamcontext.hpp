@@ -41,6 +41,10 @@ using CapabilityMap = std::map<std::string, AnyValue>;
     // Capability: ServiceDirectory may add relative endpoints to services to the list of endpoints
     // in service information.
     QI_API extern char const * const relativeEndpointUri;
+
+    // Capability: remote end accepts the trace context prefix on call, post
+    // and event messages (see Message::TypeFlag_TraceContext).
+    QI_API extern char const * const traceContext;
   }
 
   /// State of the `RelativeEndpointsUri` capability.
@@ -6,6 +6,7 @@
 #include <qi/log.hpp>
 #include "sock/networkasio.hpp"
 #include "sock/option.hpp"
+#include "sock/sendqueue.hpp"
 
 #if BOOST_OS_WINDOWS
 # include <Winsock2.h> // needed by mstcpip.h
@@ -129,6 +130,27 @@ namespace qi {
     return l.empty() ? defaultValue : boost::lexical_cast<std::uint32_t>(l);
   }
 
+  sock::SendQueueLimits getSendQueueLimitsFromEnv()
+  {
+    sock::SendQueueLimits limits;
+    const auto maxMessages = os::getenv("QI_SEND_QUEUE_MAX_MESSAGES");
+    if (!maxMessages.empty())
+      limits.maxMessages = strtoul(maxMessages.c_str(), 0, 0);
+    const auto maxBytes = os::getenv("QI_SEND_QUEUE_MAX_BYTES");
+    if (!maxBytes.empty())
+      limits.maxBytes = strtoul(maxBytes.c_str(), 0, 0);
+    const auto policy = os::getenv("QI_SEND_QUEUE_OVERFLOW_POLICY");
+    if (policy == "block")
+      limits.policy = sock::SendQueueOverflowPolicy::Block;
+    else if (policy == "drop_oldest")
+      limits.policy = sock::SendQueueOverflowPolicy::DropOldest;
+    else if (policy == "keep_latest")
+      limits.policy = sock::SendQueueOverflowPolicy::KeepLatest;
+    else if (!policy.empty() && policy != "fail")
+      qiLogWarning() << "Unknown send queue overflow policy '" << policy << "', using 'fail'.";
+    return limits;
+  }
+
 } // namespace qi
 
 namespace qi { namespace sock {
@@ -48,6 +48,11 @@ namespace qi {
 
   boost::optional<Seconds> getTcpPingTimeout(Seconds defaultTimeout);
 
+  /// Use the environment variables QI_SEND_QUEUE_MAX_MESSAGES, QI_SEND_QUEUE_MAX_BYTES and
+  /// QI_SEND_QUEUE_OVERFLOW_POLICY ("block", "fail", "drop_oldest" or "keep_latest"), if set.
+  /// The queue is unlimited otherwise.
+  sock::SendQueueLimits getSendQueueLimitsFromEnv();
+
   template<typename N, typename S>
   class TcpMessageSocket;
 
@@ -227,9 +232,15 @@ namespace qi {
     }
 
     /// Returns `true` if we could ask to send the message.
-    /// One failure case (return `false`) is when the socket is not connected.
+    /// Failure cases (return `false`) are when the socket is not connected and when the message
+    /// is rejected by the send queue.
     bool send(Message msg) override;
 
+    void setSendQueueLimits(const SendQueueLimits& limits) override;
+    SendQueueLimits sendQueueLimits() const override;
+    SendQueueStatistics sendQueueStatistics() const override;
+    SocketBufferSizes socketBufferSizes() const override;
+
     Status status() const override
     {
       boost::recursive_mutex::scoped_lock lock(_stateMutex);
@@ -295,6 +306,10 @@ namespace qi {
     using State = boost::variant<DisconnectedState, ConnectingState, ConnectedState, DisconnectingState>;
     State _state;
     boost::synchronized_value<Url> _url;
+    SendQueueLimits _sendQueueLimits;
+
+    /// _state must be synchronized before calling this method.
+    void enterConnectedState(const SocketPtr& socket, std::size_t maxPayload);
 
     bool mustTreatAsServerAuthentication(const Message& msg) const;
     bool handleCapabilityMessage(const Message& msg);
@@ -341,6 +356,7 @@ namespace qi {
     , _ssl(ssl)
     , _ioService(io)
     , _state{DisconnectedState{}}
+    , _sendQueueLimits(getSendQueueLimitsFromEnv())
   {
     if (socket)
     {
@@ -393,8 +409,8 @@ namespace qi {
         res.disconnectedPromise.future().wait();
         return false;
       }
+      enterConnectedState(res.socket, maxPayload);
       auto self = shared_from_this();
-      _state = ConnectedState(res.socket, _ssl, maxPayload, sock::HandleMessage<N, S>{self});
       auto& connected = asConnected(_state);
       connected.complete().then(connected.ioServiceStranded(
         OnConnectedComplete{self, Future<void>{nullptr}}
@@ -472,7 +488,7 @@ namespace qi {
         // Connecting was successful, so we enter the connected state (to be able
         // send and receive messages).
         static const auto maxPayload = getMaxPayloadFromEnv();
-        _state = ConnectedState(res.socket, _ssl, maxPayload, sock::HandleMessage<N, S>{self});
+        enterConnectedState(res.socket, maxPayload);
         auto& connected = asConnected(_state);
         connected.complete().then(connected.ioServiceStranded(
           OnConnectedComplete{self, connectedPromise.future()}
@@ -597,6 +613,7 @@ namespace qi {
   template<typename N, typename S>
   bool TcpMessageSocket<N, S>::handleMessage(Message msg)
   {
+    recordReceived(msg.header());
     bool success = false;
     if (mustTreatAsServerAuthentication(msg) || msg.type() == Message::Type_Capability)
     {
@@ -644,27 +661,82 @@ namespace qi {
     return fut.andThen([](bool){});
   }
 
+  template<typename N, typename S>
+  void TcpMessageSocket<N, S>::enterConnectedState(const SocketPtr& socket, std::size_t maxPayload)
+  {
+    _state = ConnectedState(socket, _ssl, maxPayload,
+                            sock::HandleMessage<N, S>{shared_from_this()});
+    asConnected(_state).setSendQueueLimits(_sendQueueLimits);
+  }
+
   template<typename N, typename S>
   bool TcpMessageSocket<N, S>::send(Message msg)
   {
-    boost::recursive_mutex::scoped_lock lock(_stateMutex);
-    if (getStatus() != Status::Connected)
+    boost::optional<ConnectedState> connected;
     {
-      QI_LOG_DEBUG_SOCKET(this) << "Socket must be connected to send().";
-      return false;
+      boost::recursive_mutex::scoped_lock lock(_stateMutex);
+      if (getStatus() != Status::Connected)
+      {
+        QI_LOG_DEBUG_SOCKET(this) << "Socket must be connected to send().";
+        return false;
+      }
+      connected = asConnected(_state);
     }
+    // The state is not locked while enqueuing, as this might block depending on the send queue
+    // overflow policy.
+    const Message::Header header = msg.header();
     // NOTE: Should we specify an `onSent` callback and stop sending if an error
     // occurred?
-    asConnected(_state).send(std::move(msg), _ssl);
+    if (!connected->send(std::move(msg), _ssl))
+    {
+      QI_LOG_DEBUG_SOCKET(this) << "Send queue is full, message " << header.address()
+                                << " rejected.";
+      return false;
+    }
+    recordSent(header);
     return true;
   }
 
+  template<typename N, typename S>
+  void TcpMessageSocket<N, S>::setSendQueueLimits(const SendQueueLimits& limits)
+  {
+    boost::recursive_mutex::scoped_lock lock(_stateMutex);
+    _sendQueueLimits = limits;
+    if (getStatus() == Status::Connected)
+      asConnected(_state).setSendQueueLimits(limits);
+  }
+
+  template<typename N, typename S>
+  auto TcpMessageSocket<N, S>::sendQueueLimits() const -> SendQueueLimits
+  {
+    boost::recursive_mutex::scoped_lock lock(_stateMutex);
+    return _sendQueueLimits;
+  }
+
+  template<typename N, typename S>
+  auto TcpMessageSocket<N, S>::sendQueueStatistics() const -> SendQueueStatistics
+  {
+    boost::recursive_mutex::scoped_lock lock(_stateMutex);
+    if (getStatus() != Status::Connected)
+      return {};
+    return asConnected(_state).sendQueueStatistics();
+  }
+
+  template<typename N, typename S>
+  auto TcpMessageSocket<N, S>::socketBufferSizes() const -> SocketBufferSizes
+  {
+    boost::recursive_mutex::scoped_lock lock(_stateMutex);
+    if (getStatus() != Status::Connected)
+      return {};
+    return asConnected(_state).socketBufferSizes();
+  }
+
   /// Network N,
   /// With NetSslSocket S:
   ///   S is compatible with N
   template <typename N = sock::NetworkAsio, typename S = sock::SocketWithContext<N>>
   TcpMessageSocketPtr<N, S> makeTcpMessageSocket(const std::string& protocol,
-                                                 EventLoop* eventLoop = getNetworkEventLoop())
+                                                 EventLoop* eventLoop = nextNetworkEventLoop())
   {
     using Socket = TcpMessageSocket<N, S>;
     if (protocol == "tcp")
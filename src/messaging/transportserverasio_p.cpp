@@ -51,6 +51,13 @@ namespace qi
       qiLogWarning() << this << " No context available, acceptor will stay down.";
   }
 
+  boost::asio::io_service& TransportServerAsioPrivate::nextSocketIoService()
+  {
+    if (context == getNetworkEventLoop())
+      return *asIoServicePtr(nextNetworkEventLoop());
+    return _acceptor->get_io_service();
+  }
+
   void TransportServerAsioPrivate::onAccept(const boost::system::error_code& erc,
     sock::SocketWithContextPtr<sock::NetworkAsio> s
     )
@@ -80,7 +87,7 @@ namespace qi
     }
     else
     {
-        auto socket = boost::make_shared<qi::TcpMessageSocket<>>(*asIoServicePtr(context), _ssl, s);
+        auto socket = boost::make_shared<qi::TcpMessageSocket<>>(s->get_io_service(), _ssl, s);
         qiLogDebug() << "New socket accepted: " << socket.get();
 
         self->newConnection(std::pair<MessageSocketPtr, Url>{
@@ -90,7 +97,7 @@ namespace qi
             qiLogError() << "bug: socket not stored by the newConnection handler (usecount:" << socket.use_count() << ")";
         }
     }
-    _s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(_acceptor->get_io_service(), _sslContext);
+    _s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(nextSocketIoService(), _sslContext);
     _acceptor->async_accept(_s->lowest_layer(),
                            boost::bind(_onAccept, shared_from_this(), _1, _s));
   }
@@ -325,7 +332,7 @@ namespace qi
       ));
     }
 
-    _s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(_acceptor->get_io_service(), _sslContext);
+    _s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(nextSocketIoService(), _sslContext);
     _acceptor->async_accept(_s->lowest_layer(),
       boost::bind(_onAccept, shared_from_this(), _1, _s));
     _connectionPromise.setValue(0);
@@ -61,6 +61,9 @@ namespace qi
 
   private:
     void restartAcceptor();
+    /// The io service of the next accepted socket. Sockets accepted on the
+    /// network event loop are spread over all the network event loops.
+    boost::asio::io_service& nextSocketIoService();
   };
 }
 
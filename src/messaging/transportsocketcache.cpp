@@ -3,13 +3,16 @@
 **  See COPYING for the license
 */
 #include <algorithm>
+#include <cstdlib>
 #include <sstream>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/range/algorithm/find_if.hpp>
 
+#include <qi/async.hpp>
 #include <qi/log.hpp>
 #include <qi/numeric.hpp>
+#include <qi/os.hpp>
 #include <qi/uri.hpp>
 
 #include "messagesocket.hpp"
@@ -24,8 +27,45 @@ qiLogCategory(LOG_CATEGORY);
 
 namespace qi
 {
+namespace
+{
+  // Weight of the last measure in the smoothed connection time, as for TCP's SRTT (RFC 6298).
+  const int connectionTimeSmoothingFactor = 8;
+  // A failing endpoint is quarantined for a duration doubling with each failure.
+  const qi::Seconds minQuarantineDuration{ 1 };
+  const qi::Seconds maxQuarantineDuration{ 60 };
+  // Statistics of endpoints that were not tried for this long are forgotten.
+  const qi::Seconds endpointStatisticsLifetime{ 600 };
+  // Idle sockets are looked for at least this often.
+  const qi::Seconds minIdleReapingPeriod{ 1 };
+
+  std::size_t getMaxConnectionsFromEnv()
+  {
+    const auto value = os::getenv("QI_SOCKET_CACHE_MAX_CONNECTIONS");
+    return value.empty() ? 0u : std::strtoul(value.c_str(), nullptr, 0);
+  }
+
+  Duration getIdleTimeoutFromEnv()
+  {
+    const auto value = os::getenv("QI_SOCKET_CACHE_IDLE_TIMEOUT");
+    return value.empty() ? Duration::zero() : Seconds{ std::strtol(value.c_str(), nullptr, 0) };
+  }
+
+  void closeSocket(const MessageSocketPtr& socket, const std::vector<SignalLink>& trackingLinks)
+  {
+    for (const auto link: trackingLinks)
+      socket->disconnected.disconnect(link);
+    socket->disconnect();
+  }
+}
+
+// As recommended by RFC 8305 (Happy Eyeballs Version 2).
+const MilliSeconds TransportSocketCache::connectionAttemptDelay{ 250 };
+
 TransportSocketCache::TransportSocketCache()
-  : _dying(false)
+  : _maxConnections(getMaxConnectionsFromEnv())
+  , _idleTimeout(getIdleTimeoutFromEnv().count())
+  , _dying(false)
 {
 }
 
@@ -49,7 +89,9 @@ TransportSocketCache::~TransportSocketCache()
 
 void TransportSocketCache::init()
 {
+  boost::mutex::scoped_lock lock(_socketMutex);
   _dying = false;
+  scheduleIdleReaping();
 }
 
 /// Container<DisconnectInfo> C
@@ -71,6 +113,7 @@ void TransportSocketCache::close()
     {
       boost::mutex::scoped_lock lock(_socketMutex);
       _dying = true;
+      _idleReaping.cancel();
       std::swap(map, _connections);
       std::swap(pending, _allPendingConnections);
     }
@@ -169,10 +212,7 @@ Future<MessageSocketPtr> TransportSocketCache::socket(const ServiceInfo& servInf
         }
       }
     }
-    // Otherwise, we keep track of all those URIs and assign them the same promise in our map.
-    // They will all track the same connection.
-    couple->attemptCount = qi::numericConvert<int>(connectionCandidates.size());
-    auto& uriMap = _connections[machineId];
+    std::vector<Uri> supportedCandidates;
     for (const auto& uri: connectionCandidates)
     {
       const auto scheme = uri.scheme();
@@ -183,18 +223,329 @@ Future<MessageSocketPtr> TransportSocketCache::socket(const ServiceInfo& servInf
       if (!local && isLoopbackAddress((*uri.authority()).host()))
         continue; // Do not try to connect on localhost when it is a remote!
 
-      uriMap[uri] = couple;
-      MessageSocketPtr socket = makeMessageSocket(scheme);
-      _allPendingConnections.push_back(socket);
-      Future<void> sockFuture = socket->connect(toUrl(uri));
-      qiLogDebug() << "Inserted [" << machineId << "][" << uri << "]";
-      sockFuture.then(std::bind(&TransportSocketCache::onSocketParallelConnectionAttempt, this,
-                                std::placeholders::_1, socket, uri, servInfo));
+      supportedCandidates.push_back(uri);
     }
+    if (supportedCandidates.empty())
+      return makeFutureError<MessageSocketPtr>(noReachableEndpointErrorMessage);
+
+    // Otherwise, we keep track of all those URIs and assign them the same promise in our map.
+    // They will all track the same connection.
+    const auto rankedCandidates = rankEndpoints(machineId, std::move(supportedCandidates));
+    couple->attemptCount = qi::numericConvert<int>(rankedCandidates.size());
+    couple->remainingUris.assign(rankedCandidates.begin(), rankedCandidates.end());
+    auto& uriMap = _connections[machineId];
+    for (const auto& uri: rankedCandidates)
+      uriMap[uri] = couple;
+
+    startNextConnection(couple, servInfo);
+    scheduleNextConnection(couple, servInfo);
   }
   return couple->promise.future();
 }
 
+std::vector<Uri> TransportSocketCache::rankEndpoints(const std::string& machineId,
+                                                     std::vector<Uri> uris) const
+{
+  const auto now = SteadyClock::now();
+  const auto rank = [&](const Uri& uri) {
+    const auto statsIt = _endpointStatistics.find(std::make_pair(machineId, uri));
+    const bool known = statsIt != _endpointStatistics.end();
+    const bool quarantined = known && statsIt->second.quarantinedUntil > now;
+    const bool loopback = isLoopbackAddress((*uri.authority()).host());
+    const auto connectionTime = known ? statsIt->second.connectionTime
+                                      : boost::optional<SteadyClock::duration>{};
+    // Endpoints without statistics come after the ones that are known to work.
+    return std::make_tuple(quarantined,
+                           !loopback,
+                           !connectionTime,
+                           connectionTime.value_or(SteadyClock::duration::zero()));
+  };
+  // The stable sort keeps the order of the service info for equivalent endpoints.
+  std::stable_sort(uris.begin(), uris.end(), [&](const Uri& a, const Uri& b) {
+    return rank(a) < rank(b);
+  });
+  // Quarantined endpoints are only tried when there is nothing else.
+  const auto firstQuarantined = std::find_if(uris.begin(), uris.end(), [&](const Uri& uri) {
+    return std::get<0>(rank(uri));
+  });
+  if (firstQuarantined != uris.begin())
+    uris.erase(firstQuarantined, uris.end());
+  return uris;
+}
+
+void TransportSocketCache::startNextConnection(ConnectionAttemptPtr attempt,
+                                               const ServiceInfo& info)
+{
+  if (attempt->state != State_Pending)
+  {
+    // The race is over: forget about the endpoints that were not tried.
+    attempt->remainingUris.clear();
+    return;
+  }
+  if (attempt->remainingUris.empty())
+    return;
+
+  const auto uri = attempt->remainingUris.front();
+  attempt->remainingUris.pop_front();
+
+  MessageSocketPtr socket = makeMessageSocket(uri.scheme());
+  _allPendingConnections.push_back(socket);
+  const auto startTime = SteadyClock::now();
+  Future<void> sockFuture = socket->connect(toUrl(uri));
+  qiLogDebug() << "Inserted [" << info.machineId() << "][" << uri << "]";
+  sockFuture.then(std::bind(&TransportSocketCache::onSocketParallelConnectionAttempt, this,
+                            std::placeholders::_1, socket, uri, info, startTime));
+}
+
+void TransportSocketCache::scheduleNextConnection(ConnectionAttemptPtr attempt,
+                                                  const ServiceInfo& info)
+{
+  if (attempt->state != State_Pending || attempt->remainingUris.empty())
+    return;
+
+  asyncDelay(track([=] {
+    boost::mutex::scoped_lock lock(_socketMutex);
+    if (_dying)
+      return;
+    startNextConnection(attempt, info);
+    scheduleNextConnection(attempt, info);
+  }, this), connectionAttemptDelay);
+}
+
+void TransportSocketCache::updateEndpointStatistics(const std::string& machineId,
+                                                    const Uri& uri,
+                                                    bool success,
+                                                    SteadyClock::duration connectionTime)
+{
+  const auto now = SteadyClock::now();
+  pruneEndpointStatistics(now);
+
+  auto& stats = _endpointStatistics[std::make_pair(machineId, uri)];
+  stats.lastAttempt = now;
+  if (success)
+  {
+    if (stats.connectionTime)
+      stats.connectionTime = *stats.connectionTime
+        + (connectionTime - *stats.connectionTime) / connectionTimeSmoothingFactor;
+    else
+      stats.connectionTime = connectionTime;
+    stats.consecutiveFailures = 0;
+    stats.quarantinedUntil = SteadyClock::time_point{};
+    return;
+  }
+
+  ++stats.consecutiveFailures;
+  const auto shift = std::min(stats.consecutiveFailures - 1, 6u);
+  const auto quarantine = std::min<SteadyClock::duration>(minQuarantineDuration * (1 << shift),
+                                                          maxQuarantineDuration);
+  stats.quarantinedUntil = now + quarantine;
+}
+
+void TransportSocketCache::pruneEndpointStatistics(SteadyClock::time_point now)
+{
+  for (auto it = _endpointStatistics.begin(); it != _endpointStatistics.end();)
+  {
+    // The quarantine is always shorter than the lifetime, no need to check it.
+    if (now - it->second.lastAttempt > endpointStatisticsLifetime)
+      it = _endpointStatistics.erase(it);
+    else
+      ++it;
+  }
+}
+
+boost::optional<TransportSocketCache::EndpointStatistics>
+TransportSocketCache::endpointStatistics(const std::string& machineId, const Uri& uri)
+{
+  boost::mutex::scoped_lock lock(_socketMutex);
+  const auto it = _endpointStatistics.find(std::make_pair(machineId, uri));
+  if (it == _endpointStatistics.end())
+    return {};
+  return it->second;
+}
+
+void TransportSocketCache::setMaxConnections(std::size_t maxConnections)
+{
+  _maxConnections = maxConnections;
+  enforceMaxConnections({});
+}
+
+std::size_t TransportSocketCache::maxConnections() const
+{
+  return _maxConnections;
+}
+
+void TransportSocketCache::setIdleTimeout(Duration idleTimeout)
+{
+  boost::mutex::scoped_lock lock(_socketMutex);
+  _idleTimeout = idleTimeout.count();
+  scheduleIdleReaping();
+}
+
+Duration TransportSocketCache::idleTimeout() const
+{
+  return Duration{ _idleTimeout.load() };
+}
+
+std::vector<TransportSocketCache::SocketStatistics> TransportSocketCache::socketStatistics()
+{
+  std::vector<SocketStatistics> result;
+  {
+    boost::mutex::scoped_lock lock(_socketMutex);
+    result = connectedSockets();
+  }
+  // The sockets lock their own state: do not hold the cache lock meanwhile.
+  for (auto& stats : result)
+  {
+    stats.sendQueue = stats.socket->sendQueueStatistics();
+    stats.bufferSizes = stats.socket->socketBufferSizes();
+  }
+  return result;
+}
+
+std::vector<TransportSocketCache::SocketStatistics> TransportSocketCache::connectedSockets() const
+{
+  const auto now = SteadyClock::now();
+  std::vector<SocketStatistics> result;
+  // A socket is usually associated to several URIs.
+  std::map<MessageSocketPtr, std::size_t> indexes;
+  for (const auto& pairMachineIdConnection: _connections)
+  {
+    for (const auto& pairUriConnection: pairMachineIdConnection.second)
+    {
+      const auto& attempt = *pairUriConnection.second;
+      const auto& socket = attempt.endpoint;
+      if (attempt.state != State_Connected || !socket)
+        continue;
+
+      const auto inserted = indexes.insert(std::make_pair(socket, result.size()));
+      if (inserted.second)
+      {
+        SocketStatistics stats;
+        stats.socket = socket;
+        stats.machineId = pairMachineIdConnection.first;
+        stats.traffic = socket->statistics();
+        stats.idleTime = now - stats.traffic.lastActivity;
+        stats.pinned = false;
+        stats.inUse = socket->isInUse();
+        result.push_back(std::move(stats));
+      }
+      auto& stats = result[inserted.first->second];
+      stats.uris.push_back(pairUriConnection.first);
+      stats.pinned = stats.pinned || attempt.pinned;
+    }
+  }
+  return result;
+}
+
+std::vector<SignalLink> TransportSocketCache::removeSocket(const MessageSocketPtr& socket)
+{
+  std::vector<SignalLink> trackingLinks;
+  _allPendingConnections.remove(socket);
+  for (auto machineIt = _connections.begin(); machineIt != _connections.end();)
+  {
+    auto& uriMap = machineIt->second;
+    for (auto uriIt = uriMap.begin(); uriIt != uriMap.end();)
+    {
+      auto& attempt = *uriIt->second;
+      if (attempt.endpoint == socket)
+      {
+        const auto link = exchangeInvalidSignalLink(attempt.disconnectionTracking);
+        if (isValidSignalLink(link))
+          trackingLinks.push_back(link);
+        uriIt = uriMap.erase(uriIt);
+      }
+      else
+        ++uriIt;
+    }
+    if (uriMap.empty())
+      machineIt = _connections.erase(machineIt);
+    else
+      ++machineIt;
+  }
+  return trackingLinks;
+}
+
+void TransportSocketCache::enforceMaxConnections(MessageSocketPtr except)
+{
+  std::vector<std::pair<MessageSocketPtr, std::vector<SignalLink>>> evicted;
+  {
+    boost::mutex::scoped_lock lock(_socketMutex);
+    const std::size_t maxConnections = _maxConnections;
+    if (_dying || maxConnections == 0)
+      return;
+
+    auto sockets = connectedSockets();
+    sockets.erase(std::remove_if(sockets.begin(), sockets.end(),
+                                 [](const SocketStatistics& s) { return s.pinned; }),
+                  sockets.end());
+    if (sockets.size() <= maxConnections)
+      return;
+
+    // Sockets that are in use are counted but never closed: closing them would break the
+    // objects relying on them. The limit is then exceeded until they are released.
+    auto excess = sockets.size() - maxConnections;
+    sockets.erase(std::remove_if(sockets.begin(), sockets.end(),
+                                 [&](const SocketStatistics& s) {
+                                   return s.inUse || s.socket == except;
+                                 }),
+                  sockets.end());
+
+    std::sort(sockets.begin(), sockets.end(), [](const SocketStatistics& a, const SocketStatistics& b) {
+      return a.traffic.lastActivity < b.traffic.lastActivity;
+    });
+    for (auto it = sockets.begin(); excess != 0 && it != sockets.end(); ++it)
+    {
+      qiLogVerbose() << "Closing the least recently used socket " << it->socket.get() << " to "
+                     << it->machineId << ", idle for "
+                     << boost::chrono::duration_cast<MilliSeconds>(it->idleTime).count() << "ms.";
+      evicted.emplace_back(it->socket, removeSocket(it->socket));
+      --excess;
+    }
+  }
+  for (const auto& socketLinks: evicted)
+    closeSocket(socketLinks.first, socketLinks.second);
+}
+
+void TransportSocketCache::reapIdleSockets()
+{
+  std::vector<std::pair<MessageSocketPtr, std::vector<SignalLink>>> reaped;
+  {
+    boost::mutex::scoped_lock lock(_socketMutex);
+    const Duration idleTimeout{ _idleTimeout.load() };
+    if (_dying || idleTimeout == Duration::zero())
+      return;
+
+    for (const auto& stats: connectedSockets())
+    {
+      if (stats.pinned || stats.inUse || stats.idleTime < idleTimeout)
+        continue;
+      qiLogVerbose() << "Closing the idle socket " << stats.socket.get() << " to "
+                     << stats.machineId << ".";
+      reaped.emplace_back(stats.socket, removeSocket(stats.socket));
+    }
+  }
+  for (const auto& socketLinks: reaped)
+    closeSocket(socketLinks.first, socketLinks.second);
+}
+
+void TransportSocketCache::scheduleIdleReaping()
+{
+  _idleReaping.cancel();
+  const auto generation = ++_idleReapingGeneration;
+  const Duration idleTimeout{ _idleTimeout.load() };
+  if (_dying || idleTimeout == Duration::zero())
+    return;
+
+  const auto period = std::max<Duration>(idleTimeout / 2, minIdleReapingPeriod);
+  _idleReaping = asyncDelay(track([=] {
+    reapIdleSockets();
+    boost::mutex::scoped_lock lock(_socketMutex);
+    // The timeout might have changed in the meantime, in which case another loop is running.
+    if (generation == _idleReapingGeneration)
+      scheduleIdleReaping();
+  }, this), period);
+}
+
 FutureSync<void> TransportSocketCache::disconnect(MessageSocketPtr socket)
 {
   Promise<void> promiseSocketRemoved;
@@ -224,6 +575,14 @@ FutureSync<void> TransportSocketCache::disconnect(MessageSocketPtr socket)
 }
 
 void TransportSocketCache::insert(const std::string& machineId, const Uri& uri, MessageSocketPtr socket)
+{
+  insert(machineId, uri, socket, true);
+}
+
+void TransportSocketCache::insert(const std::string& machineId,
+                                  const Uri& uri,
+                                  MessageSocketPtr socket,
+                                  bool pinned)
 {
   // If a connection is pending for this machine / uri, terminate the pendage and set the
   // service socket as this one
@@ -257,6 +616,7 @@ void TransportSocketCache::insert(const std::string& machineId, const Uri& uri,
       connectionAttempt.endpoint = socket;
       connectionAttempt.promise.setValue(socket);
       connectionAttempt.disconnectionTracking = disconnectionTracking;
+      connectionAttempt.pinned = pinned;
       return;
     }
   }
@@ -265,6 +625,8 @@ void TransportSocketCache::insert(const std::string& machineId, const Uri& uri,
   couple->endpoint = socket;
   couple->state = State_Connected;
   couple->relatedUris.push_back(uri);
+  couple->disconnectionTracking = disconnectionTracking;
+  couple->pinned = pinned;
   _connections[machineId][uri] = couple;
   couple->promise.setValue(socket);
 }
@@ -284,7 +646,8 @@ void TransportSocketCache::insert(const std::string& machineId, const Uri& uri,
 void TransportSocketCache::onSocketParallelConnectionAttempt(Future<void> fut,
                                                              MessageSocketPtr socket,
                                                              Uri uri,
-                                                             const ServiceInfo& info)
+                                                             const ServiceInfo& info,
+                                                             SteadyClock::time_point startTime)
 {
   {
     boost::mutex::scoped_lock lock(_socketMutex);
@@ -300,6 +663,10 @@ void TransportSocketCache::onSocketParallelConnectionAttempt(Future<void> fut,
       return;
     }
 
+    // Even the attempts that lost the race tell us something about their endpoint.
+    updateEndpointStatistics(info.machineId(), uri, !fut.hasError(),
+                             SteadyClock::now() - startTime);
+
     ConnectionMap::iterator machineIt = _connections.find(info.machineId());
     std::map<Uri, ConnectionAttemptPtr>::iterator uriIt;
     if (machineIt != _connections.end())
@@ -329,6 +696,8 @@ void TransportSocketCache::onSocketParallelConnectionAttempt(Future<void> fut,
       // Failing to connect to some of the endpoint is expected.
       qiLogDebug() << "Could not connect to service #" << info.serviceId() << " through uri " << uri;
       _allPendingConnections.remove(socket);
+      // Do not wait for the delay to try the next endpoint.
+      startNextConnection(attempt, info);
       // It's a critical error if we've exhausted all available endpoints.
       if (attempt->attemptCount == 0)
       {
@@ -351,9 +720,11 @@ void TransportSocketCache::onSocketParallelConnectionAttempt(Future<void> fut,
 
   // Associate the same socket to the relative URI of the service, so that we may reuse the same
   // socket if another service has this relative URI as one of its endpoints.
-  insert(info.machineId(), *qi::uri(std::string(uriQiScheme()) + ":" + info.name()), socket);
+  insert(info.machineId(), *qi::uri(std::string(uriQiScheme()) + ":" + info.name()), socket,
+         false);
   qiLogDebug() << "Connected to service #" << info.serviceId() << " through uri " << uri
                << " and socket " << socket.get();
+  enforceMaxConnections(socket);
 }
 
 void TransportSocketCache::checkClear(ConnectionAttemptPtr attempt, const std::string& machineId)
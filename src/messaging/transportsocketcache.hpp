@@ -7,11 +7,16 @@
 #ifndef _SRC_TRANSPORTSOCKETCACHE2_HPP_
 #define _SRC_TRANSPORTSOCKETCACHE2_HPP_
 
+#include <atomic>
+#include <deque>
 #include <string>
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/synchronized_value.hpp>
 
+#include <boost/optional.hpp>
+
+#include <qi/clock.hpp>
 #include <qi/future.hpp>
 #include <qi/uri.hpp>
 #include <qi/messaging/serviceinfo.hpp>
@@ -33,6 +38,19 @@ namespace qi
   * -> if the connection is pending wait for the result
   * -> if the socket do not exist, create it, and try to connect it
   * -> if the socket is disconnected try to reconnect it
+  *
+  * The endpoints of a service are raced in a "happy eyeballs" fashion: they are
+  * ranked according to the statistics of the previous connections (loopback
+  * endpoints first, then the fastest ones; endpoints that recently failed are
+  * skipped unless there is no other one), and each attempt is started after a
+  * short delay if the previous ones did not succeed yet, or as soon as one of
+  * them fails.
+  *
+  * The number of sockets created by the cache can be bounded (see `setMaxConnections`), in
+  * which case the least recently used ones are closed when the limit is exceeded. Sockets that
+  * did not carry any message for a while can also be closed (see `setIdleTimeout`). Closed
+  * sockets are removed from the cache, and a new connection is made the next time they are
+  * needed. Sockets given to the cache through `insert` are never closed by these policies.
   */
 
   class TransportSocketCache : public Trackable<TransportSocketCache>
@@ -44,9 +62,64 @@ namespace qi
     void init();
     void close();
 
+    /// Statistics of the connection attempts to an endpoint.
+    struct EndpointStatistics
+    {
+      /// Smoothed duration of the successful connections, if any.
+      boost::optional<SteadyClock::duration> connectionTime;
+      /// Number of failed attempts since the last successful one.
+      unsigned int consecutiveFailures = 0;
+      /// While the endpoint is quarantined, it is only tried if no other endpoint is available.
+      SteadyClock::time_point quarantinedUntil;
+      /// Time of the last attempt. The statistics of endpoints that are not tried for a while
+      /// are dropped.
+      SteadyClock::time_point lastAttempt;
+    };
+
+    /// Delay before trying the next endpoint when the previous attempts did not finish.
+    static const MilliSeconds connectionAttemptDelay;
+
+    /// Statistics of a socket held by the cache.
+    struct SocketStatistics
+    {
+      MessageSocketPtr socket;
+      std::string machineId;
+      /// All the URIs the socket is associated to.
+      std::vector<Uri> uris;
+      MessageSocket::Statistics traffic;
+      /// Memory held for the socket: the messages waiting to be sent, and the kernel buffers.
+      /// Only filled by `socketStatistics`.
+      MessageSocket::SendQueueStatistics sendQueue;
+      MessageSocket::SocketBufferSizes bufferSizes;
+      /// Time elapsed since the last message was sent or received.
+      SteadyClock::duration idleTime;
+      /// Whether the socket was given to the cache through `insert`.
+      bool pinned;
+      /// Whether objects are still bound to the socket, or remote objects are waiting for replies
+      /// or signals through it. Such sockets are neither evicted nor reaped.
+      bool inUse;
+    };
+
+    /// Maximum number of sockets created by the cache that are kept connected. Zero means
+    /// unlimited. Sockets in use are never closed to honor it, so that it is only a soft limit.
+    /// Defaults to the value of the `QI_SOCKET_CACHE_MAX_CONNECTIONS` environment
+    /// variable, or zero.
+    void setMaxConnections(std::size_t maxConnections);
+    std::size_t maxConnections() const;
+
+    /// Duration without any traffic after which a socket created by the cache is closed, unless
+    /// it is in use. Zero means never. Defaults to the value in seconds of the `QI_SOCKET_CACHE_IDLE_TIMEOUT`
+    /// environment variable, or zero.
+    void setIdleTimeout(Duration idleTimeout);
+    Duration idleTimeout() const;
+
+    /// Returns the statistics of all the connected sockets of the cache.
+    std::vector<SocketStatistics> socketStatistics();
+
     /// Get the socket for the given ServiceInfo.
     ///
-    /// The endpoints of the service info are tried in the order they were set in. If a socket
+    /// The endpoints of the service info are ranked according to the statistics of the
+    /// previous connections to them (see `EndpointStatistics`). If a socket
     /// already exists for one of the endpoints URI associated with the service info machine ID (see
     /// the `insert` member function), it is returned and no other socket is created nor another
     /// connection is attempted.
@@ -60,6 +133,11 @@ namespace qi
     /// The returned future is set when the socket has been disconnected and
     /// effectively removed from the cache.
     FutureSync<void> disconnect(MessageSocketPtr socket);
+
+    /// Returns the statistics of the connection attempts to the given endpoint, if it
+    /// has ever been tried.
+    boost::optional<EndpointStatistics> endpointStatistics(const std::string& machineId,
+                                                           const Uri& uri);
   private:
     enum State
     {
@@ -68,8 +146,18 @@ namespace qi
       State_Error
     };
 
-    void onSocketParallelConnectionAttempt(Future<void> fut, MessageSocketPtr socket, Uri uri, const ServiceInfo& info);
+    void onSocketParallelConnectionAttempt(Future<void> fut,
+                                           MessageSocketPtr socket,
+                                           Uri uri,
+                                           const ServiceInfo& info,
+                                           SteadyClock::time_point startTime);
     void onSocketDisconnected(Uri uri, const ServiceInfo& info);
+    void insert(const std::string& machineId, const Uri& uri, MessageSocketPtr socket, bool pinned);
+
+    /// Closes the least recently used sockets while there are more than `maxConnections`.
+    void enforceMaxConnections(MessageSocketPtr except);
+    void reapIdleSockets();
+    void scheduleIdleReaping();
 
 
     boost::mutex _socketMutex;
@@ -84,14 +172,32 @@ namespace qi
       Promise<MessageSocketPtr> promise;
       MessageSocketPtr endpoint;
       std::vector<Uri> relatedUris;
+      // Ranked endpoints that have not been tried yet.
+      std::deque<Uri> remainingUris;
       int attemptCount = 0;
       State state = State_Pending;
       SignalLink disconnectionTracking = SignalBase::invalidSignalLink;
+      // The socket was given by the user and must not be closed by the cache.
+      bool pinned = false;
     };
     using ConnectionAttemptPtr = boost::shared_ptr<ConnectionAttempt>;
 
     void checkClear(ConnectionAttemptPtr, const std::string& machineId);
 
+    // All the following functions must be called with `_socketMutex` locked.
+    std::vector<Uri> rankEndpoints(const std::string& machineId, std::vector<Uri> uris) const;
+    void startNextConnection(ConnectionAttemptPtr attempt, const ServiceInfo& info);
+    void scheduleNextConnection(ConnectionAttemptPtr attempt, const ServiceInfo& info);
+    void updateEndpointStatistics(const std::string& machineId,
+                                  const Uri& uri,
+                                  bool success,
+                                  SteadyClock::duration connectionTime);
+    void pruneEndpointStatistics(SteadyClock::time_point now);
+    std::vector<SocketStatistics> connectedSockets() const;
+    /// Removes all the entries of the socket and returns the links of their disconnection tracking,
+    /// which must be disconnected once the mutex is released.
+    std::vector<SignalLink> removeSocket(const MessageSocketPtr& socket);
+
     /// The promise is set when the `disconnected` signal of `socket` has been received.
     struct DisconnectInfo
     {
@@ -102,8 +208,13 @@ namespace qi
     using MachineId = std::string;
     using ConnectionMap = std::map<MachineId, std::map<Uri, ConnectionAttemptPtr>>;
     ConnectionMap _connections;
+    std::map<std::pair<MachineId, Uri>, EndpointStatistics> _endpointStatistics;
     std::list<MessageSocketPtr> _allPendingConnections;
     boost::synchronized_value<std::vector<DisconnectInfo>> _disconnectInfos;
+    std::atomic<std::size_t> _maxConnections;
+    std::atomic<Duration::rep> _idleTimeout;
+    Future<void> _idleReaping;
+    unsigned int _idleReapingGeneration = 0;
     bool _dying;
   };
 }
@@ -0,0 +1,312 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include <qi/metrics.hpp>
+#include <qi/os.hpp>
+
+namespace qi
+{
+  namespace metrics
+  {
+    namespace
+    {
+      // Metrics of the same name share their type and help.
+      struct Family
+      {
+        MetricType type;
+        std::string help;
+        std::map<Labels, std::unique_ptr<Counter>> counters;
+        std::map<Labels, std::unique_ptr<Gauge>> gauges;
+        std::map<Labels, std::unique_ptr<Histogram>> histograms;
+        // Gauges with the same labels, such as the ones of event loops with
+        // the same name, are summed.
+        std::multimap<Labels, std::pair<std::uint64_t, boost::function<double()>>> gaugeFunctions;
+      };
+
+      class Registry
+      {
+      public:
+        std::mutex mutex;
+        std::map<std::string, Family> families;
+        std::uint64_t nextGaugeFunctionId = 1;
+
+        // Must be called with the mutex locked.
+        Family& family(const std::string& name, const std::string& help, MetricType type)
+        {
+          auto it = families.find(name);
+          if (it == families.end())
+          {
+            it = families.emplace(name, Family()).first;
+            it->second.type = type;
+            it->second.help = help;
+          }
+          else if (it->second.type != type)
+            throw std::runtime_error("Metric " + name + " already exists with another type");
+          return it->second;
+        }
+      };
+
+      Registry& registry()
+      {
+        // Never destroyed: metrics may be updated by static objects being
+        // destroyed.
+        static Registry* const instance = new Registry;
+        return *instance;
+      }
+
+      template <typename Metric>
+      Metric& getOrCreate(std::map<Labels, std::unique_ptr<Metric>>& metrics, const Labels& labels)
+      {
+        auto& metric = metrics[labels];
+        if (!metric)
+          metric.reset(new Metric);
+        return *metric;
+      }
+
+      double seconds(Duration duration)
+      {
+        return static_cast<double>(duration.count()) / 1e9;
+      }
+
+      std::string escape(const std::string& value)
+      {
+        std::string result;
+        result.reserve(value.size());
+        for (const auto c : value)
+        {
+          switch (c)
+          {
+            case '\\': result += "\\\\"; break;
+            case '"':  result += "\\\""; break;
+            case '\n': result += "\\n"; break;
+            default:   result += c;
+          }
+        }
+        return result;
+      }
+
+      // Write `{a="1",b="2"}`, with `extra` as the last label if not empty.
+      void writeLabels(std::ostream& out, const Labels& labels, const std::string& extra = std::string())
+      {
+        if (labels.empty() && extra.empty())
+          return;
+        out << '{';
+        bool first = true;
+        for (const auto& label : labels)
+        {
+          if (!first)
+            out << ',';
+          first = false;
+          out << label.first << "=\"" << escape(label.second) << '"';
+        }
+        if (!extra.empty())
+          out << (first ? "" : ",") << extra;
+        out << '}';
+      }
+
+      const char* typeName(int type)
+      {
+        switch (type)
+        {
+          case MetricType_Counter:   return "counter";
+          case MetricType_Gauge:     return "gauge";
+          case MetricType_Histogram: return "histogram";
+        }
+        return "untyped";
+      }
+
+      void writeHistogram(std::ostream& out, const MetricSample& sample)
+      {
+        static const double bounds[] = { 1e-6, 1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1, 10 };
+        const auto& buckets = sample.histogram.buckets();
+        std::size_t bucket = 0;
+        std::uint64_t cumulated = 0;
+        for (const auto bound : bounds)
+        {
+          for (; bucket < buckets.size()
+                 && seconds(LatencyHistogram::bucketUpperBound(static_cast<unsigned int>(bucket))) <= bound;
+               ++bucket)
+            cumulated += buckets[bucket];
+          std::ostringstream le;
+          le << "le=\"" << bound << '"';
+          out << sample.name << "_bucket";
+          writeLabels(out, sample.labels, le.str());
+          out << ' ' << cumulated << '\n';
+        }
+        const auto count = sample.histogram.count();
+        out << sample.name << "_bucket";
+        writeLabels(out, sample.labels, "le=\"+Inf\"");
+        out << ' ' << count << '\n';
+        out << sample.name << "_sum";
+        writeLabels(out, sample.labels);
+        out << ' ' << sample.value << '\n';
+        out << sample.name << "_count";
+        writeLabels(out, sample.labels);
+        out << ' ' << count << '\n';
+      }
+    }
+
+    namespace detail
+    {
+      std::atomic<bool>& enabledFlag()
+      {
+        static std::atomic<bool> enabled([] {
+          const auto value = qi::os::getenv("QI_METRICS");
+          return !value.empty() && value != "0";
+        }());
+        return enabled;
+      }
+    }
+
+    void setEnabled(bool enabled)
+    {
+      detail::enabledFlag().store(enabled, std::memory_order_relaxed);
+    }
+
+    Histogram::Histogram()
+      : _sum(0)
+    {
+      for (auto& bucket : _buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram Histogram::snapshot() const
+    {
+      std::vector<std::uint64_t> buckets(LatencyHistogram::BucketCount);
+      std::size_t used = 0;
+      for (std::size_t i = 0; i < buckets.size(); ++i)
+      {
+        buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        if (buckets[i])
+          used = i + 1;
+      }
+      buckets.resize(used);
+      return LatencyHistogram(std::move(buckets));
+    }
+
+    Counter& counter(const std::string& name, const std::string& help, const Labels& labels)
+    {
+      auto& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return getOrCreate(r.family(name, help, MetricType_Counter).counters, labels);
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels)
+    {
+      auto& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return getOrCreate(r.family(name, help, MetricType_Gauge).gauges, labels);
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels)
+    {
+      auto& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      return getOrCreate(r.family(name, help, MetricType_Histogram).histograms, labels);
+    }
+
+    GaugeFunction::GaugeFunction(const std::string& name, const std::string& help,
+                                 const Labels& labels, boost::function<double()> read)
+    {
+      auto& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      auto& family = r.family(name, help, MetricType_Gauge);
+      if (family.gauges.count(labels))
+        throw std::runtime_error("Gauge " + name + " already exists with the same labels");
+      _id = r.nextGaugeFunctionId++;
+      family.gaugeFunctions.emplace(labels, std::make_pair(_id, std::move(read)));
+    }
+
+    GaugeFunction::~GaugeFunction()
+    {
+      auto& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      for (auto& family : r.families)
+      {
+        auto& functions = family.second.gaugeFunctions;
+        const auto it = std::find_if(functions.begin(), functions.end(),
+            [&](const decltype(*functions.begin())& f) { return f.second.first == _id; });
+        if (it != functions.end())
+        {
+          functions.erase(it);
+          return;
+        }
+      }
+    }
+
+    std::vector<MetricSample> collect()
+    {
+      std::vector<MetricSample> samples;
+      auto& r = registry();
+      // The gauge functions are called with the registry locked, so that the
+      // objects they read cannot unregister them meanwhile.
+      std::lock_guard<std::mutex> lock(r.mutex);
+      for (const auto& entry : r.families)
+      {
+        const auto& name = entry.first;
+        const auto& family = entry.second;
+        const auto first = samples.size();
+        for (const auto& c : family.counters)
+          samples.emplace_back(name, family.help, family.type, c.first,
+                               static_cast<double>(c.second->value()), LatencyHistogram());
+        for (const auto& g : family.gauges)
+          samples.emplace_back(name, family.help, family.type, g.first,
+                               static_cast<double>(g.second->value()), LatencyHistogram());
+        for (auto it = family.gaugeFunctions.begin(); it != family.gaugeFunctions.end();)
+        {
+          const auto& labels = it->first;
+          double value = 0;
+          for (; it != family.gaugeFunctions.end() && it->first == labels; ++it)
+            value += it->second.second();
+          samples.emplace_back(name, family.help, family.type, labels, value, LatencyHistogram());
+        }
+        for (const auto& h : family.histograms)
+          samples.emplace_back(name, family.help, family.type, h.first,
+                               seconds(h.second->sum()), h.second->snapshot());
+        std::sort(samples.begin() + first, samples.end(),
+                  [](const MetricSample& a, const MetricSample& b) { return a.labels < b.labels; });
+      }
+      return samples;
+    }
+
+    void writePrometheusText(std::ostream& out)
+    {
+      const auto samples = collect();
+      const auto precision = out.precision(17);
+      const std::string* previous = nullptr;
+      for (const auto& sample : samples)
+      {
+        if (!previous || *previous != sample.name)
+        {
+          out << "# HELP " << sample.name << ' ' << sample.help << '\n'
+              << "# TYPE " << sample.name << ' ' << typeName(sample.type) << '\n';
+          previous = &sample.name;
+        }
+        if (sample.type == MetricType_Histogram)
+        {
+          writeHistogram(out, sample);
+          continue;
+        }
+        out << sample.name;
+        writeLabels(out, sample.labels);
+        out << ' ' << sample.value << '\n';
+      }
+      out.precision(precision);
+    }
+
+    std::string prometheusText()
+    {
+      std::ostringstream out;
+      writePrometheusText(out);
+      return out.str();
+    }
+  }
+}
@@ -400,6 +400,25 @@ namespace qi {
       return sysconf(_SC_NPROCESSORS_CONF);
     }
 
+    int numaNodeOfCPU(int cpu)
+    {
+     #if defined (__linux__) && !defined(ANDROID)
+      // The directory of a CPU holds a "nodeN" link to its NUMA node.
+      const boost::filesystem::path dir("/sys/devices/system/cpu/cpu" + std::to_string(cpu));
+      boost::system::error_code ec;
+      for (boost::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+      {
+        const std::string name = it->path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0
+            && name.find_first_not_of("0123456789", 4) == std::string::npos)
+          return std::stoi(name.substr(4));
+      }
+     #else
+      QI_IGNORE_UNUSED(cpu);
+     #endif
+      return -1;
+    }
+
     //true on success
     bool setCurrentThreadCPUAffinity(const std::vector<int> &cpus) {
      #if defined (__linux__) && !defined(ANDROID)
@@ -495,6 +495,14 @@ namespace qi {
       return info.dwNumberOfProcessors;
     }
 
+    int numaNodeOfCPU(int cpu)
+    {
+      UCHAR node = 0;
+      if (cpu < 0 || cpu > 255 || !GetNumaProcessorNode(static_cast<UCHAR>(cpu), &node) || node == 0xFF)
+        return -1;
+      return node;
+    }
+
     bool setCurrentThreadCPUAffinity(const std::vector<int> &cpus) {
 
       if (cpus.size() == 0)
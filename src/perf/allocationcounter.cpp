@@ -0,0 +1,48 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <atomic>
+
+#include <qi/perf/allocationcounter.hpp>
+
+namespace qi
+{
+  namespace perf
+  {
+    namespace
+    {
+      // Constant initialized: operator new may be called before any dynamic
+      // initialization.
+      std::atomic<bool> countingEnabled{ false };
+      std::atomic<std::uint64_t> allocations{ 0 };
+      std::atomic<std::uint64_t> allocatedBytes{ 0 };
+    }
+
+    AllocationCount allocationCount()
+    {
+      return AllocationCount{ allocations.load(std::memory_order_relaxed),
+                              allocatedBytes.load(std::memory_order_relaxed) };
+    }
+
+    bool isAllocationCountingEnabled()
+    {
+      return countingEnabled.load(std::memory_order_relaxed);
+    }
+
+    namespace detail
+    {
+      void enableAllocationCounting() noexcept
+      {
+        countingEnabled.store(true, std::memory_order_relaxed);
+      }
+
+      void countAllocation(std::size_t size) noexcept
+      {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+      }
+    }
+  }
+}
@@ -0,0 +1,465 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include <qi/perf/benchmark.hpp>
+#include <qi/perf/allocationcounter.hpp>
+#include <qi/jsoncodec.hpp>
+#include <qi/anyvalue.hpp>
+
+namespace qi
+{
+  namespace perf
+  {
+    class BenchmarkPrivate
+    {
+    public:
+      std::string suiteName;
+      BenchmarkOptions options;
+      std::vector<BenchmarkResult> results;
+    };
+
+    namespace
+    {
+      double nanoseconds(qi::SteadyClock::duration d)
+      {
+        return static_cast<double>(boost::chrono::duration_cast<qi::NanoSeconds>(d).count());
+      }
+
+      // Run `trial` with an increasing number of iterations until it lasts
+      // at least `minDuration`, or up to `maxIterations` for trials whose
+      // duration does not depend on the number of iterations.
+      unsigned long calibrate(const boost::function<void(unsigned long)>& trial,
+                              qi::Duration minDuration)
+      {
+        const double maxIterations = 1e9;
+        const double minNs = nanoseconds(minDuration);
+        unsigned long iterations = 1;
+        while (true)
+        {
+          const auto start = qi::SteadyClock::now();
+          trial(iterations);
+          const double elapsed = nanoseconds(qi::SteadyClock::now() - start);
+          if (elapsed >= minNs || iterations >= maxIterations)
+            return iterations;
+          // Aim slightly over the minimum, growing by 2 to 10 times per step.
+          const double factor = elapsed > 0 ? minNs * 1.2 / elapsed : 10.0;
+          iterations = static_cast<unsigned long>(std::min(
+              maxIterations, std::ceil(iterations * std::min(10.0, std::max(2.0, factor)))));
+        }
+      }
+
+      // Nearest-rank percentile of sorted samples.
+      double percentile(const std::vector<double>& sorted, double q)
+      {
+        const auto rank = static_cast<std::size_t>(std::ceil(q * sorted.size()));
+        return sorted[rank == 0 ? 0 : rank - 1];
+      }
+
+      // Percentiles are only computed if the samples are those of single
+      // iterations.
+      void computeStatistics(BenchmarkResult& result, bool perIteration)
+      {
+        auto& samples = result.samples;
+        if (samples.empty())
+          return;
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+        const double n = static_cast<double>(sorted.size());
+        result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / n;
+        double squares = 0;
+        for (const auto sample : sorted)
+          squares += (sample - result.mean) * (sample - result.mean);
+        result.stddev = sorted.size() > 1 ? std::sqrt(squares / (n - 1)) : 0;
+        result.min = sorted.front();
+        result.max = sorted.back();
+        result.median = percentile(sorted, 0.5);
+        if (perIteration)
+        {
+          result.p90 = percentile(sorted, 0.9);
+          result.p99 = percentile(sorted, 0.99);
+        }
+      }
+
+      void print(const BenchmarkResult& r)
+      {
+        const auto flags = std::cout.flags();
+        const auto precision = std::cout.precision();
+        std::cout << r.name;
+        if (!r.variable.empty())
+          std::cout << "-" << r.variable;
+        std::cout << ": " << std::fixed << std::setprecision(1)
+                  << r.median << " ns (+/- " << r.stddev << "), ";
+        if (r.p90 >= 0)
+          std::cout << "p90 " << r.p90 << " ns, p99 " << r.p99 << " ns, ";
+        std::cout << std::setprecision(0) << r.iterationsPerSecond() << " it/s";
+        if (r.bytesPerIteration)
+          std::cout << ", " << std::setprecision(2) << r.megaBytesPerSecond() << " MB/s";
+        std::cout << ", " << std::setprecision(1) << r.cpuRatio * 100 << " % cpu";
+        if (r.allocationsPerIteration >= 0)
+          std::cout << ", " << std::setprecision(2) << r.allocationsPerIteration << " allocs/it";
+        std::cout << std::endl;
+        std::cout.flags(flags);
+        std::cout.precision(precision);
+      }
+
+      // Latency samples kept per benchmark. Beyond, only one iteration out of
+      // `latencyStride` is timed, so that the samples fit in memory whatever
+      // the number of iterations.
+      const double maxLatencySamples = 1 << 22;
+
+      unsigned long latencyStride(double iterations)
+      {
+        return static_cast<unsigned long>(std::max(1.0, std::ceil(iterations / maxLatencySamples)));
+      }
+
+      // Measures the wall clock time, CPU time and allocations of a run.
+      class RunMeasure
+      {
+      public:
+        RunMeasure()
+          : _allocations(allocationCount())
+          , _cpu(std::clock())
+          , _start(qi::SteadyClock::now())
+        {}
+
+        void stop(double& wallNs, double& cpuNs, AllocationCount& allocations)
+        {
+          const auto end = qi::SteadyClock::now();
+          const auto cpu = std::clock();
+          const auto endAllocations = allocationCount();
+          wallNs += nanoseconds(end - _start);
+          cpuNs += static_cast<double>(cpu - _cpu) * 1e9 / CLOCKS_PER_SEC;
+          allocations.count += endAllocations.count - _allocations.count;
+          allocations.bytes += endAllocations.bytes - _allocations.bytes;
+        }
+
+      private:
+        AllocationCount _allocations;
+        std::clock_t _cpu;
+        qi::SteadyClock::time_point _start;
+      };
+    }
+
+    double BenchmarkResult::iterationsPerSecond() const
+    {
+      // Each thread completes one iteration every `mean` nanoseconds.
+      return mean > 0 ? concurrency * 1e9 / mean : 0;
+    }
+
+    double BenchmarkResult::megaBytesPerSecond() const
+    {
+      if (!bytesPerIteration)
+        return -1;
+      return iterationsPerSecond() * bytesPerIteration / (1024.0 * 1024.0);
+    }
+
+    Benchmark::Benchmark(const std::string& suiteName, const BenchmarkOptions& options)
+      : _p(new BenchmarkPrivate)
+    {
+      _p->suiteName = suiteName;
+      _p->options = options;
+      if (_p->options.trials == 0)
+        _p->options.trials = 1;
+    }
+
+    Benchmark::~Benchmark()
+    {
+      delete _p;
+    }
+
+    bool Benchmark::run(const std::string& name,
+                        const boost::function<void(unsigned long)>& body,
+                        unsigned long bytesPerIteration,
+                        const std::string& variable)
+    {
+      const auto& options = _p->options;
+      if (name.find(options.filter) == std::string::npos)
+        return false;
+
+      BenchmarkResult result;
+      result.name = name;
+      result.variable = variable;
+      result.bytesPerIteration = bytesPerIteration;
+      result.iterations = options.iterations ? options.iterations
+                                             : calibrate(body, options.minTrialDuration);
+      for (unsigned int i = 0; i < options.warmupTrials; ++i)
+        body(result.iterations);
+
+      double wallNs = 0, cpuNs = 0;
+      AllocationCount allocations{ 0, 0 };
+      for (unsigned int i = 0; i < options.trials; ++i)
+      {
+        RunMeasure measure;
+        const double before = wallNs;
+        body(result.iterations);
+        measure.stop(wallNs, cpuNs, allocations);
+        result.samples.push_back((wallNs - before) / result.iterations);
+      }
+
+      const double totalIterations = static_cast<double>(result.iterations) * options.trials;
+      result.cpuRatio = wallNs > 0 ? cpuNs / wallNs : 0;
+      if (isAllocationCountingEnabled())
+      {
+        result.allocationsPerIteration = allocations.count / totalIterations;
+        result.allocatedBytesPerIteration = allocations.bytes / totalIterations;
+      }
+      computeStatistics(result, false);
+      print(result);
+      _p->results.push_back(std::move(result));
+      return true;
+    }
+
+    bool Benchmark::runLatency(const std::string& name,
+                               const boost::function<void()>& once,
+                               unsigned long bytesPerIteration,
+                               const std::string& variable)
+    {
+      const auto& options = _p->options;
+      if (name.find(options.filter) == std::string::npos)
+        return false;
+
+      const auto loop = [&](unsigned long n) {
+        for (unsigned long i = 0; i < n; ++i)
+          once();
+      };
+
+      BenchmarkResult result;
+      result.name = name;
+      result.variable = variable;
+      result.bytesPerIteration = bytesPerIteration;
+      result.iterations = options.iterations ? options.iterations
+                                             : calibrate(loop, options.minTrialDuration);
+      for (unsigned int i = 0; i < options.warmupTrials; ++i)
+        loop(result.iterations);
+
+      double wallNs = 0, cpuNs = 0;
+      AllocationCount allocations{ 0, 0 };
+      const double totalIterations = static_cast<double>(result.iterations) * options.trials;
+      const unsigned long stride = latencyStride(totalIterations);
+      result.samples.reserve(static_cast<std::size_t>(std::ceil(totalIterations / stride)));
+      for (unsigned int i = 0; i < options.trials; ++i)
+      {
+        RunMeasure measure;
+        for (unsigned long j = 0; j < result.iterations; ++j)
+        {
+          if (j % stride != 0)
+          {
+            once();
+            continue;
+          }
+          const auto start = qi::SteadyClock::now();
+          once();
+          result.samples.push_back(nanoseconds(qi::SteadyClock::now() - start));
+        }
+        measure.stop(wallNs, cpuNs, allocations);
+      }
+
+      result.cpuRatio = wallNs > 0 ? cpuNs / wallNs : 0;
+      if (isAllocationCountingEnabled())
+      {
+        result.allocationsPerIteration = allocations.count / totalIterations;
+        result.allocatedBytesPerIteration = allocations.bytes / totalIterations;
+      }
+      computeStatistics(result, true);
+      print(result);
+      _p->results.push_back(std::move(result));
+      return true;
+    }
+
+    bool Benchmark::runConcurrentLatency(const std::string& name,
+                                         unsigned int concurrency,
+                                         const boost::function<void(unsigned int)>& once,
+                                         unsigned long bytesPerIteration,
+                                         const std::string& variable)
+    {
+      const auto& options = _p->options;
+      if (name.find(options.filter) == std::string::npos)
+        return false;
+      if (concurrency == 0)
+        concurrency = 1;
+
+      // Run `n` iterations in each thread, appending the duration of one
+      // iteration out of `stride` to `samples` if it is not null.
+      unsigned long stride = 1;
+      const auto runThreads = [&](unsigned long n, std::vector<double>* samples) {
+        std::vector<std::vector<double>> threadSamples(concurrency);
+        std::vector<std::thread> threads;
+        threads.reserve(concurrency);
+        for (unsigned int t = 0; t < concurrency; ++t)
+          threads.emplace_back([&, t] {
+            auto& mine = threadSamples[t];
+            if (samples)
+              mine.reserve(n / stride + 1);
+            for (unsigned long i = 0; i < n; ++i)
+            {
+              if (!samples || i % stride != 0)
+              {
+                once(t);
+                continue;
+              }
+              const auto start = qi::SteadyClock::now();
+              once(t);
+              mine.push_back(nanoseconds(qi::SteadyClock::now() - start));
+            }
+          });
+        for (auto& thread : threads)
+          thread.join();
+        if (samples)
+          for (const auto& mine : threadSamples)
+            samples->insert(samples->end(), mine.begin(), mine.end());
+      };
+      const auto loop = [&](unsigned long n) { runThreads(n, nullptr); };
+
+      BenchmarkResult result;
+      result.name = name;
+      result.variable = variable;
+      result.bytesPerIteration = bytesPerIteration;
+      result.concurrency = concurrency;
+      result.iterations = options.iterations ? options.iterations
+                                             : calibrate(loop, options.minTrialDuration);
+      for (unsigned int i = 0; i < options.warmupTrials; ++i)
+        loop(result.iterations);
+
+      double wallNs = 0, cpuNs = 0;
+      AllocationCount allocations{ 0, 0 };
+      const double totalIterations =
+          static_cast<double>(result.iterations) * options.trials * concurrency;
+      stride = latencyStride(totalIterations);
+      result.samples.reserve(static_cast<std::size_t>(std::ceil(totalIterations / stride)));
+      for (unsigned int i = 0; i < options.trials; ++i)
+      {
+        RunMeasure measure;
+        runThreads(result.iterations, &result.samples);
+        measure.stop(wallNs, cpuNs, allocations);
+      }
+
+      result.cpuRatio = wallNs > 0 ? cpuNs / wallNs : 0;
+      if (isAllocationCountingEnabled())
+      {
+        result.allocationsPerIteration = allocations.count / totalIterations;
+        result.allocatedBytesPerIteration = allocations.bytes / totalIterations;
+      }
+      computeStatistics(result, true);
+      print(result);
+      _p->results.push_back(std::move(result));
+      return true;
+    }
+
+    const std::vector<BenchmarkResult>& Benchmark::results() const
+    {
+      return _p->results;
+    }
+
+    void Benchmark::writeJson(std::ostream& out) const
+    {
+      out << "{\"suite\":" << qi::encodeJSON(_p->suiteName) << ",\"results\":[";
+      bool first = true;
+      out << std::setprecision(17);
+      for (const auto& r : _p->results)
+      {
+        if (!first)
+          out << ',';
+        first = false;
+        out << "\n{\"name\":" << qi::encodeJSON(r.name)
+            << ",\"variable\":" << qi::encodeJSON(r.variable)
+            << ",\"iterations\":" << r.iterations
+            << ",\"bytesPerIteration\":" << r.bytesPerIteration
+            << ",\"concurrency\":" << r.concurrency
+            << ",\"samples\":" << r.samples.size()
+            << ",\"mean\":" << r.mean
+            << ",\"stddev\":" << r.stddev
+            << ",\"min\":" << r.min
+            << ",\"median\":" << r.median
+            << ",\"p90\":" << r.p90
+            << ",\"p99\":" << r.p99
+            << ",\"max\":" << r.max
+            << ",\"cpuRatio\":" << r.cpuRatio
+            << ",\"allocationsPerIteration\":" << r.allocationsPerIteration
+            << ",\"allocatedBytesPerIteration\":" << r.allocatedBytesPerIteration
+            << "}";
+      }
+      out << "\n]}\n";
+    }
+
+    std::vector<BenchmarkResult> Benchmark::readBaseline(std::istream& in)
+    {
+      using Object = std::map<std::string, qi::AnyValue>;
+      const std::string json{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+      std::vector<BenchmarkResult> results;
+      try
+      {
+        const auto root = qi::decodeJSON(json).to<Object>();
+        const auto it = root.find("results");
+        if (it == root.end())
+          throw std::runtime_error("no \"results\" member");
+        for (const auto& entry : it->second.to<std::vector<Object>>())
+        {
+          const auto number = [&](const char* key, double missing = 0.0) {
+            const auto field = entry.find(key);
+            return field == entry.end() ? missing : field->second.to<double>();
+          };
+          BenchmarkResult r;
+          r.name = entry.at("name").to<std::string>();
+          r.variable = entry.at("variable").to<std::string>();
+          r.iterations = static_cast<unsigned long>(number("iterations"));
+          r.bytesPerIteration = static_cast<unsigned long>(number("bytesPerIteration"));
+          r.concurrency = std::max(1u, static_cast<unsigned int>(number("concurrency")));
+          r.mean = number("mean");
+          r.stddev = number("stddev");
+          r.min = number("min");
+          r.median = number("median");
+          r.p90 = number("p90", -1);
+          r.p99 = number("p99", -1);
+          r.max = number("max");
+          r.cpuRatio = number("cpuRatio");
+          r.allocationsPerIteration = number("allocationsPerIteration");
+          r.allocatedBytesPerIteration = number("allocatedBytesPerIteration");
+          results.push_back(std::move(r));
+        }
+      }
+      catch (const std::exception& e)
+      {
+        throw std::runtime_error(std::string("Invalid benchmark results: ") + e.what());
+      }
+      return results;
+    }
+
+    std::vector<Regression> Benchmark::compare(const std::vector<BenchmarkResult>& baseline,
+                                               double threshold) const
+    {
+      std::vector<Regression> regressions;
+      for (const auto& r : _p->results)
+      {
+        const auto base = std::find_if(baseline.begin(), baseline.end(), [&](const BenchmarkResult& b) {
+          return b.name == r.name && b.variable == r.variable;
+        });
+        if (base == baseline.end())
+          continue;
+        const bool slower = r.median > base->median * (1 + threshold);
+        // Allocation counts are deterministic: any increase is a regression,
+        // within rounding of the amortized ones.
+        const bool allocatesMore = r.allocationsPerIteration >= 0
+                                && base->allocationsPerIteration >= 0
+                                && r.allocationsPerIteration > base->allocationsPerIteration + 0.5;
+        if (slower || allocatesMore)
+          regressions.push_back(Regression{ r.name, r.variable, base->median, r.median,
+                                            base->allocationsPerIteration,
+                                            r.allocationsPerIteration });
+      }
+      return regressions;
+    }
+  }
+}
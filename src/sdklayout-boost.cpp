@@ -4,10 +4,16 @@
  * found in the COPYING file.
  */
 
+#include <ctime>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <numeric>
+#include <unordered_map>
 
 #include <qi/application.hpp>
+#include <qi/atomic.hpp>
+#include <qi/clock.hpp>
 #include <qi/path.hpp>
 #include <qi/os.hpp>
 #include <qi/log.hpp>
@@ -17,6 +23,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/predef/os.h>
 #include <boost/regex.hpp>
+#include <boost/thread/mutex.hpp>
 #include <locale>
 #include <set>
 #include "sdklayout.hpp"
@@ -62,6 +69,312 @@ std::string relative(
   return relative.string(qi::unicodeFacet());
 }
 
+/*
+ * Remembers the entries of the directories looked up by SDKLayout, so that
+ * finding or listing files in the sdk prefixes does not hit the filesystem for
+ * every candidate name.
+ *
+ * Lookups stat the names they are asked for, and remember the answer.
+ * Listings take the type of the entries from the directory iteration, and only
+ * stat symbolic links. What is known about a directory is checked against its
+ * modification time, which creating, removing or renaming an entry updates.
+ * That costs a stat of the directory, so it is done at most once per
+ * `checkPeriod`: in between, the index is trusted, and changes made meanwhile
+ * may be seen up to `checkPeriod` late. The user writable directories are not
+ * indexed, so that the files the process writes there are found right away.
+ *
+ * The index is bounded: directories and listings too big to be worth keeping
+ * are looked up again each time.
+ */
+class DirectoryIndex
+{
+public:
+  enum class EntryType
+  {
+    Missing, // also broken symbolic links
+    File,
+    Directory,
+    DirectorySymlink,
+  };
+
+  static DirectoryIndex& instance()
+  {
+    static DirectoryIndex* index = nullptr;
+    QI_THREADSAFE_NEW(index);
+    return *index;
+  }
+
+  // Do not index `dir` nor the directories below it.
+  void addWritableRoot(const boost::filesystem::path& dir)
+  {
+    if (!dir.is_absolute())
+      return;
+    std::string key = dir.string(qi::unicodeFacet());
+    while (key.size() > 1 && (key.back() == '/'
+                              || key.back() == boost::filesystem::path::preferred_separator))
+      key.pop_back();
+    boost::mutex::scoped_lock lock(_mutex);
+    _writableRoots.insert(key);
+  }
+
+  // Look up the entry at `path`.
+  EntryType find(const boost::filesystem::path& path)
+  {
+    const boost::filesystem::path name = path.filename();
+    const boost::filesystem::path dir = path.parent_path();
+    if (name.empty() || name == "." || name == ".." || !dir.is_absolute())
+      return stat(path);
+
+    const std::string key = dir.string(qi::unicodeFacet());
+    const std::string nameKey = name.string(qi::unicodeFacet());
+    const qi::SteadyClock::time_point now = qi::SteadyClock::now();
+    EntryType type;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      if (isWritable(key))
+        return stat(path);
+      const auto it = _listings.find(key);
+      if (it != _listings.end() && recentlyChecked(it->second, now)
+          && lookup(it->second, nameKey, type))
+        return type;
+    }
+
+    boost::system::error_code ec;
+    const std::time_t mtime = boost::filesystem::last_write_time(dir, ec);
+    if (ec)
+      return stat(path);
+
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      const auto it = _listings.find(key);
+      if (it != _listings.end() && it->second.mtime == mtime)
+      {
+        it->second.checkedAt = now;
+        if (lookup(it->second, nameKey, type))
+          return type;
+      }
+    }
+
+    type = stat(path);
+    if (settled(mtime))
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      Listing& listing = listingToUpdate(key, mtime, now);
+      if (listing.entries.size() < maxEntries)
+        listing.entries[nameKey] = type;
+    }
+    return type;
+  }
+
+  // Append the files below `dir` to `files`, without following symbolic links
+  // to directories.
+  void listFiles(const boost::filesystem::path& dir, std::vector<boost::filesystem::path>& files)
+  {
+    Entries entries;
+    if (!list(dir, entries))
+      return;
+    for (const auto& nameType : entries)
+    {
+      const boost::filesystem::path path = dir / boost::filesystem::path(nameType.first, qi::unicodeFacet());
+      if (nameType.second == EntryType::File)
+        files.push_back(path);
+      else if (nameType.second == EntryType::Directory)
+        listFiles(path, files);
+    }
+  }
+
+private:
+  using Entries = std::map<std::string, EntryType>;
+
+  struct Listing
+  {
+    std::time_t mtime = 0;
+    // When `mtime` was last compared to the one of the directory.
+    qi::SteadyClock::time_point checkedAt;
+    Entries entries;
+    // Whether `entries` holds every entry of the directory.
+    bool complete = false;
+  };
+
+  static const std::size_t maxDirectories = 1024;
+  static const std::size_t maxEntries = 4096;
+
+  static qi::Duration checkPeriod()
+  {
+    return qi::Seconds{ 1 };
+  }
+
+  static bool recentlyChecked(const Listing& listing, qi::SteadyClock::time_point now)
+  {
+    return now - listing.checkedAt < checkPeriod();
+  }
+
+  // Find `name` in `listing`, return whether it knows its type.
+  static bool lookup(const Listing& listing, const std::string& name, EntryType& type)
+  {
+    const auto entry = listing.entries.find(name);
+    if (entry != listing.entries.end())
+    {
+      type = entry->second;
+      return true;
+    }
+#if !BOOST_OS_WINDOWS && !BOOST_OS_MACOS
+    // Names are compared the way the filesystem does: a complete listing
+    // knows the missing ones too.
+    if (listing.complete)
+    {
+      type = EntryType::Missing;
+      return true;
+    }
+#endif
+    return false;
+  }
+
+  // A directory modified during the current second may change again without
+  // its modification time changing: only keep what is known of settled ones.
+  static bool settled(std::time_t mtime)
+  {
+    return mtime < std::time(nullptr) - 1;
+  }
+
+  static EntryType stat(const boost::filesystem::path& path)
+  {
+    boost::system::error_code ec;
+    const auto status = boost::filesystem::status(path, ec);
+    if (!boost::filesystem::exists(status))
+      return EntryType::Missing;
+    return boost::filesystem::is_directory(status) ? EntryType::Directory : EntryType::File;
+  }
+
+  // Must be called with the mutex locked.
+  bool isWritable(const std::string& key) const
+  {
+    for (const auto& root : _writableRoots)
+    {
+      if (key.compare(0, root.size(), root) == 0
+          && (key.size() == root.size()
+              || key[root.size()] == boost::filesystem::path::preferred_separator
+              || key[root.size()] == '/'))
+        return true;
+    }
+    return false;
+  }
+
+  // Must be called with the mutex locked.
+  Listing& listingToUpdate(const std::string& key, std::time_t mtime,
+                           qi::SteadyClock::time_point now)
+  {
+    if (_listings.size() >= maxDirectories && _listings.count(key) == 0)
+      _listings.clear();
+    Listing& listing = _listings[key];
+    if (listing.mtime != mtime)
+    {
+      listing = Listing();
+      listing.mtime = mtime;
+    }
+    listing.checkedAt = now;
+    return listing;
+  }
+
+  // Get every entry of `dir`, return whether it could be listed.
+  bool list(const boost::filesystem::path& dir, Entries& entries)
+  {
+    // Relative paths depend on the current directory, do not keep them.
+    bool cacheable = dir.is_absolute();
+    const std::string key = dir.string(qi::unicodeFacet());
+    const qi::SteadyClock::time_point now = qi::SteadyClock::now();
+    if (cacheable)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      cacheable = !isWritable(key);
+    }
+    if (cacheable)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      const auto it = _listings.find(key);
+      if (it != _listings.end() && it->second.complete && recentlyChecked(it->second, now))
+      {
+        entries = it->second.entries;
+        return true;
+      }
+    }
+
+    boost::system::error_code ec;
+    const std::time_t mtime = boost::filesystem::last_write_time(dir, ec);
+    if (ec)
+      return false;
+
+    if (cacheable)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      const auto it = _listings.find(key);
+      if (it != _listings.end() && it->second.mtime == mtime && it->second.complete)
+      {
+        it->second.checkedAt = now;
+        entries = it->second.entries;
+        return true;
+      }
+    }
+
+    boost::filesystem::directory_iterator it(dir, ec);
+    if (ec)
+    {
+      if (ec != boost::system::errc::no_such_file_or_directory
+          && ec != boost::system::errc::not_a_directory)
+        qiLogError() << "Cannot list directory '" << key << "': " << ec.message();
+      return false;
+    }
+    try
+    {
+      for (; it != boost::filesystem::directory_iterator(); ++it)
+      {
+        // The type of the entry comes with the iteration on most systems, only
+        // symbolic links need to be resolved.
+        boost::system::error_code statusEc;
+        const auto symlinkStatus = it->symlink_status(statusEc);
+        EntryType type = boost::filesystem::is_directory(symlinkStatus) ? EntryType::Directory
+                                                                        : EntryType::File;
+        if (boost::filesystem::is_symlink(symlinkStatus))
+        {
+          const auto status = it->status(statusEc);
+          type = !boost::filesystem::exists(status) ? EntryType::Missing
+               : boost::filesystem::is_directory(status) ? EntryType::DirectorySymlink
+               : EntryType::File;
+        }
+        entries[it->path().filename().string(qi::unicodeFacet())] = type;
+      }
+    }
+    catch (const boost::filesystem::filesystem_error& e)
+    {
+      qiLogError() << e.what();
+      return false;
+    }
+
+    if (cacheable && settled(mtime) && entries.size() <= maxEntries)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      Listing& listing = listingToUpdate(key, mtime, now);
+      listing.entries = entries;
+      listing.complete = true;
+    }
+    return true;
+  }
+
+  boost::mutex _mutex;
+  std::unordered_map<std::string, Listing> _listings;
+  std::set<std::string> _writableRoots;
+};
+
+bool pathExists(const boost::filesystem::path& path)
+{
+  return DirectoryIndex::instance().find(path) != DirectoryIndex::EntryType::Missing;
+}
+
+bool fileExists(const boost::filesystem::path& path)
+{
+  return DirectoryIndex::instance().find(path) == DirectoryIndex::EntryType::File;
+}
+
 } // anonymous
 
 namespace qi {
@@ -223,6 +536,9 @@ namespace detail {
         }
       }
 
+      DirectoryIndex::instance().addWritableRoot(
+          boost::filesystem::path(fsconcat(prefix), qi::unicodeFacet()));
+
       boost::filesystem::path path;
       path = boost::filesystem::path(fsconcat(prefix, applicationName, filename),
                                      qi::unicodeFacet());
@@ -317,8 +633,7 @@ namespace detail {
                                              qi::unicodeFacet());
       const boost::filesystem::path pathFileSysComplete(boost::filesystem::system_complete(pathFile));
 
-      if (boost::filesystem::exists(pathFileSysComplete)
-          && !boost::filesystem::is_directory(pathFileSysComplete))
+      if (fileExists(pathFileSysComplete))
         return (pathFileSysComplete.string(qi::unicodeFacet()));
     }
     catch (const boost::filesystem::filesystem_error &e)
@@ -524,7 +839,7 @@ namespace detail {
         qiLogVerbose() << "Looking conf in " << *it;
         boost::filesystem::path p(fsconcat(*it, filename), qi::unicodeFacet());
 
-        if (boost::filesystem::exists(p))
+        if (pathExists(p))
           return p.string(qi::unicodeFacet());
       }
     }
@@ -547,7 +862,7 @@ namespace detail {
       {
         boost::filesystem::path p(fsconcat(*it, filename), qi::unicodeFacet());
 
-        if (boost::filesystem::exists(p))
+        if (pathExists(p))
           return p.string(qi::unicodeFacet());
       }
     }
@@ -575,52 +890,25 @@ namespace detail {
       // Otherwise on Windows we might fail when trying to match
       // foo\data\model.txt with foo\data/*.txt (instead of foo\data\*.txt)
       boost::regex pathRegex(globToRegex(fsconcat(*it, pattern)));
-      try
+      // The directories made up by dataPaths() may not exist, which is
+      // expected: they are then skipped.
+      std::vector<boost::filesystem::path> files;
+      DirectoryIndex::instance().listFiles(dataPath, files);
+      for (const auto& file : files)
       {
-        boost::system::error_code ec;
-        boost::filesystem::recursive_directory_iterator itD(dataPath,
-            boost::filesystem::symlink_option::none, ec);
-        if (ec)
-        {
-          if (ec == boost::system::errc::no_such_file_or_directory)
-          {
-            // The directory made up by dataPaths() does not exist.
-            // This is expected. Continue with the next one.
-            continue;
-          }
-          else
-          {
-            // This error is truly not expected, throw it
-            throw boost::filesystem::filesystem_error(
-                "boost::filesystem::directory_iterator::construct", ec);
-          }
-        }
-        for (;
-             itD != boost::filesystem::recursive_directory_iterator(); // end
-             ++itD)
+        const std::string fullPath = file.string(qi::unicodeFacet());
+        if (boost::regex_match(fullPath, pathRegex))
         {
-          if (!boost::filesystem::is_directory(itD->path()))
+          std::string relativePath = ::relative(dataPath, file);
+          if (matchedPaths.find(relativePath) == matchedPaths.end())
           {
-            const std::string fullPath = itD->path().string(qi::unicodeFacet());
-            if (boost::regex_match(fullPath, pathRegex))
-            {
-              std::string relativePath = ::relative(dataPath, itD->path());
-              if (matchedPaths.find(relativePath) == matchedPaths.end())
-              {
-                // we only add the match if it was not found in a previous
-                // dataPath.
-                matchedPaths.insert(relativePath);
-                fullPaths.push_back(fullPath);
-              }
-            }
+            // we only add the match if it was not found in a previous
+            // dataPath.
+            matchedPaths.insert(relativePath);
+            fullPaths.push_back(fullPath);
           }
         }
       }
-      catch (const boost::filesystem::filesystem_error &e)
-      {
-        // log and continue
-        qiLogError() << e.what();
-      }
     }
     return fullPaths;
   }
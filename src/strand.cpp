@@ -12,6 +12,8 @@
 #include <qi/log.hpp>
 #include <qi/future.hpp>
 #include <qi/getenv.hpp>
+#include <qi/metrics.hpp>
+#include <qi/tracecontext.hpp>
 
 qiLogCategory("qi.strand");
 
@@ -19,6 +21,12 @@ namespace qi {
 
 namespace
 {
+  metrics::Gauge& queuedTasksMetric()
+  {
+    static auto& gauge = metrics::gauge("qi_strand_queued_tasks", "Tasks waiting in strands.");
+    return gauge;
+  }
+
   // Executes the callback immediately. This function returns a Future for consistency with the
   // async functions and simplicity of use. The future will be in error if the callback throws
   // an exception.
@@ -168,6 +176,21 @@ StrandPrivate::~StrandPrivate() {
     qiLogWarning() << "Error while joining tasks in StrandPrivate destruction. "
       "Detail: " << *error;
   }
+  // Tasks left if the strand was joined from one of its tasks.
+  if (_reportedQueuedTasks != 0)
+    queuedTasksMetric().sub(_reportedQueuedTasks);
+}
+
+// The process wide gauge is only updated while the metrics are enabled, so that
+// the strands do not contend on it otherwise. Disabling the metrics withdraws
+// the tasks of the strand at its next queue change.
+void StrandPrivate::reportQueuedTasks()
+{
+  const auto queued = metrics::isEnabled() ? static_cast<std::int64_t>(_queue.size()) : 0;
+  if (queued == _reportedQueuedTasks)
+    return;
+  queuedTasksMetric().add(queued - _reportedQueuedTasks);
+  _reportedQueuedTasks = queued;
 }
 
 void StrandPrivate::join() QI_NOEXCEPT(true)
@@ -209,6 +232,7 @@ void StrandPrivate::join() QI_NOEXCEPT(true)
     }
   }
   _queue.clear();
+  reportQueuedTasks();
 
   qiLogDebug() << "Strand joining (" << this << ") -> clearing deferred tasks...";
   _deferredTasksFutures.reset();
@@ -228,7 +252,7 @@ boost::shared_ptr<StrandPrivate::Callback> StrandPrivate::createCallback(boost::
   boost::shared_ptr<Callback> cbStruct = boost::make_shared<Callback>();
   cbStruct->id = ++_curId;
   cbStruct->state = State::None;
-  cbStruct->callback = std::move(cb);
+  cbStruct->callback = detail::bindTraceContext(std::move(cb));
   cbStruct->executionOptions = options;
   return cbStruct;
 }
@@ -266,6 +290,8 @@ Future<void> StrandPrivate::deferImpl(boost::function<void()> cb, qi::Duration d
   qiLogDebug() << "Deferring job id " << cbStruct->id << " in " << qi::to_string(delay);
   if (delay.count())
   {
+    // The callback carries the trace context: the internal tasks do not.
+    TraceContextScope noTrace{ TraceContext() };
     cbStruct->asyncFuture = _executor.asyncDelay(track([=]{
       enqueue(cbStruct, options);
     }), delay, options).then(ka::constant_function());
@@ -292,6 +318,7 @@ void StrandPrivate::enqueue(boost::shared_ptr<Callback> cbStruct, ExecutionOptio
 
     auto scheduleCallback = [&] {
       _queue.push_back(cbStruct);
+      reportQueuedTasks();
       cbStruct->state = State::Scheduled;
     };
 
@@ -333,6 +360,7 @@ void StrandPrivate::enqueue(boost::shared_ptr<Callback> cbStruct, ExecutionOptio
   if (shouldschedule)
   {
     qiLogDebug() << "StrandPrivate::process was not scheduled, doing it";
+    TraceContextScope noTrace{ TraceContext() };
     _executor.async(track([=]{ process(); }), options);
   }
 }
@@ -345,6 +373,7 @@ void StrandPrivate::stopProcess(boost::recursive_mutex::scoped_lock& lock,
   {
     qiLogDebug() << "Strand quantum expired, rescheduling";
     lock.unlock();
+    TraceContextScope noTrace{ TraceContext() };
     _executor.async(track([=] { process(); }));
   }
   else
@@ -386,6 +415,7 @@ void StrandPrivate::process()
       }
       cbStruct = _queue.front();
       _queue.pop_front();
+      reportQueuedTasks();
       if (cbStruct->state == State::Scheduled
       || (cbStruct->state == State::Canceled && cbStruct->executionOptions.onCancelRequested == CancelOption::NeverSkipExecution))
       {
@@ -454,6 +484,7 @@ void StrandPrivate::cancel(boost::shared_ptr<Callback> cbStruct)
           if ((*iter)->id == cbStruct->id)
           {
             _queue.erase(iter);
+            reportQueuedTasks();
             erased = true;
             break;
           }
@@ -0,0 +1,72 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <random>
+#include <thread>
+
+#include <qi/tracecontext.hpp>
+
+namespace qi
+{
+  namespace
+  {
+    thread_local TraceContext currentContext;
+
+    // Ids only need to be unique, not unpredictable: a generator per thread
+    // avoids any synchronization.
+    qi::uint64_t newId()
+    {
+      static thread_local std::mt19937_64 generator([] {
+        std::random_device device;
+        return (static_cast<qi::uint64_t>(device()) << 32) ^ device()
+             ^ std::hash<std::thread::id>()(std::this_thread::get_id());
+      }());
+      qi::uint64_t id;
+      do
+        id = generator();
+      while (id == 0); // 0 means no context
+      return id;
+    }
+  }
+
+  TraceContext TraceContext::child() const
+  {
+    TraceContext result;
+    result.traceId = isValid() ? traceId : newId();
+    result.spanId = newId();
+    result.parentSpanId = spanId;
+    return result;
+  }
+
+  TraceContext currentTraceContext()
+  {
+    return currentContext;
+  }
+
+  TraceContextScope::TraceContextScope(const TraceContext& context)
+    : _previous(currentContext)
+  {
+    currentContext = context;
+  }
+
+  TraceContextScope::~TraceContextScope()
+  {
+    currentContext = _previous;
+  }
+
+  namespace detail
+  {
+    boost::function<void()> bindTraceContext(boost::function<void()> f)
+    {
+      if (!currentContext.isValid())
+        return f;
+      const TraceContext context = currentContext;
+      return [=] {
+        TraceContextScope scope(context);
+        f();
+      };
+    }
+  }
+}
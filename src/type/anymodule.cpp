@@ -1,6 +1,10 @@
+#include <atomic>
+#include <set>
+
 #include <qi/anymodule.hpp>
 #include <qi/log.hpp>
 #include <qi/application.hpp>
+#include <qi/async.hpp>
 #include <qi/type/dynamicobjectbuilder.hpp>
 #include <qi/path.hpp>
 #include <ka/scoped.hpp>
@@ -24,19 +28,52 @@ namespace qi
 
   using AnyModuleMap = std::map<std::string, AnyModule>;
 
-  static boost::recursive_mutex* gMutexPkg      = NULL;
-  static boost::recursive_mutex* gMutexLoading  = NULL;
-  static AnyModuleMap*           gReadyPackages = NULL;
-
-  /// Language -> Factory Function
+  // An import in progress, that other imports of the same module join.
+  struct PendingImport
+  {
+    Future<AnyModule> module;
+    boost::thread::id thread;
+  };
+  using PendingImportMap = std::map<std::string, PendingImport>;
+  // Thread -> module whose import, in progress in another thread, it waits for.
+  using WaitingImportMap = std::map<boost::thread::id, std::string>;
+
+  static boost::recursive_mutex* gMutexPkg       = NULL;
+  static boost::recursive_mutex* gMutexLoading   = NULL;
+  static AnyModuleMap*           gReadyPackages  = NULL;
+  static PendingImportMap*       gPendingImports = NULL;
+  static WaitingImportMap*       gWaitingImports = NULL;
+
+  /// Language -> Factory Function, guarded by gMutexPkg.
   using ModuleFactoryMap = std::map<std::string, ModuleFactoryFunctor>;
   ModuleFactoryMap               gModuleFactory;
 
+  static void initModuleGlobals()
+  {
+    QI_ONCE(
+      gMutexPkg = new boost::recursive_mutex;
+      gMutexLoading = new boost::recursive_mutex;
+      gReadyPackages = new AnyModuleMap;
+      gPendingImports = new PendingImportMap;
+      gWaitingImports = new WaitingImportMap;
+    );
+  }
+
+  /*
+   * Load the module factory plugins, once. Callers block until the plugins
+   * have registered their factories, except the loading thread itself if a
+   * plugin imports a module.
+   */
   static void loadModuleFactoryPlugins() {
-    static bool loaded = false;
-    if (loaded)
+    static std::atomic<bool> loaded{ false };
+    if (loaded.load())
       return;
-    loaded = true;
+    boost::recursive_mutex::scoped_lock sl(*gMutexLoading);
+    static bool loading = false;
+    if (loading)
+      return;
+    loading = true;
+    auto done = ka::scoped([] { loaded.store(true); });
     std::vector<std::string> vs = qi::path::listLib("qi/plugins", "*qimodule_*_plugin*");
     for (unsigned i = 0; i < vs.size(); ++i) {
       qiLogVerbose() << "found module factory: '" << vs.at(i) << "'";
@@ -67,13 +104,8 @@ namespace qi
 
   static void initModuleFactory()
   {
-    if (!gMutexPkg)
-    {
-      gMutexPkg = new boost::recursive_mutex;
-      gMutexLoading = new boost::recursive_mutex;
-      gReadyPackages = new AnyModuleMap;
-      loadModuleFactoryPlugins();
-    }
+    initModuleGlobals();
+    loadModuleFactoryPlugins();
   }
 
   //convert . to /
@@ -100,6 +132,7 @@ namespace qi
 
   static void registerModuleInFactory(const AnyModule& module) {
     initModuleFactory();
+    boost::recursive_mutex::scoped_lock sl(*gMutexPkg);
     if (gReadyPackages->find(module.moduleName()) != gReadyPackages->end())
       throw std::runtime_error("module already registered: " + module.moduleName());
     qiLogVerbose() << "Registering module " << module.moduleName();
@@ -120,6 +153,10 @@ namespace qi
 
   bool registerModuleFactory(const std::string& name, ModuleFactoryFunctor fun)
   {
+    // Also called by static initializers and by the plugins being loaded:
+    // it must not load the plugins.
+    initModuleGlobals();
+    boost::recursive_mutex::scoped_lock sl(*gMutexPkg);
     gModuleFactory[name] = fun;
     return true;
   }
@@ -141,49 +178,145 @@ namespace qi
     return mi;
   }
 
-  static AnyModule findModuleInFactory(const std::string& name) {
+  /*
+   * Whether waiting for the import of `name` would wait for `thread`: the
+   * import is in progress in `thread`, or in a thread waiting for an import
+   * in progress in `thread`, and so on. Must be called with gMutexPkg locked.
+   */
+  static bool importWaitsFor(const std::string& name, boost::thread::id thread) {
+    std::set<boost::thread::id> visited;
+    PendingImportMap::const_iterator pending = gPendingImports->find(name);
+    while (pending != gPendingImports->end())
+    {
+      const boost::thread::id importer = pending->second.thread;
+      if (importer == thread)
+        return true;
+      if (!visited.insert(importer).second)
+        return false;
+      WaitingImportMap::const_iterator waiting = gWaitingImports->find(importer);
+      if (waiting == gWaitingImports->end())
+        return false;
+      pending = gPendingImports->find(waiting->second);
+    }
+    return false;
+  }
+
+  /*
+   * Import a module, unless it is already imported. If another thread is
+   * importing it, join that import instead of loading the module twice:
+   * modules importing other modules in their initialization may run
+   * concurrently. The import is waited for only if `wait` is true, otherwise
+   * its future is returned as is.
+   *
+   * An import that would wait, directly or through other threads, for an
+   * import in progress in the current thread is circular: A imports B which
+   * imports A, whether B is imported in this thread or in another one.
+   */
+  static Future<AnyModule> importModule(const std::string& name, const ModuleInfo* moduleInfo, bool wait) {
+    initModuleFactory();
     checkPkg(name);
-    boost::recursive_mutex::scoped_lock sl(*gMutexLoading);
+
+    const boost::thread::id thisThread = boost::this_thread::get_id();
+    Promise<AnyModule> promise;
     {
       boost::recursive_mutex::scoped_lock sl(*gMutexPkg);
-      AnyModuleMap::iterator it = gReadyPackages->find(name);
-      if (it != gReadyPackages->end())
+      AnyModuleMap::iterator ready = gReadyPackages->find(name);
+      if (ready != gReadyPackages->end())
       {
         qiLogDebug() << "Library " << name << " already loaded.";
-        return (*gReadyPackages)[name];
+        return Future<AnyModule>(ready->second);
+      }
+      PendingImportMap::iterator pending = gPendingImports->find(name);
+      if (pending != gPendingImports->end())
+      {
+        if (importWaitsFor(name, thisThread))
+          throw std::runtime_error("circular import of module: " + name);
+        Future<AnyModule> module = pending->second.module;
+        if (!wait)
+          return module;
+        (*gWaitingImports)[thisThread] = name;
+        sl.unlock();
+        auto waited = ka::scoped([&] {
+          boost::recursive_mutex::scoped_lock sl(*gMutexPkg);
+          gWaitingImports->erase(thisThread);
+        });
+        qiLogDebug() << "Waiting for the import of " << name << " in progress.";
+        return Future<AnyModule>(module.value());
       }
+      (*gPendingImports)[name] = PendingImport{ promise.future(), thisThread };
     }
-    return AnyModule();
-  }
-
-  AnyModule import(const std::string& name) {
-    initModuleFactory();
 
-    AnyModule mod = findModuleInFactory(name);
-    if (mod)
-      return mod;
+    auto done = ka::scoped([&] {
+      boost::recursive_mutex::scoped_lock sl(*gMutexPkg);
+      gPendingImports->erase(name);
+    });
+    try
+    {
+      const ModuleInfo mi = moduleInfo ? *moduleInfo : findModuleInFs(name);
 
-    ModuleInfo mi = findModuleInFs(name);
+      ModuleFactoryFunctor factory;
+      {
+        boost::recursive_mutex::scoped_lock sl(*gMutexPkg);
+        ModuleFactoryMap::const_iterator it = gModuleFactory.find(mi.type);
+        if (it == gModuleFactory.end())
+          throw std::runtime_error("module factory for module type: " + mi.type + " is not available");
+        factory = it->second;
+      }
 
-    ModuleFactoryMap::const_iterator it = gModuleFactory.find(mi.type);
-    if (it == gModuleFactory.end())
-      throw std::runtime_error("module factory for module type: " + mi.type + " is not available");
+      AnyModule module = factory(mi);
+      promise.setValue(module);
+      return Future<AnyModule>(module);
+    }
+    catch (const std::exception& e)
+    {
+      promise.setError(e.what());
+      throw;
+    }
+  }
 
-    return it->second(mi);
+  AnyModule import(const std::string& name) {
+    return importModule(name, nullptr, true).value();
   }
 
   AnyModule import(const ModuleInfo& mi) {
-    initModuleFactory();
-
-    AnyModule mod = findModuleInFactory(mi.name);
-    if (mod)
-      return mod;
+    return importModule(mi.name, &mi, true).value();
+  }
 
-    ModuleFactoryMap::const_iterator it = gModuleFactory.find(mi.type);
-    if (it == gModuleFactory.end())
-      throw std::runtime_error("module factory for module type: " + mi.type + " is not available");
+  // The tasks of the event loop never wait for an import in progress in
+  // another thread: they chain on it.
+  Future<AnyModule> importAsync(const std::string& name) {
+    return qi::async([name] { return importModule(name, nullptr, false); }).unwrap();
+  }
 
-    return it->second(mi);
+  Future<std::vector<ModuleImportReport>> preloadModules(const std::vector<std::string>& names) {
+    std::vector<Future<ModuleImportReport>> imports;
+    imports.reserve(names.size());
+    for (const auto& name : names)
+    {
+      const SteadyClock::time_point start = SteadyClock::now();
+      Future<AnyModule> module = importAsync(name);
+      imports.push_back(module.then([name, start](Future<AnyModule> imported) {
+        ModuleImportReport report;
+        report.name = name;
+        if (imported.hasValue())
+          report.module = imported.value();
+        else
+          report.error = imported.hasError() ? imported.error() : "import canceled";
+        report.duration = SteadyClock::now() - start;
+        qiLogVerbose() << "Imported module " << name << " in "
+                       << boost::chrono::duration_cast<MilliSeconds>(report.duration).count()
+                       << "ms" << (report.error.empty() ? "" : ", error: " + report.error);
+        return report;
+      }));
+    }
+    Future<std::vector<Future<ModuleImportReport>>> all = waitForAll(imports);
+    return all.andThen([](const std::vector<Future<ModuleImportReport>>& done) {
+      std::vector<ModuleImportReport> reports;
+      reports.reserve(done.size());
+      for (const auto& report : done)
+        reports.push_back(report.value());
+      return reports;
+    });
   }
 
   std::vector<ModuleInfo> listModules() {
@@ -85,6 +85,61 @@ static const AnyValue& traceValidateValue(const AnyValue& v)
   return traceValidateSignature(s)? v:fallback;
 }
 
+// copy v for a trace, cut according to the capture options
+static AnyValue traceCapture(AnyReference v, const TraceOptions& options)
+{
+  // raw buffers are not traced, only their size
+  if (v.kind() == TypeKind_Raw)
+    return AnyValue::from("<" + std::to_string(v.asRaw().second) + " bytes>");
+  if (options.arguments() == TraceArguments_Full)
+    return AnyValue(v);
+  const auto maxSize = options.maxArgumentSize();
+  switch (v.kind())
+  {
+  case TypeKind_String:
+  {
+    const auto str = static_cast<StringTypeInterface*>(v.type())->get(v.rawValue());
+    const auto& raw = str.first;
+    AnyValue result = raw.second > maxSize
+        ? AnyValue::from(std::string(raw.first, maxSize) + "...")
+        : AnyValue(v);
+    if (str.second)
+      str.second(raw);
+    return result;
+  }
+  case TypeKind_List:
+  case TypeKind_Map:
+  case TypeKind_VarArgs:
+    if (v.size() > maxSize)
+      return AnyValue::from("<" + std::to_string(v.size()) + " elements>");
+    break;
+  case TypeKind_Tuple:
+  {
+    // cut the members, keeping the names of the structure
+    auto structType = static_cast<StructTypeInterface*>(v.type());
+    const AnyReferenceVector members = v.asTupleValuePtr();
+    std::vector<AnyValue> captured;
+    captured.reserve(members.size());
+    AnyReferenceVector values;
+    std::vector<TypeInterface*> types;
+    for (const auto& member : members)
+    {
+      captured.push_back(traceCapture(member, options));
+      values.push_back(captured.back().asReference());
+      types.push_back(values.back().type());
+    }
+    AnyReference tuple(makeTupleType(types, structType->className(), structType->elementsName()));
+    tuple.setTuple(values);
+    return AnyValue(tuple, false, true);
+  }
+  case TypeKind_Dynamic:
+    return v.content().isValid() ? traceCapture(v.content(), options) : AnyValue(v);
+  default:
+    break;
+  }
+  return AnyValue(v);
+}
+
 inline void call(qi::Promise<AnyReference>& out,
                  AnyObject context,
                  const GenericFunctionParameters& params,
@@ -96,46 +151,64 @@ inline void call(qi::Promise<AnyReference>& out,
 {
   bool stats = context && context.isStatsEnabled();
   bool trace = context && context.isTraceEnabled();
-  qi::AnyReference retref;
+  bool record = context && context.asGenericObject()->isTraceRecordingEnabled();
+  if ((trace || record) && !context.asGenericObject()->_sampleTrace())
+    trace = record = false;
+  const TraceOptions traceOptions = trace ? context.asGenericObject()->traceOptions() : TraceOptions();
+  const bool traceValues = trace && traceOptions.arguments() != TraceArguments_None;
+  AnyValue traceResult;
+  // traced calls get their own span, so that the calls they make, even
+  // remote ones, can be attached to them
+  const TraceContext span = (trace || record) ? currentTraceContext().child() : currentTraceContext();
   int tid = 0; // trace call id, reused for result sending
-  if (trace)
+  if (trace || record)
   {
     tid = context.asGenericObject()->_nextTraceId();
     qi::os::timeval tv(qi::SystemClock::now().time_since_epoch());
-    AnyValueVector args;
-    args.resize(params.size()-1);
-    for (unsigned i=0; i<params.size()-1; ++i)
+    AnyValue arguments;
+    if (traceValues)
     {
-      if (!params[i+1].type())
-        args[i] = AnyValue::from("<??" ">");
-      else
+      AnyValueVector args;
+      args.resize(params.size()-1);
+      for (unsigned i=0; i<params.size()-1; ++i)
       {
-        switch(params[i+1].type()->kind())
-        {
-        case TypeKind_Int:
-        case TypeKind_String:
-        case TypeKind_Float:
-        case TypeKind_VarArgs:
-        case TypeKind_List:
-        case TypeKind_Map:
-        case TypeKind_Tuple:
-        case TypeKind_Dynamic:
-        case TypeKind_Optional:
-          args[i] = params[i+1];
-          break;
-        default:
+        if (!params[i+1].type())
           args[i] = AnyValue::from("<??" ">");
+        else
+        {
+          switch(params[i+1].type()->kind())
+          {
+          case TypeKind_Int:
+          case TypeKind_String:
+          case TypeKind_Float:
+          case TypeKind_VarArgs:
+          case TypeKind_List:
+          case TypeKind_Map:
+          case TypeKind_Tuple:
+          case TypeKind_Dynamic:
+          case TypeKind_Optional:
+          case TypeKind_Raw:
+            args[i] = traceCapture(params[i+1], traceOptions);
+            break;
+          default:
+            args[i] = AnyValue::from("<??" ">");
+          }
         }
       }
+      arguments = traceValidateValue(AnyValue::from(args));
     }
-    context.asGenericObject()->traceObject(EventTrace(
-      tid, EventTrace::Event_Call, methodId, traceValidateValue(AnyValue::from(args)), tv,
-      0,0, callerContext, qi::os::gettid(), postTimestamp));
+    const EventTrace event(tid, EventTrace::Event_Call, methodId, arguments, tv,
+                           0, 0, callerContext, qi::os::gettid(),
+                           span.traceId, span.spanId, span.parentSpanId, postTimestamp);
+    if (trace)
+      context.asGenericObject()->traceObject(event);
+    if (record)
+      context.asGenericObject()->_recordTrace(event);
   }
 
-  qi::int64_t time = stats?qi::os::ustime():0;
+  const SteadyClock::time_point start = stats ? SteadyClock::now() : SteadyClock::time_point();
   std::pair<int64_t, int64_t> cputime, cpuendtime;
-  if (stats||trace)
+  if (stats||trace||record)
      cputime = qi::os::cputime();
 
   bool success = false;
@@ -143,10 +216,13 @@ inline void call(qi::Promise<AnyReference>& out,
   {
     qi::AnyReference ret;
     //the return value is destroyed by ServerResult in the future callback.
-    ret = func.call(params);
+    {
+      TraceContextScope traceScope(span);
+      ret = func.call(params);
+    }
     //copy the value for tracing later. (we want the tracing to happend after setValue
-    if (trace)
-      retref = ret.clone();
+    if (traceValues)
+      traceResult = traceCapture(ret, traceOptions);
     //the reference, is dropped here... not cool man!
     out.setValue(ret);
     success = true;
@@ -162,7 +238,7 @@ inline void call(qi::Promise<AnyReference>& out,
     out.setError("Unknown exception caught.");
   }
 
-  if (stats||trace)
+  if (stats||trace||record)
   {
     cpuendtime = qi::os::cputime();
     cpuendtime.first -= cputime.first;
@@ -170,22 +246,25 @@ inline void call(qi::Promise<AnyReference>& out,
   }
 
   if (stats)
-    context.asGenericObject()->pushStats(methodId, (float)(qi::os::ustime() - time)/1e6f,
-                       (float)cpuendtime.first / 1e6f,
-                       (float)cpuendtime.second / 1e6f);
+    context.asGenericObject()->pushStats(methodId, SteadyClock::now() - start,
+                                         MicroSeconds(cpuendtime.first),
+                                         MicroSeconds(cpuendtime.second));
 
 
-  if (trace)
+  if (trace || record)
   {
     qi::os::timeval tv(qi::SystemClock::now().time_since_epoch());
     AnyValue val;
-    if (success)
-      val = AnyValue(retref, false, true);
-    else
-      val = AnyValue::from(out.future().error());
-    context.asGenericObject()->traceObject(EventTrace(tid,
+    if (traceValues)
+      val = traceValidateValue(success ? traceResult : AnyValue::from(out.future().error()));
+    const EventTrace event(tid,
       success?EventTrace::Event_Result:EventTrace::Event_Error,
-      methodId, traceValidateValue(val), tv, cpuendtime.first, cpuendtime.second, callerContext, qi::os::gettid(), postTimestamp));
+      methodId, val, tv, cpuendtime.first, cpuendtime.second, callerContext, qi::os::gettid(),
+      span.traceId, span.spanId, span.parentSpanId, postTimestamp);
+    if (trace)
+      context.asGenericObject()->traceObject(event);
+    if (record)
+      context.asGenericObject()->_recordTrace(event);
   }
 }
 
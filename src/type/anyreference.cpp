@@ -387,10 +387,10 @@ namespace detail
   {
     StructTypeInterface* tsrc = static_cast<StructTypeInterface*>(src->type());
 
-    const std::vector<std::string> srcNames = tsrc->elementsName();
-    const std::vector<std::string> dstNames = tdst->elementsName();
-    const std::vector<TypeInterface*> srcTypes = tsrc->memberTypes();
-    const std::vector<TypeInterface*> dstTypes = tdst->memberTypes();
+    const std::vector<std::string>& srcNames = tsrc->cachedElementsName();
+    const std::vector<std::string>& dstNames = tdst->cachedElementsName();
+    const std::vector<TypeInterface*>& srcTypes = tsrc->cachedMemberTypes();
+    const std::vector<TypeInterface*>& dstTypes = tdst->cachedMemberTypes();
     if (srcTypes.size() != srcNames.size() || dstTypes.size() != dstNames.size())
     {
       qiLogVerbose() << "Cannot convert between not fully named mismatching tuples " << tsrc->infoString() << " and "
@@ -407,7 +407,7 @@ namespace detail
         fieldMap.push_back(static_cast<int>(it - dstNames.begin()));
       else
       {
-        fieldDrop[srcNames[i]] = AnyReference(srcTypes[i], tsrc->get(src->rawValue(), i));
+        fieldDrop[srcNames[i]] = tsrc->member(src->rawValue(), i);
         fieldMap.push_back(-1);
       }
     }
@@ -437,14 +437,12 @@ namespace detail
     uniqueConvertedFields.reserve(dstTypes.size());
     std::vector<void*> targetData(dstTypes.size(), nullptr);
 
-    const std::vector<void*> sourceData = tsrc->get(src->rawValue());
-
     for (unsigned i = 0; i < srcTypes.size(); ++i)
     {
       int targetIndex = fieldMap[i];
       if (targetIndex == -1)
         continue; // dropped field, do not convert
-      auto conv = AnyReference(srcTypes[i], sourceData[i]).convert(dstTypes[targetIndex]);
+      auto conv = tsrc->member(src->rawValue(), i).convert(dstTypes[targetIndex]);
       if (!conv->type())
       {
         qiLogVerbose() << "Conversion failure in tuple member " << srcNames[i] << " between "
@@ -512,22 +510,24 @@ namespace detail
     {
       return ka::invoke_catch(DefaultUniqueAnyRef{}, [&] {
         StructTypeInterface* tsrc = static_cast<StructTypeInterface*>(_type);
-        std::vector<void*> sourceData = tsrc->get(_value);
-        std::vector<TypeInterface*> srcTypes = tsrc->memberTypes();
-        std::vector<TypeInterface*> dstTypes = tdst->memberTypes();
-        QI_ASSERT(sourceData.size() == srcTypes.size());
+        const std::vector<TypeInterface*>& srcTypes = tsrc->cachedMemberTypes();
+        const std::vector<TypeInterface*>& dstTypes = tdst->cachedMemberTypes();
         if (srcTypes.size() != dstTypes.size())
         {
           qiLogVerbose() << "Conversion glitch: tuple size mismatch between " << tsrc->infoString() << " and " << tdst->infoString();
           return structConverter(this, tdst);
         }
-        std::vector<std::string> srcNames = tsrc->elementsName();
-        std::vector<std::string> dstNames = tdst->elementsName();
-        if (srcNames.size() == srcTypes.size() && dstNames.size() == dstTypes.size())
+        const std::vector<std::string>& srcNames = tsrc->cachedElementsName();
+        const std::vector<std::string>& dstNames = tdst->cachedElementsName();
+        // Names in the same order, the nominal case, need not be sorted.
+        if (srcNames.size() == srcTypes.size() && dstNames.size() == dstTypes.size()
+            && srcNames != dstNames)
         {
-          std::sort(srcNames.begin(), srcNames.end());
-          std::sort(dstNames.begin(), dstNames.end());
-          if (srcNames != dstNames)
+          std::vector<std::string> sortedSrcNames = srcNames;
+          std::vector<std::string> sortedDstNames = dstNames;
+          std::sort(sortedSrcNames.begin(), sortedSrcNames.end());
+          std::sort(sortedDstNames.begin(), sortedDstNames.end());
+          if (sortedSrcNames != sortedDstNames)
           {
             qiLogVerbose() << "Conversion glitch: names mismatch in named tuple";
             return structConverter(this, tdst);
@@ -543,7 +543,7 @@ namespace detail
         targetData.reserve(dstTypes.size());
         for (unsigned i=0; i<dstTypes.size(); ++i)
         {
-          auto conv = AnyReference(srcTypes[i], sourceData[i]).convert(dstTypes[i]);
+          auto conv = tsrc->member(_value, i).convert(dstTypes[i]);
           if (!conv->_type)
           {
             qiLogVerbose() << "Conversion failure in tuple member between "
@@ -569,8 +569,8 @@ namespace detail
           qiLogWarning() << "convert from map to struct, the key should be a string. (was " << tsrc->keyType()->kind() << ")";
           return {};
         }
-        const std::vector<std::string>& elems = tdst->elementsName();
-        std::vector<TypeInterface*> dstTypes = tdst->memberTypes();
+        const std::vector<std::string>& elems = tdst->cachedElementsName();
+        const std::vector<TypeInterface*>& dstTypes = tdst->cachedMemberTypes();
 
         if (elems.size() != dstTypes.size()) {
           qiLogWarning() << "convert from map to struct, can't convert to tuple";
@@ -635,7 +635,7 @@ namespace detail
         AnyIterator srcBegin = tsrc->begin(_value);
         AnyIterator srcEnd = tsrc->end(_value);
 
-        std::vector<TypeInterface*> dstTypes = tdst->memberTypes();
+        const std::vector<TypeInterface*>& dstTypes = tdst->cachedMemberTypes();
         std::vector<UniqueAnyReference> uniqueConvertedFields;
         uniqueConvertedFields.reserve(dstTypes.size());
         std::vector<void*> targetData;
@@ -751,12 +751,10 @@ namespace detail
         auto srcStructType = static_cast<StructTypeInterface*>(_type);
         MapTypeInterface* targetMapType = targetType;
 
-        // Source fields value
-        std::vector<void*> sourceData = srcStructType->get(_value);
         // Source fields name
-        std::vector<std::string> srcElementName = srcStructType->elementsName();
+        const std::vector<std::string>& srcElementName = srcStructType->cachedElementsName();
         // Source members type
-        std::vector<TypeInterface*> srcTypes = srcStructType->memberTypes();
+        const std::vector<TypeInterface*>& srcTypes = srcStructType->cachedMemberTypes();
         // Destination members type
         TypeInterface* dstType = targetMapType->elementType();
 
@@ -766,7 +764,7 @@ namespace detail
 
         for (unsigned int i = 0; i < srcElementName.size(); ++i)
         {
-          auto conv = AnyReference(srcTypes[i], sourceData[i]).convert(dstType);
+          auto conv = srcStructType->member(_value, i).convert(dstType);
           if (!conv->_type)
           {
             qiLogVerbose() << "Conversion failure in tuple member between "
@@ -1186,15 +1184,14 @@ namespace detail
     {
       StructTypeInterface* t = static_cast<StructTypeInterface*>(_type);
       int ikey = (int)key.toInt();
-      std::vector<TypeInterface*> types = t->memberTypes();
-      if (ikey < 0 || static_cast<size_t>(ikey) >= types.size())
+      if (ikey < 0 || static_cast<size_t>(ikey) >= t->memberCount())
       {
         if (throwOnFailure)
           throw std::runtime_error("Index out of range");
         else
           return AnyReference();
       }
-      return AnyReference(types[ikey], t->get(_value, ikey));
+      return t->member(_value, ikey);
     }
     else
       throw std::runtime_error("Expected List, Map or Tuple kind");
@@ -1431,7 +1428,7 @@ namespace detail
     if (kind() != TypeKind_Tuple)
       throw std::runtime_error("Value is not a Tuple");
     StructTypeInterface* stype = static_cast<StructTypeInterface*>(_type);
-    std::vector<TypeInterface*> types = stype->memberTypes();
+    const std::vector<TypeInterface*>& types = stype->cachedMemberTypes();
     std::vector<void*> vals;
 
     if (types.size() != values.size())
@@ -1463,7 +1460,7 @@ namespace detail
     if (kind() == TypeKind_Map)
       return static_cast<MapTypeInterface*>(_type)->size(_value);
     if (kind() == TypeKind_Tuple)
-      return static_cast<StructTypeInterface*>(_type)->memberTypes().size();
+      return static_cast<StructTypeInterface*>(_type)->memberCount();
     else
       throw std::runtime_error("Expected List, Map or Tuple.");
   }
@@ -1497,7 +1494,7 @@ namespace detail
   std::vector<TypeInterface*> AnyReferenceBase::membersType() const
   {
     if (kind() == TypeKind_Tuple)
-      return static_cast<StructTypeInterface*>(_type)->memberTypes();
+      return static_cast<StructTypeInterface*>(_type)->cachedMemberTypes();
     else
       throw std::runtime_error("Expected tuple");
   }
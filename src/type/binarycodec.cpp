@@ -552,9 +552,9 @@ namespace qi {
         }
       }
 
-      void visitTuple(const std::string& /*name*/, const AnyReferenceVector& vals, const std::vector<std::string>& /*annotations*/)
+      void visitTuple(const std::string& /*name*/, const StructMembers& vals, const std::vector<std::string>& /*annotations*/)
       {
-        out.beginTuple(qi::makeTupleSignature(vals));
+        out.beginTuple(qi::makeTupleSignature(vals.types()));
         for (unsigned i=0; i<vals.size(); ++i)
           serialize(vals[i], out, serializeObjectCb, socket);
         out.endTuple();
@@ -596,6 +596,43 @@ namespace qi {
       MessageSocketPtr socket;
     };
 
+    /*
+     * The following functions hand the storage of freshly decoded values over
+     * to the container they belong to, which then owns them, so that the
+     * decoded trees are not cloned node by node on their way up.
+     */
+    void appendOwned(AnyReference& list, AnyReference element)
+    {
+      void* storage = list.rawValue();
+      static_cast<ListTypeInterface*>(list.type())->pushBackOwned(&storage, element.rawValue());
+      list = AnyReference(list.type(), storage);
+    }
+
+    void insertOwned(AnyReference& map, AnyReference key, AnyReference element)
+    {
+      void* storage = map.rawValue();
+      static_cast<MapTypeInterface*>(map.type())->insertOwned(&storage, key.rawValue(), element.rawValue());
+      map = AnyReference(map.type(), storage);
+    }
+
+    void setMembersOwned(AnyReference& tuple, std::vector<detail::UniqueAnyReference> members)
+    {
+      std::vector<void*> storages;
+      storages.reserve(members.size());
+      for (auto& member : members)
+        storages.push_back(member.release().rawValue());
+      void* storage = tuple.rawValue();
+      static_cast<StructTypeInterface*>(tuple.type())->setOwned(&storage, storages);
+      tuple = AnyReference(tuple.type(), storage);
+    }
+
+    void setDynamicOwned(AnyReference& dynamic, AnyReference value)
+    {
+      void* storage = dynamic.rawValue();
+      static_cast<DynamicTypeInterface*>(dynamic.type())->setOwned(&storage, value);
+      dynamic = AnyReference(dynamic.type(), storage);
+    }
+
     class DeserializeTypeVisitor
     {
       /*
@@ -701,9 +738,7 @@ namespace qi {
           return;
         for (unsigned i = 0; i < sz; ++i)
         {
-          AnyReference v = deserialize(elementType, in, context, socket);
-          result.append(v);
-          v.destroy();
+          appendOwned(result, deserialize(elementType, in, context, socket));
         }
       }
 
@@ -722,11 +757,9 @@ namespace qi {
           return;
         for (unsigned i = 0; i < sz; ++i)
         {
-          AnyReference k = deserialize(keyType, in, context, socket);
+          auto k = detail::UniqueAnyReference{ deserialize(keyType, in, context, socket) };
           AnyReference v = deserialize(elementType, in, context, socket);
-          result.insert(k, v);
-          k.destroy();
-          v.destroy();
+          insertOwned(result, k.release(), v);
         }
       }
       void visitAnyObject(AnyObject& o)
@@ -778,24 +811,19 @@ namespace qi {
         throw std::runtime_error(ss.str());
       }
 
-      void visitTuple(const std::string &, const AnyReferenceVector&, const std::vector<std::string>&)
+      void visitTuple(const std::string &, const StructMembers&, const std::vector<std::string>&)
       {
-        std::vector<TypeInterface*> types = result.membersType();
-        AnyReferenceVector   vals;
-        vals.resize(types.size());
+        const std::vector<TypeInterface*>& types =
+            static_cast<StructTypeInterface*>(result.type())->cachedMemberTypes();
+        std::vector<detail::UniqueAnyReference> members;
+        members.reserve(types.size());
         for (unsigned i = 0; i<types.size(); ++i)
         {
-          AnyReference val = deserialize(types[i], in, context, socket);
-          if (!val.isValid())
+          members.emplace_back(deserialize(types[i], in, context, socket));
+          if (!members.back()->isValid())
             throw std::runtime_error("Deserialization of tuple field failed");
-          vals[i] = val;
-        }
-        //TODO: there is a copy here.
-        result.setTuple(vals);
-        for (unsigned i = 0; i<vals.size(); ++i)
-        {
-          vals[i].destroy();
         }
+        setMembersOwned(result, std::move(members));
       }
 
       void visitDynamic(AnyReference /*pointee*/)
@@ -816,9 +844,9 @@ namespace qi {
 
         DeserializeTypeVisitor dtv(*this);
         dtv.result = AnyReference(type);
+        auto value = detail::UniqueAnyReference{ dtv.result };
         typeDispatch<DeserializeTypeVisitor>(dtv, dtv.result);
-        result.setDynamic(dtv.result);
-        dtv.result.destroy();
+        setDynamicOwned(result, value.release());
       }
       void visitIterator(AnyReference)
       {
@@ -891,6 +919,166 @@ namespace qi {
       }
     }
 
+    namespace
+    {
+      template <typename T>
+      void deserializeNumber(AnyReference& result, BinaryDecoder& in)
+      {
+        T value;
+        in.read(value);
+        switch (result.kind())
+        {
+        case TypeKind_Int:
+          if (std::is_floating_point<T>::value)
+            result.setDouble(static_cast<double>(value));
+          else if (std::is_signed<T>::value)
+            result.setInt(static_cast<int64_t>(value));
+          else
+            result.setUInt(static_cast<uint64_t>(value));
+          break;
+        case TypeKind_Float:
+          result.setDouble(static_cast<double>(value));
+          break;
+        case TypeKind_Dynamic:
+          result.setDynamic(AnyReference::from(value));
+          break;
+        default:
+          throw std::runtime_error(std::string("Cannot decode a number into ") + result.type()->infoString());
+        }
+      }
+    }
+
+    /*
+     * Decodes data encoded with `signature` into `result`, whose type may not
+     * have the same signature: numbers are converted with range checks, lists,
+     * maps, tuples and optionals are decoded element by element, and a dynamic
+     * receives a value of the type of the signature. The parts whose signature
+     * matches are decoded by the DeserializeTypeVisitor, with no conversion.
+     */
+    void deserialize(AnyReference& result, const Signature& signature, BinaryDecoder& in,
+                     DeserializeObjectCallback context, MessageSocketPtr socket)
+    {
+      if (result.type()->signature() == signature)
+      {
+        result = deserialize(result, in, context, socket);
+        return;
+      }
+
+      if (result.kind() == TypeKind_Optional && signature.type() != Signature::Type_Optional)
+        throw std::runtime_error("Cannot decode " + signature.toString() + " into an optional");
+
+      switch (signature.type())
+      {
+      case Signature::Type_Bool:   deserializeNumber<bool>(result, in); return;
+      case Signature::Type_Int8:   deserializeNumber<int8_t>(result, in); return;
+      case Signature::Type_UInt8:  deserializeNumber<uint8_t>(result, in); return;
+      case Signature::Type_Int16:  deserializeNumber<int16_t>(result, in); return;
+      case Signature::Type_UInt16: deserializeNumber<uint16_t>(result, in); return;
+      case Signature::Type_Int32:  deserializeNumber<int32_t>(result, in); return;
+      case Signature::Type_UInt32: deserializeNumber<uint32_t>(result, in); return;
+      case Signature::Type_Int64:  deserializeNumber<int64_t>(result, in); return;
+      case Signature::Type_UInt64: deserializeNumber<uint64_t>(result, in); return;
+      case Signature::Type_Float:  deserializeNumber<float>(result, in); return;
+      case Signature::Type_Double: deserializeNumber<double>(result, in); return;
+      default:
+        break;
+      }
+
+      if (result.kind() == TypeKind_Dynamic)
+      {
+        TypeInterface* type = TypeInterface::fromSignature(signature);
+        if (!type)
+          throw std::runtime_error("Cannot find a type to deserialize signature " + signature.toString());
+        setDynamicOwned(result, deserialize(type, in, context, socket));
+        return;
+      }
+
+      const auto& children = signature.children();
+      switch (signature.type())
+      {
+      case Signature::Type_String:
+        if (result.kind() == TypeKind_String)
+        {
+          std::string str;
+          in.read(str);
+          result.setString(str);
+          return;
+        }
+        break;
+      case Signature::Type_List:
+      case Signature::Type_VarArgs:
+        if (result.kind() == TypeKind_List || result.kind() == TypeKind_VarArgs)
+        {
+          TypeInterface* elementType = static_cast<ListTypeInterface*>(result.type())->elementType();
+          std::uint32_t sz = 0;
+          in.read(sz);
+          for (unsigned i = 0; i < sz && in.status() == BinaryDecoder::Status::Ok; ++i)
+          {
+            auto element = detail::UniqueAnyReference{ AnyReference(elementType) };
+            deserialize(*element, children.at(0), in, context, socket);
+            appendOwned(result, element.release());
+          }
+          return;
+        }
+        break;
+      case Signature::Type_Map:
+        if (result.kind() == TypeKind_Map)
+        {
+          auto* mapType = static_cast<MapTypeInterface*>(result.type());
+          std::uint32_t sz = 0;
+          in.read(sz);
+          for (unsigned i = 0; i < sz && in.status() == BinaryDecoder::Status::Ok; ++i)
+          {
+            auto key = detail::UniqueAnyReference{ AnyReference(mapType->keyType()) };
+            auto element = detail::UniqueAnyReference{ AnyReference(mapType->elementType()) };
+            deserialize(*key, children.at(0), in, context, socket);
+            deserialize(*element, children.at(1), in, context, socket);
+            insertOwned(result, key.release(), element.release());
+          }
+          return;
+        }
+        break;
+      case Signature::Type_Tuple:
+        if (result.kind() == TypeKind_Tuple)
+        {
+          const auto& types = static_cast<StructTypeInterface*>(result.type())->cachedMemberTypes();
+          if (types.size() != children.size())
+            break;
+          std::vector<detail::UniqueAnyReference> members;
+          members.reserve(types.size());
+          for (unsigned i = 0; i < types.size(); ++i)
+          {
+            members.emplace_back(AnyReference(types[i]));
+            deserialize(*members.back(), children[i], in, context, socket);
+          }
+          setMembersOwned(result, std::move(members));
+          return;
+        }
+        break;
+      case Signature::Type_Optional:
+        if (result.kind() == TypeKind_Optional)
+        {
+          bool hasValue = false;
+          in.read(hasValue);
+          if (!hasValue)
+          {
+            result.resetOptional();
+            return;
+          }
+          auto* optType = static_cast<OptionalTypeInterface*>(result.type());
+          auto value = detail::UniqueAnyReference{ AnyReference(optType->valueType()) };
+          deserialize(*value, children.at(0), in, context, socket);
+          result.setOptional(boost::make_optional(*value));
+          return;
+        }
+        break;
+      default:
+        break;
+      }
+      throw std::runtime_error("Cannot decode " + signature.toString() + " into "
+                               + std::string(result.type()->infoString()));
+    }
+
   } // namespace detail
 
   void encodeBinary(qi::Buffer *buf, const qi::AutoAnyReference &gvp, SerializeObjectCallback onObject, MessageSocketPtr socket) {
@@ -920,5 +1108,18 @@ namespace qi {
     return dtv.result;
   }
 
+  AnyReference decodeBinary(qi::BufferReader *buf, qi::AnyReference gvp, const Signature& signature,
+    DeserializeObjectCallback onObject, MessageSocketPtr socket) {
+    BinaryDecoder in(buf);
+    detail::deserialize(gvp, signature, in, onObject, socket);
+    if (in.status() != BinaryDecoder::Status::Ok) {
+      std::stringstream ss;
+      ss << "ISerialization error " << BinaryDecoder::statusToStr(in.status());
+      qiLogError() << ss.str();
+      throw std::runtime_error(ss.str());
+    }
+    return gvp;
+  }
+
 }
 
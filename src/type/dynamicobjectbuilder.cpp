@@ -184,6 +184,10 @@ namespace qi
     _p->_object->metaObject()._p->setDescription(desc);
   }
 
+  void DynamicObjectBuilder::setMemberPriority(unsigned int id, MemberPriority priority) {
+    _p->_object->metaObject()._p->setMemberPriority(id, priority);
+  }
+
   AnyObject DynamicObjectBuilder::object(boost::function<void (GenericObject*)> onDelete)
   {
     if (!_p->_objptr)
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <sstream>
 #include <qi/anyobject.hpp>
+#include <qi/methodhandle.hpp>
 #include <qi/log.hpp>
 
 #include "metaobject_p.hpp"
@@ -93,6 +95,65 @@ std::string GenericObject::makeFindMethodErrorMessage(
         errorNo, false);
 }
 
+namespace detail
+{
+
+unsigned int bindMethod(const AnyObject& object,
+                        const std::string& nameWithOptionalSignature,
+                        const Signature& parametersSignature,
+                        const Signature& returnSignature)
+{
+  GenericObject* go = object.asGenericObject();
+  if (!go || !go->isValid())
+    throw std::runtime_error("Cannot bind method " + nameWithOptionalSignature + " of an invalid object");
+  const MetaObject& mo = go->metaObject();
+
+  // As with metaCall, a given signature must match exactly, otherwise the
+  // best overload for the parameters is chosen.
+  const bool hasSignature = nameWithOptionalSignature.find(':') != std::string::npos;
+  const std::string fullSignature = hasSignature
+      ? nameWithOptionalSignature
+      : nameWithOptionalSignature + "::" + parametersSignature.toString();
+  int methodId = mo.methodId(fullSignature);
+  int error = -1;
+  std::vector<MetaObject::CompatibleMethod> candidates;
+  if (methodId < 0 && !hasSignature)
+  {
+    candidates = mo.findCompatibleMethod(fullSignature);
+    const auto best = std::max_element(candidates.begin(), candidates.end(),
+        [](const MetaObject::CompatibleMethod& a, const MetaObject::CompatibleMethod& b) {
+          return a.second < b.second;
+        });
+    if (best != candidates.end())
+    {
+      const auto bestCount = std::count_if(candidates.begin(), candidates.end(),
+          [&](const MetaObject::CompatibleMethod& c) { return c.second == best->second; });
+      if (bestCount == 1)
+        methodId = static_cast<int>(best->first.uid());
+      else
+        error = -3;
+    }
+  }
+  if (methodId < 0)
+  {
+    if (error == -1 && !mo.findMethod(signatureSplit(fullSignature)[1]).empty())
+      error = -2;
+    throw std::runtime_error(mo._p->generateErrorString(
+        nameWithOptionalSignature, parametersSignature.toString(), candidates, error, false));
+  }
+
+  const MetaMethod* method = mo.method(static_cast<unsigned int>(methodId));
+  if (method && method->returnSignature().isConvertibleTo(returnSignature) == 0
+      && returnSignature.isConvertibleTo(method->returnSignature()) == 0)
+    throw std::runtime_error("Cannot bind method " + nameWithOptionalSignature
+                             + ": will not be able to convert return type from "
+                             + method->returnSignature().toString()
+                             + " to " + returnSignature.toString());
+  return static_cast<unsigned int>(methodId);
+}
+
+}
+
 void GenericObject::metaPost(unsigned int event, const GenericFunctionParameters& args)
 {
   if (!type || !value) {
@@ -8,39 +8,40 @@
 # define _JSONPARSER_P_HPP_
 
 # include <string>
-# include <qi/anyvalue.hpp>
+# include <qi/jsoncodec.hpp>
+# include <qi/macro.hpp>
 
 namespace qi {
 
+  /// Parses a JSON sequence and forwards its elements to a JsonHandler.
+  /// Numbers and strings are read in place, without intermediate copies.
   class JsonDecoderPrivate
   {
   public:
-    JsonDecoderPrivate(const std::string &in);
     JsonDecoderPrivate(const std::string::const_iterator &begin,
                       const std::string::const_iterator &end);
-    std::string::const_iterator decode(AnyValue &out);
+    /// Throws std::runtime_error on parse error.
+    std::string::const_iterator decode(JsonHandler &handler);
 
   private:
+    QI_NORETURN void fail() const;
     void skipWhiteSpaces();
-    bool getDigits(std::string &result);
-    bool getInteger(std::string &result);
-    bool getInteger(qi::int64_t &result);
-    bool getExponent(std::string &result);
-    bool getFloat(double &result);
-    bool decodeArray(AnyValue &value);
-    bool decodeFloat(AnyValue &value);
-    bool decodeInteger(AnyValue &value);
-    bool getCleanString(std::string &result);
-    bool decodeString(AnyValue &value);
-    bool decodeObject(AnyValue &value);
-    bool match(std::string const& expected);
-    bool decodeSpecial(AnyValue &value);
-    bool decodeValue(AnyValue &value);
+    bool match(const char* expected);
+    unsigned int getHexQuad();
+    unsigned int getCodePoint();
+    void getCleanString(std::string &result);
+    void decodeArray(JsonHandler &handler);
+    void decodeNumber(JsonHandler &handler);
+    void decodeObject(JsonHandler &handler);
+    void decodeSpecial(JsonHandler &handler);
+    void decodeValue(JsonHandler &handler);
 
   private:
     std::string::const_iterator const _begin;
     std::string::const_iterator const _end;
     std::string::const_iterator       _it;
+    // Reused by all the strings of the sequence.
+    std::string                       _string;
   };
 
 }
@@ -5,396 +5,807 @@
 
 #include <qi/jsoncodec.hpp>
 #include <qi/anyvalue.hpp>
-#include <iterator>
-#include <boost/lexical_cast.hpp>
-#ifdef WITH_BOOST_LOCALE
-#  include <boost/locale.hpp>
-#endif
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 #include "jsoncodec_p.hpp"
+#include "../base64.hpp"
 
 namespace qi {
 
-  JsonDecoderPrivate::JsonDecoderPrivate(const std::string &in)
-    :_begin(in.begin()),
-      _end(in.end()),
-      _it(_begin)
-  {}
-
-  JsonDecoderPrivate::JsonDecoderPrivate(const std::string::const_iterator &begin,
-                    const std::string::const_iterator &end)
-    :_begin(begin),
-      _end(end),
-      _it(_begin)
-  {}
-
-  std::string::const_iterator JsonDecoderPrivate::decode(AnyValue &out)
+  JsonHandler::~JsonHandler()
   {
-    _it = _begin;
-    if (!decodeValue(out))
-      throw std::runtime_error("parse error");
-    return _it;
   }
 
-  void JsonDecoderPrivate::skipWhiteSpaces()
+  namespace
   {
-    while (_it != _end && (*_it == ' ' || *_it == '\n'))
-      ++_it;
-  }
-
-  bool JsonDecoderPrivate::getDigits(std::string &result)
-  {
-    std::string::const_iterator begin = _it;
-
-    while (_it != _end && *_it >= '0' && *_it <= '9')
-      ++_it;
-    if (_it == begin)
-        return false;
-    result = std::string(begin, _it);
-    return true;
-  }
+    bool isDigit(char c)
+    {
+      return c >= '0' && c <= '9';
+    }
 
-  bool JsonDecoderPrivate::getInteger(std::string &result)
-  {
-    std::string::const_iterator save = _it;
-    std::string integerStr;
+    void appendUtf8(std::string &out, unsigned int codePoint)
+    {
+      if (codePoint < 0x80)
+        out += static_cast<char>(codePoint);
+      else if (codePoint < 0x800)
+      {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+      }
+      else if (codePoint < 0x10000)
+      {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+      }
+      else
+      {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+      }
+    }
 
-    if (_it == _end)
-      return false;
-    if (*_it == '-')
+    // Out of range values are clamped, as atol did.
+    int64_t toInt64(bool negative, uint64_t magnitude, bool overflow)
     {
-      ++_it;
-      integerStr = "-";
+      const uint64_t maxMagnitude = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+      if (negative)
+      {
+        if (overflow || magnitude > maxMagnitude)
+          return std::numeric_limits<int64_t>::min();
+        return -static_cast<int64_t>(magnitude);
+      }
+      if (overflow || magnitude > maxMagnitude)
+        return std::numeric_limits<int64_t>::max();
+      return static_cast<int64_t>(magnitude);
     }
-    std::string digitsStr;
 
-    if (!getDigits(digitsStr))
+    double toDouble(const char* data, std::size_t size)
     {
-      _it = save;
-      return false;
+      // strtod needs a terminated string, which the input is not: copy the
+      // number, which is short, in a local buffer.
+      char buffer[64];
+      std::string longNumber;
+      char* str = buffer;
+      if (size < sizeof(buffer))
+      {
+        std::memcpy(buffer, data, size);
+        buffer[size] = '\0';
+      }
+      else
+      {
+        longNumber.assign(data, size);
+        str = &longNumber[0];
+      }
+      // strtod follows the decimal point of the C locale, JSON does not.
+      const char point = *std::localeconv()->decimal_point;
+      if (point != '.')
+      {
+        if (char* dot = std::strchr(str, '.'))
+          *dot = point;
+      }
+      return std::strtod(str, nullptr);
     }
-    integerStr += digitsStr;
 
-    result = integerStr;
-    return true;
-  }
+    // Builds the generic values decodeJSON has always returned: arrays become
+    // lists of AnyValue and objects maps of string to AnyValue.
+    class JsonValueBuilder : public JsonHandler
+    {
+    public:
+      AnyValue& result() { return _result; }
+      bool done() const { return _frames.empty(); }
 
-  bool JsonDecoderPrivate::getInteger(qi::int64_t &result)
-  {
-    std::string integerStr;
+      void onNull() override { add(AnyValue(qi::typeOf<void>())); }
+      void onBool(bool value) override { add(AnyValue::from(value)); }
+      void onInt(int64_t value) override { add(AnyValue::from(value)); }
+      void onDouble(double value) override { add(AnyValue::from(value)); }
 
-    if (!getInteger(integerStr))
-      return false;
-    result = ::atol(integerStr.c_str());
-    return true;
-  }
+      void onString(const char* data, std::size_t size) override
+      {
+        AnyValue value = AnyValue::make<std::string>();
+        value.as<std::string>().assign(data, size);
+        add(std::move(value));
+      }
 
-  bool JsonDecoderPrivate::getExponent(std::string &result)
-  {
-    std::string::const_iterator save = _it;
+      void onBeginArray() override { _frames.emplace_back(false); }
 
-    if (_it == _end || (*_it != 'e' && *_it != 'E'))
-      return false;
-    ++_it;
-    std::string exponentStr;
+      void onEndArray() override
+      {
+        AnyValue value = AnyValue::make<AnyValueVector>();
+        std::swap(value.as<AnyValueVector>(), _frames.back().array);
+        _frames.pop_back();
+        add(std::move(value));
+      }
 
-    exponentStr += 'e';
-    if (*_it == '+' || *_it == '-')
-    {
-      exponentStr += *_it;
-      ++_it;
-    }
-    else
-      exponentStr += '+';
-    std::string integerStr;
-    if (!getDigits(integerStr))
-    {
-      _it = save;
-      return false;
-    }
+      void onBeginObject() override { _frames.emplace_back(true); }
 
-    result = exponentStr + integerStr;
-    return true;
-  }
+      void onKey(const char* data, std::size_t size) override
+      {
+        _frames.back().key.assign(data, size);
+      }
 
-  bool JsonDecoderPrivate::getFloat(double &result)
-  {
-    std::string floatStr;
-    std::string beforePoint;
-    std::string afterPoint;
-    std::string exponent;
-    std::string::const_iterator save = _it;
-
-    if (!getInteger(beforePoint))
-      return false;
-    if (!getExponent(exponent))
+      void onEndObject() override
+      {
+        AnyValue value = AnyValue::make<std::map<std::string, AnyValue>>();
+        std::swap(value.as<std::map<std::string, AnyValue>>(), _frames.back().object);
+        _frames.pop_back();
+        add(std::move(value));
+      }
+
+    private:
+      struct Frame
+      {
+        explicit Frame(bool object)
+          : isObject(object)
+        {}
+        bool isObject;
+        AnyValueVector array;
+        std::map<std::string, AnyValue> object;
+        std::string key;
+      };
+
+      void add(AnyValue value)
+      {
+        if (_frames.empty())
+          _result = std::move(value);
+        else if (_frames.back().isObject)
+          _frames.back().object[_frames.back().key] = std::move(value);
+        else
+          _frames.back().array.push_back(std::move(value));
+      }
+
+      std::vector<Frame> _frames;
+      AnyValue _result;
+    };
+
+    /*
+     * Decodes straight into a value of a given type, as the binary decoder
+     * does: the elements of lists and maps are decoded in fresh storages of
+     * their type, then appended. Dynamic values are built by a JsonValueBuilder.
+     */
+    class JsonTypedBuilder : public JsonHandler
     {
-      if (_it == _end || *_it != '.')
+    public:
+      explicit JsonTypedBuilder(AnyReference target)
+        : _target(target)
+      {}
+
+      ~JsonTypedBuilder()
       {
-        _it = save;
-        return false;
+        // Only left non empty if the decoding failed.
+        for (auto& frame : _frames)
+          frame.destroy();
       }
-      ++_it;
-      if (!getDigits(afterPoint))
+
+      void onNull() override
       {
-        _it = save;
-        return false;
+        if (forward([](JsonHandler& h) { h.onNull(); }))
+          return;
+        AnyReference slot = nextSlot();
+        if (slot.isValid())
+        {
+          switch (slot.kind())
+          {
+          case TypeKind_Optional: slot.resetOptional(); break;
+          case TypeKind_Dynamic: slot.setDynamic(AnyReference(qi::typeOf<void>())); break;
+          case TypeKind_Void: break;
+          default: mismatch(slot, "null");
+          }
+        }
+        endValue();
       }
-      getExponent(exponent);
-      floatStr = beforePoint + "." + afterPoint + exponent;
-    }
-    else
-      floatStr = beforePoint + exponent;
 
-    result = boost::lexical_cast<double>(floatStr.c_str());
-    return true;
-  }
+      void onBool(bool value) override
+      {
+        if (forward([=](JsonHandler& h) { h.onBool(value); }))
+          return;
+        setScalar(AnyReference::from(value), [=](AnyReference& slot) { slot.setInt(value); });
+      }
 
-  bool JsonDecoderPrivate::decodeArray(AnyValue &value)
-  {
-    std::string::const_iterator save = _it;
+      void onInt(int64_t value) override
+      {
+        if (forward([=](JsonHandler& h) { h.onInt(value); }))
+          return;
+        setScalar(AnyReference::from(value), [=](AnyReference& slot) { slot.setInt(value); });
+      }
 
-    if (_it == _end || *_it != '[')
-      return false;
-    ++_it;
-    AnyValueVector   tmpArray;
+      void onDouble(double value) override
+      {
+        if (forward([=](JsonHandler& h) { h.onDouble(value); }))
+          return;
+        setScalar(AnyReference::from(value), [=](AnyReference& slot) { slot.setDouble(value); });
+      }
 
-    while (true)
-    {
-      AnyValue subElement;
+      void onString(const char* data, std::size_t size) override
+      {
+        if (forward([=](JsonHandler& h) { h.onString(data, size); }))
+          return;
+        AnyReference slot = unwrapOptional(nextSlot());
+        if (slot.isValid())
+        {
+          static TypeInterface* tstring = qi::typeOf<std::string>();
+          if (slot.type() == tstring || slot.type()->info() == tstring->info())
+            slot.as<std::string>().assign(data, size);
+          else if (slot.kind() == TypeKind_Dynamic)
+            slot.setDynamic(AnyReference::from(std::string(data, size)));
+          else if (slot.kind() == TypeKind_String)
+            slot.setString(std::string(data, size));
+          else if (slot.kind() == TypeKind_Raw)
+            setRaw(slot, data, size);
+          else
+            mismatch(slot, "a string");
+        }
+        endValue();
+      }
 
-      if (!decodeValue(subElement))
-        break;
-      tmpArray.push_back(subElement);
-      if (*_it != ',')
-        break;
-      ++_it;
-    }
-    if (*_it != ']')
-    {
-      _it = save;
-      return false;
-    }
-    ++_it;
-    value = AnyValue(tmpArray);
-    return true;
-  }
+      void onBeginArray() override
+      {
+        if (forward([](JsonHandler& h) { h.onBeginArray(); }))
+          return;
+        AnyReference slot = unwrapOptional(nextSlot());
+        if (!slot.isValid() || slot.kind() == TypeKind_Dynamic)
+          return delegate(slot, [](JsonHandler& h) { h.onBeginArray(); });
+        Frame frame;
+        frame.container = slot;
+        if (slot.kind() == TypeKind_Tuple)
+          frame.initMembers();
+        else if (slot.kind() != TypeKind_List && slot.kind() != TypeKind_VarArgs)
+          mismatch(slot, "an array");
+        _frames.push_back(frame);
+      }
 
-  bool JsonDecoderPrivate::decodeFloat(AnyValue &value)
-  {
-    double tmpFloat;
+      void onEndArray() override
+      {
+        if (forward([](JsonHandler& h) { h.onEndArray(); }))
+          return;
+        endContainer();
+      }
 
-    if (!getFloat(tmpFloat))
-      return false;
-    value = AnyValue(tmpFloat);
-    return true;
-  }
+      void onBeginObject() override
+      {
+        if (forward([](JsonHandler& h) { h.onBeginObject(); }))
+          return;
+        AnyReference slot = unwrapOptional(nextSlot());
+        if (!slot.isValid() || slot.kind() == TypeKind_Dynamic)
+          return delegate(slot, [](JsonHandler& h) { h.onBeginObject(); });
+        Frame frame;
+        frame.container = slot;
+        if (slot.kind() == TypeKind_Tuple)
+        {
+          frame.initMembers();
+          frame.byName = true;
+          frame.index = noMember;
+          if (frame.structType()->cachedElementsName().empty())
+          {
+            frame.destroy();
+            mismatch(slot, "an object");
+          }
+        }
+        else if (slot.kind() != TypeKind_Map)
+          mismatch(slot, "an object");
+        _frames.push_back(frame);
+      }
 
-  bool JsonDecoderPrivate::decodeInteger(AnyValue &value)
-  {
-    qi::int64_t tmpInteger;
+      void onKey(const char* data, std::size_t size) override
+      {
+        if (forward([=](JsonHandler& h) { h.onKey(data, size); }))
+          return;
+        Frame& frame = _frames.back();
+        if (frame.byName)
+        {
+          const auto& names = frame.structType()->cachedElementsName();
+          frame.index = noMember;
+          for (unsigned int i = 0; i < names.size(); ++i)
+          {
+            if (names[i].size() == size && names[i].compare(0, size, data, size) == 0)
+            {
+              frame.index = i;
+              break;
+            }
+          }
+          return;
+        }
+        TypeInterface* keyType = static_cast<MapTypeInterface*>(frame.container.type())->keyType();
+        frame.key = AnyReference(keyType);
+        frame.key.setString(std::string(data, size));
+      }
 
-    if (!getInteger(tmpInteger))
-      return false;
-    value = AnyValue(tmpInteger);
-    return true;
-  }
+      void onEndObject() override
+      {
+        if (forward([](JsonHandler& h) { h.onEndObject(); }))
+          return;
+        endContainer();
+      }
 
-  bool JsonDecoderPrivate::getCleanString(std::string &result)
-  {
-    std::string::const_iterator save = _it;
+    private:
+      static const unsigned int noMember = static_cast<unsigned int>(-1);
 
-    if (_it == _end || *_it != '"')
-      return false;
-    std::string tmpString;
+      struct Frame
+      {
+        void initMembers()
+        {
+          for (TypeInterface* type : structType()->cachedMemberTypes())
+            members.push_back(AnyReference(type));
+        }
 
-    ++_it;
-    for (;_it != _end && *_it != '"';)
-    {
-      if (*_it == '\\')
+        StructTypeInterface* structType()
+        {
+          return static_cast<StructTypeInterface*>(container.type());
+        }
+
+        void destroy()
+        {
+          element.destroy();
+          key.destroy();
+          for (auto& member : members)
+            member.destroy();
+          members.clear();
+        }
+
+        // The list, map, struct or optional being decoded.
+        AnyReference container;
+        // Owned. The element of the list or map, or the value of the optional.
+        AnyReference element;
+        // Owned. The key of the element of the map.
+        AnyReference key;
+        // Owned. The fields of the struct, set all at once when it ends.
+        AnyReferenceVector members;
+        unsigned int index = 0;
+        bool byName = false;
+      };
+
+      // Raw data is encoded as a base64 string.
+      static void setRaw(AnyReference slot, const char* data, std::size_t size)
       {
-        if (_it + 1 == _end)
+        std::string raw;
+        if (!detail::decodeBase64(data, size, raw))
         {
-          _it = save;
-          return false;
+          std::ostringstream ss;
+          ss << "JSON decoding: invalid base64 data for a value of type "
+             << slot.type()->infoString();
+          throw std::runtime_error(ss.str());
         }
-        switch (*(_it + 1))
+        slot.setRaw(raw.data(), raw.size());
+      }
+
+      QI_NORETURN void mismatch(AnyReference slot, const char* what)
+      {
+        std::ostringstream ss;
+        ss << "JSON decoding: cannot store " << what << " in a value of type "
+           << slot.type()->infoString();
+        throw std::runtime_error(ss.str());
+      }
+
+      // Forwards the event to the builder of the dynamic value being decoded,
+      // if any.
+      template <typename F>
+      bool forward(F event)
+      {
+        if (!_dynamic)
+          return false;
+        event(*_dynamic);
+        if (_dynamic->done())
         {
-        case '"' : tmpString += '"' ; _it += 2; break;
-        case '\\': tmpString += '\\'; _it += 2; break;
-        case '/' : tmpString += '/' ; _it += 2; break;
-        case 'b' : tmpString += '\b'; _it += 2; break;
-        case 'f' : tmpString += '\f'; _it += 2; break;
-        case 'n' : tmpString += '\n'; _it += 2; break;
-        case 'r' : tmpString += '\r'; _it += 2; break;
-        case 't' : tmpString += '\t'; _it += 2; break;
-#ifdef WITH_BOOST_LOCALE
-        case 'u' :
+          if (_dynamicSlot.isValid())
+            _dynamicSlot.setDynamic(_dynamic->result().asReference());
+          _dynamic.reset();
+          endValue();
+        }
+        return true;
+      }
+
+      // An invalid slot means the value is dropped.
+      template <typename F>
+      void delegate(AnyReference slot, F event)
+      {
+        _dynamic.reset(new JsonValueBuilder);
+        _dynamicSlot = slot;
+        event(*_dynamic);
+      }
+
+      template <typename F>
+      void setScalar(AnyReference value, F set)
+      {
+        AnyReference slot = unwrapOptional(nextSlot());
+        if (slot.isValid())
         {
-          if (std::distance(_it, _end) <= 6)
-          {
-            _it = save;
-            return false;
-          }
-          std::istringstream ss(std::string(_it+2, _it+6));
-          int val;
-          ss >> std::hex >> val;
-          if (!ss.eof())
+          switch (slot.kind())
           {
-            _it = save;
-            return false;
+          case TypeKind_Int:
+          case TypeKind_Float: set(slot); break;
+          case TypeKind_Dynamic: slot.setDynamic(value); break;
+          default: mismatch(slot, "a number");
           }
-          tmpString += boost::locale::conv::utf_to_utf<char>(&val, &val + 1);
-          _it += 6;
-          break;
         }
-#endif
+        endValue();
+      }
+
+      // Returns where the next value goes.
+      AnyReference nextSlot()
+      {
+        if (_frames.empty())
+          return _target;
+        Frame& frame = _frames.back();
+        switch (frame.container.kind())
+        {
+        case TypeKind_Tuple:
+          if (frame.index == noMember)
+            return AnyReference();
+          if (frame.index >= frame.members.size())
+            mismatch(frame.container, "an array of this size");
+          return frame.members[frame.index];
+        case TypeKind_Optional:
+          return frame.element;
+        case TypeKind_Map:
+          frame.element = AnyReference(static_cast<MapTypeInterface*>(frame.container.type())->elementType());
+          return frame.element;
         default:
-          _it = save;
-          return false;
+          frame.element = AnyReference(static_cast<ListTypeInterface*>(frame.container.type())->elementType());
+          return frame.element;
         }
       }
-      else
+
+      // Optionals receiving a value are decoded through a frame holding the
+      // value, set in the optional once complete.
+      AnyReference unwrapOptional(AnyReference slot)
       {
-        tmpString += *_it;
-        ++_it;
+        while (slot.isValid() && slot.kind() == TypeKind_Optional)
+        {
+          Frame frame;
+          frame.container = slot;
+          frame.element = AnyReference(static_cast<OptionalTypeInterface*>(slot.type())->valueType());
+          _frames.push_back(frame);
+          slot = frame.element;
+        }
+        return slot;
       }
-    }
-    if (_it == _end)
+
+      // Called once the value in the current slot is complete.
+      void endValue()
+      {
+        while (!_frames.empty())
+        {
+          Frame& frame = _frames.back();
+          switch (frame.container.kind())
+          {
+          case TypeKind_Tuple:
+            if (!frame.byName)
+              ++frame.index;
+            return;
+          case TypeKind_Map:
+            frame.container.insert(frame.key, frame.element);
+            frame.destroy();
+            return;
+          case TypeKind_Optional:
+            frame.container.setOptional(boost::make_optional(frame.element));
+            frame.destroy();
+            _frames.pop_back();
+            break; // the optional is complete in turn
+          default:
+            frame.container.append(frame.element);
+            frame.destroy();
+            return;
+          }
+        }
+      }
+
+      void endContainer()
+      {
+        Frame& frame = _frames.back();
+        if (frame.container.kind() == TypeKind_Tuple)
+        {
+          if (!frame.byName && frame.index != frame.members.size())
+            mismatch(frame.container, "an array of this size");
+          frame.container.setTuple(frame.members);
+        }
+        frame.destroy();
+        _frames.pop_back();
+        endValue();
+      }
+
+      AnyReference _target;
+      std::vector<Frame> _frames;
+      std::unique_ptr<JsonValueBuilder> _dynamic;
+      AnyReference _dynamicSlot;
+    };
+  }
+
+  JsonDecoderPrivate::JsonDecoderPrivate(const std::string::const_iterator &begin,
+                    const std::string::const_iterator &end)
+    :_begin(begin),
+      _end(end),
+      _it(_begin)
+  {}
+
+  std::string::const_iterator JsonDecoderPrivate::decode(JsonHandler &handler)
+  {
+    _it = _begin;
+    decodeValue(handler);
+    return _it;
+  }
+
+  void JsonDecoderPrivate::fail() const
+  {
+    std::ostringstream ss;
+    ss << "parse error at offset " << (_it - _begin);
+    throw std::runtime_error(ss.str());
+  }
+
+  void JsonDecoderPrivate::skipWhiteSpaces()
+  {
+    while (_it != _end && (*_it == ' ' || *_it == '\n' || *_it == '\r' || *_it == '\t'))
+      ++_it;
+  }
+
+  bool JsonDecoderPrivate::match(const char* expected)
+  {
+    std::string::const_iterator it = _it;
+
+    for (; *expected; ++expected, ++it)
     {
-      _it = save;
-      return false;
+      if (it == _end || *it != *expected)
+        return false;
     }
-    ++_it;
-    result = tmpString;
+    _it = it;
     return true;
   }
 
-  bool JsonDecoderPrivate::decodeString(AnyValue &value)
+  unsigned int JsonDecoderPrivate::getHexQuad()
   {
-    std::string tmpString;
-
-    if (!getCleanString(tmpString))
-      return false;
-    value = AnyValue(tmpString);
-    return true;
+    if (_end - _it < 4)
+      fail();
+    unsigned int result = 0;
+    for (int i = 0; i < 4; ++i, ++_it)
+    {
+      const char c = *_it;
+      result <<= 4;
+      if (c >= '0' && c <= '9')
+        result |= c - '0';
+      else if (c >= 'a' && c <= 'f')
+        result |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        result |= c - 'A' + 10;
+      else
+        fail();
+    }
+    return result;
   }
 
-  bool JsonDecoderPrivate::decodeObject(AnyValue &value)
+  // Reads the digits of a \u escape, and those of the low surrogate
+  // following a high one.
+  unsigned int JsonDecoderPrivate::getCodePoint()
   {
-    std::string::const_iterator save = _it;
+    static const unsigned int replacementCharacter = 0xFFFD;
+    const unsigned int unit = getHexQuad();
+    if (unit < 0xD800 || unit > 0xDFFF)
+      return unit;
+    if (unit > 0xDBFF || _end - _it < 6 || _it[0] != '\\' || _it[1] != 'u')
+      return replacementCharacter;
+    const std::string::const_iterator save = _it;
+    _it += 2;
+    const unsigned int low = getHexQuad();
+    if (low < 0xDC00 || low > 0xDFFF)
+    {
+      _it = save;
+      return replacementCharacter;
+    }
+    return 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+  }
 
-    if (_it == _end || *_it != '{')
-      return false;
+  void JsonDecoderPrivate::getCleanString(std::string &result)
+  {
+    // *_it is the opening quote.
     ++_it;
-
-    std::map<std::string, AnyValue> tmpMap;
+    result.clear();
     while (true)
     {
-      skipWhiteSpaces();
-      std::string key;
-
-      if (!getCleanString(key))
-        break;
-      skipWhiteSpaces();
-      if (_it == _end || *_it != ':')
+      std::string::const_iterator run = _it;
+      while (_it != _end && *_it != '"' && *_it != '\\')
+        ++_it;
+      result.append(run, _it);
+      if (_it == _end)
+        fail();
+      if (*_it == '"')
       {
-        _it = save;
-        return false;
+        ++_it;
+        return;
       }
-      ++_it;
-      AnyValue tmpValue;
-      if (!decodeValue(tmpValue))
+      if (++_it == _end)
+        fail();
+      switch (*_it++)
       {
-        _it = save;
-        return false;
+      case '"' : result += '"' ; break;
+      case '\\': result += '\\'; break;
+      case '/' : result += '/' ; break;
+      case 'b' : result += '\b'; break;
+      case 'f' : result += '\f'; break;
+      case 'n' : result += '\n'; break;
+      case 'r' : result += '\r'; break;
+      case 't' : result += '\t'; break;
+      case 'u' : appendUtf8(result, getCodePoint()); break;
+      default:
+        --_it;
+        fail();
       }
-      if (_it == _end)
-        break;
-      tmpMap[key] = tmpValue;
-      if (*_it != ',')
-        break;
-      ++_it;
     }
-    if (_it == _end || *_it != '}')
+  }
+
+  void JsonDecoderPrivate::decodeArray(JsonHandler &handler)
+  {
+    ++_it;
+    handler.onBeginArray();
+    skipWhiteSpaces();
+    while (_it != _end && *_it != ']')
     {
-      _it = save;
-      return false;
+      decodeValue(handler);
+      if (_it == _end || *_it != ',')
+        break;
+      ++_it;
+      skipWhiteSpaces();
     }
+    if (_it == _end || *_it != ']')
+      fail();
     ++_it;
-    value = AnyValue(tmpMap);
-    return true;
+    handler.onEndArray();
   }
 
-  bool JsonDecoderPrivate::match(std::string const& expected)
+  void JsonDecoderPrivate::decodeNumber(JsonHandler &handler)
   {
-    std::string::const_iterator save = _it;
-    std::string::const_iterator begin = expected.begin();
+    const std::string::const_iterator begin = _it;
+    const bool negative = *_it == '-';
+    if (negative)
+      ++_it;
+
+    const std::string::const_iterator digits = _it;
+    const uint64_t max = std::numeric_limits<uint64_t>::max();
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    for (; _it != _end && isDigit(*_it); ++_it)
+    {
+      const unsigned int digit = *_it - '0';
+      if (magnitude > (max - digit) / 10)
+        overflow = true;
+      else
+        magnitude = magnitude * 10 + digit;
+    }
+    if (_it == digits)
+      fail();
 
-    while (_it != _end && begin != expected.end())
+    // A point or an exponent not followed by digits is not part of the number.
+    bool isFloat = false;
+    if (_end - _it >= 2 && *_it == '.' && isDigit(_it[1]))
     {
-      if (*_it != *begin)
+      isFloat = true;
+      _it += 2;
+      while (_it != _end && isDigit(*_it))
+        ++_it;
+    }
+    if (_it != _end && (*_it == 'e' || *_it == 'E'))
+    {
+      std::string::const_iterator exponent = _it + 1;
+      if (exponent != _end && (*exponent == '+' || *exponent == '-'))
+        ++exponent;
+      if (exponent != _end && isDigit(*exponent))
       {
-        _it = save;
-        return false;
+        isFloat = true;
+        _it = exponent;
+        while (_it != _end && isDigit(*_it))
+          ++_it;
       }
-      ++_it;
-      ++begin;
     }
-    if (begin != expected.end())
+
+    if (isFloat)
+      handler.onDouble(toDouble(&*begin, _it - begin));
+    else
+      handler.onInt(toInt64(negative, magnitude, overflow));
+  }
+
+  void JsonDecoderPrivate::decodeObject(JsonHandler &handler)
+  {
+    ++_it;
+    handler.onBeginObject();
+    skipWhiteSpaces();
+    while (_it != _end && *_it == '"')
     {
-      _it = save;
-      return false;
+      getCleanString(_string);
+      handler.onKey(_string.data(), _string.size());
+      skipWhiteSpaces();
+      if (_it == _end || *_it != ':')
+        fail();
+      ++_it;
+      decodeValue(handler);
+      if (_it == _end || *_it != ',')
+        break;
+      ++_it;
+      skipWhiteSpaces();
     }
-    return true;
+    if (_it == _end || *_it != '}')
+      fail();
+    ++_it;
+    handler.onEndObject();
   }
 
-  bool JsonDecoderPrivate::decodeSpecial(AnyValue &value)
+  void JsonDecoderPrivate::decodeSpecial(JsonHandler &handler)
   {
-    if (_it == _end)
-      return false;
     if (match("true"))
-      value = AnyValue(true);
+      handler.onBool(true);
     else if (match("false"))
-      value = AnyValue::from(false);
+      handler.onBool(false);
     else if (match("null"))
-      value = AnyValue(qi::typeOf<void>());
+      handler.onNull();
     else
-      return false;
-    return true;
+      fail();
   }
 
-  bool JsonDecoderPrivate::decodeValue(AnyValue &value)
+  void JsonDecoderPrivate::decodeValue(JsonHandler &handler)
   {
     skipWhiteSpaces();
-    if (decodeSpecial(value)
-        || decodeString(value)
-        || decodeFloat(value)
-        || decodeInteger(value)
-        || decodeArray(value)
-        || decodeObject(value)
-        )
+    if (_it == _end)
+      fail();
+    switch (*_it)
     {
-      skipWhiteSpaces();
-      return true;
+    case '"':
+      getCleanString(_string);
+      handler.onString(_string.data(), _string.size());
+      break;
+    case '[':
+      decodeArray(handler);
+      break;
+    case '{':
+      decodeObject(handler);
+      break;
+    case 't':
+    case 'f':
+    case 'n':
+      decodeSpecial(handler);
+      break;
+    default:
+      if (*_it != '-' && !isDigit(*_it))
+        fail();
+      decodeNumber(handler);
     }
-    return false;
+    skipWhiteSpaces();
   }
 
   std::string::const_iterator decodeJSON(const std::string::const_iterator &begin,
                                          const std::string::const_iterator &end,
-                                         AnyValue &target)
+                                         JsonHandler &handler)
   {
     JsonDecoderPrivate parser(begin, end);
-    return parser.decode(target);
+    return parser.decode(handler);
+  }
+
+  std::string::const_iterator decodeJSON(const std::string::const_iterator &begin,
+                                         const std::string::const_iterator &end,
+                                         AnyValue &target)
+  {
+    JsonValueBuilder builder;
+    std::string::const_iterator it = decodeJSON(begin, end, builder);
+    target = std::move(builder.result());
+    return it;
   }
 
   AnyValue decodeJSON(const std::string &in)
   {
-    AnyValue value;
-    JsonDecoderPrivate parser(in);
+    JsonValueBuilder builder;
+    decodeJSON(in.begin(), in.end(), builder);
+    return std::move(builder.result());
+  }
 
-    parser.decode(value);
-    return value;
+  void decodeJSON(const std::string &in, AnyReference target)
+  {
+    JsonTypedBuilder builder(target);
+    decodeJSON(in.begin(), in.end(), builder);
   }
 
 }
@@ -3,22 +3,21 @@
 **  See COPYING for the license
 */
 
-#include <sstream>
+#include <clocale>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <string>
-#include <iomanip>
-#ifdef WITH_BOOST_LOCALE
-#  include <boost/locale.hpp>
-#endif
 #include <qi/jsoncodec.hpp>
 #include <qi/anyobject.hpp>
 #include <qi/type/typedispatcher.hpp>
-#include <qi/numeric.hpp>
+#include "../base64.hpp"
 
 qiLogCategory("qitype.jsonencoder");
 
 namespace qi {
 
-  static void serialize(AnyReference val, std::stringstream& out, JsonOption jsonPrintOption, unsigned int indent);
+  static void serialize(AnyReference val, std::string& out, JsonOption jsonPrintOption, unsigned int indent);
 
   //Taken from boost::json
   inline char to_hex_char(unsigned int c)
@@ -30,118 +29,222 @@ namespace qi {
     return 'A' - 10 + ch;
   }
 
-  //Taken from boost::json
-  std::string non_printable_to_string(unsigned int c)
+  static void appendNonPrintable(std::string& out, unsigned int c)
   {
-    std::string result( 6, '\\' );
-    result[1] = 'u';
-    result[ 5 ] = to_hex_char(c & 0x000F);
-    c >>= 4;
-    result[ 4 ] = to_hex_char(c & 0x000F);
-    c >>= 4;
-    result[ 3 ] = to_hex_char(c & 0x000F);
-    c >>= 4;
-    result[ 2 ] = to_hex_char(c & 0x000F);
-    return result;
+    const char escaped[6] = { '\\', 'u',
+                              to_hex_char((c >> 12) & 0xF), to_hex_char((c >> 8) & 0xF),
+                              to_hex_char((c >> 4) & 0xF), to_hex_char(c & 0xF) };
+    out.append(escaped, sizeof(escaped));
   }
 
-  //Taken from boost::json
-  bool add_esc_char(char c, std::string& s, JsonOption jsonPrintOption)
+  static bool isEscapedInJson(char c)
   {
-    if (!(jsonPrintOption & JsonOption_Expand))
-    {
-      switch(c)
-      {
-      case '"':  s += "\\\""; return true;
-      case '\\': s += "\\\\"; return true;
-      case '\b': s += "\\b" ; return true;
-      case '\f': s += "\\f" ; return true;
-      case '\n': s += "\\n" ; return true;
-      case '\r': s += "\\r" ; return true;
-      case '\t': s += "\\t" ; return true;
-      }
-    }
-    else
+    switch (c)
     {
-      s += c;
+    case '"': case '\\': case '\b': case '\f': case '\n': case '\r': case '\t':
       return true;
     }
     return false;
   }
 
-  //Taken from boost::json
-  std::string add_esc_chars(const std::wstring& s, JsonOption jsonPrintOption)
+  static void appendEscapedChar(std::string& out, char c)
   {
-    using Iter_type = std::wstring::const_iterator;
-    using Char_type = std::wstring::value_type;
+    switch (c)
+    {
+    case '"':  out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\b': out += "\\b" ; break;
+    case '\f': out += "\\f" ; break;
+    case '\n': out += "\\n" ; break;
+    case '\r': out += "\\r" ; break;
+    case '\t': out += "\\t" ; break;
+    }
+  }
 
-    std::string result;
-    const Iter_type end( s.end() );
+  // Returns the length of the UTF-8 sequence starting at data and sets
+  // codePoint, or returns 0 if the sequence is invalid.
+  static size_t decodeUtf8(const unsigned char* data, size_t size, unsigned int& codePoint)
+  {
+    size_t length;
+    unsigned int minimum;
+    if (data[0] >= 0xC2 && data[0] <= 0xDF)
+    {
+      length = 2;
+      minimum = 0x80;
+      codePoint = data[0] & 0x1F;
+    }
+    else if (data[0] >= 0xE0 && data[0] <= 0xEF)
+    {
+      length = 3;
+      minimum = 0x800;
+      codePoint = data[0] & 0x0F;
+    }
+    else if (data[0] >= 0xF0 && data[0] <= 0xF4)
+    {
+      length = 4;
+      minimum = 0x10000;
+      codePoint = data[0] & 0x07;
+    }
+    else
+      return 0;
+    if (size < length)
+      return 0;
+    for (size_t i = 1; i < length; ++i)
+    {
+      if ((data[i] & 0xC0) != 0x80)
+        return 0;
+      codePoint = (codePoint << 6) | (data[i] & 0x3F);
+    }
+    if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+      return 0;
+    return length;
+  }
 
-    for(Iter_type i = s.begin(); i != end; ++i)
+  /*
+   * Escapes the UTF-8 string directly in the output: runs of printable ASCII
+   * characters are appended at once, other characters as \uXXXX escapes of
+   * their code point (a surrogate pair above U+FFFF). Bytes that are not part
+   * of valid UTF-8 sequences are escaped as if they were Latin-1.
+   */
+  static void appendEscapedString(std::string& out, const char* data, size_t size, JsonOption jsonPrintOption)
+  {
+    const bool expand = (jsonPrintOption & JsonOption_Expand) != 0;
+    const unsigned char* it = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* const end = it + size;
+    while (it != end)
     {
-      const Char_type c(*i);
-      if (qi::numericIsInRange<char>(c) &&
-          add_esc_char(static_cast<char>(c), result, jsonPrintOption))
+      const unsigned char* run = it;
+      // 127 is the end of printable characters in ASCII table.
+      while (it != end && *it >= 0x20 && *it < 127 && (expand || !isEscapedInJson(static_cast<char>(*it))))
+        ++it;
+      out.append(reinterpret_cast<const char*>(run), it - run);
+      if (it == end)
+        break;
+
+      const unsigned char c = *it;
+      if (c < 0x80)
+      {
+        if (expand)
+          out += static_cast<char>(c);
+        else if (isEscapedInJson(static_cast<char>(c)))
+          appendEscapedChar(out, static_cast<char>(c));
+        else
+          appendNonPrintable(out, c);
+        ++it;
         continue;
-      const wint_t unsigned_c = qi::numericConvert<wint_t>(c);
+      }
 
-      // 127 is the end of printable characters in ASCII table.
-      if(iswprint(unsigned_c) && unsigned_c < 127)
-        result += static_cast<char>(c);
+      unsigned int codePoint = 0;
+      const size_t length = decodeUtf8(it, end - it, codePoint);
+      if (length == 0)
+      {
+        appendNonPrintable(out, c);
+        ++it;
+        continue;
+      }
+      if (codePoint > 0xFFFF)
+      {
+        codePoint -= 0x10000;
+        appendNonPrintable(out, 0xD800 + (codePoint >> 10));
+        appendNonPrintable(out, 0xDC00 + (codePoint & 0x3FF));
+      }
       else
-        result += non_printable_to_string(unsigned_c);
+        appendNonPrintable(out, codePoint);
+      it += length;
     }
-    return result;
+  }
+
+  static void appendUInt(std::string& out, uint64_t value)
+  {
+    char digits[20];
+    char* begin = digits + sizeof(digits);
+    do
+    {
+      *--begin = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value);
+    out.append(begin, digits + sizeof(digits) - begin);
+  }
+
+  static void appendInt(std::string& out, int64_t value)
+  {
+    if (value < 0)
+    {
+      out += '-';
+      // Negate as unsigned, which does not overflow on the minimum value.
+      appendUInt(out, 0u - static_cast<uint64_t>(value));
+    }
+    else
+      appendUInt(out, static_cast<uint64_t>(value));
+  }
+
+  // Same output as a stream in the "C" locale with the given precision.
+  static void appendFloat(std::string& out, double value, int precision)
+  {
+    char buffer[64];
+    const int size = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+    if (size <= 0)
+      return;
+    // snprintf follows the decimal point of the C locale, JSON does not.
+    const char point = *std::localeconv()->decimal_point;
+    if (point != '.')
+    {
+      if (char* p = std::strchr(buffer, point))
+        *p = '.';
+    }
+    out.append(buffer, size);
   }
 
   std::string encodeJSON(const qi::AutoAnyReference &value, JsonOption jsonPrintOption) {
-    std::stringstream ss;
-    serialize(value, ss, jsonPrintOption, 0);
-    return ss.str();
+    std::string result;
+    serialize(value, result, jsonPrintOption, 0);
+    return result;
+  }
+
+  void encodeJSON(const qi::AutoAnyReference &value, std::string &out, JsonOption jsonPrintOption) {
+    serialize(value, out, jsonPrintOption, 0);
   }
 
   class SerializeJSONTypeVisitor
   {
   public:
-    SerializeJSONTypeVisitor(std::stringstream& outd, JsonOption jsonPrintOptiond, unsigned int indentd)
+    SerializeJSONTypeVisitor(std::string& outd, JsonOption jsonPrintOptiond, unsigned int indentd)
       : out(outd)
       , jsonPrintOption(jsonPrintOptiond)
       , indent(indentd)
     {
-      //force C local, for int and float formatting
-      out.imbue(std::locale("C"));
     }
 
     void printIndent()
     {
       if (jsonPrintOption & qi::JsonOption_PrettyPrint)
       {
-        out << std::endl;
-        for (unsigned int i = 0; i < indent; ++i)
-          out << "  ";
+        out += '\n';
+        out.append(2 * indent, ' ');
       }
     }
 
     void printColon()
     {
       if (jsonPrintOption & qi::JsonOption_PrettyPrint)
-        out << ": ";
+        out += ": ";
       else
-        out << ":";
+        out += ':';
     }
 
 
     void visitUnknown(AnyReference v)
     {
       qiLogError() << "JSON Error: Type " << v.type()->infoString() <<" not serializable";
-      out << "\"Error: no serialization for unknown type:" << v.type()->infoString() << "\"";
+      out += "\"Error: no serialization for unknown type:";
+      out += v.type()->infoString();
+      out += '"';
     }
 
     void visitVoid()
     {
       // Not an error, makes sense if encapsulated in a Dynamic for instance
-      out << "null";
+      out += "null";
     }
 
     void visitInt(int64_t value, bool isSigned, int byteSize)
@@ -151,19 +254,19 @@ namespace qi {
       case 0: {
         bool v = value != 0;
         if (v)
-          out << "true";
+          out += "true";
         else
-          out << "false";
+          out += "false";
         break;
       }
       case 1:
       case 2:
       case 4:
-      case 8:  out << ((int64_t)value); break;
+      case 8:  appendInt(out, value); break;
       case -1:
       case -2:
       case -4:
-      case -8: out << ((uint64_t)value);break;
+      case -8: appendUInt(out, (uint64_t)value);break;
 
       default:
         qiLogError() << "Unknown integer type " << isSigned << " " << byteSize;
@@ -174,13 +277,11 @@ namespace qi {
     {
       if (byteSize == 4)
       {
-        out.precision(std::numeric_limits<float>::max_digits10);
-        out << ((float)value);
+        appendFloat(out, (float)value, std::numeric_limits<float>::max_digits10);
       }
       else if (byteSize == 8)
       {
-        out.precision(std::numeric_limits<double>::max_digits10);
-        out << ((double)value);
+        appendFloat(out, value, std::numeric_limits<double>::max_digits10);
       }
       else
       {
@@ -190,16 +291,14 @@ namespace qi {
 
     void visitString(const char* data, size_t size)
     {
-#ifdef WITH_BOOST_LOCALE
-      out << "\"" << add_esc_chars(boost::locale::conv::to_utf<wchar_t>(std::string(data, size), "UTF-8"), jsonPrintOption) << "\"";
-#else
-      out << "\"" << add_esc_chars(std::wstring(data, data+size), jsonPrintOption) << "\"";
-#endif
+      out += '"';
+      appendEscapedString(out, data, size, jsonPrintOption);
+      out += '"';
     }
 
     void visitList(AnyIterator begin, AnyIterator end)
     {
-      out << "[";
+      out += '[';
       ++indent;
       const bool empty = begin == end;
       while (begin != end)
@@ -208,12 +307,12 @@ namespace qi {
         serialize(*begin, out, jsonPrintOption, indent);
         ++begin;
         if (begin != end)
-          out << ",";
+          out += ',';
       }
       --indent;
       if (!empty)
         printIndent();
-      out << "]";
+      out += ']';
     }
 
     void visitVarArgs(AnyIterator begin, AnyIterator end)
@@ -223,7 +322,7 @@ namespace qi {
 
     void visitMap(AnyIterator begin, AnyIterator end)
     {
-      out << "{";
+      out += '{';
       ++indent;
       const bool empty = begin == end;
       while (begin != end)
@@ -235,39 +334,39 @@ namespace qi {
         serialize(e[1], out, jsonPrintOption, indent);
         ++begin;
         if (begin != end)
-          out << ",";
+          out += ',';
       }
       --indent;
       if (!empty)
         printIndent();
-      out << "}";
+      out += '}';
     }
 
     void visitObject(GenericObject value)
     {
       // TODO: implement?
       qiLogError() << "JSON Error: Serializing an object without a shared pointer";
-      out << "\"Error: no serialization for object\"";
+      out += "\"Error: no serialization for object\"";
     }
 
     void visitAnyObject(AnyObject& value)
     {
       // TODO: implement?
       qiLogError() << "JSON Error: Serializing an object without a shared pointer";
-      out << "\"Error: no serialization for object\"";
+      out += "\"Error: no serialization for object\"";
     }
 
     void visitPointer(AnyReference pointee)
     {
       qiLogError() << "JSON Error: error a pointer!!!";
-      out << "\"Error: no serialization for pointer\"";
+      out += "\"Error: no serialization for pointer\"";
     }
 
-    void visitTuple(const std::string &name, const AnyReferenceVector &vals, const std::vector<std::string> &annotations)
+    void visitTuple(const std::string &name, const StructMembers &vals, const std::vector<std::string> &annotations)
     {
       //is the tuple is annotated serialize as an object
       if (annotations.size()) {
-        out << "{";
+        out += '{';
         ++indent;
         for (unsigned i=0; i<vals.size();++i) {
           printIndent();
@@ -275,25 +374,25 @@ namespace qi {
           printColon();
           serialize(vals[i], out, jsonPrintOption, indent);
           if (i + 1 < vals.size())
-            out << ",";
+            out += ',';
         }
         --indent;
         printIndent();
-        out << "}";
+        out += '}';
         return;
       }
 
-      out << "[";
+      out += '[';
       ++indent;
       for (unsigned i=0; i<vals.size();++i) {
         printIndent();
         serialize(vals[i], out, jsonPrintOption, indent);
         if (i + 1 < vals.size())
-          out << ",";
+          out += ',';
       }
       --indent;
       printIndent();
-      out << "]";
+      out += ']';
     }
 
     void visitDynamic(AnyReference pointee)
@@ -305,15 +404,17 @@ namespace qi {
 
     void visitRaw(AnyReference raw)
     {
-      //TODO: implement buffer support
-      qiLogError() << "JSON Error: raw data encoder not implemented!!!";
-      out << "\"Error: no serialization for Buffer\"";
+      // Raw data is encoded as a base64 string.
+      const auto data = raw.asRaw();
+      out += '"';
+      detail::encodeBase64(data.first, data.second, out);
+      out += '"';
     }
 
     void visitIterator(AnyReference)
     {
       qiLogError() << "JSON Error: no serialization for iterator!!!";
-      out << "\"Error: no serialization for iterator\"";
+      out += "\"Error: no serialization for iterator\"";
     }
 
     void visitOptional(AnyReference value)
@@ -324,16 +425,16 @@ namespace qi {
       }
       else
       {
-        out << "null";
+        out += "null";
       }
     }
 
-    std::stringstream& out;
+    std::string& out;
     JsonOption jsonPrintOption;
     unsigned int indent;
   };
 
-  static void serialize(AnyReference val, std::stringstream& out, JsonOption jsonPrintOption, unsigned int indent)
+  static void serialize(AnyReference val, std::string& out, JsonOption jsonPrintOption, unsigned int indent)
   {
     SerializeJSONTypeVisitor stv(out, jsonPrintOption, indent);
     qi::typeDispatch(stv, val);
@@ -1,9 +1,185 @@
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <limits>
 #include <qi/type/detail/manageable.hpp>
 #include <qi/type/objecttypebuilder.hpp>
 #include "../type/signal_p.hpp"
 
 namespace qi
 {
+  namespace
+  {
+    // Statistics are recorded into stripes, each thread using the stripe
+    // selected by its index, so that concurrent calls of a method rarely
+    // write to the same counters. The stripes are merged when read.
+    const unsigned int statsStripeCount = 4;
+
+    unsigned int currentStatsStripe()
+    {
+      static std::atomic<unsigned int> nextThreadIndex{ 0 };
+      static thread_local const unsigned int stripe = nextThreadIndex++ % statsStripeCount;
+      return stripe;
+    }
+
+    // Minimum, maximum and sum of durations, in nanoseconds.
+    struct DurationCounters
+    {
+      std::atomic<int64_t> minValue{ std::numeric_limits<int64_t>::max() };
+      std::atomic<int64_t> maxValue{ 0 };
+      std::atomic<int64_t> cumulatedValue{ 0 };
+
+      void push(int64_t value)
+      {
+        cumulatedValue.fetch_add(value, std::memory_order_relaxed);
+        int64_t current = minValue.load(std::memory_order_relaxed);
+        while (value < current &&
+               !minValue.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+        current = maxValue.load(std::memory_order_relaxed);
+        while (value > current &&
+               !maxValue.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+      }
+
+      void reset()
+      {
+        minValue.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+        cumulatedValue.store(0, std::memory_order_relaxed);
+      }
+    };
+
+    struct HistogramCounters
+    {
+      std::array<std::atomic<uint64_t>, LatencyHistogram::BucketCount> buckets;
+
+      HistogramCounters()
+      {
+        reset();
+      }
+
+      void push(int64_t value)
+      {
+        const auto index = LatencyHistogram::bucketIndex(static_cast<uint64_t>(std::max<int64_t>(value, 0)));
+        buckets[index].fetch_add(1, std::memory_order_relaxed);
+      }
+
+      void mergeInto(LatencyHistogram& histogram) const
+      {
+        std::vector<uint64_t> values(buckets.size());
+        for (std::size_t i = 0; i < buckets.size(); ++i)
+          values[i] = buckets[i].load(std::memory_order_relaxed);
+        histogram.merge(LatencyHistogram(std::move(values)));
+      }
+
+      void reset()
+      {
+        for (auto& bucket : buckets)
+          bucket.store(0, std::memory_order_relaxed);
+      }
+    };
+
+    struct StatsStripe
+    {
+      std::atomic<unsigned int> count{ 0 };
+      DurationCounters wall;
+      DurationCounters user;
+      DurationCounters system;
+      HistogramCounters wallHistogram;
+      HistogramCounters cpuHistogram;
+    };
+
+    MinMaxSum toMinMaxSum(int64_t minValue, int64_t maxValue, int64_t cumulatedValue)
+    {
+      return MinMaxSum(static_cast<float>(minValue) / 1e9f,
+                       static_cast<float>(maxValue) / 1e9f,
+                       static_cast<float>(cumulatedValue) / 1e9f);
+    }
+
+    // Statistics of one method. Never removed before the object is destroyed, so
+    // that they can be found and updated without locking.
+    struct MethodStatsCounters
+    {
+      explicit MethodStatsCounters(unsigned int methodId)
+        : methodId(methodId)
+      {
+      }
+
+      const unsigned int methodId;
+      // Next method in the same slot of ManageablePrivate::methodStats.
+      MethodStatsCounters* next = nullptr;
+      std::array<StatsStripe, statsStripeCount> stripes;
+
+      MethodStatistics statistics() const
+      {
+        unsigned int count = 0;
+        int64_t mins[3] = { std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::max(),
+                            std::numeric_limits<int64_t>::max() };
+        int64_t maxs[3] = { 0, 0, 0 };
+        int64_t sums[3] = { 0, 0, 0 };
+        for (const auto& stripe : stripes)
+        {
+          count += stripe.count.load(std::memory_order_relaxed);
+          const DurationCounters* counters[3] = { &stripe.wall, &stripe.user, &stripe.system };
+          for (int i = 0; i < 3; ++i)
+          {
+            mins[i] = std::min(mins[i], counters[i]->minValue.load(std::memory_order_relaxed));
+            maxs[i] = std::max(maxs[i], counters[i]->maxValue.load(std::memory_order_relaxed));
+            sums[i] += counters[i]->cumulatedValue.load(std::memory_order_relaxed);
+          }
+        }
+        for (auto& m : mins)
+          if (m == std::numeric_limits<int64_t>::max())
+            m = 0;
+        return MethodStatistics(count,
+                                toMinMaxSum(mins[0], maxs[0], sums[0]),
+                                toMinMaxSum(mins[1], maxs[1], sums[1]),
+                                toMinMaxSum(mins[2], maxs[2], sums[2]));
+      }
+
+      MethodHistograms histograms() const
+      {
+        LatencyHistogram wall;
+        LatencyHistogram cpu;
+        for (const auto& stripe : stripes)
+        {
+          stripe.wallHistogram.mergeInto(wall);
+          stripe.cpuHistogram.mergeInto(cpu);
+        }
+        return MethodHistograms(std::move(wall), std::move(cpu));
+      }
+
+      bool empty() const
+      {
+        for (const auto& stripe : stripes)
+          if (stripe.count.load(std::memory_order_relaxed) != 0)
+            return false;
+        return true;
+      }
+
+      void reset()
+      {
+        for (auto& stripe : stripes)
+        {
+          stripe.count.store(0, std::memory_order_relaxed);
+          stripe.wall.reset();
+          stripe.user.reset();
+          stripe.system.reset();
+          stripe.wallHistogram.reset();
+          stripe.cpuHistogram.reset();
+        }
+      }
+    };
+
+    // The argument capture options of a TraceOptions, in one word.
+    uint64_t packTraceCapture(const TraceOptions& options)
+    {
+      return static_cast<uint64_t>(options.arguments()) << 32 | options.maxArgumentSize();
+    }
+  }
 
   class ManageablePrivate
   {
@@ -20,19 +196,86 @@ namespace qi
 
     bool statsEnabled;
     bool traceEnabled;
-    ObjectStatistics stats;
+    // Lock-free hash table of the statistics of the methods, each slot being
+    // a list to which methods are only prepended.
+    std::array<std::atomic<MethodStatsCounters*>, 32> methodStats;
     qi::Atomic<int> traceId;
+
+    std::atomic<bool> traceRecordingEnabled{ false };
+    // The trace options, read without locking at each traced call: the
+    // sampling period, and the argument capture in the high 32 bits with the
+    // maximum argument size in the low ones. Written under traceMutex.
+    std::atomic<unsigned int> traceSamplingPeriod{ 1 };
+    std::atomic<uint64_t> traceCapture{ packTraceCapture(TraceOptions()) };
+    std::atomic<unsigned int> traceSampleCounter{ 0 };
+    mutable boost::mutex traceMutex;
+    std::vector<TraceRecord> pendingTraceRecords;
+
+    // Takes the pending records as a chunk. Must be called with traceMutex locked.
+    Buffer takeTraceRecords();
+
+    MethodStatsCounters& methodStatsCounters(unsigned int methodId);
+    template <typename F>
+    void forEachMethodStats(F f) const
+    {
+      for (const auto& slot : methodStats)
+        for (auto counters = slot.load(std::memory_order_acquire); counters; counters = counters->next)
+          f(*counters);
+    }
   };
 
+  Buffer ManageablePrivate::takeTraceRecords()
+  {
+    Buffer chunk;
+    chunk.write(pendingTraceRecords.data(), pendingTraceRecords.size() * sizeof(TraceRecord));
+    pendingTraceRecords.clear();
+    return chunk;
+  }
+
+  MethodStatsCounters& ManageablePrivate::methodStatsCounters(unsigned int methodId)
+  {
+    auto& slot = methodStats[methodId % methodStats.size()];
+    MethodStatsCounters* const first = slot.load(std::memory_order_acquire);
+    for (auto counters = first; counters; counters = counters->next)
+      if (counters->methodId == methodId)
+        return *counters;
+
+    std::unique_ptr<MethodStatsCounters> created(new MethodStatsCounters(methodId));
+    MethodStatsCounters* known = first;
+    created->next = first;
+    while (!slot.compare_exchange_weak(created->next, created.get(),
+                                       std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+      // Another thread prepended methods: it may be this one.
+      for (auto counters = created->next; counters != known; counters = counters->next)
+        if (counters->methodId == methodId)
+          return *counters;
+      known = created->next;
+    }
+    return *created.release();
+  }
+
   ManageablePrivate::ManageablePrivate()
     : dying(false)
     , statsEnabled(false)
     , traceEnabled(false)
   {
+    for (auto& slot : methodStats)
+      slot.store(nullptr, std::memory_order_relaxed);
   }
 
   ManageablePrivate::~ManageablePrivate()
   {
+    for (auto& slot : methodStats)
+    {
+      auto counters = slot.load(std::memory_order_acquire);
+      while (counters)
+      {
+        auto next = counters->next;
+        delete counters;
+        counters = next;
+      }
+    }
     dying = true;
     std::vector<SignalSubscriber> copy;
     {
@@ -48,6 +291,7 @@ namespace qi
 
   Manageable::Manageable()
     : traceObject([this](bool enable){ enableTrace(enable); return Future<void>{0}; })
+    , traceRecords([this](bool enable){ enableTraceRecording(enable); return Future<void>{0}; })
     , _p(new ManageablePrivate())
   {
   }
@@ -101,21 +345,47 @@ namespace qi
 
   void Manageable::pushStats(int slotId, float wallTime, float userTime, float systemTime)
   {
-    boost::mutex::scoped_lock l(_p->registrationsMutex);
-    MethodStatistics& ms = _p->stats[slotId];
-    ms.push(wallTime, userTime, systemTime);
+    const auto toDuration = [](float seconds) {
+      return Duration(static_cast<int64_t>(static_cast<double>(seconds) * 1e9));
+    };
+    pushStats(slotId, toDuration(wallTime), toDuration(userTime), toDuration(systemTime));
+  }
+
+  void Manageable::pushStats(int slotId, Duration wallTime, Duration userTime, Duration systemTime)
+  {
+    StatsStripe& stripe =
+        _p->methodStatsCounters(static_cast<unsigned int>(slotId)).stripes[currentStatsStripe()];
+    stripe.wall.push(wallTime.count());
+    stripe.user.push(userTime.count());
+    stripe.system.push(systemTime.count());
+    stripe.wallHistogram.push(wallTime.count());
+    stripe.cpuHistogram.push(userTime.count() + systemTime.count());
+    stripe.count.fetch_add(1, std::memory_order_release);
   }
 
   ObjectStatistics Manageable::stats() const
   {
-    boost::mutex::scoped_lock l(_p->registrationsMutex);
-    return _p->stats;
+    ObjectStatistics result;
+    _p->forEachMethodStats([&](const MethodStatsCounters& counters) {
+      if (!counters.empty())
+        result[counters.methodId] = counters.statistics();
+    });
+    return result;
+  }
+
+  ObjectHistograms Manageable::statsHistogram() const
+  {
+    ObjectHistograms result;
+    _p->forEachMethodStats([&](const MethodStatsCounters& counters) {
+      if (!counters.empty())
+        result[counters.methodId] = counters.histograms();
+    });
+    return result;
   }
 
   void Manageable::clearStats()
   {
-    boost::mutex::scoped_lock l(_p->registrationsMutex);
-    _p->stats.clear();
+    _p->forEachMethodStats([](MethodStatsCounters& counters) { counters.reset(); });
   }
 
   bool Manageable::isTraceEnabled() const
@@ -133,6 +403,113 @@ namespace qi
     return ++_p->traceId;
   }
 
+  bool Manageable::isTraceRecordingEnabled() const
+  {
+    return _p->traceRecordingEnabled.load();
+  }
+
+  void Manageable::enableTraceRecording(bool state)
+  {
+    _p->traceRecordingEnabled.store(state);
+    if (!state)
+    {
+      boost::mutex::scoped_lock l(_p->traceMutex);
+      _p->pendingTraceRecords.clear();
+    }
+  }
+
+  void Manageable::flushTrace()
+  {
+    Buffer chunk;
+    {
+      boost::mutex::scoped_lock l(_p->traceMutex);
+      if (_p->pendingTraceRecords.empty())
+        return;
+      chunk = _p->takeTraceRecords();
+    }
+    traceRecords(chunk);
+  }
+
+  TraceOptions Manageable::traceOptions() const
+  {
+    const uint64_t capture = _p->traceCapture.load(std::memory_order_relaxed);
+    return TraceOptions(_p->traceSamplingPeriod.load(std::memory_order_relaxed),
+                        static_cast<TraceArguments>(capture >> 32),
+                        static_cast<unsigned int>(capture & 0xFFFFFFFF));
+  }
+
+  void Manageable::setTraceOptions(const TraceOptions& options)
+  {
+    boost::mutex::scoped_lock l(_p->traceMutex);
+    _p->traceCapture.store(packTraceCapture(options));
+    _p->traceSamplingPeriod.store(options.samplingPeriod());
+  }
+
+  bool Manageable::_sampleTrace()
+  {
+    const auto period = _p->traceSamplingPeriod.load(std::memory_order_relaxed);
+    return period <= 1
+        || _p->traceSampleCounter.fetch_add(1, std::memory_order_relaxed) % period == 0;
+  }
+
+  void Manageable::_recordTrace(const EventTrace& event)
+  {
+    const auto toUs = [](const os::timeval& tv) { return tv.tv_sec * 1000000LL + tv.tv_usec; };
+    TraceRecord record;
+    record.id = event.id();
+    record.kind = static_cast<uint32_t>(event.kind());
+    record.slotId = event.slotId();
+    record.callerContext = event.callerContext();
+    record.calleeContext = event.calleeContext();
+    record.reserved = 0;
+    record.timestamp = toUs(event.timestamp());
+    record.postTimestamp = toUs(event.postTimestamp());
+    record.userUsTime = event.userUsTime();
+    record.systemUsTime = event.systemUsTime();
+    record.traceId = event.traceId();
+    record.spanId = event.spanId();
+    record.parentSpanId = event.parentSpanId();
+
+    Buffer chunk;
+    {
+      boost::mutex::scoped_lock l(_p->traceMutex);
+      if (_p->pendingTraceRecords.empty())
+        _p->pendingTraceRecords.reserve(TraceRecordsPerChunk);
+      _p->pendingTraceRecords.push_back(record);
+      if (_p->pendingTraceRecords.size() < TraceRecordsPerChunk)
+        return;
+      chunk = _p->takeTraceRecords();
+    }
+    traceRecords(chunk);
+  }
+
+  std::vector<EventTrace> decodeTraceRecords(const Buffer& chunk)
+  {
+    if (chunk.size() % sizeof(TraceRecord) != 0)
+      throw std::runtime_error("Trace records chunk of " + std::to_string(chunk.size())
+                               + " bytes is not made of whole records");
+    const auto toTimeval = [](int64_t us) {
+      os::timeval tv;
+      tv.tv_sec = us / 1000000LL;
+      tv.tv_usec = us % 1000000LL;
+      return tv;
+    };
+    std::vector<EventTrace> events;
+    events.reserve(chunk.size() / sizeof(TraceRecord));
+    const auto data = static_cast<const char*>(chunk.data());
+    for (std::size_t offset = 0; offset < chunk.size(); offset += sizeof(TraceRecord))
+    {
+      TraceRecord record;
+      std::memcpy(&record, data + offset, sizeof(record));
+      events.emplace_back(record.id, static_cast<EventTrace::EventKind>(record.kind), record.slotId,
+                          AnyValue(), toTimeval(record.timestamp), record.userUsTime,
+                          record.systemUsTime, record.callerContext, record.calleeContext,
+                          record.traceId, record.spanId, record.parentSpanId,
+                          toTimeval(record.postTimestamp));
+    }
+    return events;
+  }
+
   namespace manageable
   {
   static Manageable::MethodMap* methodMap = nullptr;
@@ -155,6 +532,11 @@ namespace qi
     builder.advertiseMethod("isTraceEnabled", &Manageable::isTraceEnabled, MetaCallType_Auto, id++);
     builder.advertiseMethod("enableTrace", &Manageable::enableTrace,       MetaCallType_Auto, id++);
     builder.advertiseSignal("traceObject", &Manageable::traceObject, id++);
+    builder.advertiseMethod("statsHistogram", &Manageable::statsHistogram, MetaCallType_Auto, id++);
+    builder.advertiseSignal("traceRecords", &Manageable::traceRecords, id++);
+    builder.advertiseMethod("flushTrace", &Manageable::flushTrace,         MetaCallType_Auto, id++);
+    builder.advertiseMethod("traceOptions", &Manageable::traceOptions,     MetaCallType_Auto, id++);
+    builder.advertiseMethod("setTraceOptions", &Manageable::setTraceOptions, MetaCallType_Auto, id++);
     QI_ASSERT(id <= endId);
     const detail::ObjectTypeData& typeData = builder.typeData();
     *manageable::methodMap = typeData.methodMap;
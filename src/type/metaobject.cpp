@@ -42,6 +42,10 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
       boost::recursive_mutex::scoped_lock sl(rhs._propertiesMutex);
       _properties = rhs._properties;
     }
+    {
+      boost::mutex::scoped_lock sl(rhs._prioritiesMutex);
+      _priorities = rhs._priorities;
+    }
     _index = rhs._index;
     _description = rhs._description;
     // cache data uses pointers to map entries and must be refreshed
@@ -490,7 +494,8 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
     boost::recursive_mutex::scoped_lock ml(_methodsMutex);
     boost::recursive_mutex::scoped_lock el(_eventsMutex);
     unsigned int idx = 0;
-    std::ostringstream buff;
+    // The content hash is fed with the fields as they are visited.
+    ka::sha1_hasher_t contentHasher;
     {
       _objectNameToIdx.clear();
       _methodNameToOverload.clear();
@@ -500,7 +505,7 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
         const std::string methodNameSignature = metaMethod.toString();
         _objectNameToIdx[methodNameSignature] = MetaObjectIdType(metaMethod.uid(), MetaObjectType_Method);
         idx = std::max(idx, metaMethod.uid());
-        buff << methodNameSignature << metaMethod.uid();
+        contentHasher.update(methodNameSignature).update_value(metaMethod.uid());
 
         OverloadMap::iterator overloadIt = _methodNameToOverload.find(metaMethod.name());
         if (overloadIt == _methodNameToOverload.end())
@@ -522,16 +527,16 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
         const auto metaSignalNameSignature = metaSignal.toString();
         _objectNameToIdx[metaSignalNameSignature] = MetaObjectIdType(metaSignal.uid(), MetaObjectType_Signal);
         idx = std::max(idx, metaSignal.uid());
-        buff << metaSignalNameSignature << metaSignal.uid();
+        contentHasher.update(metaSignalNameSignature).update_value(metaSignal.uid());
       }
     }
-    buff << _description;
+    contentHasher.update(_description);
 
     // never lower index
     _index = std::max(idx, _index.load());
 
     // update content hash
-    _contentSHA1 = ka::sha1(buff.str());
+    _contentSHA1 = contentHasher.digest();
     _dirtyCache = false;
   }
 
@@ -676,6 +681,11 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
     if (!result._p->addProperties(dest.propertyMap()))
       qiLogError() << "can't merge metaobject (properties)";
     result._p->setDescription(dest.description());
+    {
+      boost::mutex::scoped_lock sl(dest._p->_prioritiesMutex);
+      for (const auto& priority: dest._p->_priorities)
+        result._p->setMemberPriority(priority.first, priority.second);
+    }
     result._p->refreshCache();
     return result;
   }
@@ -684,6 +694,24 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
     return _p->_description;
   }
 
+  MemberPriority MetaObject::memberPriority(unsigned int id) const {
+    return _p->memberPriority(id);
+  }
+
+  void MetaObjectPrivate::setMemberPriority(unsigned int id, MemberPriority priority) {
+    boost::mutex::scoped_lock sl(_prioritiesMutex);
+    if (priority == MemberPriority::Default)
+      _priorities.erase(id);
+    else
+      _priorities[id] = priority;
+  }
+
+  MemberPriority MetaObjectPrivate::memberPriority(unsigned int id) const {
+    boost::mutex::scoped_lock sl(_prioritiesMutex);
+    const auto it = _priorities.find(id);
+    return it == _priorities.end() ? MemberPriority::Default : it->second;
+  }
+
   //MetaObjectBuilder
   class MetaObjectBuilderPrivate {
   public:
@@ -729,6 +757,10 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
     return _p->metaObject._p->setDescription(desc);
   }
 
+  void MetaObjectBuilder::setMemberPriority(unsigned int id, MemberPriority priority) {
+    _p->metaObject._p->setMemberPriority(id, priority);
+  }
+
 }
 
 namespace qi {
@@ -9,6 +9,7 @@
 
 #include <array>
 #include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <ka/macroregular.hpp>
 #include <ka/range.hpp>
@@ -156,6 +157,9 @@ namespace qi {
 
     void setDescription(const std::string& desc);
 
+    void setMemberPriority(unsigned int id, MemberPriority priority);
+    MemberPriority memberPriority(unsigned int id) const;
+
     int findMethod(const std::string& nameWithOptionalSignature, const GenericFunctionParameters& args, bool* canCache) const;
 
   private:
@@ -188,6 +192,10 @@ namespace qi {
 
     std::string                         _description;
 
+    // Not serialized, see MemberPriority.
+    std::map<unsigned int, MemberPriority> _priorities;
+    mutable boost::mutex                _prioritiesMutex;
+
     // true if cache must be refreshed
     mutable bool                        _dirtyCache;
 
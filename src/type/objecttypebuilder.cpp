@@ -46,6 +46,11 @@ namespace qi {
     _p->metaObject._p->setDescription(description);
   }
 
+  void ObjectTypeBuilderBase::setMemberPriority(unsigned int id, MemberPriority priority)
+  {
+    _p->metaObject._p->setMemberPriority(id, priority);
+  }
+
   unsigned int ObjectTypeBuilderBase::xAdvertiseMethod(MetaMethodBuilder& builder,
                                                        AnyFunction func,
                                                        MetaCallType threadingModel,
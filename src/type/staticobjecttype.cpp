@@ -22,6 +22,27 @@ void StaticObjectTypeBase::initialize(const MetaObject& mo, const ObjectTypeData
 {
   _metaObject = mo;
   _data = data;
+  _parametersTypes.clear();
+  for (const auto& method : _data.methodMap)
+  {
+    const MetaMethod* mm = _metaObject.method(method.first);
+    std::vector<TypeInterface*> types = method.second.first.argumentsType();
+    if (!mm || types.empty())
+      continue;
+    // Drop the instance, which is the first argument of the function.
+    types.erase(types.begin());
+    TypeInterface* type = makeTupleType(types);
+    // Some methods are advertised with a signature differing from their
+    // arguments: their calls are still decoded from the signature.
+    if (type->signature() == mm->parametersSignature())
+      _parametersTypes[method.first] = type;
+  }
+}
+
+TypeInterface* StaticObjectTypeBase::parametersType(void*, unsigned int method)
+{
+  const auto it = _parametersTypes.find(method);
+  return it == _parametersTypes.end() ? nullptr : it->second;
 }
 
 ObjectUid StaticObjectTypeBase::uid(void* instance) const
@@ -2,9 +2,14 @@
 **  Copyright (C) 2012 Aldebaran Robotics
 **  See COPYING for the license
 */
+#include <functional>
+#include <memory>
 #include <qi/type/typeinterface.hpp>
 #include <qi/anyvalue.hpp>
+#include <qi/atomic.hpp>
 #include <qi/numeric.hpp>
+#include <ka/scoped.hpp>
+#include "typeregistry_p.hpp"
 
 namespace qi
 {
@@ -18,20 +23,70 @@ namespace qi
     }
   }
 
+  namespace
+  {
+    // The members of a struct type never change, see memberTypes().
+    struct StructMembersCache
+    {
+      std::vector<TypeInterface*> memberTypes;
+      std::vector<std::string> elementsName;
+    };
+
+    // Kept out of StructTypeInterface, whose layout is part of the ABI. Types
+    // are never destroyed, neither are their entries.
+    using StructMembersCacheRegistry =
+        detail::TypeRegistry<StructTypeInterface*, const StructMembersCache*,
+                             std::hash<StructTypeInterface*>>;
+
+    const StructMembersCache& structMembersCache(StructTypeInterface* type)
+    {
+      static StructMembersCacheRegistry* registry = nullptr;
+      QI_THREADSAFE_NEW(registry);
+      if (const auto cache = registry->find(type))
+        return **cache;
+      // Computed out of the lock of the registry: the member types may be
+      // created meanwhile. Another thread may have filled the cache in the
+      // meantime: keep its one.
+      std::unique_ptr<const StructMembersCache> newCache(
+          new StructMembersCache{ type->memberTypes(), type->elementsName() });
+      const StructMembersCache* cache =
+          registry->findOrInsert(type, [&] { return newCache.get(); });
+      if (cache == newCache.get())
+        newCache.release();
+      return *cache;
+    }
+  }
+
+  const std::vector<TypeInterface*>& StructTypeInterface::cachedMemberTypes()
+  {
+    return structMembersCache(this).memberTypes;
+  }
+
+  const std::vector<std::string>& StructTypeInterface::cachedElementsName()
+  {
+    return structMembersCache(this).elementsName;
+  }
+
+  AnyReference StructTypeInterface::member(void* storage, unsigned int index)
+  {
+    return AnyReference(cachedMemberTypes()[index], get(storage, index));
+  }
+
   AnyReferenceVector StructTypeInterface::values(void* storage)
   {
-    std::vector<TypeInterface*> types = memberTypes();
-    std::vector<void*> values = get(storage);
+    const auto count = qi::numericConvert<unsigned int>(memberCount());
     AnyReferenceVector result;
-    for (unsigned i=0; i<types.size(); ++i)
-      result.push_back(AnyReference(types[i], values[i]));
+    result.reserve(count);
+    for (auto i = 0u; i < count; ++i)
+      result.push_back(member(storage, i));
     return result;
   }
 
   std::vector<void*> StructTypeInterface::get(void* storage)
   {
     std::vector<void*> result;
-    const auto count = qi::numericConvert<unsigned int>(memberTypes().size());
+    const auto count = qi::numericConvert<unsigned int>(memberCount());
+    result.reserve(count);
     for (auto i = 0u; i < count; ++i)
       result.push_back(get(storage, i));
     return result;
@@ -42,4 +97,14 @@ namespace qi
     for (unsigned i=0; i<values.size(); ++i)
       set(storage, i, values[i]);
   }
+
+  void StructTypeInterface::setOwned(void** storage, const std::vector<void*>& valStorages)
+  {
+    const auto destroyValues = ka::scoped([&] {
+      const auto& types = cachedMemberTypes();
+      for (unsigned i = 0; i < valStorages.size(); ++i)
+        types[i]->destroy(valStorages[i]);
+    });
+    set(storage, valStorages);
+  }
 }
@@ -27,16 +27,24 @@ namespace qi
     qi::int64_t tPost; // time at which call was posted() from parent
     qi::int64_t tStart;
     qi::int64_t tEnd; // 0 means not ended yet
+    qi::uint64_t traceId;
+    qi::uint64_t spanId;
+    qi::uint64_t parentSpanId;
     std::weak_ptr<CallData> parent;
     std::weak_ptr<CallData> asyncParent;
+    std::weak_ptr<CallData> remoteParent;
     std::list<std::shared_ptr<CallData>> children; // child sync call sequences
     std::vector<std::shared_ptr<CallData>> asyncChildren; // unordered
+    // calls made from this one, found by trace context only: usually made
+    // from another process
+    std::vector<std::shared_ptr<CallData>> remoteChildren;
   };
 
   using CallList = std::list<std::shared_ptr<CallData>>;
   using PerContext = boost::unordered_map<unsigned int, std::list<std::shared_ptr<CallData>>>;
   using PerId = boost::unordered_map<unsigned int, std::shared_ptr<CallData>>;
   using TraceBuffer = boost::unordered_map<unsigned int, qi::EventTrace>;
+  using PerSpan = boost::unordered_map<qi::uint64_t, std::shared_ptr<CallData>>;
 
   class TraceAnalyzerImpl
   {
@@ -87,6 +95,9 @@ namespace qi
     for (auto asyncChild : asyncChildren)
       if (asyncChild)
         asyncChild->asyncParent.reset();
+    for (auto remoteChild : remoteChildren)
+      if (remoteChild)
+        remoteChild->remoteParent.reset();
   }
 
   TraceAnalyzer::TraceAnalyzer()
@@ -106,6 +117,9 @@ namespace qi
     , tPost(fromTV(et.postTimestamp()))
     , tStart(fromTV(et.timestamp()))
     , tEnd(0)
+    , traceId(et.traceId())
+    , spanId(et.spanId())
+    , parentSpanId(et.parentSpanId())
     {}
 
   void CallData::complete(const EventTrace& et)
@@ -338,6 +352,40 @@ namespace qi
       links.insert(FlowLink(d->obj, d->fun, asyncChild->obj, asyncChild->fun, false));
       // no need to recurse on async children
     }
+    for (const auto& remoteChild : d->remoteChildren)
+      links.insert(FlowLink(d->obj, d->fun, remoteChild->obj, remoteChild->fun, false));
+  }
+
+  static void indexSpans(PerSpan& perSpan, const CallList& l)
+  {
+    for (const auto& data : l)
+    {
+      if (data->spanId)
+        perSpan[data->spanId] = data;
+      indexSpans(perSpan, data->children);
+    }
+  }
+
+  // Attach the calls to the call of their parent span, when the timeline
+  // of their context did not already make them its children.
+  static void linkSpans(const PerSpan& perSpan, const CallList& l)
+  {
+    for (const auto& data : l)
+    {
+      linkSpans(perSpan, data->children);
+      if (!data->parentSpanId || !data->remoteParent.expired())
+        continue;
+      const auto it = perSpan.find(data->parentSpanId);
+      if (it == perSpan.end())
+        continue;
+      const auto& spanParent = it->second;
+      if (spanParent->traceId != data->traceId
+          || data->parent.lock() == spanParent
+          || data->asyncParent.lock() == spanParent)
+        continue;
+      spanParent->remoteChildren.push_back(data);
+      data->remoteParent = spanParent;
+    }
   }
 
   void TraceAnalyzer::analyze(std::set<FlowLink>& links)
@@ -357,6 +405,15 @@ namespace qi
         }
       }
     }
+    // Then stitch the calls of a same distributed trace
+    PerSpan perSpan;
+    for (const auto& perContextPair : _p->perContext)
+      indexSpans(perSpan, perContextPair.second);
+    if (!perSpan.empty())
+    {
+      for (const auto& perContextPair : _p->perContext)
+        linkSpans(perSpan, perContextPair.second);
+    }
     for (const auto& perContextPair : _p->perContext)
     {
       const auto& dataList = perContextPair.second;
@@ -387,6 +444,15 @@ namespace qi
         }
         o << '}';
       }
+      if (cd.remoteChildren.size())
+      {
+        o << '[';
+        for (auto& remoteChild : cd.remoteChildren)
+        {
+          o << remoteChild->uid << ',';
+        }
+        o << ']';
+      }
     }
   }
 
@@ -406,4 +472,89 @@ namespace qi
     dumpTraces(s);
     return s.str();
   }
+
+  void TraceAnalyzer::addTraceRecords(const Buffer& chunk, unsigned int objectId)
+  {
+    for (const auto& trace : decodeTraceRecords(chunk))
+      addTrace(trace, objectId);
+  }
+
+  namespace
+  {
+    class ChromeTraceWriter
+    {
+    public:
+      explicit ChromeTraceWriter(std::ostream& o)
+        : o(o)
+      {
+        o << "{\"traceEvents\":[";
+      }
+
+      ~ChromeTraceWriter()
+      {
+        o << "]}";
+      }
+
+      void writeCalls(const CallList& l)
+      {
+        for (const auto& call : l)
+        {
+          const CallData& cd = *call;
+          if (cd.tEnd)
+          {
+            begin(cd, "X", cd.tStart);
+            o << ",\"dur\":" << (cd.tEnd - cd.tStart) << ",\"args\":{\"id\":" << cd.uid << "}}";
+          }
+          else
+          {
+            // Not finished yet (or its end was not traced).
+            begin(cd, "B", cd.tStart);
+            o << '}';
+          }
+          for (const auto& asyncChild : cd.asyncChildren)
+            writeFlow(cd, *asyncChild, asyncChild->tPost);
+          for (const auto& remoteChild : cd.remoteChildren)
+            writeFlow(cd, *remoteChild, remoteChild->tStart);
+          writeCalls(cd.children);
+        }
+      }
+
+    private:
+      void writeFlow(const CallData& from, const CallData& to, qi::int64_t timestamp)
+      {
+        ++flowId;
+        begin(from, "s", timestamp);
+        o << ",\"id\":" << flowId << '}';
+        begin(to, "f", to.tStart);
+        o << ",\"id\":" << flowId << ",\"bp\":\"e\"}";
+      }
+
+      void begin(const CallData& cd, const char* phase, qi::int64_t timestamp)
+      {
+        if (!first)
+          o << ',';
+        first = false;
+        o << "{\"name\":\"" << cd.obj << '.' << cd.fun << "\",\"cat\":\"qi\",\"ph\":\"" << phase
+          << "\",\"ts\":" << timestamp << ",\"pid\":" << cd.obj << ",\"tid\":" << cd.ctx;
+      }
+
+      std::ostream& o;
+      bool first = true;
+      unsigned int flowId = 0;
+    };
+  }
+
+  void TraceAnalyzer::dumpChromeTrace(std::ostream& o)
+  {
+    ChromeTraceWriter writer(o);
+    for (const auto& perContextPair : _p->perContext)
+      writer.writeCalls(perContextPair.second);
+  }
+
+  std::string TraceAnalyzer::dumpChromeTrace()
+  {
+    std::stringstream s;
+    dumpChromeTrace(s);
+    return s.str();
+  }
 }
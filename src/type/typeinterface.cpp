@@ -3,9 +3,11 @@
 **  See COPYING for the license
 */
 
+#include <cstring>
 #include <boost/thread/mutex.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/core/typeinfo.hpp>
+#include <boost/functional/hash.hpp>
 
 #include <qi/type/typeinterface.hpp>
 #include <qi/signature.hpp>
@@ -13,6 +15,7 @@
 #include <qi/anyobject.hpp>
 #include <qi/type/typedispatcher.hpp>
 #include <qi/anyfunction.hpp>
+#include "typeregistry_p.hpp"
 
 #ifdef __GNUC__
 #include <cxxabi.h>
@@ -88,7 +91,29 @@ namespace qi {
       return customInfo < b.customInfo;
   }
 
-  using TypeFactory = std::map<TypeInfo, TypeInterface*>;
+  // Consistent with TypeInfo::operator==, which compares the names of the types.
+  struct TypeInfoHash
+  {
+    std::size_t operator()(const TypeInfo& info) const
+    {
+      const char* name = info.asCString();
+      return boost::hash_range(name, name + std::strlen(name));
+    }
+  };
+
+  struct TypeInfoPairHash
+  {
+    std::size_t operator()(const std::pair<TypeInfo, TypeInfo>& infos) const
+    {
+      std::size_t seed = TypeInfoHash()(infos.first);
+      boost::hash_combine(seed, TypeInfoHash()(infos.second));
+      return seed;
+    }
+  };
+
+  // The registries are never destroyed, because types may be requested until
+  // the very end of the program.
+  using TypeFactory = detail::TypeRegistry<TypeInfo, TypeInterface*, TypeInfoHash>;
   static TypeFactory& typeFactory()
   {
     static TypeFactory* res = nullptr;
@@ -96,7 +121,7 @@ namespace qi {
     return *res;
   }
 
-  using FallbackTypeFactory = std::map<std::string, TypeInterface*>;
+  using FallbackTypeFactory = detail::TypeRegistry<std::string, TypeInterface*, boost::hash<std::string>>;
   static FallbackTypeFactory& fallbackTypeFactory()
   {
     static FallbackTypeFactory* res = nullptr;
@@ -106,17 +131,15 @@ namespace qi {
 
   QI_API TypeInterface* getType(const TypeIndex& typeId)
   {
-    static boost::mutex* mutex = nullptr;
-    QI_THREADSAFE_NEW(mutex);
-    boost::mutex::scoped_lock sl(*mutex);
     static bool fallback = !qi::os::getenv("QI_TYPE_RTTI_FALLBACK").empty();
 
     // We create-if-not-exist on purpose: to detect access that occur before
     // registration
-    TypeInterface* result = typeFactory()[TypeInfo(typeId)];
+    TypeInterface* result = typeFactory().findOrInsert(TypeInfo(typeId),
+                                                       []() -> TypeInterface* { return nullptr; });
     if (result || !fallback)
       return result;
-    result = fallbackTypeFactory()[typeId.name()];
+    result = fallbackTypeFactory().find(typeId.name()).value_or(nullptr);
     if (result)
       qiLogError("qitype.type") << "RTTI failure for " << typeId.name();
     return result;
@@ -128,18 +151,18 @@ namespace qi {
     qiLogCategory("qitype.type"); // method can be called at static init
     qiLogDebug() << "registerType "  << typeId.name() << " "
      << type->kind() <<" " << (void*)type << " " << type->signature().toString();
-    TypeFactory::iterator i = typeFactory().find(TypeInfo(typeId));
-    if (i != typeFactory().end())
+    const auto previous = typeFactory().find(TypeInfo(typeId));
+    if (previous)
     {
-      if (i->second)
+      if (*previous)
         qiLogVerbose() << "registerType: previous registration present for "
-          << typeId.name()<< " " << (void*)i->second << " " << i->second->kind();
+          << typeId.name()<< " " << (void*)*previous << " " << (*previous)->kind();
       else
         qiLogVerbose() << "registerType: access to type factory before"
           " registration detected for type " << typeId.name();
     }
-    typeFactory()[TypeInfo(typeId)] = type;
-    fallbackTypeFactory()[typeId.name()] = type;
+    typeFactory().set(TypeInfo(typeId), type);
+    fallbackTypeFactory().set(typeId.name(), type);
     return true;
   }
 
@@ -294,10 +317,12 @@ namespace qi {
       result = qi::Signature::fromType(Signature::Type_Unknown);
     }
 
-    void visitTuple(const std::string &name, const AnyReferenceVector& vals, const std::vector<std::string>& annotations)
+    void visitTuple(const std::string &name, const StructMembers& vals, const std::vector<std::string>& annotations)
     {
-      std::string res;
-      res = qi::makeTupleSignature(vals, _resolveDynamic).toString();
+      // Only dynamic members need their value to get their signature.
+      std::string res = _resolveDynamic
+          ? qi::makeTupleSignature(AnyReferenceVector(vals), _resolveDynamic).toString()
+          : qi::makeTupleSignature(vals.types()).toString();
 
       if (annotations.size() >= vals.size()) {
 
@@ -414,9 +439,10 @@ namespace qi {
         break;
       }
       case TypeKind_Tuple: {
-        std::vector<TypeInterface*>       memberTypes = static_cast<StructTypeInterface*>(this)->memberTypes();
-        std::vector<std::string> annotations = static_cast<StructTypeInterface*>(this)->elementsName();
-        std::string              name        = static_cast<StructTypeInterface*>(this)->className();
+        auto* structType = static_cast<StructTypeInterface*>(this);
+        const std::vector<TypeInterface*>& memberTypes = structType->cachedMemberTypes();
+        const std::vector<std::string>&    annotations = structType->cachedElementsName();
+        std::string                        name        = structType->className();
         v.result = qi::makeTupleSignature(memberTypes, name, annotations);
         break;
       }
@@ -752,24 +778,12 @@ namespace qi {
   // We want exactly one instance per element type
   static TypeInterface* makeListIteratorType(TypeInterface* element)
   {
-    static boost::mutex* mutex;
-    QI_THREADSAFE_NEW(mutex);
-    boost::mutex::scoped_lock lock(*mutex);
-    static std::map<TypeInfo, TypeInterface*>* map = nullptr;
-    if (!map)
-      map = new std::map<TypeInfo, TypeInterface*>();
-    TypeInfo key = element->info();
-    std::map<TypeInfo, TypeInterface*>::iterator it;
-    TypeInterface* result;
-    it = map->find(key);
-    if (it == map->end())
-    {
-      result = new DefaultListIteratorType(element);
-      (*map)[key] = result;
-    }
-    else
-      result = it->second;
-    return result;
+    using Registry = detail::TypeRegistry<TypeInfo, TypeInterface*, TypeInfoHash>;
+    static Registry* registry = nullptr;
+    QI_THREADSAFE_NEW(registry);
+    return registry->findOrInsert(element->info(), [&]() -> TypeInterface* {
+      return new DefaultListIteratorType(element);
+    });
   }
 
   template <typename T>
@@ -835,6 +849,12 @@ namespace qi {
       src.push_back(_elementType->clone(valueStorage));
     }
 
+    void pushBackOwned(void** storage, void* valueStorage)
+    {
+      std::vector<void*>& src = *(std::vector<void*>*)ptrFromStorage(storage);
+      src.push_back(valueStorage);
+    }
+
     void* element(void* storage, int key)
     {
       std::vector<void*>& src = *(std::vector<void*>*)ptrFromStorage(&storage);
@@ -875,46 +895,22 @@ namespace qi {
 
   TypeInterface* makeVarArgsType(TypeInterface* element)
   {
-    static boost::mutex* mutex = nullptr;
-    QI_THREADSAFE_NEW(mutex);
-    boost::mutex::scoped_lock lock(*mutex);
-    static std::map<TypeInfo, TypeInterface*>* map = nullptr;
-    if (!map)
-      map = new std::map<TypeInfo, TypeInterface*>();
-    TypeInfo key(element->info());
-    std::map<TypeInfo, TypeInterface*>::iterator it;
-    TypeInterface* result;
-    it = map->find(key);
-    if (it == map->end())
-    {
-      result = new DefaultVarArgsType(element);
-      (*map)[key] = result;
-    }
-    else
-      result = it->second;
-    return result;
+    using Registry = detail::TypeRegistry<TypeInfo, TypeInterface*, TypeInfoHash>;
+    static Registry* registry = nullptr;
+    QI_THREADSAFE_NEW(registry);
+    return registry->findOrInsert(element->info(), [&]() -> TypeInterface* {
+      return new DefaultVarArgsType(element);
+    });
   }
     // We want exactly one instance per element type
   TypeInterface* makeListType(TypeInterface* element)
   {
-    static boost::mutex* mutex = nullptr;
-    QI_THREADSAFE_NEW(mutex);
-    boost::mutex::scoped_lock lock(*mutex);
-    static std::map<TypeInfo, TypeInterface*>* map = nullptr;
-    if (!map)
-      map = new std::map<TypeInfo, TypeInterface*>();
-    TypeInfo key(element->info());
-    std::map<TypeInfo, TypeInterface*>::iterator it;
-    TypeInterface* result;
-    it = map->find(key);
-    if (it == map->end())
-    {
-      result = new DefaultListType(element);
-      (*map)[key] = result;
-    }
-    else
-      result = it->second;
-    return result;
+    using Registry = detail::TypeRegistry<TypeInfo, TypeInterface*, TypeInfoHash>;
+    static Registry* registry = nullptr;
+    QI_THREADSAFE_NEW(registry);
+    return registry->findOrInsert(element->info(), [&]() -> TypeInterface* {
+      return new DefaultListType(element);
+    });
   }
 
   class DefaultTupleType: public StructTypeInterface
@@ -960,6 +956,19 @@ namespace qi {
       ptr[index] = _types[index]->clone(valStorage);
     }
 
+    void setOwned(void** storage, const std::vector<void*>& valStorages) override
+    {
+      std::vector<void*>& ptr = *(std::vector<void*>*)ptrFromStorage(storage);
+      if (ptr.size() < valStorages.size())
+        ptr.resize(valStorages.size(), 0);
+      for (unsigned i = 0; i < valStorages.size(); ++i)
+      {
+        if (ptr[i])
+          _types[i]->destroy(ptr[i]);
+        ptr[i] = valStorages[i];
+      }
+    }
+
     const TypeInfo& info() override
     {
       return _info;
@@ -1117,27 +1126,12 @@ namespace qi {
   // We want exactly one instance per element type
   static TypeInterface* makeMapIteratorType(TypeInterface* te)
   {
-    using Map = std::map<TypeInfo, TypeInterface*>;
-    static boost::mutex* mutex = nullptr;
-    QI_THREADSAFE_NEW(mutex);
-    boost::mutex::scoped_lock lock(*mutex);
-
-    static Map * map = nullptr;
-    if (!map)
-      map = new Map();
-    TypeInfo ti(te->info());
-    Map::key_type key(ti);
-    Map::iterator it;
-    TypeInterface* result;
-    it = map->find(key);
-    if (it == map->end())
-    {
-      result = new DefaultMapIteratorType(te);
-      (*map)[key] = result;
-    }
-    else
-      result = it->second;
-    return result;
+    using Registry = detail::TypeRegistry<TypeInfo, TypeInterface*, TypeInfoHash>;
+    static Registry* registry = nullptr;
+    QI_THREADSAFE_NEW(registry);
+    return registry->findOrInsert(te->info(), [&]() -> TypeInterface* {
+      return new DefaultMapIteratorType(te);
+    });
   }
 
   class DefaultMapType: public MapTypeInterface
@@ -1190,11 +1184,12 @@ namespace qi {
     }
 
     // Unconditional insert, assumes key is not present, return value
-    AnyReference _insert(DefaultMapStorage& ptr, void* keyStorage, void* valueStorage, bool copyValue)
+    AnyReference _insert(DefaultMapStorage& ptr, void* keyStorage, void* valueStorage, bool copyKey, bool copyValue)
     {
       // key is referenced in map key, and map value for the pair
       AnyReference key(_keyType, keyStorage);
-      key = key.clone();
+      if (copyKey)
+        key = key.clone();
       AnyReference value(_elementType, valueStorage);
       if (copyValue)
         value = value.clone();
@@ -1226,7 +1221,25 @@ namespace qi {
       }
       else
       {
-        _insert(ptr, keyStorage, valueStorage, true);
+        _insert(ptr, keyStorage, valueStorage, true, true);
+      }
+    }
+
+    void insertOwned(void** storage, void* keyStorage, void* valueStorage) override
+    {
+      DefaultMapStorage& ptr = *(DefaultMapStorage*)ptrFromStorage(storage);
+      DefaultMapStorage::iterator i = ptr.find(AnyReference(_keyType, keyStorage));
+      if (i != ptr.end())
+      {// Replace the previous value, the stored key is kept
+        std::vector<void*>& elem = _pairType->backend(i->second);
+        QI_ASSERT(elem.size() == 2);
+        _elementType->destroy(elem[1]);
+        elem[1] = valueStorage;
+        _keyType->destroy(keyStorage);
+      }
+      else
+      {
+        _insert(ptr, keyStorage, valueStorage, false, false);
       }
     }
 
@@ -1241,7 +1254,7 @@ namespace qi {
       }
       if (!autoInsert)
         return AnyReference();
-      return _insert(ptr, keyStorage, _elementType->initializeStorage(), false);
+      return _insert(ptr, keyStorage, _elementType->initializeStorage(), true, false);
     }
 
     size_t size(void* storage) override
@@ -1292,30 +1305,13 @@ namespace qi {
   // We want exactly one instance per element type
   TypeInterface* makeMapType(TypeInterface* kt, TypeInterface* et)
   {
-    static boost::mutex* mutex = nullptr;
-    QI_THREADSAFE_NEW(mutex);
-    boost::mutex::scoped_lock lock(*mutex);
-
-    using Map = std::map<std::pair<TypeInfo, TypeInfo>, MapTypeInterface*>;
-    static Map * map = nullptr;
-    if (!map)
-      map = new Map();
-    TypeInfo kk(kt->info());
-    TypeInfo ek(et->info());
-    Map::key_type key(kk, ek);
-    Map::iterator it;
-    MapTypeInterface* result;
-    it = map->find(key);
-    if (it == map->end())
-    {
-      result = new DefaultMapType(kt, et);
-      (*map)[key] = result;
-    }
-    else
-    {
-      result = it->second;
-    }
-    return result;
+    using Registry =
+        detail::TypeRegistry<std::pair<TypeInfo, TypeInfo>, MapTypeInterface*, TypeInfoPairHash>;
+    static Registry* registry = nullptr;
+    QI_THREADSAFE_NEW(registry);
+    return registry->findOrInsert(std::make_pair(kt->info(), et->info()), [&]() -> MapTypeInterface* {
+      return new DefaultMapType(kt, et);
+    });
   }
 
   class DefaultOptionalType : public OptionalTypeInterface
@@ -1414,21 +1410,12 @@ namespace qi {
 
   TypeInterface* makeOptionalType(TypeInterface* value)
   {
-    static boost::mutex mutex;
-    boost::mutex::scoped_lock lock(mutex);
-    static std::map<TypeInfo, TypeInterface*> map;
-
-    const auto typeInfo = value->info();
-    auto it = map.find(typeInfo);
-    if (it == map.end())
-    {
-      auto type = new DefaultOptionalType(value);
-      bool inserted = false;
-      std::tie(it, inserted) = map.emplace(typeInfo, type);
-      if (!inserted)
-        return nullptr;
-    }
-    return it->second;
+    using Registry = detail::TypeRegistry<TypeInfo, TypeInterface*, TypeInfoHash>;
+    static Registry* registry = nullptr;
+    QI_THREADSAFE_NEW(registry);
+    return registry->findOrInsert(value->info(), [&]() -> TypeInterface* {
+      return new DefaultOptionalType(value);
+    });
   }
 
   struct InfosKey
@@ -1440,6 +1427,28 @@ namespace qi {
       , _elements(elements)
     {}
 
+    bool operator==(const InfosKey& b) const
+    {
+      if (_types.size() != b._types.size())
+        return false;
+      for (unsigned i = 0; i < _types.size(); ++i)
+      {
+        if (_types[i]->info() != b._types[i]->info())
+          return false;
+      }
+      return _name == b._name && _elements == b._elements;
+    }
+
+    std::size_t hash() const
+    {
+      std::size_t seed = 0;
+      for (auto* type : _types)
+        boost::hash_combine(seed, TypeInfoHash()(type->info()));
+      boost::hash_combine(seed, _name);
+      boost::hash_combine(seed, _elements);
+      return seed;
+    }
+
     bool operator < (const InfosKey& b) const
     {
       //check for types
@@ -1472,30 +1481,44 @@ namespace qi {
     std::vector<std::string> _elements;
   };
 
-  //TODO: not threadsafe
-  TypeInterface* makeTupleType(const std::vector<TypeInterface*>& types, const std::string &name, const std::vector<std::string>& elementNames)
+  struct InfosKeyHash
   {
-    using Map = std::map<InfosKey, StructTypeInterface*>;
-    static boost::mutex* mutex;
-    QI_THREADSAFE_NEW(mutex);
-    boost::mutex::scoped_lock lock(*mutex);
-    static Map* map = nullptr;
-    if (!map)
-      map = new Map;
-    InfosKey key(types, name, elementNames);
-    Map::iterator it = map->find(key);
-    if (it == map->end())
-    {
-      StructTypeInterface* result = new DefaultTupleType(types, name, elementNames);
-      (*map)[key] = result;
-      return result;
-    }
-    else
+    std::size_t operator()(const InfosKey& key) const
     {
-      StructTypeInterface* res = it->second;
-      QI_ASSERT(res->memberTypes().size() == types.size());
-      return res;
+      return key.hash();
     }
+  };
+
+  TypeInterface* makeTupleType(const std::vector<TypeInterface*>& types, const std::string &name, const std::vector<std::string>& elementNames)
+  {
+    using Registry = detail::TypeRegistry<InfosKey, StructTypeInterface*, InfosKeyHash>;
+    static Registry* registry = nullptr;
+    QI_THREADSAFE_NEW(registry);
+    StructTypeInterface* res = registry->findOrInsert(InfosKey(types, name, elementNames),
+                                                      [&]() -> StructTypeInterface* {
+      return new DefaultTupleType(types, name, elementNames);
+    });
+    QI_ASSERT(res->memberTypes().size() == types.size());
+    return res;
+  }
+
+  void ListTypeInterface::pushBackOwned(void** storage, void* valueStorage)
+  {
+    pushBack(storage, valueStorage);
+    elementType()->destroy(valueStorage);
+  }
+
+  void MapTypeInterface::insertOwned(void** storage, void* keyStorage, void* valueStorage)
+  {
+    insert(storage, keyStorage, valueStorage);
+    keyType()->destroy(keyStorage);
+    elementType()->destroy(valueStorage);
+  }
+
+  void DynamicTypeInterface::setOwned(void** storage, AnyReference source)
+  {
+    set(storage, source);
+    source.destroy();
   }
 
   void* ListTypeInterface::element(void* storage, int index)
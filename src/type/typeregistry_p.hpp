@@ -0,0 +1,198 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_TYPE_TYPEREGISTRY_P_HPP_
+#define _SRC_TYPE_TYPEREGISTRY_P_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace qi {
+namespace detail {
+
+  /// Append-only hash map whose lookups do not take any lock.
+  ///
+  /// It is meant for the registries of types, which are read on every dynamic
+  /// typing operation but only written the first time a type is requested.
+  ///
+  /// Entries are never removed: a reader can walk a bucket while an entry is
+  /// added, because the entry is fully constructed before being published.
+  /// Writers are serialized by a mutex. When the table grows, the entries are
+  /// linked in a new table, and the old one is kept until the registry is
+  /// destroyed because readers may still be walking it. The values of the
+  /// entries are shared by all tables, so updating one is seen through all of
+  /// them.
+  ///
+  /// Regular K, TriviallyCopyable V, Procedure<std::size_t (K)> H
+  template<typename K, typename V, typename H>
+  class TypeRegistry
+  {
+    struct Entry
+    {
+      Entry(const K& k, V v)
+        : key(k)
+        , value(v)
+      {
+      }
+      const K key;
+      std::atomic<V> value;
+    };
+
+    struct Link
+    {
+      Entry* const entry;
+      Link* const next;
+    };
+
+    struct Table
+    {
+      Table(std::size_t bucketCount, std::unique_ptr<Table> prev)
+        : size(bucketCount)
+        , buckets(new std::atomic<Link*>[bucketCount])
+        , previous(std::move(prev))
+      {
+        for (std::size_t i = 0; i < size; ++i)
+          buckets[i].store(nullptr, std::memory_order_relaxed);
+      }
+
+      ~Table()
+      {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          Link* link = buckets[i].load(std::memory_order_relaxed);
+          while (link)
+          {
+            Link* next = link->next;
+            delete link;
+            link = next;
+          }
+        }
+      }
+
+      std::atomic<Link*>& bucket(std::size_t hash)
+      {
+        return buckets[hash % size];
+      }
+
+      const std::size_t size;
+      std::unique_ptr<std::atomic<Link*>[]> buckets;
+      std::unique_ptr<Table> previous;
+    };
+
+  public:
+    explicit TypeRegistry(std::size_t bucketCount = 64u)
+      : _table(new Table(bucketCount, nullptr))
+    {
+    }
+
+    ~TypeRegistry()
+    {
+      Table* table = _table.load(std::memory_order_relaxed);
+      for (std::size_t i = 0; i < table->size; ++i)
+      {
+        for (Link* link = table->buckets[i].load(std::memory_order_relaxed); link; link = link->next)
+          delete link->entry;
+      }
+      delete table;
+    }
+
+    TypeRegistry(const TypeRegistry&) = delete;
+    TypeRegistry& operator=(const TypeRegistry&) = delete;
+
+    /// Does not lock.
+    boost::optional<V> find(const K& key) const
+    {
+      if (Entry* entry = findEntry(key, _hash(key)))
+        return entry->value.load(std::memory_order_acquire);
+      return {};
+    }
+
+    /// Returns the value of the key, inserting the result of `makeValue()`
+    /// if there is none. Only locks if the key is absent. `makeValue` is
+    /// called at most once per key and must not use this registry.
+    ///
+    /// Procedure<V ()> F
+    template<typename F>
+    V findOrInsert(const K& key, F makeValue)
+    {
+      const auto hash = _hash(key);
+      if (Entry* entry = findEntry(key, hash))
+        return entry->value.load(std::memory_order_acquire);
+
+      boost::mutex::scoped_lock lock(_mutex);
+      if (Entry* entry = findEntry(key, hash))
+        return entry->value.load(std::memory_order_acquire);
+      const V value = makeValue();
+      insert(key, hash, value);
+      return value;
+    }
+
+    /// Inserts the key or replaces its value.
+    void set(const K& key, V value)
+    {
+      const auto hash = _hash(key);
+      boost::mutex::scoped_lock lock(_mutex);
+      if (Entry* entry = findEntry(key, hash))
+        entry->value.store(value, std::memory_order_release);
+      else
+        insert(key, hash, value);
+    }
+
+  private:
+    Entry* findEntry(const K& key, std::size_t hash) const
+    {
+      Table* table = _table.load(std::memory_order_acquire);
+      for (Link* link = table->bucket(hash).load(std::memory_order_acquire); link; link = link->next)
+      {
+        if (link->entry->key == key)
+          return link->entry;
+      }
+      return nullptr;
+    }
+
+    // Must be called with `_mutex` locked.
+    void insert(const K& key, std::size_t hash, V value)
+    {
+      Table* table = _table.load(std::memory_order_relaxed);
+      if (_count >= table->size)
+        table = grow(table);
+      auto& bucket = table->bucket(hash);
+      bucket.store(new Link{ new Entry(key, value), bucket.load(std::memory_order_relaxed) },
+                   std::memory_order_release);
+      ++_count;
+    }
+
+    // Must be called with `_mutex` locked.
+    Table* grow(Table* table)
+    {
+      std::unique_ptr<Table> newTable(new Table(table->size * 2u, std::unique_ptr<Table>(table)));
+      for (std::size_t i = 0; i < table->size; ++i)
+      {
+        for (Link* link = table->buckets[i].load(std::memory_order_relaxed); link; link = link->next)
+        {
+          auto& bucket = newTable->bucket(_hash(link->entry->key));
+          bucket.store(new Link{ link->entry, bucket.load(std::memory_order_relaxed) },
+                       std::memory_order_relaxed);
+        }
+      }
+      Table* result = newTable.release();
+      _table.store(result, std::memory_order_release);
+      return result;
+    }
+
+    H _hash;
+    std::atomic<Table*> _table;
+    std::size_t _count = 0u;
+    boost::mutex _mutex;
+  };
+
+} // namespace detail
+} // namespace qi
+
+#endif // _SRC_TYPE_TYPEREGISTRY_P_HPP_
@@ -165,3 +165,74 @@ TEST(Sha1, PerformanceIIter) {
   // `hex` returns the output iterator.
   *boost::algorithm::hex(s, std::ostream_iterator<char>{std::cout}) = '\n';
 }
+
+TEST(Sha1Hasher, Empty) {
+  using namespace ka;
+  ASSERT_EQ(sha1_hasher_t{}.digest(), sha1(std::string{}));
+}
+
+TEST(Sha1Hasher, SeveralUpdates) {
+  using namespace ka;
+  sha1_hasher_t h;
+  h.update(std::string{"you"}).update(boost::string_ref{"p"});
+  uint8_t s[] = "i";
+  h.update(std::begin(s), std::end(s) - 1);
+  ASSERT_FALSE(h.finalized());
+  ASSERT_EQ(h.digest(), youpi_digest);
+  ASSERT_TRUE(h.finalized());
+}
+
+TEST(Sha1Hasher, InputIter) {
+  using namespace ka;
+  using I = std::istream_iterator<uint8_t>;
+  std::istringstream s{"youpi"};
+  sha1_hasher_t h;
+  h.update(I{s}, I{});
+  ASSERT_EQ(h.digest(), youpi_digest);
+}
+
+TEST(Sha1Hasher, Value) {
+  using namespace ka;
+  const uint32_t i = 0x12345678;
+  sha1_hasher_t h;
+  h.update_value(i);
+  auto const p = reinterpret_cast<unsigned char const*>(&i);
+  ASSERT_EQ(h.digest(), sha1(p, p + sizeof(i)));
+}
+
+TEST(Sha1Hasher, CopyContinuesIndependently) {
+  using namespace ka;
+  sha1_hasher_t h;
+  h.update(std::string{"youpi"});
+  sha1_hasher_t h2{h};
+  h2.update(std::string{"youp"});
+  ASSERT_EQ(h.digest(), youpi_digest);
+  ASSERT_EQ(h2.digest(), sha1(std::string{"youpiyoup"}));
+}
+
+TEST(Sha1Hasher, MovedHasherIsCopied) {
+  using namespace ka;
+  sha1_hasher_t h;
+  h.update(std::string{"youpi"});
+  sha1_hasher_t h2{std::move(h)};
+  sha1_hasher_t h3;
+  h3 = std::move(h2);
+  h2.update(std::string{"youp"});
+  ASSERT_EQ(h.digest(), youpi_digest);
+  ASSERT_EQ(h3.digest(), youpi_digest);
+  ASSERT_EQ(h2.digest(), sha1(std::string{"youpiyoup"}));
+}
+
+TEST(Sha1Hasher, LongData) {
+  using namespace ka;
+  // Spans several 64 bytes blocks, with updates not aligned on blocks.
+  std::string s;
+  for (int i = 0; i < 1000; ++i) {
+    s += static_cast<char>(i % 251);
+  }
+  sha1_hasher_t h;
+  for (std::size_t i = 0; i < s.size(); i += 37) {
+    h.update(s.substr(i, 37));
+  }
+  ASSERT_EQ(h.digest(), sha1(s));
+}
@@ -30,6 +30,13 @@ namespace mock
     {
       bool value;
     };
+    struct socket_option_buffer_size_type
+    {
+      int size = 0;
+      int value() const {return size;}
+    };
+    using socket_option_receive_buffer_size_type = socket_option_buffer_size_type;
+    using socket_option_send_buffer_size_type = socket_option_buffer_size_type;
     struct accept_option_reuse_address_type
     {
       bool value;
@@ -148,6 +155,7 @@ namespace mock
         static const int max_connections = 42;
         using endpoint_type = _endpoint;
         void set_option(socket_option_no_delay_type) {}
+        void get_option(socket_option_buffer_size_type&) const {}
 
         using _anyAsyncConnecter = std::function<void (_resolver_entry, _anyHandler)>;
         static _anyAsyncConnecter async_connect;
@@ -329,3 +329,177 @@ TEST(NetSendMessageEnqueue, MultipleSendsFromMultipleThreadsAsio)
   // Allow detached thread to finish.
   for (auto& t: sendThreads) t.join();
 }
+
+namespace
+{
+  qi::Message makeEvent(unsigned int id, unsigned int event)
+  {
+    qi::Message msg{ qi::Message::Type_Event, qi::MessageAddress{ id, 1u, 1u, event } };
+    return msg;
+  }
+}
+
+TEST(NetSendMessageEnqueue, FailPolicyRejectsMessagesOverTheLimit)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  std::vector<N::_anyTransferHandler> writeConts;
+  auto scopedWrite = ka::scoped_set_and_restore(
+    N::_async_write_next_layer,
+    [&](SslSocket<N>::next_layer_type&, const std::vector<N::_const_buffer_sequence>&,
+          N::_anyTransferHandler writeCont) {
+      writeConts.push_back(writeCont);
+    }
+  );
+  SslContext<N> context;
+  auto socket = makeSslSocketPtr<N>(N::defaultIoService(), context);
+  SendMessageEnqueue<N, SslSocketPtr<N>> send{socket};
+  SendQueueLimits limits;
+  limits.maxMessages = 2u;
+  limits.policy = SendQueueOverflowPolicy::Fail;
+  send.setLimits(limits);
+
+  EXPECT_TRUE(send(makeEvent(1u, 1u), SslEnabled{false}));
+  EXPECT_TRUE(send(makeEvent(2u, 1u), SslEnabled{false}));
+  EXPECT_FALSE(send(makeEvent(3u, 1u), SslEnabled{false}));
+  // Replies are always enqueued.
+  EXPECT_TRUE(send(Message{ Message::Type_Reply, MessageAddress{ 4u, 1u, 1u, 1u } },
+                   SslEnabled{false}));
+
+  const auto stats = send.statistics();
+  EXPECT_EQ(3u, stats.messages);
+  EXPECT_EQ(3u * sizeof(Message::Header), stats.bytes);
+  EXPECT_EQ(1u, stats.rejectedMessages);
+  EXPECT_EQ(0u, stats.droppedMessages);
+  EXPECT_EQ(1u, writeConts.size());
+}
+
+TEST(NetSendMessageEnqueue, KeepLatestPolicyReplacesEnqueuedEventOfTheSameSignal)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  std::vector<N::_anyTransferHandler> writeConts;
+  auto scopedWrite = ka::scoped_set_and_restore(
+    N::_async_write_next_layer,
+    [&](SslSocket<N>::next_layer_type&, const std::vector<N::_const_buffer_sequence>&,
+          N::_anyTransferHandler writeCont) {
+      writeConts.push_back(writeCont);
+    }
+  );
+  SslContext<N> context;
+  auto socket = makeSslSocketPtr<N>(N::defaultIoService(), context);
+  SendMessageEnqueue<N, SslSocketPtr<N>> send{socket};
+  SendQueueLimits limits;
+  limits.maxMessages = 3u;
+  limits.policy = SendQueueOverflowPolicy::KeepLatest;
+  send.setLimits(limits);
+
+  using I = std::list<Message>::const_iterator;
+  std::vector<unsigned int> sentIds;
+  auto onSent = [&](ErrorCode<N>, I itMsg) {
+    sentIds.push_back(itMsg->id());
+    return true;
+  };
+  // The first message is being sent and must not be replaced.
+  EXPECT_TRUE(send(makeEvent(1u, 1u), SslEnabled{false}, onSent));
+  EXPECT_TRUE(send(makeEvent(2u, 1u), SslEnabled{false}, onSent));
+  EXPECT_TRUE(send(makeEvent(3u, 2u), SslEnabled{false}, onSent));
+  EXPECT_TRUE(send(makeEvent(4u, 1u), SslEnabled{false}, onSent));
+  // No event of this signal is enqueued: the oldest one is dropped.
+  EXPECT_TRUE(send(makeEvent(5u, 3u), SslEnabled{false}, onSent));
+
+  const auto stats = send.statistics();
+  EXPECT_EQ(3u, stats.messages);
+  EXPECT_EQ(3u, stats.peakMessages);
+  EXPECT_EQ(2u, stats.droppedMessages);
+
+  // Each continuation starts sending the next message, which adds a continuation.
+  for (std::size_t i = 0u; i < writeConts.size(); ++i)
+  {
+    auto writeCont = writeConts[i];
+    writeCont(success<ErrorCode<N>>(), 0u);
+  }
+  EXPECT_EQ((std::vector<unsigned int>{ 1u, 3u, 5u }), sentIds);
+  EXPECT_EQ(0u, send.statistics().messages);
+}
+
+TEST(NetSendMessageEnqueue, ControlMessagesOvertakeEnqueuedEvents)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  std::vector<N::_anyTransferHandler> writeConts;
+  auto scopedWrite = ka::scoped_set_and_restore(
+    N::_async_write_next_layer,
+    [&](SslSocket<N>::next_layer_type&, const std::vector<N::_const_buffer_sequence>&,
+          N::_anyTransferHandler writeCont) {
+      writeConts.push_back(writeCont);
+    }
+  );
+  SslContext<N> context;
+  auto socket = makeSslSocketPtr<N>(N::defaultIoService(), context);
+  SendMessageEnqueue<N, SslSocketPtr<N>> send{socket};
+
+  using I = std::list<Message>::const_iterator;
+  std::vector<unsigned int> sentIds;
+  auto onSent = [&](ErrorCode<N>, I itMsg) {
+    sentIds.push_back(itMsg->id());
+    return true;
+  };
+  // The first event is being sent.
+  for (unsigned int id = 1u; id <= 3u; ++id)
+    send(makeEvent(id, 1u), SslEnabled{false}, onSent);
+  send(Message{ Message::Type_Reply, MessageAddress{ 4u, 1u, 1u, 1u } }, SslEnabled{false}, onSent);
+  auto controlEvent = makeEvent(5u, 2u);
+  controlEvent.setPriority(MemberPriority::Control);
+  send(std::move(controlEvent), SslEnabled{false}, onSent);
+  auto bulkReply = Message{ Message::Type_Reply, MessageAddress{ 6u, 1u, 1u, 1u } };
+  bulkReply.setPriority(MemberPriority::Bulk);
+  send(std::move(bulkReply), SslEnabled{false}, onSent);
+
+  for (std::size_t i = 0u; i < writeConts.size(); ++i)
+  {
+    auto writeCont = writeConts[i];
+    writeCont(success<ErrorCode<N>>(), 0u);
+  }
+  EXPECT_EQ((std::vector<unsigned int>{ 1u, 4u, 5u, 2u, 3u, 6u }), sentIds);
+}
+
+TEST(NetSendMessageEnqueue, EventsAreNotStarvedByControlMessages)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  std::vector<N::_anyTransferHandler> writeConts;
+  auto scopedWrite = ka::scoped_set_and_restore(
+    N::_async_write_next_layer,
+    [&](SslSocket<N>::next_layer_type&, const std::vector<N::_const_buffer_sequence>&,
+          N::_anyTransferHandler writeCont) {
+      writeConts.push_back(writeCont);
+    }
+  );
+  SslContext<N> context;
+  auto socket = makeSslSocketPtr<N>(N::defaultIoService(), context);
+  SendMessageEnqueue<N, SslSocketPtr<N>> send{socket};
+
+  using I = std::list<Message>::const_iterator;
+  std::vector<unsigned int> sentIds;
+  auto onSent = [&](ErrorCode<N>, I itMsg) {
+    sentIds.push_back(itMsg->id());
+    return true;
+  };
+  // The first event is being sent.
+  send(makeEvent(1u, 1u), SslEnabled{false}, onSent);
+  send(makeEvent(2u, 1u), SslEnabled{false}, onSent);
+  for (unsigned int id = 10u; id < 16u; ++id)
+    send(Message{ Message::Type_Reply, MessageAddress{ id, 1u, 1u, 1u } }, SslEnabled{false}, onSent);
+
+  for (std::size_t i = 0u; i < writeConts.size(); ++i)
+  {
+    auto writeCont = writeConts[i];
+    writeCont(success<ErrorCode<N>>(), 0u);
+  }
+  EXPECT_EQ((std::vector<unsigned int>{ 1u, 10u, 11u, 12u, 13u, 2u, 14u, 15u }), sentIds);
+}
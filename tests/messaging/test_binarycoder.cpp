@@ -649,3 +649,95 @@ TEST(testSerializable, Value) {
   qi::encodeBinary(&buf, gv);
   qi::decodeBinary(&bufr, &gv2);
 }
+
+TEST(testSerializable, DecodeIntoOtherType)
+{
+  // Encoded as a list of tuples of int and float, decoded as a map of
+  // int64 to double: the values are widened while decoding.
+  std::vector<std::pair<int, float>> pairs{ { 1, 1.5f }, { 2, -2.f } };
+  qi::Buffer buf;
+  qi::encodeBinary(&buf, qi::AnyReference::from(std::map<int, float>(pairs.begin(), pairs.end())));
+  const qi::Signature signature = qi::typeOf<std::map<int, float>>()->signature();
+
+  std::map<qi::int64_t, double> wide;
+  qi::BufferReader bufr(buf);
+  qi::decodeBinary(&bufr, qi::AnyReference::from(wide), signature);
+  EXPECT_EQ((std::map<qi::int64_t, double>{ { 1, 1.5 }, { 2, -2. } }), wide);
+
+  // Structs are decoded member by member.
+  qi::Buffer pointBuf;
+  qi::encodeBinary(&pointBuf, std::make_pair(4, 2));
+  Point2D point;
+  qi::BufferReader pointReader(pointBuf);
+  qi::decodeBinary(&pointReader, qi::AnyReference::from(point), qi::Signature("(ii)"));
+  EXPECT_EQ(4, point.x());
+  EXPECT_EQ(2, point.y());
+
+  // Values which do not fit are rejected.
+  qi::Buffer bigBuf;
+  qi::encodeBinary(&bigBuf, std::vector<int>{ 1, 100000 });
+  std::vector<short> shorts;
+  qi::BufferReader bigReader(bigBuf);
+  EXPECT_ANY_THROW(qi::decodeBinary(&bigReader, qi::AnyReference::from(shorts), qi::Signature("[i]")));
+}
+
+struct Labelled
+{
+  int id;
+  std::string label;
+  qi::AnyValue value;
+};
+
+QI_TYPE_STRUCT(Labelled, id, label, value);
+
+TEST(testSerializable, DecodeNestedValues)
+{
+  // The decoded elements are handed over to their containers: make sure the
+  // trees come out whole, for static types and for types made from signatures.
+  using Nested = std::map<std::string, std::vector<Labelled>>;
+  Nested value;
+  value["one"].push_back(Labelled{ 1, "a", qi::AnyValue::from(std::vector<std::string>{ "x", "y" }) });
+  value["one"].push_back(Labelled{ 2, "b", qi::AnyValue::from(3.5) });
+  value["two"].push_back(Labelled{ 3, "c", qi::AnyValue::from(std::map<int, std::string>{ { 4, "d" } }) });
+  qi::Buffer buf;
+  qi::encodeBinary(&buf, qi::AnyReference::from(value));
+
+  const auto expectWhole = [](Nested decoded) {
+    ASSERT_EQ(2u, decoded.size());
+    ASSERT_EQ(2u, decoded["one"].size());
+    ASSERT_EQ(1u, decoded["two"].size());
+    EXPECT_EQ(2, decoded["one"][1].id);
+    EXPECT_EQ("b", decoded["one"][1].label);
+    EXPECT_EQ((std::vector<std::string>{ "x", "y" }),
+              decoded["one"][0].value.to<std::vector<std::string>>());
+    EXPECT_EQ(3.5, decoded["one"][1].value.toDouble());
+    EXPECT_EQ("d", (decoded["two"][0].value.to<std::map<int, std::string>>()[4]));
+  };
+
+  Nested decoded;
+  qi::BufferReader reader(buf);
+  qi::decodeBinary(&reader, &decoded);
+  expectWhole(decoded);
+
+  qi::TypeInterface* type = qi::TypeInterface::fromSignature(qi::typeOf<Nested>()->signature());
+  qi::BufferReader dynamicReader(buf);
+  qi::AnyValue dynamic(qi::decodeBinary(&dynamicReader, qi::AnyReference(type)), false, true);
+  expectWhole(dynamic.to<Nested>());
+}
+
+TEST(testSerializable, DecodeStructsBuiltFromAllFields)
+{
+  // Structs registered with QI_TYPE_STRUCT_AGREGATE_CONSTRUCTOR can only be
+  // set as a whole.
+  const qi::MethodStatistics stats(2, qi::MinMaxSum(1.f, 2.f, 3.f),
+                                   qi::MinMaxSum(0.5f, 1.f, 1.5f), qi::MinMaxSum());
+  qi::Buffer buf;
+  qi::encodeBinary(&buf, qi::AnyReference::from(stats));
+
+  qi::MethodStatistics decoded;
+  qi::BufferReader reader(buf);
+  qi::decodeBinary(&reader, &decoded);
+  EXPECT_EQ(2u, decoded.count());
+  EXPECT_EQ(2.f, decoded.wall().maxValue());
+  EXPECT_EQ(1.5f, decoded.user().cumulatedValue());
+}
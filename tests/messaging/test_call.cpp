@@ -18,10 +18,12 @@
 #include <qi/application.hpp>
 #include <qi/eventloop.hpp>
 #include <qi/anyobject.hpp>
+#include <qi/methodhandle.hpp>
 #include <qi/type/dynamicobject.hpp>
 #include <qi/type/dynamicobjectbuilder.hpp>
 #include <qi/type/objecttypebuilder.hpp>
 #include <qi/session.hpp>
+#include <qi/tracecontext.hpp>
 #include <qi/testutils/testutils.hpp>
 #include <ka/errorhandling.hpp>
 #include <ka/functional.hpp>
@@ -103,6 +105,28 @@ TEST(TestCall, Convert)
   EXPECT_ANY_THROW(obj.call<bool>("getstring"));
 }
 
+TEST(TestCall, MethodHandle)
+{
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("getint", &getint);
+  ob.advertiseMethod("getstring", &getstring);
+
+  TestSessionPair p;
+  p.server()->registerService("Serv", ob.object());
+  qi::AnyObject obj = p.client()->service("Serv").value();
+
+  qi::MethodHandle<float()> getIntAsFloat(obj, "getint");
+  EXPECT_EQ(42.f, getIntAsFloat());
+  EXPECT_EQ(42.f, getIntAsFloat.async().value());
+  qi::MethodHandle<std::string()> getString(obj, "getstring");
+  EXPECT_EQ("lol", getString());
+
+  // Booleans are integers for signatures: the value is checked by the call.
+  qi::MethodHandle<bool()> getIntAsBool(obj, "getint");
+  EXPECT_ANY_THROW(getIntAsBool());
+  EXPECT_ANY_THROW(qi::MethodHandle<int()>(obj, "getstring"));
+}
+
 int addOne(int v)
 {
   qiLogDebug() << "addOne";
@@ -308,6 +332,27 @@ TEST(TestCall, CallVoid)
   p.server()->unregisterService(serviceID);
 }
 
+TEST(TestCall, CallPropagatesTraceContext)
+{
+  TestSessionPair          p;
+  qi::DynamicObjectBuilder ob;
+
+  ob.advertiseMethod("traceId", [] { return qi::currentTraceContext().traceId; });
+  qi::AnyObject obj(ob.object());
+
+  const auto serviceID = p.server()->registerService("serviceCall", obj).value();
+  qi::AnyObject proxy = p.client()->service("serviceCall").value();
+
+  const auto context = qi::TraceContext().child();
+  {
+    qi::TraceContextScope scope(context);
+    EXPECT_EQ(context.traceId, proxy.call<qi::uint64_t>("traceId"));
+  }
+  // Calls made out of any trace are not traced.
+  EXPECT_EQ(0u, proxy.call<qi::uint64_t>("traceId"));
+  p.server()->unregisterService(serviceID);
+}
+
 TEST(TestCall, CallVoidErr)
 {
   std::list<std::pair<std::string, int> >  robots;
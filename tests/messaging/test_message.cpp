@@ -51,3 +51,22 @@ TEST(TestMessage, CopiesAreDistinct)
   ASSERT_NE(buf.totalSize(), bb.totalSize());
 
 }
+
+TEST(TestMessage, TraceContextPrefixesThePayload)
+{
+  using namespace qi;
+  const auto context = TraceContext().child().child();
+  Message msg(Message::Type_Call, MessageAddress{509, 2, 3, 105});
+  EXPECT_FALSE(msg.traceContext().isValid());
+
+  msg.setTraceContext(context);
+  msg.setValue(AnyReference::from(std::string("payload")), "s");
+  EXPECT_TRUE(msg.flags() & Message::TypeFlag_TraceContext);
+  EXPECT_EQ(msg.buffer().totalSize(), msg.header().size);
+
+  const auto received = msg.traceContext();
+  EXPECT_EQ(context.traceId, received.traceId);
+  EXPECT_EQ(context.spanId, received.spanId);
+  EXPECT_EQ(0u, received.parentSpanId); // not transmitted
+  EXPECT_EQ("payload", msg.value("s", MessageSocketPtr()).to<std::string>());
+}
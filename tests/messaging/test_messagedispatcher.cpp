@@ -0,0 +1,138 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <vector>
+#include <gtest/gtest.h>
+#include <qi/eventloop.hpp>
+#include <qi/strand.hpp>
+#include "src/messaging/messagedispatcher.hpp"
+
+namespace
+{
+  const unsigned int serviceId = 1;
+  const unsigned int objectId = 2;
+
+  qi::Message makeMessage(unsigned int messageId, unsigned int object = objectId)
+  {
+    return qi::Message(qi::Message::Type_Post, qi::MessageAddress(messageId, serviceId, object, 100));
+  }
+}
+
+// Messages dispatched while the execution context is busy are all handed
+// over at once when it becomes free, in the order they were received.
+TEST(MessageDispatcher, DispatchesABurstInOrder)
+{
+  const bool spawnOnOverload = false;
+  qi::EventLoop loop{ "TestMessageDispatcher", 1, spawnOnOverload };
+  qi::Strand strand{ loop };
+  qi::MessageDispatcher dispatcher{ strand };
+
+  std::vector<unsigned int> received;
+  dispatcher.messagePendingConnect(serviceId, objectId, [&](const qi::Message& msg) {
+    received.push_back(msg.id());
+    return qi::DispatchStatus::MessageHandled;
+  });
+
+  qi::Promise<void> release;
+  auto busy = strand.async([&] { release.future().wait(); });
+
+  std::vector<qi::Future<bool>> results;
+  for (unsigned int id = 1; id <= 5; ++id)
+    results.push_back(dispatcher.dispatch(makeMessage(id)));
+  results.push_back(dispatcher.dispatch(makeMessage(6, objectId + 1)));
+  release.setValue(nullptr);
+  busy.value();
+
+  for (std::size_t i = 0; i + 1 < results.size(); ++i)
+    EXPECT_TRUE(results[i].value());
+  // No handler for the last recipient.
+  EXPECT_FALSE(results.back().value());
+  EXPECT_EQ((std::vector<unsigned int>{ 1, 2, 3, 4, 5 }), received);
+}
+
+TEST(MessageDispatcher, DispatchesAfterABatch)
+{
+  qi::Strand strand;
+  qi::MessageDispatcher dispatcher{ strand };
+  int received = 0;
+  dispatcher.messagePendingConnect(serviceId, objectId, [&](const qi::Message&) {
+    ++received;
+    return qi::DispatchStatus::MessageHandled;
+  });
+
+  EXPECT_TRUE(dispatcher.dispatch(makeMessage(1)).value());
+  EXPECT_TRUE(dispatcher.dispatch(makeMessage(2)).value());
+  EXPECT_EQ(2, received);
+}
+
+// A batch is dispatched with a snapshot of the handlers, which must not keep
+// handlers disconnected while the batch is dispatched.
+TEST(MessageDispatcher, DoesNotDispatchToHandlersDisconnectedDuringABatch)
+{
+  const bool spawnOnOverload = false;
+  qi::EventLoop loop{ "TestMessageDispatcher", 1, spawnOnOverload };
+  qi::Strand strand{ loop };
+  qi::MessageDispatcher dispatcher{ strand };
+
+  std::vector<unsigned int> received;
+  const auto other = objectId + 1;
+  const auto otherLink = dispatcher.messagePendingConnect(serviceId, other, [&](const qi::Message& msg) {
+    received.push_back(msg.id());
+    return qi::DispatchStatus::MessageHandled;
+  });
+  dispatcher.messagePendingConnect(serviceId, objectId, [&](const qi::Message& msg) {
+    received.push_back(msg.id());
+    dispatcher.messagePendingDisconnect(serviceId, other, otherLink);
+    return qi::DispatchStatus::MessageHandled;
+  });
+
+  qi::Promise<void> release;
+  auto busy = strand.async([&] { release.future().wait(); });
+
+  const auto first = dispatcher.dispatch(makeMessage(1, other));
+  const auto second = dispatcher.dispatch(makeMessage(2, other));
+  const auto third = dispatcher.dispatch(makeMessage(3));
+  const auto fourth = dispatcher.dispatch(makeMessage(4, other));
+  release.setValue(nullptr);
+  busy.value();
+
+  EXPECT_TRUE(first.value());
+  EXPECT_TRUE(second.value());
+  EXPECT_TRUE(third.value());
+  EXPECT_FALSE(fourth.value());
+  EXPECT_EQ((std::vector<unsigned int>{ 1, 2, 3 }), received);
+}
+
+// A throwing handler must neither prevent the other handlers from getting the
+// message, nor the rest of the batch from being dispatched.
+TEST(MessageDispatcher, DispatchesABatchDespiteThrowingHandlers)
+{
+  const bool spawnOnOverload = false;
+  qi::EventLoop loop{ "TestMessageDispatcher", 1, spawnOnOverload };
+  qi::Strand strand{ loop };
+  qi::MessageDispatcher dispatcher{ strand };
+
+  std::vector<unsigned int> received;
+  dispatcher.messagePendingConnect(serviceId, objectId, [&](const qi::Message&) -> qi::DispatchStatus {
+    throw 42;
+  });
+  dispatcher.messagePendingConnect(serviceId, objectId, [&](const qi::Message& msg) {
+    received.push_back(msg.id());
+    return qi::DispatchStatus::MessageHandled;
+  });
+
+  qi::Promise<void> release;
+  auto busy = strand.async([&] { release.future().wait(); });
+
+  std::vector<qi::Future<bool>> results;
+  for (unsigned int id = 1; id <= 3; ++id)
+    results.push_back(dispatcher.dispatch(makeMessage(id)));
+  release.setValue(nullptr);
+  busy.value();
+
+  for (auto& result : results)
+    EXPECT_TRUE(result.value());
+  EXPECT_EQ((std::vector<unsigned int>{ 1, 2, 3 }), received);
+}
@@ -278,3 +278,30 @@ TEST(ServiceDirectory, IsNotConnectedAfterClose)
   session->close();
   ASSERT_FALSE(session->isConnected());
 }
+
+TEST(ServiceDirectory, ServiceIsUnknownAfterRemoteUnregistration)
+{
+  auto server = qi::makeSession();
+  auto client = qi::makeSession();
+  server->listenStandalone("tcp://127.0.0.1:0");
+  client->connect(server->endpoints().back());
+
+  const auto id = server->registerService("Serv", boost::make_shared<Serv>()).value();
+  ASSERT_EQ(Serv::response, client->service("Serv").value().call<int>("f"));
+
+  qi::Promise<void> removed;
+  client->serviceUnregistered.connect([=](unsigned int, const std::string& name) mutable {
+    if (name == "Serv")
+      removed.setValue(nullptr);
+  });
+  server->unregisterService(id).value();
+  ASSERT_TRUE(test::finishesWithValue(removed.future()));
+
+  // Unknown services are waited for until the timeout cancels the wait.
+  ASSERT_EQ(qi::FutureState_Canceled, client->waitForService("Serv", qi::MilliSeconds{ 100 }).wait());
+
+  auto reregistered = client->waitForService("Serv").async();
+  server->registerService("Serv", boost::make_shared<Serv>()).value();
+  ASSERT_TRUE(test::finishesWithValue(reregistered));
+  ASSERT_EQ(Serv::response, client->service("Serv").value().call<int>("f"));
+}
@@ -0,0 +1,71 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <qi/anyobject.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+#include <qi/testutils/testutils.hpp>
+#include "src/messaging/servicedirectoryclient.hpp"
+
+namespace
+{
+
+// Service directory answering any lookup and counting them.
+struct ServiceDirectoryClientCache : testing::Test
+{
+  ServiceDirectoryClientCache()
+  {
+    qi::DynamicObjectBuilder builder;
+    builder.advertiseMethod("service", [this](const std::string& name) {
+      ++lookupCount;
+      qi::ServiceInfo info;
+      info.setName(name);
+      info.setServiceId(42);
+      return info;
+    });
+    builder.advertiseSignal<unsigned int, std::string>("serviceAdded");
+    builder.advertiseSignal<unsigned int, std::string>("serviceRemoved");
+    sd = builder.object();
+    client.setServiceDirectory(sd);
+  }
+
+  std::atomic<int> lookupCount{ 0 };
+  qi::AnyObject sd;
+  qi::ServiceDirectoryClient client;
+};
+
+} // anonymous namespace
+
+TEST_F(ServiceDirectoryClientCache, KnownServiceIsNotLookedUpAgain)
+{
+  auto info = client.service("Serv");
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, info.wait(test::defaultFutureWaitDuration)) << info.error();
+  EXPECT_EQ(42u, info.value().serviceId());
+  EXPECT_EQ(1, lookupCount.load());
+
+  info = client.service("Serv");
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, info.wait(test::defaultFutureWaitDuration)) << info.error();
+  EXPECT_EQ(42u, info.value().serviceId());
+  EXPECT_EQ(1, lookupCount.load());
+}
+
+TEST_F(ServiceDirectoryClientCache, ServiceIsLookedUpAgainAfterItIsRemoved)
+{
+  ASSERT_EQ(qi::FutureState_FinishedWithValue,
+            client.service("Serv").wait(test::defaultFutureWaitDuration));
+  EXPECT_EQ(1, lookupCount.load());
+
+  qi::Promise<void> removed;
+  client.serviceRemoved.connect([=](unsigned int, const std::string&) mutable {
+    removed.setValue(nullptr);
+  });
+  sd.post("serviceRemoved", 42u, std::string("Serv"));
+  ASSERT_TRUE(test::finishesWithValue(removed.future()));
+
+  ASSERT_EQ(qi::FutureState_FinishedWithValue,
+            client.service("Serv").wait(test::defaultFutureWaitDuration));
+  EXPECT_EQ(2, lookupCount.load());
+}
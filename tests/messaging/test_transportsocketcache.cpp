@@ -6,6 +6,7 @@
 **
 */
 
+#include <atomic>
 #include <vector>
 #include <algorithm>
 #include <iterator>
@@ -110,6 +111,224 @@ TEST_F(TestTransportSocketCache, FirstUrlWillFail)
   ASSERT_TRUE(sock->isConnected());
 }
 
+TEST_F(TestTransportSocketCache, FailingEndpointIsQuarantined)
+{
+  server_.listen("tcp://127.0.0.1:0").wait();
+  const qi::Url failingUrl("tcp://127.0.0.1:4444");
+  const qi::Url workingUrl = server_.endpoints()[0];
+  const auto machineId = qi::os::getMachineId();
+
+  qi::ServiceInfo servInfo;
+  servInfo.setMachineId(machineId);
+  servInfo.setEndpoints({ failingUrl, workingUrl });
+  qi::MessageSocketPtr sock = cache_.socket(servInfo).value();
+  ASSERT_TRUE(sock->isConnected());
+  ASSERT_EQ(workingUrl, sock->url());
+
+  // The failing endpoint is known to fail, the working one to be reachable.
+  auto failingStats = cache_.endpointStatistics(machineId, *qi::toUri(failingUrl));
+  ASSERT_TRUE(failingStats);
+  EXPECT_EQ(1u, failingStats->consecutiveFailures);
+  EXPECT_FALSE(failingStats->connectionTime);
+  EXPECT_GT(failingStats->quarantinedUntil, qi::SteadyClock::now());
+
+  auto workingStats = cache_.endpointStatistics(machineId, *qi::toUri(workingUrl));
+  ASSERT_TRUE(workingStats);
+  EXPECT_EQ(0u, workingStats->consecutiveFailures);
+  EXPECT_TRUE(workingStats->connectionTime);
+}
+
+TEST_F(TestTransportSocketCache, QuarantinedEndpointIsSkipped)
+{
+  server_.listen("tcp://127.0.0.1:0").wait();
+  const qi::Url failingUrl("tcp://127.0.0.1:4444");
+  const qi::Url workingUrl = server_.endpoints()[0];
+  const auto machineId = qi::os::getMachineId();
+
+  qi::ServiceInfo servInfo;
+  servInfo.setMachineId(machineId);
+  servInfo.setEndpoints({ failingUrl, workingUrl });
+  qi::MessageSocketPtr sock = cache_.socket(servInfo).value();
+  ASSERT_TRUE(sock->isConnected());
+  sock->disconnect();
+  // the disconnected signal can take some time until it's received, so wait a bit
+  std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+
+  // The failing endpoint is still quarantined and is not tried again.
+  sock = cache_.socket(servInfo).value();
+  ASSERT_TRUE(sock->isConnected());
+  ASSERT_EQ(workingUrl, sock->url());
+  auto failingStats = cache_.endpointStatistics(machineId, *qi::toUri(failingUrl));
+  ASSERT_TRUE(failingStats);
+  EXPECT_EQ(1u, failingStats->consecutiveFailures);
+}
+
+namespace
+{
+  bool becomesDisconnected(const qi::MessageSocketPtr& socket)
+  {
+    for (int i = 0; i < 100 && socket->isConnected(); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+    return !socket->isConnected();
+  }
+}
+
+TEST_F(TestTransportSocketCache, LeastRecentlyUsedSocketIsClosedOverMaxConnections)
+{
+  using namespace qi;
+
+  ASSERT_TRUE(test::finishesWithValue(server_.listen("tcp://127.0.0.1:0")));
+  ASSERT_TRUE(test::finishesWithValue(server_.listen("tcp://127.0.0.1:0")));
+  const auto endpoints = server_.endpoints();
+  ASSERT_EQ(2u, endpoints.size());
+  const auto machineId = os::getMachineId();
+
+  ServiceInfo info1;
+  info1.setMachineId(machineId);
+  info1.setName("muffins");
+  info1.setEndpoints({ endpoints[0] });
+
+  ServiceInfo info2;
+  info2.setMachineId(machineId);
+  info2.setName("cookies");
+  info2.setEndpoints({ endpoints[1] });
+
+  cache_.setMaxConnections(1);
+  const auto socket1Fut = cache_.socket(info1);
+  ASSERT_TRUE(test::finishesWithValue(socket1Fut));
+  const auto socket2Fut = cache_.socket(info2);
+  ASSERT_TRUE(test::finishesWithValue(socket2Fut));
+
+  EXPECT_TRUE(becomesDisconnected(socket1Fut.value()));
+  EXPECT_TRUE(socket2Fut.value()->isConnected());
+  const auto stats = cache_.socketStatistics();
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(socket2Fut.value(), stats[0].socket);
+  EXPECT_FALSE(stats[0].pinned);
+
+  // The service is reconnected on the next use.
+  const auto socket3Fut = cache_.socket(info1);
+  ASSERT_TRUE(test::finishesWithValue(socket3Fut));
+  EXPECT_NE(socket1Fut.value(), socket3Fut.value());
+  EXPECT_TRUE(socket3Fut.value()->isConnected());
+}
+
+TEST_F(TestTransportSocketCache, IdleSocketIsClosed)
+{
+  using namespace qi;
+
+  ASSERT_TRUE(test::finishesWithValue(server_.listen("tcp://127.0.0.1:0")));
+  ServiceInfo info;
+  info.setMachineId(os::getMachineId());
+  info.setName("muffins");
+  info.setEndpoints(server_.endpoints());
+
+  cache_.setIdleTimeout(Seconds{ 1 });
+  const auto socketFut = cache_.socket(info);
+  ASSERT_TRUE(test::finishesWithValue(socketFut));
+  EXPECT_TRUE(becomesDisconnected(socketFut.value()));
+  EXPECT_TRUE(cache_.socketStatistics().empty());
+}
+
+TEST_F(TestTransportSocketCache, SocketInUseIsNotClosedOverMaxConnections)
+{
+  using namespace qi;
+
+  ASSERT_TRUE(test::finishesWithValue(server_.listen("tcp://127.0.0.1:0")));
+  ASSERT_TRUE(test::finishesWithValue(server_.listen("tcp://127.0.0.1:0")));
+  const auto endpoints = server_.endpoints();
+  ASSERT_EQ(2u, endpoints.size());
+  const auto machineId = os::getMachineId();
+
+  ServiceInfo info1;
+  info1.setMachineId(machineId);
+  info1.setName("muffins");
+  info1.setEndpoints({ endpoints[0] });
+
+  ServiceInfo info2;
+  info2.setMachineId(machineId);
+  info2.setName("cookies");
+  info2.setEndpoints({ endpoints[1] });
+
+  cache_.setMaxConnections(1);
+  const auto socket1Fut = cache_.socket(info1);
+  ASSERT_TRUE(test::finishesWithValue(socket1Fut));
+  const auto socket1 = socket1Fut.value();
+  // Simulates a remote object bound to the socket.
+  const auto link = socket1->messagePendingConnect(1, 1, [](const qi::Message&) {
+    return DispatchStatus::MessageHandled;
+  });
+  const auto socket2Fut = cache_.socket(info2);
+  ASSERT_TRUE(test::finishesWithValue(socket2Fut));
+
+  EXPECT_TRUE(socket1->isConnected());
+  EXPECT_TRUE(socket2Fut.value()->isConnected());
+  const auto stats = cache_.socketStatistics();
+  ASSERT_EQ(2u, stats.size());
+  EXPECT_EQ(1, std::count_if(stats.begin(), stats.end(), [](const TransportSocketCache::SocketStatistics& s) {
+    return s.inUse;
+  }));
+  for (const auto& s : stats)
+  {
+    // Connected TCP sockets have kernel buffers.
+    EXPECT_LT(0u, s.bufferSizes.receive);
+    EXPECT_LT(0u, s.bufferSizes.send);
+  }
+  socket1->messagePendingDisconnect(1, 1, link);
+}
+
+TEST_F(TestTransportSocketCache, IdleSocketInUseIsNotClosed)
+{
+  using namespace qi;
+
+  ASSERT_TRUE(test::finishesWithValue(server_.listen("tcp://127.0.0.1:0")));
+  ServiceInfo info;
+  info.setMachineId(os::getMachineId());
+  info.setName("muffins");
+  info.setEndpoints(server_.endpoints());
+
+  cache_.setIdleTimeout(Seconds{ 1 });
+  const auto socketFut = cache_.socket(info);
+  ASSERT_TRUE(test::finishesWithValue(socketFut));
+  const auto socket = socketFut.value();
+  const auto link = socket->messagePendingConnect(1, 1, [](const qi::Message&) {
+    return DispatchStatus::MessageHandled;
+  });
+  std::this_thread::sleep_for(std::chrono::seconds{ 2 });
+  EXPECT_TRUE(socket->isConnected());
+
+  // Once released, the socket is reaped.
+  socket->messagePendingDisconnect(1, 1, link);
+  EXPECT_TRUE(becomesDisconnected(socket));
+}
+
+TEST_F(TestTransportSocketCache, IdleSocketIsClosedOnceItsHandlersAreNotInUse)
+{
+  using namespace qi;
+
+  ASSERT_TRUE(test::finishesWithValue(server_.listen("tcp://127.0.0.1:0")));
+  ServiceInfo info;
+  info.setMachineId(os::getMachineId());
+  info.setName("muffins");
+  info.setEndpoints(server_.endpoints());
+
+  cache_.setIdleTimeout(Seconds{ 1 });
+  const auto socketFut = cache_.socket(info);
+  ASSERT_TRUE(test::finishesWithValue(socketFut));
+  const auto socket = socketFut.value();
+  // Simulates a remote object kept alive but waiting for a reply, then done with it.
+  std::atomic<bool> waitingForReply{ true };
+  const auto link = socket->messagePendingConnect(1, 1,
+    [](const qi::Message&) { return DispatchStatus::MessageHandled; },
+    [&] { return waitingForReply.load(); });
+  std::this_thread::sleep_for(std::chrono::seconds{ 2 });
+  EXPECT_TRUE(socket->isConnected());
+
+  waitingForReply = false;
+  EXPECT_TRUE(becomesDisconnected(socket));
+  socket->messagePendingDisconnect(1, 1, link);
+}
+
 static const std::string fakeMachineId = "there is relatively low chances this \
     could end being the same machineID than the actual one of this \
     machine. Then again, one can't be too sure, and we should probably \
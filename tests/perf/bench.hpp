@@ -0,0 +1,19 @@
+#pragma once
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _TESTS_PERF_BENCH_HPP_
+#define _TESTS_PERF_BENCH_HPP_
+
+#include <qi/perf/benchmark.hpp>
+
+// Benchmarks of qi_perf, one function per area.
+void futureBenchmarks(qi::perf::Benchmark& bench);
+void strandBenchmarks(qi::perf::Benchmark& bench);
+void signalBenchmarks(qi::perf::Benchmark& bench);
+void codecBenchmarks(qi::perf::Benchmark& bench);
+void callBenchmarks(qi::perf::Benchmark& bench);
+
+#endif  // _TESTS_PERF_BENCH_HPP_
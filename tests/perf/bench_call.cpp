@@ -0,0 +1,50 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <string>
+
+#include <qi/anyobject.hpp>
+#include <qi/session.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+  qi::AnyObject makeEchoObject()
+  {
+    qi::DynamicObjectBuilder builder;
+    builder.setThreadingModel(qi::ObjectThreadingModel_MultiThread);
+    builder.advertiseMethod("echoInt", [](int v) { return v; });
+    builder.advertiseMethod("echoString", [](const std::string& v) { return v; });
+    return builder.object();
+  }
+
+  void echoBenchmarks(qi::perf::Benchmark& bench, const std::string& name, qi::AnyObject echo)
+  {
+    bench.runLatency(name, [&] { echo.call<int>("echoInt", 42); }, sizeof(int), "int");
+    for (std::size_t size : { 1024u, 64u * 1024u })
+    {
+      const std::string payload(size, 'x');
+      bench.runLatency(name, [&] { echo.call<std::string>("echoString", payload); },
+                       size, "string_" + std::to_string(size));
+    }
+  }
+}
+
+void callBenchmarks(qi::perf::Benchmark& bench)
+{
+  qi::AnyObject echo = makeEchoObject();
+  echoBenchmarks(bench, "LocalCall", echo);
+
+  qi::Session server;
+  server.listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  server.registerService("Echo", echo);
+  qi::Session client;
+  client.connect(server.endpoints()[0]);
+  echoBenchmarks(bench, "RemoteCall", client.service("Echo").value());
+  client.close();
+  server.close();
+}
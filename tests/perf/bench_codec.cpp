@@ -0,0 +1,67 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <qi/anyvalue.hpp>
+#include <qi/binarycodec.hpp>
+#include <qi/buffer.hpp>
+#include <qi/jsoncodec.hpp>
+
+#include "bench.hpp"
+
+namespace
+{
+  template <typename T>
+  void binaryBenchmarks(qi::perf::Benchmark& bench, const T& value, const std::string& variable)
+  {
+    qi::Buffer encoded;
+    qi::encodeBinary(&encoded, qi::AnyReference::from(value));
+    const auto size = encoded.totalSize();
+
+    bench.run("EncodeBinary", [&](unsigned long n) {
+      for (unsigned long i = 0; i < n; ++i)
+      {
+        qi::Buffer buffer;
+        qi::encodeBinary(&buffer, qi::AnyReference::from(value));
+      }
+    }, size, variable);
+
+    bench.run("DecodeBinary", [&](unsigned long n) {
+      for (unsigned long i = 0; i < n; ++i)
+      {
+        T decoded;
+        qi::BufferReader reader(encoded);
+        qi::decodeBinary(&reader, &decoded, qi::DeserializeObjectCallback(), qi::MessageSocketPtr());
+      }
+    }, size, variable);
+
+    const auto json = qi::encodeJSON(value);
+    bench.run("EncodeJSON", [&](unsigned long n) {
+      for (unsigned long i = 0; i < n; ++i)
+        qi::encodeJSON(value);
+    }, json.size(), variable);
+
+    bench.run("DecodeJSON", [&](unsigned long n) {
+      for (unsigned long i = 0; i < n; ++i)
+      {
+        T decoded;
+        qi::decodeJSON(json, &decoded);
+      }
+    }, json.size(), variable);
+  }
+}
+
+void codecBenchmarks(qi::perf::Benchmark& bench)
+{
+  binaryBenchmarks(bench, std::vector<int>(1024, 42), "int_1024");
+  binaryBenchmarks(bench, std::vector<std::string>(256, std::string(32, 'x')), "string_256x32");
+  std::map<std::string, double> map;
+  for (int i = 0; i < 128; ++i)
+    map["key" + std::to_string(i)] = i * 0.5;
+  binaryBenchmarks(bench, map, "map_128");
+}
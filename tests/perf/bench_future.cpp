@@ -0,0 +1,35 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <qi/future.hpp>
+#include <qi/async.hpp>
+
+#include "bench.hpp"
+
+void futureBenchmarks(qi::perf::Benchmark& bench)
+{
+  bench.run("FutureSetValue", [](unsigned long n) {
+    for (unsigned long i = 0; i < n; ++i)
+    {
+      qi::Promise<int> promise;
+      promise.setValue(static_cast<int>(i));
+      promise.future().value();
+    }
+  });
+
+  bench.run("FutureThenSync", [](unsigned long n) {
+    for (unsigned long i = 0; i < n; ++i)
+    {
+      qi::Promise<int> promise(qi::FutureCallbackType_Sync);
+      auto next = promise.future().andThen(qi::FutureCallbackType_Sync, [](int v) { return v + 1; });
+      promise.setValue(static_cast<int>(i));
+      next.value();
+    }
+  });
+
+  bench.runLatency("AsyncRoundTrip", [] {
+    qi::async([] {}).value();
+  });
+}
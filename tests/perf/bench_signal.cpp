@@ -0,0 +1,46 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <atomic>
+#include <thread>
+
+#include <qi/signal.hpp>
+
+#include "bench.hpp"
+
+void signalBenchmarks(qi::perf::Benchmark& bench)
+{
+  std::atomic<unsigned long> received{ 0 };
+  const auto onSignal = [&](int) { ++received; };
+
+  {
+    qi::Signal<int> signal;
+    signal.connect(onSignal).setCallType(qi::MetaCallType_Direct);
+    bench.run("SignalTriggerDirect", [&](unsigned long n) {
+      for (unsigned long i = 0; i < n; ++i)
+        signal(static_cast<int>(i));
+    });
+  }
+  {
+    qi::Signal<int> signal;
+    for (int i = 0; i < 8; ++i)
+      signal.connect(onSignal).setCallType(qi::MetaCallType_Direct);
+    bench.run("SignalTriggerDirect", [&](unsigned long n) {
+      for (unsigned long i = 0; i < n; ++i)
+        signal(static_cast<int>(i));
+    }, 0, "8_subscribers");
+  }
+  {
+    qi::Signal<int> signal;
+    signal.connect(onSignal).setCallType(qi::MetaCallType_Queued);
+    bench.run("SignalTriggerQueued", [&](unsigned long n) {
+      const unsigned long expected = received + n;
+      for (unsigned long i = 0; i < n; ++i)
+        signal(static_cast<int>(i));
+      while (received < expected)
+        std::this_thread::yield();
+    });
+  }
+}
@@ -0,0 +1,24 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <qi/strand.hpp>
+
+#include "bench.hpp"
+
+void strandBenchmarks(qi::perf::Benchmark& bench)
+{
+  qi::Strand strand;
+
+  bench.run("StrandAsync", [&](unsigned long n) {
+    qi::Future<void> last;
+    for (unsigned long i = 0; i < n; ++i)
+      last = strand.async([] {});
+    last.value();
+  });
+
+  bench.runLatency("StrandRoundTrip", [&] {
+    strand.async([] {}).value();
+  });
+}
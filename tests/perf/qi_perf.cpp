@@ -0,0 +1,56 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Benchmarks of the building blocks of libqi: futures, strands, signals, the
+ * binary and JSON codecs, and local and remote calls.
+ *
+ * Results can be written as JSON with --json, and compared to those of a
+ * previous run with --baseline: the program then fails if a benchmark got
+ * slower than --threshold percent, or allocates more.
+ */
+
+#include <iostream>
+
+#include <boost/program_options.hpp>
+
+#include <qi/application.hpp>
+#include <qi/perf/allocationcounter.hpp>
+#include <qi/perf/benchmark.hpp>
+
+#include "bench.hpp"
+
+QI_PERF_COUNT_ALLOCATIONS()
+
+namespace po = boost::program_options;
+
+int main(int argc, char *argv[])
+{
+  qi::Application app(argc, argv);
+
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.");
+
+  desc.add(qi::perf::getBenchmarkOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::perf::Benchmark bench("qi", qi::perf::benchmarkOptions(vm));
+  futureBenchmarks(bench);
+  strandBenchmarks(bench);
+  signalBenchmarks(bench);
+  codecBenchmarks(bench);
+  callBenchmarks(bench);
+
+  return qi::perf::finishBenchmark(bench, vm);
+}
@@ -0,0 +1,192 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Benchmarks of the network event loops with many sockets.
+ *
+ * A session listens as a standalone service directory and registers a
+ * service with a method counting its calls and a signal. Many client
+ * sessions, each with its own socket, then:
+ * - post to the method, in turn (ReactorPost, throughput until all posts
+ *   arrived),
+ * - receive the signal triggered by the server (ReactorEvent, throughput
+ *   until all clients got all events).
+ *
+ * The results are named after the number of client sessions, e.g.
+ * "ReactorPost-s512". Compare runs with different numbers of network event
+ * loops with `--qi-network-eventloop-count` (or QI_NETWORK_EVENTLOOP_COUNT).
+ * Each client session uses at least two file descriptors: raise the limit of
+ * open files for thousands of sockets.
+ */
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/application.hpp>
+#include <qi/session.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+#include <qi/perf/allocationcounter.hpp>
+#include <qi/perf/benchmark.hpp>
+
+QI_PERF_COUNT_ALLOCATIONS()
+
+namespace po = boost::program_options;
+
+namespace
+{
+  // Counts the arrivals of posts or events, and wakes a waiter up once its
+  // target is reached.
+  class Counter
+  {
+  public:
+    void add()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (++_count == _target)
+        _reached.notify_all();
+    }
+
+    unsigned long count()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _count;
+    }
+
+    void waitFor(unsigned long target)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _target = target;
+      _reached.wait(lock, [&] { return _count >= _target; });
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable _reached;
+    unsigned long _count = 0;
+    unsigned long _target = 0;
+  };
+
+  qi::AnyObject makeService(Counter& sunk)
+  {
+    qi::DynamicObjectBuilder builder;
+    builder.setThreadingModel(qi::ObjectThreadingModel_MultiThread);
+    builder.advertiseMethod("sink", [&sunk](int) { sunk.add(); });
+    builder.advertiseSignal<int>("event");
+    return builder.object();
+  }
+
+  void socketBenchmarks(qi::perf::Benchmark& bench,
+                        qi::AnyObject service,
+                        const std::vector<qi::AnyObject>& clients,
+                        Counter& sunk)
+  {
+    const auto variable = "s" + std::to_string(clients.size());
+
+    bench.run("ReactorPost", [&](unsigned long n) {
+      const auto target = sunk.count() + n;
+      for (unsigned long i = 0; i < n; ++i)
+        clients[i % clients.size()].post("sink", 42);
+      sunk.waitFor(target);
+    }, sizeof(int), variable);
+
+    Counter received;
+    std::vector<qi::SignalLink> links;
+    for (const auto& client : clients)
+      links.push_back(client.connect("event", boost::function<void(int)>(
+                                                [&received](int) { received.add(); })).value());
+    bench.run("ReactorEvent", [&](unsigned long n) {
+      const auto target = received.count() + n * clients.size();
+      for (unsigned long i = 0; i < n; ++i)
+        service.post("event", 42);
+      received.waitFor(target);
+    }, sizeof(int), variable);
+    for (std::size_t i = 0; i < clients.size(); ++i)
+      clients[i].disconnect(links[i]).wait();
+  }
+
+  std::vector<std::string> splitList(const std::string& list)
+  {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+      if (!item.empty())
+        items.push_back(item);
+    return items;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  qi::Application app(argc, argv);
+
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("sockets", po::value<std::string>()->default_value("16,128,512"),
+     "Comma separated numbers of client sessions, each with its own socket.");
+
+  desc.add(qi::perf::getBenchmarkOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  std::vector<unsigned int> socketCounts;
+  try
+  {
+    for (const auto& count : splitList(vm["sockets"].as<std::string>()))
+      socketCounts.push_back(static_cast<unsigned int>(std::stoul(count)));
+  }
+  catch (const std::exception&)
+  {
+    std::cerr << "Invalid --sockets list" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Counter sunk;
+  qi::AnyObject service = makeService(sunk);
+
+  qi::Session server;
+  server.listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  server.registerService("ReactorPerf", service);
+  const auto endpoint = server.endpoints().at(0);
+
+  qi::perf::Benchmark bench("reactor", qi::perf::benchmarkOptions(vm));
+  for (const auto socketCount : socketCounts)
+  {
+    if (socketCount == 0)
+      continue;
+    std::vector<qi::SessionPtr> sessions;
+    std::vector<qi::AnyObject> clients;
+    for (unsigned int i = 0; i < socketCount; ++i)
+    {
+      sessions.push_back(qi::makeSession());
+      sessions.back()->connect(endpoint);
+      clients.push_back(sessions.back()->service("ReactorPerf").value());
+    }
+
+    socketBenchmarks(bench, service, clients, sunk);
+
+    clients.clear();
+    for (const auto& session : sessions)
+      session->close();
+  }
+  server.close();
+
+  return qi::perf::finishBenchmark(bench, vm);
+}
@@ -0,0 +1,304 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * End-to-end benchmarks of remote calls over the loopback interface.
+ *
+ * A session listens as a standalone service directory and registers a
+ * service with, for each argument shape, a method echoing its argument, a
+ * method ignoring it, and a signal. Several client sessions then:
+ * - call the echo method at the same time (RpcEcho, latency per call),
+ * - call the sink method at the same time (RpcSink, latency per call),
+ * - post to the sink method (RpcPost, throughput until all posts arrived),
+ * - receive the signal triggered by the server (RpcEvent, throughput until
+ *   all clients got all events).
+ *
+ * The results are named after the transport, the number of clients, the
+ * shape and the size of the argument, e.g. "RpcEcho-tcps_c4_string_1024".
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/application.hpp>
+#include <qi/buffer.hpp>
+#include <qi/path.hpp>
+#include <qi/session.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+#include <qi/perf/allocationcounter.hpp>
+#include <qi/perf/benchmark.hpp>
+
+QI_PERF_COUNT_ALLOCATIONS()
+
+namespace po = boost::program_options;
+
+namespace
+{
+  // Counts the arrivals of posts or events, and wakes a waiter up once its
+  // target is reached.
+  class Counter
+  {
+  public:
+    void add()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (++_count == _target)
+        _reached.notify_all();
+    }
+
+    unsigned long count()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _count;
+    }
+
+    void waitFor(unsigned long target)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _target = target;
+      _reached.wait(lock, [&] { return _count >= _target; });
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable _reached;
+    unsigned long _count = 0;
+    unsigned long _target = 0;
+  };
+
+  // Arguments of `size` bytes, in each shape.
+  template <typename T>
+  T makePayload(std::size_t size);
+
+  template <>
+  std::string makePayload<std::string>(std::size_t size)
+  {
+    return std::string(size, 'x');
+  }
+
+  template <>
+  qi::Buffer makePayload<qi::Buffer>(std::size_t size)
+  {
+    qi::Buffer buffer;
+    const std::vector<char> bytes(size, 'x');
+    if (size)
+      buffer.write(bytes.data(), size);
+    return buffer;
+  }
+
+  template <>
+  std::vector<int> makePayload<std::vector<int>>(std::size_t size)
+  {
+    return std::vector<int>(size / sizeof(int), 42);
+  }
+
+  // Many small elements, to weigh the per element cost of the codec.
+  template <>
+  std::vector<std::string> makePayload<std::vector<std::string>>(std::size_t size)
+  {
+    return std::vector<std::string>(size / 16, std::string(16, 'x'));
+  }
+
+  struct Shapes
+  {
+    std::vector<std::string> names;
+
+    bool has(const std::string& shape) const
+    {
+      return std::find(names.begin(), names.end(), shape) != names.end();
+    }
+  };
+
+  template <typename T>
+  void advertiseShape(qi::DynamicObjectBuilder& builder, const std::string& shape, Counter& sunk)
+  {
+    builder.advertiseMethod("echo_" + shape, [](const T& v) { return v; });
+    builder.advertiseMethod("sink_" + shape, [&sunk](const T&) { sunk.add(); });
+    builder.advertiseSignal<T>("event_" + shape);
+  }
+
+  qi::AnyObject makeService(const Shapes& shapes, Counter& sunk)
+  {
+    qi::DynamicObjectBuilder builder;
+    builder.setThreadingModel(qi::ObjectThreadingModel_MultiThread);
+    if (shapes.has("string"))
+      advertiseShape<std::string>(builder, "string", sunk);
+    if (shapes.has("buffer"))
+      advertiseShape<qi::Buffer>(builder, "buffer", sunk);
+    if (shapes.has("ints"))
+      advertiseShape<std::vector<int>>(builder, "ints", sunk);
+    if (shapes.has("strings"))
+      advertiseShape<std::vector<std::string>>(builder, "strings", sunk);
+    return builder.object();
+  }
+
+  template <typename T>
+  void shapeBenchmarks(qi::perf::Benchmark& bench,
+                       qi::AnyObject service,
+                       const std::vector<qi::AnyObject>& clients,
+                       Counter& sunk,
+                       const std::string& shape,
+                       std::size_t size,
+                       const std::string& prefix)
+  {
+    const T payload = makePayload<T>(size);
+    const auto variable = prefix + "_" + shape + "_" + std::to_string(size);
+    const auto concurrency = static_cast<unsigned int>(clients.size());
+    const std::string echo = "echo_" + shape;
+    const std::string sink = "sink_" + shape;
+    const std::string event = "event_" + shape;
+
+    bench.runConcurrentLatency("RpcEcho", concurrency, [&](unsigned int client) {
+      clients[client].call<T>(echo, payload);
+    }, size, variable);
+
+    bench.runConcurrentLatency("RpcSink", concurrency, [&](unsigned int client) {
+      clients[client].call<void>(sink, payload);
+    }, size, variable);
+
+    bench.run("RpcPost", [&](unsigned long n) {
+      const auto target = sunk.count() + n;
+      for (unsigned long i = 0; i < n; ++i)
+        clients[i % clients.size()].post(sink, payload);
+      sunk.waitFor(target);
+    }, size, variable);
+
+    Counter received;
+    std::vector<qi::SignalLink> links;
+    for (const auto& client : clients)
+      links.push_back(client.connect(event, boost::function<void(const T&)>(
+                                                [&received](const T&) { received.add(); })).value());
+    bench.run("RpcEvent", [&](unsigned long n) {
+      const auto target = received.count() + n * clients.size();
+      for (unsigned long i = 0; i < n; ++i)
+        service.post(event, payload);
+      received.waitFor(target);
+    }, size, variable);
+    for (std::size_t i = 0; i < clients.size(); ++i)
+      clients[i].disconnect(links[i]).wait();
+  }
+
+  std::vector<std::string> splitList(const std::string& list)
+  {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ','))
+      if (!item.empty())
+        items.push_back(item);
+    return items;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  qi::Application app(argc, argv);
+
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("transports", po::value<std::string>()->default_value("tcp,tcps"),
+     "Comma separated transports to benchmark.")
+    ("clients", po::value<std::string>()->default_value("1,4"),
+     "Comma separated numbers of client sessions calling at the same time.")
+    ("shapes", po::value<std::string>()->default_value("string,buffer,ints,strings"),
+     "Comma separated argument shapes, among string, buffer, ints and strings.")
+    ("sizes", po::value<std::string>()->default_value("0,1024,65536"),
+     "Comma separated argument sizes, in bytes.")
+    ("key", po::value<std::string>()->default_value(qi::path::findData("qi", "server.key")),
+     "Private key of the server, for tcps.")
+    ("certificate", po::value<std::string>()->default_value(qi::path::findData("qi", "server.crt")),
+     "Certificate of the server, for tcps.");
+
+  desc.add(qi::perf::getBenchmarkOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const auto transports = splitList(vm["transports"].as<std::string>());
+  const Shapes shapes{ splitList(vm["shapes"].as<std::string>()) };
+  std::vector<unsigned int> clientCounts;
+  std::vector<std::size_t> sizes;
+  try
+  {
+    for (const auto& count : splitList(vm["clients"].as<std::string>()))
+      clientCounts.push_back(static_cast<unsigned int>(std::stoul(count)));
+    for (const auto& size : splitList(vm["sizes"].as<std::string>()))
+      sizes.push_back(std::stoul(size));
+  }
+  catch (const std::exception&)
+  {
+    std::cerr << "Invalid --clients or --sizes list" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Counter sunk;
+  qi::AnyObject service = makeService(shapes, sunk);
+
+  qi::Session server;
+  if (std::find(transports.begin(), transports.end(), "tcps") != transports.end()
+      && !server.setIdentity(vm["key"].as<std::string>(), vm["certificate"].as<std::string>()))
+  {
+    std::cerr << "Cannot use the key and certificate for tcps" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<qi::Url> listenUrls;
+  for (const auto& transport : transports)
+    listenUrls.push_back(qi::Url(transport + "://127.0.0.1:0"));
+  server.listenStandalone(listenUrls);
+  server.registerService("RpcPerf", service);
+
+  qi::perf::Benchmark bench("rpc", qi::perf::benchmarkOptions(vm));
+  for (const auto& endpoint : server.endpoints())
+  {
+    for (const auto clientCount : clientCounts)
+    {
+      if (clientCount == 0)
+        continue;
+      std::vector<qi::SessionPtr> sessions;
+      std::vector<qi::AnyObject> clients;
+      for (unsigned int i = 0; i < clientCount; ++i)
+      {
+        sessions.push_back(qi::makeSession());
+        sessions.back()->connect(endpoint);
+        clients.push_back(sessions.back()->service("RpcPerf").value());
+      }
+
+      const auto prefix = endpoint.protocol() + "_c" + std::to_string(clientCount);
+      for (const auto size : sizes)
+      {
+        if (shapes.has("string"))
+          shapeBenchmarks<std::string>(bench, service, clients, sunk, "string", size, prefix);
+        if (shapes.has("buffer"))
+          shapeBenchmarks<qi::Buffer>(bench, service, clients, sunk, "buffer", size, prefix);
+        if (shapes.has("ints"))
+          shapeBenchmarks<std::vector<int>>(bench, service, clients, sunk, "ints", size, prefix);
+        if (shapes.has("strings"))
+          shapeBenchmarks<std::vector<std::string>>(bench, service, clients, sunk, "strings", size, prefix);
+      }
+
+      clients.clear();
+      for (const auto& session : sessions)
+        session->close();
+    }
+  }
+  server.close();
+
+  return qi::perf::finishBenchmark(bench, vm);
+}
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2012-2013 Aldebaran Robotics. All rights reserved.
+ */
+
+/*
+ * Encodes and decodes raw buffers of 1KB to 16MB to and from JSON, where they
+ * are represented as base64 strings, to measure the throughput of the base64
+ * codec.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyvalue.hpp>
+#include <qi/buffer.hpp>
+#include <qi/jsoncodec.hpp>
+#include <qi/perf/dataperfsuite.hpp>
+
+namespace po = boost::program_options;
+
+int main(int argc, char *argv[])
+{
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("bytes", po::value<unsigned long>()->default_value(256ul << 20), "Bytes processed per benchmark.");
+
+  desc.add(qi::detail::getPerfOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::DataPerfSuite out("qi", "test_base64perf", qi::DataPerfSuite::OutputData_MsgPerSecond, vm["output"].as<std::string>());
+
+  const auto totalBytes = vm["bytes"].as<unsigned long>();
+  for (unsigned long size = 1ul << 10; size <= 16ul << 20; size <<= 2)
+  {
+    const auto loopCount = std::max(1ul, totalBytes / size);
+    std::string data(size, '\0');
+    for (unsigned long i = 0; i < size; ++i)
+      data[i] = static_cast<char>(i * 7);
+    qi::Buffer buffer;
+    buffer.write(data.data(), data.size());
+
+    qi::DataPerf dp;
+    std::string json;
+    {
+      dp.start("Encode_" + std::to_string(size) + "B", loopCount, size);
+      for (unsigned long i = 0; i < loopCount; ++i)
+      {
+        json.clear();
+        qi::encodeJSON(buffer, json);
+      }
+      dp.stop();
+      out << dp;
+    }
+    {
+      dp.start("Decode_" + std::to_string(size) + "B", loopCount, size);
+      for (unsigned long i = 0; i < loopCount; ++i)
+      {
+        qi::Buffer decoded;
+        qi::decodeJSON(json, &decoded);
+      }
+      dp.stop();
+      out << dp;
+    }
+  }
+  out.close();
+
+  return EXIT_SUCCESS;
+}
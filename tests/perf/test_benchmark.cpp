@@ -0,0 +1,115 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <qi/perf/benchmark.hpp>
+
+namespace
+{
+  qi::perf::BenchmarkOptions fixedOptions()
+  {
+    qi::perf::BenchmarkOptions options;
+    options.warmupTrials = 1;
+    options.trials = 5;
+    options.iterations = 100;
+    return options;
+  }
+}
+
+TEST(TestBenchmark, RunsWarmupAndTrials)
+{
+  qi::perf::Benchmark bench("test", fixedOptions());
+  unsigned long iterations = 0;
+  ASSERT_TRUE(bench.run("Count", [&](unsigned long n) { iterations += n; }, 8, "var"));
+  EXPECT_EQ(600u, iterations);
+
+  ASSERT_EQ(1u, bench.results().size());
+  const auto& result = bench.results()[0];
+  EXPECT_EQ("Count", result.name);
+  EXPECT_EQ("var", result.variable);
+  EXPECT_EQ(100u, result.iterations);
+  EXPECT_EQ(5u, result.samples.size());
+  EXPECT_LE(result.min, result.median);
+  EXPECT_LE(result.median, result.max);
+  EXPECT_GE(result.stddev, 0);
+  // Five trial means have no meaningful percentiles.
+  EXPECT_EQ(-1, result.p90);
+  EXPECT_EQ(-1, result.p99);
+  // This program does not count its allocations.
+  EXPECT_EQ(-1, result.allocationsPerIteration);
+}
+
+TEST(TestBenchmark, LatencyHasOneSamplePerIteration)
+{
+  qi::perf::Benchmark bench("test", fixedOptions());
+  ASSERT_TRUE(bench.runLatency("Noop", [] {}));
+  ASSERT_EQ(1u, bench.results().size());
+  const auto& result = bench.results()[0];
+  EXPECT_EQ(500u, result.samples.size());
+  EXPECT_LE(result.median, result.p90);
+  EXPECT_LE(result.p90, result.p99);
+  EXPECT_LE(result.p99, result.max);
+}
+
+TEST(TestBenchmark, ConcurrentLatencyRunsEveryThread)
+{
+  qi::perf::Benchmark bench("test", fixedOptions());
+  std::atomic<unsigned long> calls[3] = {};
+  ASSERT_TRUE(bench.runConcurrentLatency("Noop", 3, [&](unsigned int thread) { ++calls[thread]; }));
+  for (const auto& count : calls)
+    EXPECT_EQ(600u, count.load());
+  ASSERT_EQ(1u, bench.results().size());
+  const auto& result = bench.results()[0];
+  EXPECT_EQ(3u, result.concurrency);
+  EXPECT_EQ(1500u, result.samples.size());
+}
+
+TEST(TestBenchmark, CalibratesIterations)
+{
+  auto options = fixedOptions();
+  options.iterations = 0;
+  options.minTrialDuration = qi::MilliSeconds{ 1 };
+  qi::perf::Benchmark bench("test", options);
+  ASSERT_TRUE(bench.run("Noop", [](unsigned long) {}));
+  EXPECT_GT(bench.results()[0].iterations, 1u);
+}
+
+TEST(TestBenchmark, Filter)
+{
+  auto options = fixedOptions();
+  options.filter = "Call";
+  qi::perf::Benchmark bench("test", options);
+  EXPECT_FALSE(bench.run("Future", [](unsigned long) {}));
+  EXPECT_TRUE(bench.run("RemoteCall", [](unsigned long) {}));
+  EXPECT_EQ(1u, bench.results().size());
+}
+
+TEST(TestBenchmark, ComparesToBaseline)
+{
+  qi::perf::Benchmark bench("test", fixedOptions());
+  bench.run("Count", [](unsigned long) {}, 0, "var");
+  std::stringstream json;
+  bench.writeJson(json);
+
+  auto baseline = qi::perf::Benchmark::readBaseline(json);
+  ASSERT_EQ(1u, baseline.size());
+  EXPECT_EQ("Count", baseline[0].name);
+  EXPECT_EQ("var", baseline[0].variable);
+  EXPECT_DOUBLE_EQ(bench.results()[0].median, baseline[0].median);
+  EXPECT_TRUE(bench.compare(baseline, 0.1).empty());
+
+  baseline[0].median = bench.results()[0].median / 2;
+  const auto regressions = bench.compare(baseline, 0.1);
+  ASSERT_EQ(1u, regressions.size());
+  EXPECT_EQ("Count", regressions[0].name);
+
+  std::stringstream invalid("{\"suite\": \"test\"}");
+  EXPECT_THROW(qi::perf::Benchmark::readBaseline(invalid), std::runtime_error);
+}
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2012-2013 Aldebaran Robotics. All rights reserved.
+ */
+
+/*
+ * Decodes dynamically typed values from several threads at once. The types of
+ * the values are resolved from their signature at each decoding, as done for
+ * incoming messages, so that the contention on the type registries shows up in
+ * the throughput.
+ */
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyvalue.hpp>
+#include <qi/binarycodec.hpp>
+#include <qi/buffer.hpp>
+#include <qi/perf/dataperfsuite.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  struct Element
+  {
+    int id;
+    float weight;
+    std::string name;
+  };
+}
+
+QI_TYPE_STRUCT(Element, id, weight, name);
+
+namespace
+{
+  using Value = std::map<std::string, std::vector<Element>>;
+
+  Value makeValue()
+  {
+    Value value;
+    for (int i = 0; i < 8; ++i)
+    {
+      auto& elements = value["key" + std::to_string(i)];
+      for (int j = 0; j < 4; ++j)
+        elements.push_back(Element{ j, static_cast<float>(j) / 2.f, "element" });
+    }
+    return value;
+  }
+
+  void decodeLoop(const qi::Buffer& buffer, const qi::Signature& signature, unsigned long loopCount)
+  {
+    for (unsigned long i = 0; i < loopCount; ++i)
+    {
+      qi::TypeInterface* type = qi::TypeInterface::fromSignature(signature);
+      qi::BufferReader reader(buffer);
+      qi::AnyValue(qi::decodeBinary(&reader, qi::AnyReference(type)), false, true);
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("loops", po::value<unsigned long>()->default_value(20000), "Decodings per thread.");
+
+  desc.add(qi::detail::getPerfOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::DataPerfSuite out("qi", "test_decodeperf", qi::DataPerfSuite::OutputData_MsgPerSecond, vm["output"].as<std::string>());
+
+  const auto value = makeValue();
+  qi::Buffer buffer;
+  qi::encodeBinary(&buffer, qi::AutoAnyReference(value));
+  const auto signature = qi::typeOf<Value>()->signature();
+  const auto loopCount = vm["loops"].as<unsigned long>();
+
+  for (unsigned int threadCount : { 1u, 2u, 4u, 8u })
+  {
+    qi::DataPerf dp;
+    dp.start("Decode_" + std::to_string(threadCount) + "_threads", loopCount * threadCount,
+             buffer.totalSize());
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadCount; ++i)
+      threads.emplace_back(decodeLoop, std::cref(buffer), std::cref(signature), loopCount);
+    for (auto& thread : threads)
+      thread.join();
+    dp.stop();
+    out << dp;
+  }
+  out.close();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2012-2013 Aldebaran Robotics. All rights reserved.
+ */
+
+/*
+ * Measures the startup cost of importing modules, one after the other or all
+ * at once with qi::preloadModules. Modules stay loaded once imported, so each
+ * run of the program measures a single cold import of the requested modules:
+ * compare runs with and without --serial.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anymodule.hpp>
+#include <qi/application.hpp>
+#include <qi/perf/dataperfsuite.hpp>
+
+namespace po = boost::program_options;
+
+int main(int argc, char *argv[])
+{
+  qi::Application app(argc, argv);
+
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("modules", po::value<std::vector<std::string>>()->multitoken()
+                  ->default_value(std::vector<std::string>{ "qi_test_anymodule" }, "qi_test_anymodule"),
+     "Modules to import.")
+    ("serial", po::bool_switch(), "Import the modules one after the other.");
+
+  desc.add(qi::detail::getPerfOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::DataPerfSuite out("qi", "test_importperf", qi::DataPerfSuite::OutputData_Period, vm["output"].as<std::string>());
+
+  const auto modules = vm["modules"].as<std::vector<std::string>>();
+  const bool serial = vm["serial"].as<bool>();
+  std::vector<qi::ModuleImportReport> reports;
+
+  qi::DataPerf dp;
+  dp.start(serial ? "ImportSerial" : "Preload", static_cast<unsigned long>(modules.size()));
+  if (serial)
+  {
+    for (const auto& name : modules)
+    {
+      qi::ModuleImportReport report;
+      report.name = name;
+      const qi::SteadyClock::time_point start = qi::SteadyClock::now();
+      try
+      {
+        report.module = qi::import(name);
+      }
+      catch (const std::exception& e)
+      {
+        report.error = e.what();
+      }
+      report.duration = qi::SteadyClock::now() - start;
+      reports.push_back(report);
+    }
+  }
+  else
+  {
+    reports = qi::preloadModules(modules).value();
+  }
+  dp.stop();
+  out << dp;
+  out.close();
+
+  for (const auto& report : reports)
+  {
+    std::cout << report.name << ": "
+              << boost::chrono::duration_cast<qi::MicroSeconds>(report.duration).count() << "us";
+    if (!report.error.empty())
+      std::cout << " (" << report.error << ")";
+    std::cout << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2012-2013 Aldebaran Robotics. All rights reserved.
+ */
+
+/*
+ * Encodes and decodes a JSON document of a few megabytes, made of a list of
+ * structs with numbers and strings, some of which need escaping.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyvalue.hpp>
+#include <qi/jsoncodec.hpp>
+#include <qi/perf/dataperfsuite.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  struct Record
+  {
+    int id;
+    double timestamp;
+    std::vector<float> position;
+    std::string label;
+    std::string comment;
+  };
+}
+
+QI_TYPE_STRUCT(Record, id, timestamp, position, label, comment);
+
+int main(int argc, char *argv[])
+{
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("elements", po::value<unsigned long>()->default_value(20000), "Structs in the document.")
+    ("loops", po::value<unsigned long>()->default_value(10), "Operations per benchmark.");
+
+  desc.add(qi::detail::getPerfOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::DataPerfSuite out("qi", "test_jsonperf", qi::DataPerfSuite::OutputData_MsgMBPerSecond, vm["output"].as<std::string>());
+
+  const auto elementCount = vm["elements"].as<unsigned long>();
+  const auto loopCount = vm["loops"].as<unsigned long>();
+  std::vector<Record> records;
+  for (unsigned long i = 0; i < elementCount; ++i)
+  {
+    records.push_back(Record{ static_cast<int>(i), 0.25 * i, { 1.5f, -2.f, 0.125f },
+                              "record " + std::to_string(i),
+                              "caf\xc3\xa9 \"quoted\"\tand a line\n" });
+  }
+  const std::string document = qi::encodeJSON(records);
+
+  qi::DataPerf dp;
+  {
+    std::string buffer;
+    dp.start("EncodeJSON", loopCount, document.size());
+    for (unsigned long i = 0; i < loopCount; ++i)
+    {
+      buffer.clear();
+      qi::encodeJSON(records, buffer);
+    }
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("DecodeJSON", loopCount, document.size());
+    for (unsigned long i = 0; i < loopCount; ++i)
+      qi::decodeJSON(document);
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("DecodeJSONToType", loopCount, document.size());
+    for (unsigned long i = 0; i < loopCount; ++i)
+    {
+      std::vector<Record> decoded;
+      qi::decodeJSON(document, &decoded);
+    }
+    dp.stop();
+    out << dp;
+  }
+  out.close();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*
+ *  Copyright (c) 2012-2013 Aldebaran Robotics. All rights reserved.
+ */
+
+/*
+ * Calls methods of a local object by name with AnyObject::call, and through
+ * a qi::MethodHandle bound once, to measure the cost of the method lookup
+ * and overload resolution done at each call by name.
+ */
+
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/methodhandle.hpp>
+#include <qi/perf/dataperfsuite.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  int add(int a, int b) { return a + b; }
+  std::string echo(const std::string& s) { return s; }
+  int twice(int i) { return 2 * i; }
+  double twice(double d) { return 2. * d; }
+}
+
+int main(int argc, char *argv[])
+{
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("loops", po::value<unsigned long>()->default_value(200000), "Calls per benchmark.");
+
+  desc.add(qi::detail::getPerfOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::DataPerfSuite out("qi", "test_methodhandleperf", qi::DataPerfSuite::OutputData_MsgPerSecond, vm["output"].as<std::string>());
+
+  qi::DynamicObjectBuilder builder;
+  builder.advertiseMethod("add", &add);
+  builder.advertiseMethod("echo", &echo);
+  builder.advertiseMethod("twice", static_cast<int (*)(int)>(&twice));
+  builder.advertiseMethod("twice", static_cast<double (*)(double)>(&twice));
+  qi::AnyObject obj = builder.object();
+
+  const auto loopCount = vm["loops"].as<unsigned long>();
+  const std::string text(64, 'x');
+  qi::DataPerf dp;
+
+  {
+    dp.start("Call_add", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      obj.call<int>("add", 1, 2);
+    dp.stop();
+    out << dp;
+  }
+  {
+    qi::MethodHandle<int(int, int)> addHandle(obj, "add");
+    dp.start("Handle_add", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      addHandle(1, 2);
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("Call_echo", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      obj.call<std::string>("echo", text);
+    dp.stop();
+    out << dp;
+  }
+  {
+    qi::MethodHandle<std::string(const std::string&)> echoHandle(obj, "echo");
+    dp.start("Handle_echo", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      echoHandle(text);
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("Call_overloaded", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      obj.call<int>("twice", 21);
+    dp.stop();
+    out << dp;
+  }
+  {
+    qi::MethodHandle<int(int)> twiceHandle(obj, "twice");
+    dp.start("Handle_overloaded", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      twiceHandle(21);
+    dp.stop();
+    out << dp;
+  }
+  out.close();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+/*
+ *  Copyright (c) 2012-2013 Aldebaran Robotics. All rights reserved.
+ */
+
+/*
+ * Computes sha1 digests of small buffers, as done for object uids, and of
+ * buffers of the size of the content of a meta object, either at once or
+ * field by field as done for the meta object content hash.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <ka/sha1.hpp>
+#include <qi/perf/dataperfsuite.hpp>
+
+namespace po = boost::program_options;
+
+int main(int argc, char *argv[])
+{
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("loops", po::value<unsigned long>()->default_value(200000), "Digests per benchmark.")
+    ("fields", po::value<unsigned long>()->default_value(64), "Fields of the large buffer.");
+
+  desc.add(qi::detail::getPerfOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::DataPerfSuite out("qi", "test_sha1perf", qi::DataPerfSuite::OutputData_MsgPerSecond, vm["output"].as<std::string>());
+
+  const auto loopCount = vm["loops"].as<unsigned long>();
+
+  // Fields looking like the method signatures of a meta object.
+  std::vector<std::string> fields;
+  for (unsigned long i = 0; i < vm["fields"].as<unsigned long>(); ++i)
+    fields.push_back("method" + std::to_string(i) + "::(ssi)");
+  std::string large;
+  for (const auto& field : fields)
+    large += field;
+  const std::string small(64, 'x');
+
+  // Accumulated to prevent the digests from being optimized out.
+  unsigned int check = 0;
+  qi::DataPerf dp;
+  {
+    dp.start("Sha1_64B", loopCount, small.size());
+    for (unsigned long i = 0; i < loopCount; ++i)
+      check += ka::sha1(small)[0];
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("Sha1_" + std::to_string(large.size()) + "B", loopCount, large.size());
+    for (unsigned long i = 0; i < loopCount; ++i)
+      check += ka::sha1(large)[0];
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("Sha1Incremental_" + std::to_string(fields.size()) + "_fields", loopCount, large.size());
+    for (unsigned long i = 0; i < loopCount; ++i)
+    {
+      ka::sha1_hasher_t hasher;
+      for (const auto& field : fields)
+        hasher.update(field);
+      check += hasher.digest()[0];
+    }
+    dp.stop();
+    out << dp;
+  }
+  out.close();
+
+  std::cout << "check: " << check << std::endl;
+  return EXIT_SUCCESS;
+}
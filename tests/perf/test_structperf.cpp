@@ -0,0 +1,117 @@
+/*
+ *  Copyright (c) 2012-2013 Aldebaran Robotics. All rights reserved.
+ */
+
+/*
+ * Serializes, converts and prints lists of structs, to measure the cost of
+ * accessing the fields of struct values.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyvalue.hpp>
+#include <qi/binarycodec.hpp>
+#include <qi/buffer.hpp>
+#include <qi/jsoncodec.hpp>
+#include <qi/perf/dataperfsuite.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  struct Sample
+  {
+    int id;
+    double timestamp;
+    float x;
+    float y;
+    std::string label;
+  };
+
+  // Same fields as Sample, to measure struct to struct conversions.
+  struct OtherSample
+  {
+    int id;
+    double timestamp;
+    float x;
+    float y;
+    std::string label;
+  };
+}
+
+QI_TYPE_STRUCT(Sample, id, timestamp, x, y, label);
+QI_TYPE_STRUCT(OtherSample, id, timestamp, x, y, label);
+
+int main(int argc, char *argv[])
+{
+  po::options_description desc;
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("elements", po::value<unsigned long>()->default_value(10000), "Structs per list.")
+    ("loops", po::value<unsigned long>()->default_value(50), "Operations per benchmark.");
+
+  desc.add(qi::detail::getPerfOptions());
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  qi::DataPerfSuite out("qi", "test_structperf", qi::DataPerfSuite::OutputData_Period, vm["output"].as<std::string>());
+
+  const auto elementCount = vm["elements"].as<unsigned long>();
+  const auto loopCount = vm["loops"].as<unsigned long>();
+  std::vector<Sample> samples;
+  for (unsigned long i = 0; i < elementCount; ++i)
+    samples.push_back(Sample{ static_cast<int>(i), 0.5 * i, 1.f, 2.f, "sample" });
+
+  qi::DataPerf dp;
+  {
+    dp.start("EncodeBinary", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+    {
+      qi::Buffer buffer;
+      qi::encodeBinary(&buffer, qi::AutoAnyReference(samples));
+    }
+    dp.stop();
+    out << dp;
+  }
+  {
+    qi::Buffer buffer;
+    qi::encodeBinary(&buffer, qi::AutoAnyReference(samples));
+    dp.start("DecodeBinary", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+    {
+      std::vector<Sample> decoded;
+      qi::BufferReader reader(buffer);
+      qi::decodeBinary(&reader, &decoded);
+    }
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("ConvertToOtherStruct", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      qi::AnyReference::from(samples).to<std::vector<OtherSample>>();
+    dp.stop();
+    out << dp;
+  }
+  {
+    dp.start("EncodeJSON", loopCount);
+    for (unsigned long i = 0; i < loopCount; ++i)
+      qi::encodeJSON(samples);
+    dp.stop();
+    out << dp;
+  }
+  out.close();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <ka/base64.hpp>
+#include "src/base64.hpp"
+
+namespace
+{
+  // Sizes of the chunks the data is given in: they split the groups of three
+  // bytes and of four characters at every position, and the large ones are
+  // encoded by the vectorized kernels.
+  const std::vector<std::size_t> chunkSizes{ 1, 2, 3, 4, 5, 7, 11, 31, 32, 33, 64, 100 };
+
+  // Lengths of the data, covering each remainder of the groups, and data long
+  // enough for several vectorized blocks.
+  const std::vector<std::size_t> dataSizes{ 0, 1, 2, 3, 4, 5, 6, 31, 32, 33, 47, 48, 49, 95, 96, 97, 1000, 1001, 1002 };
+
+  std::string makeData(std::size_t size)
+  {
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i)
+      data[i] = static_cast<char>((i * 7 + 3) % 256);
+    return data;
+  }
+
+  // The encoding by ka, which expects unsigned bytes.
+  std::string kaEncode(const std::string& data, bool padding)
+  {
+    const auto begin = reinterpret_cast<const unsigned char*>(data.data());
+    const auto end = begin + data.size();
+    return padding ? ka::base64_encode_with_padding(begin, end) : ka::base64_encode(begin, end);
+  }
+
+  std::string encodeInChunks(qi::detail::Base64Encoder& encoder, const std::string& data,
+                             std::size_t chunkSize)
+  {
+    std::string out;
+    for (std::size_t i = 0; i < data.size(); i += chunkSize)
+      encoder.update(data.data() + i, std::min(chunkSize, data.size() - i), out);
+    encoder.finish(out);
+    return out;
+  }
+
+  bool decodeInChunks(qi::detail::Base64Decoder& decoder, const std::string& encoded,
+                      std::size_t chunkSize, std::string& out)
+  {
+    for (std::size_t i = 0; i < encoded.size(); i += chunkSize)
+    {
+      if (!decoder.update(encoded.data() + i, std::min(chunkSize, encoded.size() - i), out))
+        return false;
+    }
+    return decoder.finish(out);
+  }
+}
+
+TEST(Base64Encoder, EncodesChunksLikeAllAtOnce)
+{
+  // The same encoder is reused after each finish.
+  qi::detail::Base64Encoder encoder;
+  for (const auto size : dataSizes)
+  {
+    const auto data = makeData(size);
+    const auto expected = kaEncode(data, true);
+    std::string oneShot;
+    qi::detail::encodeBase64(data.data(), data.size(), oneShot);
+    ASSERT_EQ(expected, oneShot) << "size: " << size;
+    for (const auto chunkSize : chunkSizes)
+      EXPECT_EQ(expected, encodeInChunks(encoder, data, chunkSize))
+          << "size: " << size << ", chunk size: " << chunkSize;
+  }
+}
+
+TEST(Base64Encoder, AppendsToTheOutput)
+{
+  qi::detail::Base64Encoder encoder;
+  std::string out = "prefix:";
+  encoder.update("fo", 2, out);
+  encoder.update("o", 1, out);
+  encoder.update("b", 1, out);
+  encoder.finish(out);
+  EXPECT_EQ("prefix:Zm9vYg==", out);
+}
+
+TEST(Base64Decoder, DecodesChunksOfPaddedDataLikeAllAtOnce)
+{
+  qi::detail::Base64Decoder decoder;
+  for (const auto size : dataSizes)
+  {
+    const auto data = makeData(size);
+    const auto encoded = kaEncode(data, true);
+    std::string oneShot;
+    ASSERT_TRUE(qi::detail::decodeBase64(encoded.data(), encoded.size(), oneShot)) << "size: " << size;
+    ASSERT_EQ(data, oneShot) << "size: " << size;
+    for (const auto chunkSize : chunkSizes)
+    {
+      std::string decoded;
+      EXPECT_TRUE(decodeInChunks(decoder, encoded, chunkSize, decoded))
+          << "size: " << size << ", chunk size: " << chunkSize;
+      EXPECT_EQ(data, decoded) << "size: " << size << ", chunk size: " << chunkSize;
+    }
+  }
+}
+
+TEST(Base64Decoder, DecodesChunksOfUnpaddedDataLikeAllAtOnce)
+{
+  qi::detail::Base64Decoder decoder;
+  for (const auto size : dataSizes)
+  {
+    const auto data = makeData(size);
+    const auto encoded = kaEncode(data, false);
+    std::string oneShot;
+    ASSERT_TRUE(qi::detail::decodeBase64(encoded.data(), encoded.size(), oneShot)) << "size: " << size;
+    ASSERT_EQ(data, oneShot) << "size: " << size;
+    for (const auto chunkSize : chunkSizes)
+    {
+      std::string decoded;
+      EXPECT_TRUE(decodeInChunks(decoder, encoded, chunkSize, decoded))
+          << "size: " << size << ", chunk size: " << chunkSize;
+      EXPECT_EQ(data, decoded) << "size: " << size << ", chunk size: " << chunkSize;
+    }
+  }
+}
+
+TEST(Base64Decoder, RejectsInvalidDataInAnyChunk)
+{
+  const std::vector<std::string> invalid{
+    "Zm9v*mFy",  // out of the alphabet
+    "Zm9v YmFy", // white space
+    "Zg==Zm9v",  // data after the padding
+    "Zm9vY",     // truncated group
+    "Z===",      // too much padding
+    "Zm=v",      // padding in the middle of a group
+  };
+  for (const auto& encoded : invalid)
+  {
+    std::string oneShot;
+    EXPECT_FALSE(qi::detail::decodeBase64(encoded.data(), encoded.size(), oneShot)) << encoded;
+    for (const auto chunkSize : chunkSizes)
+    {
+      qi::detail::Base64Decoder decoder;
+      std::string decoded;
+      EXPECT_FALSE(decodeInChunks(decoder, encoded, chunkSize, decoded))
+          << encoded << ", chunk size: " << chunkSize;
+    }
+  }
+}
+
+TEST(Base64Decoder, CanBeReusedAfterAnError)
+{
+  qi::detail::Base64Decoder decoder;
+  std::string out;
+  EXPECT_TRUE(decoder.update("Zg", 2, out));
+  EXPECT_FALSE(decoder.update("==Zg==", 6, out));
+  decoder.finish(out);
+
+  out.clear();
+  EXPECT_TRUE(decodeInChunks(decoder, "Zm9vYg==", 3, out));
+  EXPECT_EQ("foob", out);
+}
@@ -2,10 +2,17 @@
 #include <mutex>
 #include <gtest/gtest.h>
 #include <qi/eventloop.hpp>
+#include <qi/getenv.hpp>
+#include <qi/strand.hpp>
+#include <qi/tracecontext.hpp>
 #include <src/eventloop_p.hpp>
 #include <ka/macro.hpp>
 #include "test_future.hpp"
 
+#ifdef __linux__
+# include <sched.h>
+#endif
+
 int ping(int v)
 {
   if (v>= 0)
@@ -44,6 +51,37 @@ TEST(EventLoop, EventLoopCanAsyncDelay)
   loop.asyncDelay([] {}, qi::MilliSeconds{ 1 }).value(100);
 }
 
+TEST(EventLoop, TasksRunWithTheTraceContextOfThePoster)
+{
+  qi::EventLoop loop{ gEventLoopName, 1 };
+  qi::Strand strand{ loop };
+  const auto context = qi::TraceContext().child();
+  ASSERT_TRUE(context.isValid());
+
+  qi::TraceContext inLoop, inStrand, withoutContext;
+  {
+    qi::TraceContextScope scope(context);
+    loop.asyncDelay([&] { inLoop = qi::currentTraceContext(); }, qi::MilliSeconds{ 1 }).value(1000);
+    strand.async([&] { inStrand = qi::currentTraceContext(); }).value(1000);
+  }
+  loop.asyncDelay([&] { withoutContext = qi::currentTraceContext(); }, qi::Duration{ 0 }).value(1000);
+
+  EXPECT_EQ(context, inLoop);
+  EXPECT_EQ(context, inStrand);
+  EXPECT_FALSE(withoutContext.isValid());
+  EXPECT_FALSE(qi::currentTraceContext().isValid());
+}
+
+TEST(EventLoop, TraceContextChildKeepsTheTrace)
+{
+  const auto root = qi::TraceContext().child();
+  const auto child = root.child();
+  EXPECT_EQ(root.traceId, child.traceId);
+  EXPECT_EQ(root.spanId, child.parentSpanId);
+  EXPECT_NE(root.spanId, child.spanId);
+  EXPECT_EQ(0u, root.parentSpanId);
+}
+
 TEST(EventLoop, asyncNoop)
 {
   qi::async([]{}).value(100);
@@ -250,6 +288,106 @@ TEST(EventLoopAsio, DynamicShrinking)
   ASSERT_EQ(minThreadCount, *(e-1));
 }
 
+TEST(EventLoop, StatisticsMeasureTheTasks)
+{
+  const bool spawnOnOverload = false; // No monitoring task.
+  qi::EventLoop loop{ gEventLoopName, 1, spawnOnOverload };
+  const int taskCount = 3;
+  for (int i = 0; i < taskCount; ++i)
+  {
+    loop.async([] {
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }).value();
+  }
+  loop.asyncDelay([] {}, qi::MilliSeconds{ 200 }).value();
+
+  const auto statistics = loop.statistics();
+  EXPECT_EQ(1, statistics.workers);
+  EXPECT_EQ(taskCount + 1u, statistics.queueDelay.count());
+  EXPECT_EQ(taskCount + 1u, statistics.runTime.count());
+  EXPECT_GE(statistics.runTime.quantile(1.), qi::MilliSeconds{ 10 });
+  // The delayed task waited from its due date, not from when it was posted.
+  EXPECT_LT(statistics.queueDelay.quantile(1.), qi::MilliSeconds{ 200 });
+}
+
+// A task blocking the only thread of the event loop makes the queue delay
+// grow until it is released, which the monitoring task measures.
+TEST(EventLoopAsio, MeasuresTheQueueDelayOfABlockedQueue)
+{
+  using namespace qi;
+  const std::string oldPingTimeout = os::getenv("QI_EVENTLOOP_PING_TIMEOUT");
+  os::setenv("QI_EVENTLOOP_PING_TIMEOUT", "20");
+  auto _ = ka::scoped([&]() {
+    os::setenv("QI_EVENTLOOP_PING_TIMEOUT", oldPingTimeout.c_str());
+  });
+  const int threadCount = 1;
+  const bool spawnOnOverload = true;
+  EventLoopAsio ev{threadCount, threadCount, threadCount, "blocked", spawnOnOverload};
+
+  Promise<void> release;
+  ev.asyncCall(Duration{0}, [&] { release.future().wait(); });
+  const auto deadline = SteadyClock::now() + Seconds{ 5 };
+  while (ev.statistics().recentQueueDelay < MilliSeconds{ 100 } && SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  release.setValue(nullptr);
+
+  EXPECT_GE(ev.statistics().recentQueueDelay, MilliSeconds{ 100 });
+  EXPECT_EQ(threadCount, ev.workerCount());
+}
+
+TEST(EventLoop, parseCPUList)
+{
+  using qi::detail::parseCPUList;
+  EXPECT_EQ(std::vector<int>{}, parseCPUList(""));
+  EXPECT_EQ((std::vector<int>{ 0, 1, 2, 3, 6 }), parseCPUList("0-3,6"));
+  EXPECT_EQ((std::vector<int>{ 1, 2 }), parseCPUList("2,1,2"));
+  EXPECT_THROW(parseCPUList("a"), std::runtime_error);
+  EXPECT_THROW(parseCPUList("1x"), std::runtime_error);
+  EXPECT_THROW(parseCPUList("3-1"), std::runtime_error);
+  EXPECT_THROW(parseCPUList("1-"), std::runtime_error);
+  EXPECT_THROW(parseCPUList("-1"), std::runtime_error);
+  EXPECT_THROW(parseCPUList("1,,2"), std::runtime_error);
+}
+
+TEST(EventLoop, cpuSetsByNumaNodeKeepsEveryCPU)
+{
+  const std::vector<int> cpus{ 0 };
+  const auto sets = qi::detail::cpuSetsByNumaNode(cpus);
+  ASSERT_EQ(1u, sets.size());
+  EXPECT_EQ(cpus, sets[0]);
+  EXPECT_TRUE(qi::detail::cpuSetsByNumaNode({}).empty());
+}
+
+#ifdef __linux__
+TEST(EventLoop, WorkersRunOnTheirCPUs)
+{
+  const int threadCount = 2;
+  const bool spawnOnOverload = false;
+  qi::EventLoop loop{ gEventLoopName, threadCount, threadCount, threadCount, spawnOnOverload, { 0 } };
+  for (int i = 0; i < 2 * threadCount; ++i)
+  {
+    int cpu = -1;
+    loop.async([&] { cpu = sched_getcpu(); }).value();
+    EXPECT_EQ(0, cpu);
+  }
+}
+#endif
+
+// There is a single network event loop unless QI_NETWORK_EVENTLOOP_COUNT says
+// otherwise, and the first one is always among them.
+TEST(EventLoop, NextNetworkEventLoopsIncludeTheNetworkEventLoop)
+{
+  const auto count = qi::os::getEnvDefault("QI_NETWORK_EVENTLOOP_COUNT", 1);
+  bool found = false;
+  for (int i = 0; i < std::max(count, 1); ++i)
+  {
+    const auto loop = qi::nextNetworkEventLoop();
+    ASSERT_TRUE(loop);
+    found = found || loop == qi::getNetworkEventLoop();
+  }
+  EXPECT_TRUE(found);
+}
+
 TEST(EventLoop, posInBetween)
 {
   using qi::detail::posInBetween;
@@ -0,0 +1,147 @@
+/*
+**  Copyright (C) 2026 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <qi/eventloop.hpp>
+#include <qi/metrics.hpp>
+#include <qi/strand.hpp>
+
+namespace
+{
+  // Enables the metrics for its lifetime.
+  struct EnableMetrics
+  {
+    EnableMetrics() : wasEnabled(qi::metrics::isEnabled()) { qi::metrics::setEnabled(true); }
+    ~EnableMetrics() { qi::metrics::setEnabled(wasEnabled); }
+    const bool wasEnabled;
+  };
+
+  const qi::metrics::MetricSample* find(const std::vector<qi::metrics::MetricSample>& samples,
+                                        const std::string& name,
+                                        const qi::metrics::Labels& labels = qi::metrics::Labels())
+  {
+    const auto it = std::find_if(samples.begin(), samples.end(), [&](const qi::metrics::MetricSample& s) {
+      return s.name == name && s.labels == labels;
+    });
+    return it == samples.end() ? nullptr : &*it;
+  }
+}
+
+TEST(TestMetrics, CountersAndHistogramsOnlyRecordWhenEnabled)
+{
+  auto& counter = qi::metrics::counter("test_disabled_total", "Test counter.");
+  auto& histogram = qi::metrics::histogram("test_disabled_seconds", "Test histogram.");
+  qi::metrics::setEnabled(false);
+  counter.add(3);
+  histogram.push(qi::MicroSeconds{ 5 });
+  EXPECT_EQ(0u, counter.value());
+  EXPECT_EQ(0u, histogram.snapshot().count());
+
+  EnableMetrics enable;
+  counter.add(3);
+  histogram.push(qi::MicroSeconds{ 5 });
+  EXPECT_EQ(3u, counter.value());
+  EXPECT_EQ(1u, histogram.snapshot().count());
+  EXPECT_EQ(qi::MicroSeconds{ 5 }, histogram.sum());
+}
+
+TEST(TestMetrics, NameAndLabelsIdentifyAMetric)
+{
+  auto& a = qi::metrics::counter("test_identity_total", "Test counter.", { { "l", "a" } });
+  auto& b = qi::metrics::counter("test_identity_total", "Test counter.", { { "l", "b" } });
+  EXPECT_EQ(&a, &qi::metrics::counter("test_identity_total", "Test counter.", { { "l", "a" } }));
+  EXPECT_NE(&a, &b);
+  EXPECT_THROW(qi::metrics::gauge("test_identity_total", "Test gauge."), std::runtime_error);
+}
+
+TEST(TestMetrics, GaugeFunctionsAreSummedUntilDestroyed)
+{
+  const qi::metrics::Labels labels{ { "l", "x" } };
+  {
+    qi::metrics::GaugeFunction one("test_function_gauge", "Test gauge.", labels, [] { return 1.0; });
+    qi::metrics::GaugeFunction two("test_function_gauge", "Test gauge.", labels, [] { return 2.0; });
+    const auto samples = qi::metrics::collect();
+    const auto sample = find(samples, "test_function_gauge", labels);
+    ASSERT_TRUE(sample);
+    EXPECT_EQ(qi::metrics::MetricType_Gauge, sample->type);
+    EXPECT_DOUBLE_EQ(3.0, sample->value);
+  }
+  EXPECT_FALSE(find(qi::metrics::collect(), "test_function_gauge", labels));
+}
+
+TEST(TestMetrics, PrometheusText)
+{
+  EnableMetrics enable;
+  qi::metrics::counter("test_text_total", "Test \"counter\".", { { "type", "a\"b" } }).add(2);
+  qi::metrics::gauge("test_text_level", "Test gauge.").set(-4);
+  auto& histogram = qi::metrics::histogram("test_text_seconds", "Test histogram.");
+  histogram.push(qi::MicroSeconds{ 50 });
+  histogram.push(qi::MilliSeconds{ 50 });
+
+  const auto text = qi::metrics::prometheusText();
+  EXPECT_NE(std::string::npos, text.find("# TYPE test_text_total counter\n"
+                                         "test_text_total{type=\"a\\\"b\"} 2\n"));
+  EXPECT_NE(std::string::npos, text.find("# TYPE test_text_level gauge\n"
+                                         "test_text_level -4\n"));
+  EXPECT_NE(std::string::npos, text.find("# TYPE test_text_seconds histogram\n"));
+  EXPECT_NE(std::string::npos, text.find("test_text_seconds_bucket{le=\"1e-05\"} 0\n"
+                                         "test_text_seconds_bucket{le=\"0.0001\"} 1\n"));
+  EXPECT_NE(std::string::npos, text.find("test_text_seconds_bucket{le=\"0.1\"} 2\n"));
+  EXPECT_NE(std::string::npos, text.find("test_text_seconds_bucket{le=\"+Inf\"} 2\n"
+                                         "test_text_seconds_sum "));
+  EXPECT_NE(std::string::npos, text.find("test_text_seconds_count 2\n"));
+}
+
+TEST(TestMetrics, EventLoopPublishesItsTasks)
+{
+  EnableMetrics enable;
+  const std::string name = "TestMetricsLoop";
+  const qi::metrics::Labels labels{ { "loop", name } };
+  auto& delays = qi::metrics::histogram("qi_eventloop_task_delay_seconds", "", labels);
+  auto& durations = qi::metrics::histogram("qi_eventloop_task_duration_seconds", "", labels);
+  const auto delaysBefore = delays.snapshot().count();
+  const auto durationsBefore = durations.snapshot().count();
+  {
+    const bool spawnOnOverload = false; // No monitoring task.
+    qi::EventLoop loop{ name, 1, spawnOnOverload };
+    loop.async([] {}).value();
+    loop.asyncDelay([] {}, qi::MilliSeconds{ 1 }).value();
+
+    const auto samples = qi::metrics::collect();
+    const auto workers = find(samples, "qi_eventloop_workers", labels);
+    ASSERT_TRUE(workers);
+    EXPECT_GE(workers->value, 1.0);
+    EXPECT_TRUE(find(samples, "qi_eventloop_queued_tasks", labels));
+  }
+  EXPECT_EQ(delaysBefore + 2, delays.snapshot().count());
+  EXPECT_EQ(durationsBefore + 2, durations.snapshot().count());
+  EXPECT_FALSE(find(qi::metrics::collect(), "qi_eventloop_workers", labels));
+}
+
+TEST(TestMetrics, StrandsAreAccountedOnlyWhileEnabled)
+{
+  auto& queued = qi::metrics::gauge("qi_strand_queued_tasks", "");
+  qi::metrics::setEnabled(false);
+  const auto before = queued.value();
+
+  qi::Promise<void> release;
+  qi::Strand strand;
+  strand.async([=] { release.future().wait(); });
+  auto disabledTask = strand.async([] {});
+  EXPECT_EQ(before, queued.value());
+
+  EnableMetrics enable;
+  auto enabledTask = strand.async([] {});
+  // The first task might not have been dequeued yet.
+  EXPECT_GE(queued.value(), before + 2);
+
+  release.setValue(nullptr);
+  enabledTask.value();
+  EXPECT_EQ(before, queued.value());
+}
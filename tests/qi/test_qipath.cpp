@@ -5,6 +5,7 @@
  */
 
 #include <boost/filesystem/fstream.hpp>
+#include <ctime>
 #include <numeric>
 
 #include <gtest/gtest.h>
@@ -652,6 +653,33 @@ TEST_F(qiPathData, findDataDir)
   EXPECT_TRUE(barDirMatches.empty()); // listData discards directories
 }
 
+TEST(qiPath, findAndListDataSeeDirectoryChanges)
+{
+  const bfs::path prefix(qi::os::mktmpdir("indexedSdk"), qi::unicodeFacet());
+  const bfs::path shareFoo = prefix / "share" / "foo";
+  createData(shareFoo, "a.dat");
+  // Age the directory so that its listing is kept between lookups.
+  bfs::last_write_time(shareFoo, std::time(nullptr) - 60);
+
+  qi::SDKLayout sdkl(prefix.string(qi::unicodeFacet()));
+  EXPECT_EQ((shareFoo / "a.dat").make_preferred().string(qi::unicodeFacet()),
+            sdkl.findData("foo", "a.dat", true));
+  EXPECT_EQ(std::string(), sdkl.findData("foo", "b.dat", true));
+
+  writeData(shareFoo / "b.dat");
+  bfs::remove(shareFoo / "a.dat");
+  // Directories are checked for changes at most once per second.
+  qi::os::msleep(1100);
+  EXPECT_EQ(std::string(), sdkl.findData("foo", "a.dat", true));
+  EXPECT_EQ((shareFoo / "b.dat").make_preferred().string(qi::unicodeFacet()),
+            sdkl.findData("foo", "b.dat", true));
+  const std::vector<std::string> listed = sdkl.listData("foo", "*.dat", true);
+  ASSERT_EQ(1u, listed.size());
+  EXPECT_TRUE(isInVector(shareFoo / "b.dat", listed));
+
+  bfs::remove_all(prefix);
+}
+
 TEST(qiPath, filesystemConcat)
 {
   std::string s0 = fsconcat("/toto", "tata");
@@ -1,5 +1,7 @@
 #include <vector>
 #include <string>
+#include <chrono>
+#include <future>
 
 #include <gtest/gtest.h>
 #include <qi/log.hpp>
@@ -44,3 +46,56 @@ TEST(TestPackage, FactoryCreatesFunctionalObject)
 
     ASSERT_EQ(result, 42);
 }
+
+TEST(TestPackage, ImportAsyncSharesTheModule)
+{
+    qi::Future<qi::AnyModule> first = ::qi::importAsync("qi_test_anymodule");
+    qi::Future<qi::AnyModule> second = ::qi::importAsync("qi_test_anymodule");
+    qi::AnyModule pkg = first.value();
+    ASSERT_TRUE(pkg);
+    ASSERT_EQ(pkg, second.value());
+    ASSERT_EQ(pkg, ::qi::import("qi_test_anymodule"));
+    ASSERT_EQ(pkg.call<int>("my_scl_func"), 45);
+}
+
+TEST(TestPackage, PreloadReportsEachModule)
+{
+    std::vector<qi::ModuleImportReport> reports =
+        ::qi::preloadModules({ "qi_test_anymodule", "qi_test_no_such_module" }).value();
+    ASSERT_EQ(2u, reports.size());
+
+    EXPECT_EQ("qi_test_anymodule", reports[0].name);
+    EXPECT_TRUE(reports[0].module);
+    EXPECT_TRUE(reports[0].error.empty());
+
+    EXPECT_EQ("qi_test_no_such_module", reports[1].name);
+    EXPECT_FALSE(reports[1].module);
+    EXPECT_FALSE(reports[1].error.empty());
+}
+
+TEST(TestPackage, CircularImportAcrossThreadsFails)
+{
+    // Each module imports the other during its initialization, once both
+    // imports are in progress.
+    std::promise<void> aStarted, bStarted;
+    std::shared_future<void> aStartedFuture = aStarted.get_future().share();
+    std::shared_future<void> bStartedFuture = bStarted.get_future().share();
+    qi::ModuleInfo a;
+    a.name = "qi_test_cycle_a";
+    a.type = "qi_test_cycle";
+    qi::ModuleInfo b = a;
+    b.name = "qi_test_cycle_b";
+    qi::registerModuleFactory("qi_test_cycle", [&](const qi::ModuleInfo& mi) {
+        const bool isA = mi.name == a.name;
+        (isA ? aStarted : bStarted).set_value();
+        (isA ? bStartedFuture : aStartedFuture).wait();
+        return ::qi::import(isA ? b : a);
+    });
+
+    auto importA = std::async(std::launch::async, [&] { return ::qi::import(a); });
+    auto importB = std::async(std::launch::async, [&] { return ::qi::import(b); });
+    ASSERT_EQ(std::future_status::ready, importA.wait_for(std::chrono::seconds(10)));
+    ASSERT_EQ(std::future_status::ready, importB.wait_for(std::chrono::seconds(10)));
+    EXPECT_ANY_THROW(importA.get());
+    EXPECT_ANY_THROW(importB.get());
+}
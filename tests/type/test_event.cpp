@@ -217,6 +217,28 @@ TEST(TestTraceAnalyzer, AsyncChildren)
 }
 
 
+TEST(TestTraceAnalyzer, RemoteChildren)
+{
+  qi::TraceAnalyzer ta;
+  qi::AnyValue noargs;
+  // call 11 of object 2 is made, from another process, by call 10 of object 1
+  const qi::uint64_t trace = 7, parentSpan = 70, childSpan = 71;
+  ta.addTrace(qi::EventTrace(11, EventTrace::Event_Call,   101, noargs, ts(12), 0, 0, 60, 60, trace, childSpan, parentSpan), 2);
+  ta.addTrace(qi::EventTrace(11, EventTrace::Event_Result, 101, noargs, ts(14), 0, 0, 60, 60, trace, childSpan, parentSpan), 2);
+  ta.addTrace(qi::EventTrace(10, EventTrace::Event_Call,   100, noargs, ts(10), 0, 0, 50, 50, trace, parentSpan, 0), 1);
+  ta.addTrace(qi::EventTrace(10, EventTrace::Event_Result, 100, noargs, ts(20), 0, 0, 50, 50, trace, parentSpan, 0), 1);
+  std::set<qi::TraceAnalyzer::FlowLink> fl;
+  ta.analyze(fl);
+  EXPECT_EQ("50 10:1.100[11,]\n60 11:2.101\n", sort(ta.dumpTraces()));
+  ASSERT_EQ(1u, fl.size());
+  EXPECT_EQ(1u, fl.begin()->srcObj);
+  EXPECT_EQ(2u, fl.begin()->dstObj);
+  EXPECT_FALSE(fl.begin()->sync);
+  // the link is only made once
+  ta.analyze(fl);
+  EXPECT_EQ("50 10:1.100[11,]\n60 11:2.101\n", sort(ta.dumpTraces()));
+}
+
 TEST(TestTraceAnalyzer, BogusChildren)
 {
   qi::TraceAnalyzer ta;
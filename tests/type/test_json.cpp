@@ -9,6 +9,7 @@
 #include <map>
 #include <qi/anyvalue.hpp>
 #include <qi/application.hpp>
+#include <qi/buffer.hpp>
 #include <qi/type/typeinterface.hpp>
 #include <qi/jsoncodec.hpp>
 #include <qi/log.hpp>
@@ -138,6 +139,32 @@ TEST(EncodeJSON, OptionalValue)
   EXPECT_EQ("642", qi::encodeJSON(boost::optional<int>(642)));
 }
 
+TEST(EncodeJSON, StringOutsideBasicPlane)
+{
+  // U+1F600 is escaped as a surrogate pair.
+  const std::string smiley = "\xF0\x9F\x98\x80";
+  EXPECT_EQ("\"\\uD83D\\uDE00\"", qi::encodeJSON(smiley));
+  EXPECT_EQ(smiley, qi::decodeJSON(qi::encodeJSON(smiley)).to<std::string>());
+}
+
+TEST(EncodeJSON, AppendToOutput)
+{
+  std::string out = "[";
+  qi::encodeJSON(42, out);
+  out += ',';
+  qi::encodeJSON("foo", out);
+  out += ']';
+  EXPECT_EQ("[42,\"foo\"]", out);
+}
+
+TEST(EncodeJSON, Buffer)
+{
+  qi::Buffer buffer;
+  buffer.write("\x00\xFF\x10youpi", 8);
+  EXPECT_EQ("\"AP8QeW91cGk=\"", qi::encodeJSON(buffer));
+  EXPECT_EQ("\"\"", qi::encodeJSON(qi::Buffer()));
+}
+
 template<class T>
 std::string itoa(T n)
 {
@@ -456,3 +483,126 @@ TEST(DecodeJSON, StructWithDifferentSizedFields)
   EXPECT_EQ(val,
             res) << qi::encodeJSON(val) << "\n" << qi::encodeJSON(res);
 }
+
+
+namespace
+{
+  // Records the events it receives.
+  class JsonEventRecorder : public qi::JsonHandler
+  {
+  public:
+    void onNull() override { events += "null "; }
+    void onBool(bool value) override { events += value ? "true " : "false "; }
+    void onInt(int64_t value) override { events += "int:" + std::to_string(value) + " "; }
+    void onDouble(double value) override { events += "double:" + std::to_string(value) + " "; }
+    void onString(const char* data, std::size_t size) override { events += "string:" + std::string(data, size) + " "; }
+    void onBeginArray() override { events += "[ "; }
+    void onEndArray() override { events += "] "; }
+    void onBeginObject() override { events += "{ "; }
+    void onKey(const char* data, std::size_t size) override { events += "key:" + std::string(data, size) + " "; }
+    void onEndObject() override { events += "} "; }
+
+    std::string events;
+  };
+}
+
+TEST(DecodeJSON, Handler)
+{
+  const std::string json = "{\"a\": [1, 2.5, \"x\\ny\"], \"b\": {\"c\": null, \"d\": true}}";
+  JsonEventRecorder recorder;
+  EXPECT_EQ(json.end(), qi::decodeJSON(json.begin(), json.end(), recorder));
+  EXPECT_EQ("{ key:a [ int:1 double:2.500000 string:x\ny ] key:b { key:c null key:d true } } ",
+            recorder.events);
+
+  const std::string broken = "[1, 2";
+  EXPECT_ANY_THROW(qi::decodeJSON(broken.begin(), broken.end(), recorder));
+}
+
+struct Reading
+{
+  std::string name;
+  std::vector<double> values;
+  std::map<std::string, int> counts;
+  boost::optional<int> limit;
+  qi::AnyValue extra;
+  MPoint origin;
+};
+QI_TYPE_STRUCT(Reading, name, values, counts, limit, extra, origin);
+
+TEST(DecodeJSON, IntoType)
+{
+  const std::string json =
+      "{\"name\": \"sensor\", \"values\": [1.5, 2, -3e2], \"counts\": {\"a\": 1, \"b\": 2},"
+      " \"limit\": 12, \"extra\": [\"free\", {\"form\": 1}], \"unknown\": {\"skipped\": [1]},"
+      " \"origin\": {\"x\": 4, \"y\": 5}}";
+  Reading reading;
+  qi::decodeJSON(json, &reading);
+
+  EXPECT_EQ("sensor", reading.name);
+  EXPECT_EQ((std::vector<double>{ 1.5, 2., -300. }), reading.values);
+  EXPECT_EQ((std::map<std::string, int>{ { "a", 1 }, { "b", 2 } }), reading.counts);
+  ASSERT_TRUE(reading.limit);
+  EXPECT_EQ(12, *reading.limit);
+  EXPECT_EQ(qi::TypeKind_List, reading.extra.kind());
+  EXPECT_EQ("free", reading.extra[0].content().to<std::string>());
+  EXPECT_EQ(4, reading.origin.x);
+  EXPECT_EQ(5, reading.origin.y);
+
+  // Same result as going through a generic value.
+  EXPECT_EQ(qi::encodeJSON(qi::decodeJSON(json).to<Reading>()), qi::encodeJSON(reading));
+}
+
+TEST(DecodeJSON, IntoTypeFromArrayAndNull)
+{
+  std::vector<boost::optional<MPoint>> points;
+  qi::decodeJSON("[[1, 2], null, {\"y\": 3, \"x\": 4}]", &points);
+  ASSERT_EQ(3u, points.size());
+  ASSERT_TRUE(points[0]);
+  EXPECT_EQ(1, points[0]->x);
+  EXPECT_EQ(2, points[0]->y);
+  EXPECT_FALSE(points[1]);
+  ASSERT_TRUE(points[2]);
+  EXPECT_EQ(4, points[2]->x);
+  EXPECT_EQ(3, points[2]->y);
+}
+
+TEST(DecodeJSON, IntoTypeMismatch)
+{
+  std::vector<int> ints;
+  EXPECT_ANY_THROW(qi::decodeJSON("[1, \"two\"]", &ints));
+  EXPECT_ANY_THROW(qi::decodeJSON("{\"a\": 1}", &ints));
+  MPoint point;
+  EXPECT_ANY_THROW(qi::decodeJSON("[1, 2, 3]", &point));
+  EXPECT_ANY_THROW(qi::decodeJSON("[1", &point));
+}
+
+TEST(DecodeJSON, IntoBuffer)
+{
+  // Sizes around the block sizes of the vectorized codecs.
+  for (std::size_t size : { 0u, 1u, 2u, 3u, 11u, 12u, 16u, 23u, 24u, 33u, 100u, 4099u })
+  {
+    std::string data(size, '\0');
+    for (std::size_t i = 0; i < size; ++i)
+      data[i] = static_cast<char>(i * 7);
+    qi::Buffer buffer;
+    buffer.write(data.data(), data.size());
+
+    std::vector<qi::Buffer> decoded;
+    qi::decodeJSON(qi::encodeJSON(std::vector<qi::Buffer>{ buffer }), &decoded);
+    ASSERT_EQ(1u, decoded.size());
+    EXPECT_EQ(buffer, decoded[0]) << "size " << size;
+  }
+
+  qi::Buffer buffer;
+  qi::decodeJSON("\"eW91cGk\"", &buffer); // without padding
+  EXPECT_EQ(std::string("youpi"), std::string(static_cast<const char*>(buffer.data()), buffer.size()));
+}
+
+TEST(DecodeJSON, IntoBufferInvalid)
+{
+  qi::Buffer buffer;
+  EXPECT_ANY_THROW(qi::decodeJSON("\"eW91 cGk=\"", &buffer));
+  EXPECT_ANY_THROW(qi::decodeJSON("\"eW91cGk=eW91\"", &buffer));
+  EXPECT_ANY_THROW(qi::decodeJSON("\"e\"", &buffer));
+  EXPECT_ANY_THROW(qi::decodeJSON("42", &buffer));
+}
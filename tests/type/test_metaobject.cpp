@@ -149,6 +149,25 @@ TEST(MetaObject, findMethod)
   EXPECT_TRUE(true);
 }
 
+TEST(MetaObject, memberPriority)
+{
+  qi::MetaObjectBuilder b;
+  const unsigned int f = b.addMethod("i", "f", "(i)").id;
+  const unsigned int s = b.addSignal("s", "(i)").id;
+  b.setMemberPriority(s, qi::MemberPriority::Control);
+
+  const qi::MetaObject mo = b.metaObject();
+  EXPECT_EQ(qi::MemberPriority::Default, mo.memberPriority(f));
+  EXPECT_EQ(qi::MemberPriority::Control, mo.memberPriority(s));
+
+  qi::MetaObjectBuilder other;
+  const unsigned int g = other.addMethod("i", "g", "(i)", 200).id;
+  other.setMemberPriority(g, qi::MemberPriority::Bulk);
+  const qi::MetaObject merged = qi::MetaObject::merge(mo, other.metaObject());
+  EXPECT_EQ(qi::MemberPriority::Control, merged.memberPriority(s));
+  EXPECT_EQ(qi::MemberPriority::Bulk, merged.memberPriority(g));
+}
+
 TEST(MetaObject, defaultConstructedMosAreEqual)
 {
   qi::MetaObject mo1;
@@ -23,6 +23,8 @@
 #include <qi/type/dynamicobjectbuilder.hpp>
 #include <qi/type/objecttypebuilder.hpp>
 #include <qi/anymodule.hpp>
+#include <qi/methodhandle.hpp>
+#include <qi/type/detail/traceanalyzer.hpp>
 #include <random>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/stable_vector.hpp>
@@ -404,6 +406,50 @@ TEST(TestObject, Methods) {
   EXPECT_EQ(f, obj.call<C>("valuetest", f));
 }
 
+int overloadInt(int i) { return i * 2; }
+std::string overloadString(const std::string& s) { return s + s; }
+
+TEST(TestObject, MethodHandle)
+{
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("test", &fun);
+  ob.advertiseMethod("vtest", &vfun);
+  ob.advertiseMethod("overload", &overloadInt);
+  ob.advertiseMethod("overload", &overloadString);
+  qi::AnyObject obj(ob.object());
+
+  qi::MethodHandle<int(int, int)> test(obj, "test");
+  ASSERT_TRUE(test.isValid());
+  EXPECT_EQ(42, test(21, 21));
+  EXPECT_EQ(12, test(5, 7));
+  EXPECT_EQ(42, test.async(40, 2).value());
+
+  // Parameters and results are converted as with call().
+  qi::MethodHandle<double(short, double)> converted(obj, "test");
+  EXPECT_EQ(42.0, converted(21, 21.0));
+
+  gGlobalResult = 0;
+  qi::MethodHandle<void(int, int)> vtest(obj, "vtest");
+  vtest.async(21, 21).wait();
+  EXPECT_EQ(42, gGlobalResult);
+
+  // Overloads are resolved once, from the parameter types.
+  qi::MethodHandle<int(int)> overloadedInt(obj, "overload");
+  qi::MethodHandle<std::string(std::string)> overloadedString(obj, "overload");
+  EXPECT_NE(overloadedInt.methodId(), overloadedString.methodId());
+  EXPECT_EQ(8, overloadedInt(4));
+  EXPECT_EQ("abab", overloadedString("ab"));
+  qi::MethodHandle<int(int)> bySignature(obj, "overload::(i)");
+  EXPECT_EQ(overloadedInt.methodId(), bySignature.methodId());
+
+  using Handle = qi::MethodHandle<int(int, int)>;
+  EXPECT_ANY_THROW(Handle(obj, "noSuchMethod"));
+  EXPECT_ANY_THROW((qi::MethodHandle<int(std::string)>(obj, "test")));
+  EXPECT_ANY_THROW(Handle(qi::AnyObject(), "test"));
+  EXPECT_FALSE(Handle().isValid());
+  EXPECT_ANY_THROW(Handle()(1, 2));
+}
+
 struct YetAnotherPoint
 {
   bool operator == (const YetAnotherPoint& b) const { return x==b.x && y==b.y;}
@@ -900,6 +946,72 @@ TEST(TestObject, DISABLED_statisticsType)
   EXPECT_EQ(2u, stats[mid].count());
 }
 
+TEST(TestObject, LatencyHistogramBuckets)
+{
+  using qi::LatencyHistogram;
+  for (unsigned int i = 0; i < LatencyHistogram::BucketCount; ++i)
+  {
+    const auto lower = LatencyHistogram::bucketLowerBound(i);
+    const auto upper = LatencyHistogram::bucketUpperBound(i);
+    EXPECT_EQ(i, LatencyHistogram::bucketIndex(lower.count()));
+    EXPECT_EQ(i, LatencyHistogram::bucketIndex(upper.count() - 1));
+    if (i + 1 < LatencyHistogram::BucketCount)
+      EXPECT_EQ(upper, LatencyHistogram::bucketLowerBound(i + 1));
+    // Buckets are at most 12.5% wide.
+    EXPECT_LE((upper - lower).count() * 8, std::max<int64_t>(lower.count(), 8));
+  }
+  EXPECT_EQ(LatencyHistogram::BucketCount - 1, LatencyHistogram::bucketIndex(uint64_t(1) << 50));
+
+  LatencyHistogram histogram;
+  EXPECT_EQ(qi::Duration(0), histogram.quantile(0.5));
+  for (int i = 1; i <= 100; ++i)
+    histogram.push(qi::MicroSeconds(i));
+  EXPECT_EQ(100u, histogram.count());
+  const auto median = histogram.quantile(0.5);
+  EXPECT_LE(qi::MicroSeconds(50), median);
+  EXPECT_GT(qi::MicroSeconds(57), median);
+  EXPECT_LE(qi::MicroSeconds(99), histogram.quantile(0.99));
+}
+
+TEST(TestObject, statisticsHistogram)
+{
+  qi::DynamicObjectBuilder gob;
+  const auto mid = gob.advertiseMethod("nop", [] {});
+  qi::AnyObject obj = gob.object();
+  EXPECT_TRUE(obj.statsHistogram().empty());
+
+  // Push from several threads at once, as concurrent calls do.
+  const int threadCount = 4;
+  const int pushCount = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+    threads.emplace_back([&, t] {
+      for (int i = 1; i <= pushCount; ++i)
+        obj.asGenericObject()->pushStats(mid, qi::MicroSeconds(i), qi::MicroSeconds(t), qi::Duration(0));
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  qi::ObjectStatistics stats = obj.stats();
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(unsigned(threadCount * pushCount), stats[mid].count());
+  EXPECT_FLOAT_EQ(1e-6f, stats[mid].wall().minValue());
+  EXPECT_FLOAT_EQ(1e-3f, stats[mid].wall().maxValue());
+  EXPECT_FLOAT_EQ(3e-6f, stats[mid].user().maxValue());
+
+  qi::ObjectHistograms histograms = obj.call<qi::ObjectHistograms>("statsHistogram");
+  ASSERT_EQ(1u, histograms.size());
+  const auto& wall = histograms[mid].wall();
+  EXPECT_EQ(uint64_t(threadCount * pushCount), wall.count());
+  EXPECT_LE(qi::MicroSeconds(990), wall.quantile(0.99));
+  EXPECT_GT(qi::MicroSeconds(1100), wall.quantile(0.99));
+  EXPECT_GT(qi::MicroSeconds(4), histograms[mid].cpu().quantile(1.));
+
+  obj.clearStats();
+  EXPECT_TRUE(obj.stats().empty());
+  EXPECT_TRUE(obj.statsHistogram().empty());
+}
+
 void pushTrace(std::vector<qi::EventTrace>& target,
     boost::mutex& mutex,
     const qi::EventTrace& trace)
@@ -1013,6 +1125,134 @@ TEST(TestObject, traceType)
   ASSERT_TRUE(!oa1.call<bool>("isTraceEnabled"));
 }
 
+TEST(TestObject, traceSampling)
+{
+  qi::ObjectTypeBuilder<Adder> builder;
+  builder.advertiseMethod("add", &Adder::add);
+  Adder a1(1);
+  qi::AnyObject oa1 = builder.object(&a1, &qi::AnyObject::deleteGenericObjectOnly);
+
+  boost::mutex mutex;
+  std::vector<qi::EventTrace> traces;
+  qi::SignalLink id = oa1.connect("traceObject",
+    (boost::function<void(qi::EventTrace)>)
+    boost::bind(&pushTrace, boost::ref(traces), boost::ref(mutex), _1)).value();
+  ASSERT_TRUE(qi::isValidSignalLink(id));
+  oa1.call<void>("setTraceOptions", qi::TraceOptions(2, qi::TraceArguments_None));
+  {
+    boost::mutex::scoped_lock l(mutex);
+    traces.clear();
+  }
+
+  for (unsigned i = 0; i < 4; ++i)
+    EXPECT_EQ(3, oa1.call<int>("add", 2));
+  for (unsigned i=0; i<20; ++i) {
+    {
+      boost::mutex::scoped_lock l(mutex);
+      if (traces.size() >= 4)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+  boost::mutex::scoped_lock l(mutex);
+  ASSERT_EQ(4u, traces.size()); // one call out of two
+  for (const auto& trace : traces)
+    EXPECT_FALSE(trace.arguments().isValid());
+  oa1.disconnect(id);
+}
+
+namespace
+{
+  void takeTraced(const std::pair<std::string, std::vector<int>>&, const qi::Buffer&)
+  {
+  }
+}
+
+TEST(TestObject, traceTruncatedArguments)
+{
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("take", &takeTraced);
+  qi::AnyObject obj = ob.object();
+
+  boost::mutex mutex;
+  std::vector<qi::EventTrace> traces;
+  qi::SignalLink id = obj.connect("traceObject",
+    (boost::function<void(qi::EventTrace)>)
+    boost::bind(&pushTrace, boost::ref(traces), boost::ref(mutex), _1)).value();
+  ASSERT_TRUE(qi::isValidSignalLink(id));
+  obj.call<void>("setTraceOptions", qi::TraceOptions(1, qi::TraceArguments_Truncated, 4));
+  {
+    boost::mutex::scoped_lock l(mutex);
+    traces.clear();
+  }
+
+  qi::Buffer buffer;
+  const char data[16] = {};
+  buffer.write(data, sizeof(data));
+  obj.call<void>("take", std::make_pair(std::string("abcdefgh"), std::vector<int>(10, 1)), buffer);
+  for (unsigned i=0; i<20; ++i) {
+    {
+      boost::mutex::scoped_lock l(mutex);
+      if (traces.size() >= 2)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+  }
+  boost::mutex::scoped_lock l(mutex);
+  ASSERT_EQ(2u, traces.size());
+  std::sort(traces.begin(), traces.end(), comparator);
+  ASSERT_EQ(qi::EventTrace::Event_Call, traces[0].kind());
+  const auto args = traces[0].arguments().to<std::vector<qi::AnyValue>>();
+  ASSERT_EQ(2u, args.size());
+  const auto pair = args[0].to<std::tuple<std::string, std::string>>();
+  EXPECT_EQ("abcd...", std::get<0>(pair));
+  EXPECT_EQ("<10 elements>", std::get<1>(pair));
+  EXPECT_EQ("<16 bytes>", args[1].to<std::string>());
+  obj.disconnect(id);
+}
+
+TEST(TestObject, traceRecords)
+{
+  qi::ObjectTypeBuilder<Adder> builder;
+  const auto mid = builder.advertiseMethod("add", &Adder::add);
+  Adder a1(1);
+  qi::AnyObject oa1 = builder.object(&a1, &qi::AnyObject::deleteGenericObjectOnly);
+
+  qi::Promise<qi::Buffer> chunk;
+  qi::SignalLink id = oa1.connect("traceRecords",
+    boost::function<void(qi::Buffer)>([&](qi::Buffer b) { chunk.setValue(b); })).value();
+  ASSERT_TRUE(qi::isValidSignalLink(id));
+  ASSERT_TRUE(oa1.asGenericObject()->isTraceRecordingEnabled());
+
+  EXPECT_EQ(3, oa1.call<int>("add", 2));
+  EXPECT_EQ(4, oa1.call<int>("add", 3));
+  oa1.asGenericObject()->flushTrace();
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, chunk.future().wait(qi::Seconds{ 5 }));
+
+  const auto events = qi::decodeTraceRecords(chunk.future().value());
+  ASSERT_EQ(4u, events.size());
+  for (const auto& event : events)
+  {
+    EXPECT_EQ(mid, event.slotId());
+    EXPECT_FALSE(event.arguments().isValid());
+  }
+  EXPECT_EQ(qi::EventTrace::Event_Call, events[0].kind());
+  EXPECT_EQ(qi::EventTrace::Event_Result, events[1].kind());
+  EXPECT_EQ(events[0].id(), events[1].id());
+
+  qi::TraceAnalyzer analyzer;
+  analyzer.addTraceRecords(chunk.future().value(), 1);
+  const auto json = analyzer.dumpChromeTrace();
+  EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, json.find("\"ph\":\"X\""));
+
+  qi::Buffer truncated;
+  truncated.write("x", 1);
+  EXPECT_ANY_THROW(qi::decodeTraceRecords(truncated));
+  oa1.disconnect(id);
+}
+
 static void bim(int i, qi::Promise<void>& p, const std::string &name) {
   qiLogInfo() << "Bim le callback:" << name << " ,i:" << i;
   if (i == 42)
@@ -7,6 +7,7 @@
 #include <map>
 #include <functional>
 #include <tuple>
+#include <thread>
 #include <gtest/gtest.h>
 #include <boost/optional.hpp>
 #include <boost/filesystem.hpp>
@@ -17,6 +18,7 @@
 #include <qi/application.hpp>
 #include <qi/anyobject.hpp>
 #include <qi/type/dynamicobjectbuilder.hpp>
+#include <qi/type/typedispatcher.hpp>
 #include <qi/jsoncodec.hpp>
 #include <qi/path.hpp>
 
@@ -531,6 +533,70 @@ TEST(Value, Tuple)
   ASSERT_EQ(p, gtuple.to<Point2D>());
 }
 
+TEST(Struct, MemberAccess)
+{
+  TStruct t;
+  t.d = 12.0;
+  t.s = "foo";
+  auto type = static_cast<StructTypeInterface*>(typeOf<TStruct>());
+  AnyReference ref = AnyReference::from(t);
+
+  ASSERT_EQ(2u, type->memberCount());
+  EXPECT_EQ(type->memberTypes(), type->cachedMemberTypes());
+  EXPECT_EQ(type->elementsName(), type->cachedElementsName());
+  // The cache is computed once.
+  EXPECT_EQ(&type->cachedMemberTypes(), &type->cachedMemberTypes());
+  EXPECT_EQ(12.0, type->member(ref.rawValue(), 0).toDouble());
+  EXPECT_EQ("foo", type->member(ref.rawValue(), 1).toString());
+}
+
+namespace
+{
+  // A dispatcher written for the visitTuple taking a vector of the fields.
+  struct VectorTupleDispatcher
+  {
+    void visitUnknown(AnyReference) {}
+    void visitVoid() {}
+    void visitInt(int64_t, bool, int) {}
+    void visitFloat(double, int) {}
+    void visitString(char*, size_t) {}
+    void visitList(AnyIterator, AnyIterator) {}
+    void visitVarArgs(AnyIterator, AnyIterator) {}
+    void visitMap(AnyIterator, AnyIterator) {}
+    void visitObject(GenericObject) {}
+    void visitAnyObject(AnyObject&) {}
+    void visitPointer(AnyReference) {}
+    void visitDynamic(AnyReference) {}
+    void visitRaw(AnyReference) {}
+    void visitIterator(AnyReference) {}
+    void visitOptional(AnyReference) {}
+
+    void visitTuple(const std::string&, const AnyReferenceVector& tuple,
+                    const std::vector<std::string>& names)
+    {
+      fields = tuple;
+      fieldNames = names;
+    }
+
+    AnyReferenceVector fields;
+    std::vector<std::string> fieldNames;
+  };
+}
+
+TEST(Struct, DispatchToVectorVisitTuple)
+{
+  TStruct t;
+  t.d = 12.0;
+  t.s = "foo";
+  VectorTupleDispatcher dispatcher;
+  typeDispatch(dispatcher, AnyReference::from(t));
+
+  ASSERT_EQ(2u, dispatcher.fields.size());
+  EXPECT_EQ(12.0, dispatcher.fields[0].toDouble());
+  EXPECT_EQ("foo", dispatcher.fields[1].toString());
+  EXPECT_EQ((std::vector<std::string>{ "d", "s" }), dispatcher.fieldNames);
+}
+
 TEST(Value, StructFromAndToMap)
 {
   std::map<std::string, int> asMap;
@@ -1414,3 +1480,31 @@ KA_WARNING_DISABLE(, missing-field-initializers)
 KA_WARNING_POP()
   EXPECT_EQ(typeOf<TypeParam>()->kind(), autoRef.kind());
 }
+
+TEST(TypeFactory, ConcurrentRequestsReturnTheSameTypes)
+{
+  static const int typeCount = 300;
+  static const int threadCount = 4;
+  std::vector<std::vector<TypeInterface*>> types(threadCount);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&types, t] {
+      for (int i = 0; i < typeCount; ++i)
+      {
+        const auto name = "ConcurrentTuple" + std::to_string(i);
+        const auto tupleType = makeTupleType({ typeOf<int>() }, name, { "value" });
+        types[t].push_back(tupleType);
+        types[t].push_back(makeListType(tupleType));
+        types[t].push_back(makeMapType(typeOf<std::string>(), tupleType));
+        types[t].push_back(makeOptionalType(tupleType));
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  for (int t = 1; t < threadCount; ++t)
+    EXPECT_EQ(types[0], types[t]);
+  EXPECT_EQ(makeListType(types[0][0]), types[0][1]);
+}